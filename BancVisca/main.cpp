@@ -0,0 +1,1318 @@
+﻿//*********************************************************************************************
+//* Programme : main.cpp (BancVisca)                                           Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Bancs de mesure des chemins critiques (QBENCHMARK) : encodage d'une commande (paquet
+//*       binaire contre texte hexadécimal d'origine), décodage d'une réponse, découpage d'un
+//*       flux reçu (rafale, puis débit en réponses par seconde sur des lectures de tailles
+//*       aléatoires), cycle complet d'une commande dans l'ordonnanceur, télémétrie (signal en
+//*       file et texte par message d'origine contre CanalTelemetrie : messages par seconde et
+//*       allocations par message), incrément d'une métrique, enregistrement du trafic série
+//*       (blocs de 9 et 64 octets dans un fichier .trc projeté en mémoire) et détection de
+//*       mouvement sur des images 1080p. À lancer en Release, par exemple :
+//*       BancVisca -minimumvalue 1000 -o resultats.csv,csv
+//*       La détection de mouvement rejoue le clip désigné par BANC_CLIP_MOUVEMENT
+//*       ("chemin:LxH", images de luminance brutes mises bout à bout, par exemple
+//*       ffmpeg -i clip.mp4 -pix_fmt gray -f rawvideo clip.gray), ou à défaut une mire animée.
+//*       La mise en visée d'une cible (nombre d'actions et temps pour l'atteindre, conduite
+//*       manuelle contre clic dans l'aperçu) est simulée en temps virtuel sur SimulateurVisca,
+//*       comme la commande d'un groupe de 64 caméras (temps jusqu'au dernier accusé).
+//*       Sous Unix, 64 caméras réparties sur dix processus SimulateurVisca (pseudo-terminaux,
+//*       temps réel) sont aussi pilotées par GestionnaireCameras : temps pour qu'une commande
+//*       envoyée à chacune soit terminée partout. Devant ces caméras, un générateur de charge
+//*       (200 pupitres TCP ou WebSocket) mesure les allers-retours par seconde traités par
+//*       ServeurControle : lecture d'état, puis rappel de mémoire jusqu'à son aboutissement.
+//* Programmes associés : ../CameraDeSurveillance/Visca.h, AnalyseurVisca.cpp,
+//*                       OrdonnanceurCommandes.cpp, CanalTelemetrie.h, Metriques.h,
+//*                       EnregistreurTrafic.cpp, FormatTrace.h,
+//*                       DetectionMouvement.cpp, NoyauxMouvement.cpp, ChampVision.cpp,
+//*                       GestionnaireCameras.cpp, ServeurControle.cpp, ProtocoleControle.h,
+//*                       ../SimulateurVisca/SimulateurVisca.cpp,
+//*                       ../SimulateurVisca/main.cpp
+//*********************************************************************************************
+
+#include <QtTest>
+#include <QProcess>
+#include <QSet>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QWebSocket>
+#include "AnalyseurVisca.h"
+#include "CanalTelemetrie.h"
+#include "ChampVision.h"
+#include "DetectionMouvement.h"
+#include "EnregistreurTrafic.h"
+#include "EtatCameras.h"
+#include "GestionnaireCameras.h"
+#include "Metriques.h"
+#include "OrdonnanceurCommandes.h"
+#include "ProtocoleControle.h"
+#include "ServeurControle.h"
+#include "TransactionsVisca.h"
+#include "Visca.h"
+#include "../SimulateurVisca/SimulateurVisca.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    std::atomic<quint64> allocationCount { 0 };
+}
+
+#ifdef __GLIBC__
+// Comptage des allocations de tout le processus, Qt compris (QString, QByteArray et évènements
+// passent tous par malloc) : glibc laisse l'exécutable remplacer malloc et garde l'original
+constexpr bool COUNTS_ALLOCATIONS = true;
+
+extern "C"
+{
+    void* __libc_malloc(std::size_t size);
+    void* __libc_calloc(std::size_t count, std::size_t size);
+    void* __libc_realloc(void* pointer, std::size_t size);
+
+    void* malloc(std::size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void* calloc(std::size_t count, std::size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, std::size_t size) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(pointer, size);
+    }
+}
+#else
+constexpr bool COUNTS_ALLOCATIONS = false;
+#endif
+
+// Chemin de télémétrie d'origine, pour comparaison : un signal en file par état, comme
+// ControleCamera::stateChanged vers la fenêtre avant CanalTelemetrie
+class EmetteurEtat : public QObject
+{
+    Q_OBJECT
+
+signals:
+    void stateChanged(quint8 address, const CameraState& state);
+};
+
+class BancVisca : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodeDrive();
+    void encodeDriveText();
+    void parseReply();
+    void frameStream();
+    void frameThroughput();
+    void scheduleCommand();
+    void telemetry_data();
+    void telemetry();
+    void metricIncrement();
+    void recordTraffic_data();
+    void recordTraffic();
+    void motionDetect_data();
+    void motionDetect();
+    void targetAcquisition_data();
+    void targetAcquisition();
+    void groupAcknowledge_data();
+    void groupAcknowledge();
+    void managerCommands();
+    void serverRoundTrips_data();
+    void serverRoundTrips();
+
+private:
+    QByteArray clip;
+    int clipWidth = 0;
+    int clipHeight = 0;
+    void loadClip();
+};
+
+namespace
+{
+    // Mire 1080p : fond bruité et carré traversant l'image
+    QByteArray syntheticClip(int width, int height, int frames)
+    {
+        QByteArray data(width * height * frames, Qt::Uninitialized);
+        quint32 noise = 12345;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            std::uint8_t* pixels = reinterpret_cast<std::uint8_t*>(data.data()) + frame * width * height;
+            for (int i = 0; i < width * height; ++i)
+            {
+                noise = noise * 1664525u + 1013904223u;
+                pixels[i] = static_cast<std::uint8_t>(96 + (noise >> 29));
+            }
+            int left = frame * (width - 200) / frames;
+            for (int y = height / 2 - 100; y < height / 2 + 100; ++y)
+            {
+                std::memset(pixels + y * width + left, 230, 200);
+            }
+        }
+        return data;
+    }
+
+    using namespace std::chrono_literals;
+
+    SimulateurVisca::Options chainOptions(int cameras)
+    {
+        SimulateurVisca::Options options;
+        options.cameras = cameras;
+        return options;
+    }
+
+    // Chaîne de caméras simulée en temps virtuel : les paquets arrivent au débit de la liaison,
+    // les axes avancent par pas de 10 ms et les réponses sont lues puis ignorées
+    class ChaineVirtuelle
+    {
+    public:
+        explicit ChaineVirtuelle(int cameras)
+            : simulateur(chainOptions(cameras)), start(SimulateurVisca::Clock::now()), now(start)
+        {
+            send(Visca::addressSet());
+            run(100ms);
+        }
+
+        template <typename Packet>
+        void send(const Packet& packet)
+        {
+            simulateur.receive(packet.bytes, packet.size(), now);
+        }
+
+        void run(std::chrono::milliseconds duration)
+        {
+            SimulateurVisca::Clock::time_point end = now + duration;
+            std::uint8_t buffer[256];
+            while (now < end)
+            {
+                now += 10ms;
+                simulateur.advance(now);
+                while (simulateur.transmit(buffer, sizeof(buffer), now) > 0)
+                {
+                }
+            }
+        }
+
+        // Attend la fin du mouvement en cours (20 s au plus)
+        void settle()
+        {
+            run(20ms);
+            for (int step = 0; step < 2000 && simulateur.position(0).moving; ++step)
+            {
+                run(10ms);
+            }
+        }
+
+        ChampVision::Pose pose() const
+        {
+            SimulateurVisca::Position position = simulateur.position(0);
+            ChampVision::Pose result;
+            result.pan = static_cast<std::int16_t>(std::lround(position.pan));
+            result.tilt = static_cast<std::int16_t>(std::lround(position.tilt));
+            result.zoom = static_cast<std::uint16_t>(std::lround(position.zoom));
+            return result;
+        }
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(now - start).count();
+        }
+
+    private:
+        SimulateurVisca simulateur;
+        SimulateurVisca::Clock::time_point start;
+        SimulateurVisca::Clock::time_point now;
+    };
+
+    //-----------------------------------------------------------------------------------------
+    //* Modèle de l'opérateur : chaque action (regarder l'image, décider, agir) coûte
+    //* ACTION_DELAY. En conduite manuelle, il dirige la caméra en vitesse (manette ou
+    //* setVelocity), vitesse choisie pour un mouvement d'environ une seconde, et relâche à
+    //* ±RELEASE_JITTER près ; il règle le zoom au curseur à ±ZOOM_JITTER près, une fois la cible
+    //* proche du centre. Au clic, il trace le rectangle à cadrer (ou clique la cible une fois
+    //* le zoom atteint) à ±CLICK_JITTER de l'image près. La cible est atteinte quand elle est à
+    //* moins de 10 % du demi-champ final du centre et le grossissement à 10 % près.
+    //-----------------------------------------------------------------------------------------
+    constexpr double PI = 3.14159265358979323846;
+    constexpr double ASPECT = 16.0 / 9.0;
+    constexpr std::chrono::milliseconds ACTION_DELAY(400);
+    constexpr double RELEASE_JITTER = 0.08;         // s
+    constexpr double ZOOM_JITTER = 0.15;            // Part du grossissement visé
+    constexpr double CLICK_JITTER = 0.005;          // Part de l'image
+    constexpr int MAX_ACTIONS = 40;
+    constexpr double PAN_UNITS_PER_SPEED = 100.0;   // Vitesses du simulateur (unités/s par cran)
+    constexpr double TILT_UNITS_PER_SPEED = 60.0;
+
+    struct Cible
+    {
+        double pan;
+        double tilt;
+        double magnification;
+    };
+
+    struct Essai
+    {
+        int actions = 0;
+        double seconds = 0.0;
+        bool reached = false;
+    };
+
+    double radians(double units)
+    {
+        return units / ChampVision::UNITS_PER_DEGREE * PI / 180.0;
+    }
+
+    // Place de la cible dans l'image d'une visée (inverse de ChampVision::direction) et écart
+    // angulaire entre la cible et le centre de l'image
+    void project(const ChampVision::Pose& pose, const Cible& cible, double& x, double& y, double& errorDegrees)
+    {
+        double tangent = std::tan(ChampVision::WIDE_FOV / 2.0 * PI / 180.0) / ChampVision::magnification(pose.zoom);
+        double p = radians(pose.pan);
+        double t = radians(pose.tilt);
+        double d[3] = { std::cos(radians(cible.tilt)) * std::sin(radians(cible.pan)), std::sin(radians(cible.tilt)),
+            std::cos(radians(cible.tilt)) * std::cos(radians(cible.pan)) };
+        double forward = d[0] * std::cos(t) * std::sin(p) + d[1] * std::sin(t) + d[2] * std::cos(t) * std::cos(p);
+        double right = d[0] * std::cos(p) - d[2] * std::sin(p);
+        double up = -d[0] * std::sin(t) * std::sin(p) + d[1] * std::cos(t) - d[2] * std::sin(t) * std::cos(p);
+        errorDegrees = std::acos(std::clamp(forward, -1.0, 1.0)) * 180.0 / PI;
+        x = forward > 0.0 ? (right / forward / tangent + 1.0) / 2.0 : 0.5;
+        y = forward > 0.0 ? (1.0 - up / forward * ASPECT / tangent) / 2.0 : 0.5;
+    }
+
+    Essai acquire(const Cible& cible, bool click, std::mt19937& random)
+    {
+        std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+        ChaineVirtuelle chaine(1);
+        double start = chaine.seconds();
+        double tolerance = 0.1 * ChampVision::horizontalFov(ChampVision::zoomFor(cible.magnification)) / 2.0;
+        Essai essai;
+        while (essai.actions < MAX_ACTIONS)
+        {
+            ChampVision::Pose pose = chaine.pose();
+            double x = 0.5;
+            double y = 0.5;
+            double error = 0.0;
+            project(pose, cible, x, y, error);
+            double ratio = ChampVision::magnification(pose.zoom) / cible.magnification;
+            bool zoomReached = std::abs(ratio - 1.0) <= 0.1;
+            if (error <= tolerance && zoomReached)
+            {
+                essai.reached = true;
+                break;
+            }
+
+            chaine.run(ACTION_DELAY);
+            ++essai.actions;
+            if (click)
+            {
+                // Un seul mouvement absolu : AbsolutePosition et CAM_Zoom Direct (ControleCamera::moveTo)
+                x += CLICK_JITTER * jitter(random);
+                y += CLICK_JITTER * jitter(random);
+                ChampVision::Pose target;
+                if (zoomReached)
+                {
+                    target = ChampVision::centerOn(pose, x, y, ASPECT);
+                }
+                else
+                {
+                    double extent = ratio * (1.0 + 2.0 * CLICK_JITTER * jitter(random));
+                    target = ChampVision::frame(pose, x - extent / 2.0, y - extent / 2.0, extent, extent, ASPECT);
+                }
+                chaine.send(Visca::absolutePosition(1, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+                    static_cast<std::uint16_t>(target.pan), static_cast<std::uint16_t>(target.tilt)));
+                chaine.send(Visca::zoomDirect(1, target.zoom));
+                chaine.settle();
+            }
+            else if (!zoomReached && error < 0.25 * ChampVision::horizontalFov(pose.zoom) / 2.0)
+            {
+                chaine.send(Visca::zoomDirect(1, ChampVision::zoomFor(cible.magnification * (1.0 + ZOOM_JITTER * jitter(random)))));
+                chaine.settle();
+            }
+            else
+            {
+                // Conduite en vitesse sur les deux axes, chacun relâché à son arrivée estimée
+                double panError = cible.pan - pose.pan;
+                double tiltError = cible.tilt - pose.tilt;
+                int panSpeed = std::clamp(static_cast<int>(std::ceil(std::abs(panError) / PAN_UNITS_PER_SPEED)), 1, int(Visca::PAN_SPEED_MAX));
+                int tiltSpeed = std::clamp(static_cast<int>(std::ceil(std::abs(tiltError) / TILT_UNITS_PER_SPEED)), 1, int(Visca::TILT_SPEED_MAX));
+                double panTime = std::max(0.0, std::abs(panError) / (panSpeed * PAN_UNITS_PER_SPEED) + RELEASE_JITTER * jitter(random));
+                double tiltTime = std::max(0.0, std::abs(tiltError) / (tiltSpeed * TILT_UNITS_PER_SPEED) + RELEASE_JITTER * jitter(random));
+                Visca::PanDirection pan = panTime <= 0.0 ? Visca::PanDirection::Stop
+                    : (panError > 0.0 ? Visca::PanDirection::Right : Visca::PanDirection::Left);
+                Visca::TiltDirection tilt = tiltTime <= 0.0 ? Visca::TiltDirection::Stop
+                    : (tiltError > 0.0 ? Visca::TiltDirection::Up : Visca::TiltDirection::Down);
+                std::uint8_t vv = static_cast<std::uint8_t>(panSpeed);
+                std::uint8_t ww = static_cast<std::uint8_t>(tiltSpeed);
+                double first = std::min(panTime, tiltTime);
+                double last = std::max(panTime, tiltTime);
+
+                chaine.send(Visca::panTiltDrive(1, vv, ww, pan, tilt));
+                chaine.run(std::chrono::milliseconds(std::lround(first * 1000.0)));
+                chaine.send(Visca::panTiltDrive(1, vv, ww, panTime > tiltTime ? pan : Visca::PanDirection::Stop,
+                    tiltTime > panTime ? tilt : Visca::TiltDirection::Stop));
+                chaine.run(std::chrono::milliseconds(std::lround((last - first) * 1000.0)));
+                chaine.send(Visca::panTiltStop(1));
+                chaine.run(30ms);
+            }
+        }
+        essai.seconds = chaine.seconds() - start;
+        return essai;
+    }
+
+    // Chaîne simulée derrière le vrai chemin d'envoi (ordonnanceur, transactions, découpage des
+    // réponses) : seul le port série est remplacé, les octets passent au débit de la liaison
+    class LiaisonVirtuelle
+    {
+    public:
+        LiaisonVirtuelle(int cameras, const SimulateurVisca::Clock::time_point& now)
+            : simulateur(chainOptions(cameras)), clock(now), cameraCount(cameras),
+            transactions([this](const char* data, qint64 size) {
+                ++writes;
+                simulateur.receive(reinterpret_cast<const std::uint8_t*>(data), static_cast<std::size_t>(size), clock);
+                return true;
+            }),
+            ordonnanceur(transactions)
+        {
+            QObject::connect(&transactions, &TransactionsVisca::commandAcknowledged, [this]() { ++acknowledged; });
+            QObject::connect(&transactions, &TransactionsVisca::commandCompleted, [this](quint32 id) {
+                // La diffusion revenue est passée par chaque caméra de la chaîne
+                if (id == broadcastId)
+                {
+                    acknowledged += cameraCount;
+                }
+            });
+        }
+
+        void enumerate()
+        {
+            Visca::Command command = Visca::addressSet();
+            simulateur.receive(command.bytes, command.size, clock);
+        }
+
+        // Même commande pour toute la chaîne, comme GestionnaireCameras::sendGroup
+        void sendGroup(const Visca::Command& command, bool broadcast)
+        {
+            transactions.holdWrites();
+            Visca::Command routed = command;
+            if (broadcast && cameraCount > 1)
+            {
+                routed.setAddress(Visca::BROADCAST_ADDRESS);
+                broadcastId = ordonnanceur.schedule(routed);
+            }
+            else
+            {
+                for (int address = 1; address <= cameraCount; ++address)
+                {
+                    routed.setAddress(static_cast<std::uint8_t>(address));
+                    ordonnanceur.schedule(routed);
+                }
+            }
+            transactions.releaseWrites();
+        }
+
+        void send(const Visca::Command& command)
+        {
+            ordonnanceur.schedule(command);
+        }
+
+        void step()
+        {
+            simulateur.advance(clock);
+            std::uint8_t buffer[AnalyseurVisca::RING_SIZE];
+            std::size_t size;
+            while ((size = simulateur.transmit(buffer, sizeof(buffer), clock)) > 0)
+            {
+                analyseur.feed(buffer, size);
+                Visca::Reply reply;
+                while (analyseur.next(reply))
+                {
+                    transactions.handleReply(reply);
+                }
+            }
+        }
+
+        int cameras() const { return cameraCount; }
+
+        int writes = 0;
+        int acknowledged = 0;
+
+    private:
+        SimulateurVisca simulateur;
+        const SimulateurVisca::Clock::time_point& clock;
+        int cameraCount;
+        quint32 broadcastId = 0;
+        TransactionsVisca transactions;
+        OrdonnanceurCommandes ordonnanceur;
+        AnalyseurVisca analyseur;
+    };
+
+    // Chaînes simulées derrière de vrais ports : un processus SimulateurVisca par chaîne, sur un
+    // pseudo-terminal que l'application ouvre comme un port série, en temps réel
+    class ChainesPty
+    {
+    public:
+        ~ChainesPty()
+        {
+            for (const std::unique_ptr<QProcess>& process : processes)
+            {
+                process->terminate();
+                process->waitForFinished(2000);
+            }
+        }
+
+        // Faux si le simulateur n'est pas à côté du banc (Windows, ou cible pas construite)
+        bool start(const QList<int>& cameraCounts)
+        {
+            const QString program = QCoreApplication::applicationDirPath() + "/SimulateurVisca";
+            if (!directory.isValid() || !QFileInfo(program).isExecutable())
+            {
+                return false;
+            }
+            for (int cameras : cameraCounts)
+            {
+                QString link = directory.filePath(QString("visca%1").arg(paths.size()));
+                auto process = std::make_unique<QProcess>();
+                process->start(program, { "--cameras", QString::number(cameras), "--link", link });
+                // La première ligne est écrite une fois le lien créé
+                if (!process->waitForStarted(2000) || !process->waitForReadyRead(5000))
+                {
+                    return false;
+                }
+                processes.push_back(std::move(process));
+                paths.append(link);
+            }
+            return true;
+        }
+
+        const QStringList& links() const { return paths; }
+
+    private:
+        QTemporaryDir directory;
+        std::vector<std::unique_ptr<QProcess>> processes;
+        QStringList paths;
+    };
+
+    // Pupitres simulés pour ServeurControle, servis par leur propre thread pour ne pas prendre
+    // le temps du serveur. Chacun garde WINDOW requêtes en cours et en relance une à chaque
+    // réponse (état) ou à chaque évènement d'aboutissement (rappel de mémoire).
+    class GenerateurCharge
+    {
+    public:
+        static constexpr int WINDOW = 4;            // Sous ServeurControle::MAX_IN_FLIGHT
+        static constexpr quint8 MEMORY = 15;        // Jamais enregistrée : Completion sans mouvement
+
+        GenerateurCharge(bool webSocket, bool memory, const QList<CameraId>& cameras)
+            : webSocket(webSocket), memory(memory), cameras(cameras)
+        {
+            context.moveToThread(&thread);
+            thread.start();
+        }
+
+        ~GenerateurCharge()
+        {
+            QMetaObject::invokeMethod(&context, [this]() { qDeleteAll(context.children()); },
+                Qt::BlockingQueuedConnection);
+            thread.quit();
+            thread.wait();
+        }
+
+        void connectClients(int count, quint16 port)
+        {
+            QMetaObject::invokeMethod(&context, [this, count, port]() {
+                for (int i = 0; i < count; ++i)
+                {
+                    if (webSocket)
+                    {
+                        openWebSocket(port);
+                    }
+                    else
+                    {
+                        openTcp(port);
+                    }
+                }
+            });
+        }
+
+        std::atomic<int> connected { 0 };
+        std::atomic<quint64> roundTrips { 0 };
+        std::atomic<quint64> errors { 0 };
+
+    private:
+        enum class Outcome
+        {
+            Pending,    // Commande acceptée, aboutissement attendu
+            Done,
+            Error,
+            Ignored
+        };
+
+        // Vrai si l'aller-retour est fini et qu'une requête doit être relancée
+        bool settle(Outcome outcome)
+        {
+            if (outcome == Outcome::Done)
+            {
+                ++roundTrips;
+            }
+            else if (outcome == Outcome::Error)
+            {
+                ++errors;
+            }
+            return outcome == Outcome::Done || outcome == Outcome::Error;
+        }
+
+        const CameraId& nextCamera()
+        {
+            return cameras.at(static_cast<int>(next++ % static_cast<quint32>(cameras.size())));
+        }
+
+        void openTcp(quint16 port)
+        {
+            auto* socket = new QTcpSocket(&context);
+            auto* input = new QByteArray;
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            QObject::connect(socket, &QObject::destroyed, [input]() { delete input; });
+            QObject::connect(socket, &QTcpSocket::connected, socket, [this, socket]() {
+                ++connected;
+                for (int i = 0; i < WINDOW; ++i)
+                {
+                    sendTcp(socket);
+                }
+            });
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, input]() {
+                const int lengthSize = static_cast<int>(ProtocoleControle::LENGTH_SIZE);
+                input->append(socket->readAll());
+                int offset = 0;
+                while (input->size() - offset >= lengthSize)
+                {
+                    int length = qFromLittleEndian<quint16>(input->constData() + offset);
+                    if (length < 1 || input->size() - offset < lengthSize + length)
+                    {
+                        break;
+                    }
+                    const auto* body = reinterpret_cast<const quint8*>(input->constData() + offset + lengthSize);
+                    offset += lengthSize + length;
+                    if (settle(tcpOutcome(body, length)))
+                    {
+                        sendTcp(socket);
+                    }
+                }
+                input->remove(0, offset);
+            });
+            socket->connectToHost(QHostAddress::LocalHost, port);
+        }
+
+        Outcome tcpOutcome(const quint8* body, int length) const
+        {
+            using ProtocoleControle::Event;
+            if (body[0] == static_cast<quint8>(Event::Completed))
+            {
+                return Outcome::Done;
+            }
+            if (body[0] == static_cast<quint8>(Event::Failed) || body[0] == static_cast<quint8>(Event::Coalesced))
+            {
+                return Outcome::Error;
+            }
+            if (body[0] == static_cast<quint8>(Event::State) || length < 2)
+            {
+                return Outcome::Ignored;
+            }
+            if (body[1] != static_cast<quint8>(ProtocoleControle::Status::Ok))
+            {
+                return Outcome::Error;
+            }
+            return memory ? Outcome::Pending : Outcome::Done;
+        }
+
+        void sendTcp(QTcpSocket* socket)
+        {
+            const CameraId& camera = nextCamera();
+            const int length = static_cast<int>(ProtocoleControle::REQUEST_HEADER) + (memory ? 1 : 0);
+            char frame[ProtocoleControle::LENGTH_SIZE + ProtocoleControle::REQUEST_HEADER + 1];
+            qToLittleEndian<quint16>(static_cast<quint16>(length), frame);
+            frame[2] = static_cast<char>(memory ? ProtocoleControle::Operation::Memory : ProtocoleControle::Operation::State);
+            frame[3] = static_cast<char>(camera.port);
+            frame[4] = static_cast<char>(camera.address);
+            qToLittleEndian<quint32>(next, frame + 5);
+            frame[9] = static_cast<char>(MEMORY);
+            socket->write(frame, static_cast<qint64>(ProtocoleControle::LENGTH_SIZE) + length);
+        }
+
+        void openWebSocket(quint16 port)
+        {
+            auto* socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, &context);
+            QObject::connect(socket, &QWebSocket::connected, socket, [this, socket]() {
+                ++connected;
+                for (int i = 0; i < WINDOW; ++i)
+                {
+                    sendJson(socket);
+                }
+            });
+            QObject::connect(socket, &QWebSocket::textMessageReceived, socket, [this, socket](const QString& message) {
+                if (settle(jsonOutcome(QJsonDocument::fromJson(message.toUtf8()).object())))
+                {
+                    sendJson(socket);
+                }
+            });
+            socket->open(QUrl(QString("ws://127.0.0.1:%1").arg(port)));
+        }
+
+        Outcome jsonOutcome(const QJsonObject& object) const
+        {
+            QString event = object.value("event").toString();
+            if (event == "completed")
+            {
+                return Outcome::Done;
+            }
+            if (!event.isEmpty())
+            {
+                return event == "state" ? Outcome::Ignored : Outcome::Error;
+            }
+            if (object.value("status").toString() != "ok")
+            {
+                return Outcome::Error;
+            }
+            return memory ? Outcome::Pending : Outcome::Done;
+        }
+
+        void sendJson(QWebSocket* socket)
+        {
+            const CameraId& camera = nextCamera();
+            QJsonObject request;
+            request.insert("op", memory ? "memory" : "state");
+            request.insert("port", camera.port);
+            request.insert("address", camera.address);
+            request.insert("tag", static_cast<double>(next));
+            if (memory)
+            {
+                request.insert("memory", MEMORY);
+            }
+            socket->sendTextMessage(QString::fromUtf8(QJsonDocument(request).toJson(QJsonDocument::Compact)));
+        }
+
+        const bool webSocket;
+        const bool memory;
+        const QList<CameraId> cameras;
+        quint32 next = 0;               // Étiquette et caméra suivantes (thread des pupitres)
+        QThread thread;
+        QObject context;                // Parent des sockets, vit dans le thread des pupitres
+    };
+
+    // Neuf chaînes de 7 caméras et une chaîne d'une caméra : 64 caméras sur dix ports
+    QList<int> sixtyFourCameras()
+    {
+        QList<int> counts;
+        for (int remaining = 64; remaining > 0; remaining -= 7)
+        {
+            counts.append(std::min(remaining, 7));
+        }
+        return counts;
+    }
+}
+
+void BancVisca::encodeDrive()
+{
+    std::uint8_t speed = 1;
+    Visca::Command command;
+    QBENCHMARK {
+        command = Visca::panTiltDrive(1, speed, speed, Visca::PanDirection::Left, Visca::TiltDirection::Up);
+        ++speed;
+    }
+    QVERIFY(command.size == 9);
+}
+
+void BancVisca::encodeDriveText()
+{
+    // Chemin d'origine de writeToPort : texte hexadécimal construit puis converti à chaque envoi
+    std::uint8_t speed = 1;
+    std::uint8_t sent = speed;
+    QByteArray data;
+    QBENCHMARK {
+        QString command = QString("81 01 06 01 %1 %2 01 01 FF")
+            .arg(speed, 2, 16, QLatin1Char('0'))
+            .arg(speed, 2, 16, QLatin1Char('0'));
+        data = QByteArray::fromHex(command.toLatin1());
+        sent = speed;
+        speed = static_cast<std::uint8_t>(speed % Visca::TILT_SPEED_MAX + 1);
+    }
+    Visca::Command command = Visca::panTiltDrive(1, sent, sent, Visca::PanDirection::Left, Visca::TiltDirection::Up);
+    QCOMPARE(data, QByteArray(command.data(), command.size));
+}
+
+void BancVisca::parseReply()
+{
+    const std::uint8_t packet[] = { 0x90, 0x50, 0x01, 0x02, 0x03, 0x04, 0xFF };
+    Visca::Reply reply;
+    QBENCHMARK {
+        reply = Visca::parseReply(packet, sizeof(packet));
+    }
+    QCOMPARE(reply.type, Visca::ReplyType::InquiryReply);
+}
+
+void BancVisca::frameStream()
+{
+    // Rafale typique d'une interrogation de chaîne : ACK, Completion et réponse de position
+    const std::uint8_t stream[] = { 0x90, 0x41, 0xFF, 0x90, 0x51, 0xFF,
+        0x90, 0x50, 0x00, 0x01, 0x02, 0x03, 0x0F, 0x0E, 0x0D, 0x0C, 0xFF };
+    AnalyseurVisca analyseur;
+    Visca::Reply reply;
+    int replies = 0;
+    QBENCHMARK {
+        analyseur.feed(stream, sizeof(stream));
+        while (analyseur.next(reply))
+        {
+            ++replies;
+        }
+    }
+    QVERIFY(replies > 0);
+    QCOMPARE(analyseur.framingErrors(), std::uint64_t(0));
+}
+
+void BancVisca::frameThroughput()
+{
+    // Débit du découpage : 10 000 réponses (ACK, Completion, positions) reçues en lectures de 1
+    // à 64 octets, tailles tirées une fois pour toutes. Résultat : réponses par seconde.
+    std::mt19937 random(2026);
+    std::uniform_int_distribution<int> kind(0, 2);
+    std::uniform_int_distribution<int> chunk(1, 64);
+    QByteArray stream;
+    const int replies = 10000;
+    for (int index = 0; index < replies; ++index)
+    {
+        const char address = static_cast<char>(0x90 + 0x10 * (index % 7));
+        switch (kind(random))
+        {
+        case 0: stream += QByteArray(1, address) + QByteArray::fromHex("41ff"); break;
+        case 1: stream += QByteArray(1, address) + QByteArray::fromHex("51ff"); break;
+        default: stream += QByteArray(1, address) + QByteArray::fromHex("50000102030f0e0d0cff"); break;
+        }
+    }
+    std::vector<int> reads;
+    for (int offset = 0; offset < stream.size(); offset += reads.back())
+    {
+        reads.push_back(std::min(chunk(random), static_cast<int>(stream.size()) - offset));
+    }
+
+    AnalyseurVisca analyseur;
+    Visca::Reply reply;
+    qint64 parsed = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        const std::uint8_t* data = reinterpret_cast<const std::uint8_t*>(stream.constData());
+        for (int size : reads)
+        {
+            analyseur.feed(data, static_cast<std::size_t>(size));
+            data += size;
+            while (analyseur.next(reply))
+            {
+                ++parsed;
+            }
+        }
+    }
+    double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+    qInfo("%.1f millions de réponses par seconde", static_cast<double>(parsed) / seconds / 1e6);
+    QCOMPARE(parsed % replies, qint64(0));
+    QCOMPARE(analyseur.framingErrors(), std::uint64_t(0));
+}
+
+void BancVisca::scheduleCommand()
+{
+    // Planification, écriture, ACK et Completion d'une commande, sans port série
+    qint64 written = 0;
+    TransactionsVisca transactions([&written](const char*, qint64 size) {
+        written += size;
+        return true;
+    });
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    const std::uint8_t ack[] = { 0x90, 0x41, 0xFF };
+    const std::uint8_t completion[] = { 0x90, 0x51, 0xFF };
+    const Visca::Reply ackReply = Visca::parseReply(ack, sizeof(ack));
+    const Visca::Reply completionReply = Visca::parseReply(completion, sizeof(completion));
+
+    QBENCHMARK {
+        ordonnanceur.schedule(Visca::zoomDirect(1, 0x2000), CommandClass::ZoomAbsolute);
+        transactions.handleReply(ackReply);
+        transactions.handleReply(completionReply);
+    }
+    QVERIFY(transactions.isIdle());
+    QVERIFY(written > 0);
+}
+
+void BancVisca::telemetry_data()
+{
+    QTest::addColumn<bool>("channel");
+
+    QTest::newRow("signal-en-file") << false;
+    QTest::newRow("canal") << true;
+}
+
+void BancVisca::telemetry()
+{
+    // Un thread de chaîne publie 200 000 états aussi vite que possible, la fenêtre les relève :
+    // - avant : un signal en file par état, texte de la barre d'état formaté à chaque message ;
+    // - après : instantanés copiés dans CanalTelemetrie, relevés en boucle, texte formaté une
+    //   fois par relève (le producteur attend si l'anneau est plein, rien n'est perdu).
+    // Résultats : messages par seconde et allocations par message (processus entier, glibc).
+    QFETCH(bool, channel);
+    const int count = 200000;
+    auto statusText = [](qint16 pan, qint16 tilt, quint16 zoom, bool moving) {
+        return QString("Pan %1   Tilt %2   Zoom %3%4").arg(pan).arg(tilt).arg(zoom).arg(moving ? "   ..." : "");
+    };
+
+    qRegisterMetaType<CameraState>();
+    EmetteurEtat emetteur;
+    CanalTelemetrie canal;
+    QString shown;
+    int received = 0;
+    int formatted = 0;
+    connect(&emetteur, &EmetteurEtat::stateChanged, this, [&](quint8, const CameraState& state) {
+        ++received;
+        ++formatted;
+        shown = statusText(state.pan, state.tilt, state.zoom, state.moving);
+    }, Qt::QueuedConnection);
+
+    std::unique_ptr<QThread> producer(QThread::create([&]() {
+        CameraState state;
+        Telemetrie::Snapshot snapshot = {};
+        snapshot.address = 1;
+        for (int index = 0; index < count; ++index)
+        {
+            state.pan = snapshot.pan = static_cast<qint16>(index);
+            if (!channel)
+            {
+                emit emetteur.stateChanged(1, state);
+                continue;
+            }
+            while (!canal.push(snapshot))
+            {
+                QThread::yieldCurrentThread();
+            }
+        }
+    }));
+
+    const quint64 allocationsBefore = allocationCount.load();
+    QElapsedTimer timer;
+    timer.start();
+    producer->start();
+    while (received < count)
+    {
+        if (!channel)
+        {
+            QCoreApplication::processEvents();
+            continue;
+        }
+        if (std::size_t drained = canal.drain())
+        {
+            received += static_cast<int>(drained);
+            const Telemetrie::Snapshot& state = canal.latest(1);
+            ++formatted;
+            shown = statusText(state.pan, state.tilt, state.zoom, (state.flags & Telemetrie::MOVING) != 0);
+        }
+    }
+    const double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+    const double perMessage = static_cast<double>(allocationCount.load() - allocationsBefore) / count;
+    producer->wait();
+
+    const double rate = count / seconds;
+    if (COUNTS_ALLOCATIONS)
+    {
+        qInfo("%s : %.0f messages par seconde, %.2f allocations par message, %d textes formatés",
+            QTest::currentDataTag(), rate, perMessage, formatted);
+    }
+    else
+    {
+        qInfo("%s : %.0f messages par seconde, %d textes formatés (allocations non comptées hors glibc)",
+            QTest::currentDataTag(), rate, formatted);
+    }
+    QTest::setBenchmarkResult(rate, QTest::Events);
+    QCOMPARE(shown, statusText(static_cast<qint16>(count - 1), 0, 0, false));
+}
+
+void BancVisca::metricIncrement()
+{
+    QBENCHMARK {
+        Metriques::add(Metrique::Counter::CommandsSent);
+    }
+    QVERIFY(Metriques::counter(Metrique::Counter::CommandsSent) > 0);
+}
+
+void BancVisca::recordTraffic_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("9-octets") << 9;      // Une commande de déplacement
+    QTest::newRow("64-octets") << 64;    // Une lecture groupée, sur trois enregistrements
+}
+
+void BancVisca::recordTraffic()
+{
+    // Enregistrement d'un bloc dans un fichier .trc projeté en mémoire, horodatage compris.
+    // Résultat : nanosecondes par appel ; l'enregistreur reste actif en production s'il coûte
+    // bien moins d'une microseconde.
+    QFETCH(int, size);
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    EnregistreurTrafic enregistreur;
+    QVERIFY(enregistreur.open(directory.filePath("banc.trc")));
+    const quint64 before = enregistreur.recordCount();     // Enregistrement de session
+
+    QByteArray data(size, '\0');
+    for (int index = 0; index < size; ++index)
+    {
+        data[index] = static_cast<char>(0x81 + index);
+    }
+    qint64 calls = 0;
+    QElapsedTimer timer;
+    timer.start();
+    QBENCHMARK {
+        enregistreur.record(Trace::Direction::Transmit, data.constData(), data.size());
+        ++calls;
+    }
+    const double perCall = static_cast<double>(timer.nsecsElapsed()) / static_cast<double>(calls);
+    qInfo("%s : %.0f ns par appel", QTest::currentDataTag(), perCall);
+
+    const qint64 perRecord = (size + static_cast<qint64>(Trace::RECORD_DATA) - 1) / static_cast<qint64>(Trace::RECORD_DATA);
+    QCOMPARE(enregistreur.recordCount() - before, static_cast<quint64>(calls * perRecord));
+    QVERIFY(perCall < 1000.0);
+}
+
+void BancVisca::loadClip()
+{
+    if (!clip.isEmpty())
+    {
+        return;
+    }
+    QString source = qEnvironmentVariable("BANC_CLIP_MOUVEMENT");
+    int separator = source.lastIndexOf(':');
+    QStringList size = source.mid(separator + 1).split('x');
+    if (separator > 0 && size.size() == 2)
+    {
+        QFile file(source.left(separator));
+        clipWidth = size[0].toInt();
+        clipHeight = size[1].toInt();
+        if (clipWidth > 0 && clipHeight > 0 && file.open(QIODevice::ReadOnly))
+        {
+            clip = file.readAll();
+            clip.truncate(clip.size() - clip.size() % (clipWidth * clipHeight));
+        }
+    }
+    if (clip.isEmpty())
+    {
+        clipWidth = 1920;
+        clipHeight = 1080;
+        clip = syntheticClip(clipWidth, clipHeight, 30);
+    }
+}
+
+void BancVisca::motionDetect_data()
+{
+    QTest::addColumn<int>("isa");
+    QTest::newRow("scalaire") << static_cast<int>(NoyauxMouvement::Isa::Scalar);
+    if (NoyauxMouvement::supported(NoyauxMouvement::Isa::Sse2))
+    {
+        QTest::newRow("sse2") << static_cast<int>(NoyauxMouvement::Isa::Sse2);
+    }
+    if (NoyauxMouvement::supported(NoyauxMouvement::Isa::Avx2))
+    {
+        QTest::newRow("avx2") << static_cast<int>(NoyauxMouvement::Isa::Avx2);
+    }
+}
+
+void BancVisca::motionDetect()
+{
+    // Une image par itération : réduction, comparaison au fond, zones et alarmes
+    QFETCH(int, isa);
+    loadClip();
+    const int frameBytes = clipWidth * clipHeight;
+    const int frames = static_cast<int>(clip.size() / frameBytes);
+
+    DetectionMouvement detection;
+    detection.setIsa(static_cast<NoyauxMouvement::Isa>(isa));
+    Video::Image image;
+    image.width = clipWidth;
+    image.height = clipHeight;
+    image.stride = clipWidth;
+    image.format = Video::PixelFormat::Gray8;
+    int frame = 0;
+    QBENCHMARK {
+        image.data = reinterpret_cast<const std::uint8_t*>(clip.constData()) + static_cast<qsizetype>(frame) * frameBytes;
+        image.captureTime += 33333333;
+        detection.process(image);
+        frame = (frame + 1) % frames;
+    }
+    QVERIFY(detection.stats().frames > 0);
+}
+
+void BancVisca::targetAcquisition_data()
+{
+    QTest::addColumn<bool>("click");
+    QTest::newRow("manuel") << false;
+    QTest::newRow("clic") << true;
+}
+
+void BancVisca::targetAcquisition()
+{
+    // Mêmes cibles pour les deux modes : un point visible en grand angle depuis la position de
+    // repos, à cadrer entre 2x et 16x. Résultat : temps moyen jusqu'à la cible (ms, virtuel).
+    QFETCH(bool, click);
+    const int trials = 200;
+    std::mt19937 cibles(2026);
+    std::mt19937 operateur(17);
+    std::uniform_real_distribution<double> place(0.1, 0.9);
+    std::uniform_real_distribution<double> zoom(std::log(2.0), std::log(16.0));
+
+    std::vector<double> times;
+    int actions = 0;
+    int reached = 0;
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        Cible cible;
+        double x = place(cibles);
+        double y = place(cibles);
+        ChampVision::direction(ChampVision::Pose(), x, y, ASPECT, cible.pan, cible.tilt);
+        cible.magnification = std::exp(zoom(cibles));
+        Essai essai = acquire(cible, click, operateur);
+        actions += essai.actions;
+        reached += essai.reached ? 1 : 0;
+        times.push_back(essai.seconds);
+    }
+
+    std::sort(times.begin(), times.end());
+    double total = 0.0;
+    for (double seconds : times)
+    {
+        total += seconds;
+    }
+    qInfo("%s : %.2f actions, %.2f s en moyenne, %.2f s au 95e centile, %d/%d cibles atteintes",
+        click ? "clic" : "manuel", static_cast<double>(actions) / trials, total / trials,
+        times[trials * 95 / 100], reached, trials);
+    QTest::setBenchmarkResult(total / trials * 1000.0, QTest::WalltimeMilliseconds);
+    QCOMPARE(reached, trials);
+}
+
+void BancVisca::groupAcknowledge_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("boucle") << 0;       // Une caméra après l'autre, chacune attend son ACK
+    QTest::newRow("parallele") << 1;    // Commandes adressées, une écriture par chaîne
+    QTest::newRow("diffusion") << 2;    // Une diffusion (88) par chaîne complète
+}
+
+void BancVisca::groupAcknowledge()
+{
+    // Groupe de 64 caméras à 9600 bauds : neuf chaînes de 7 et une chaîne d'une caméra. Tout
+    // le groupe rappelle la position mémoire 5 (confinement). Résultat : temps jusqu'à ce que
+    // chaque caméra ait accusé réception (ms, virtuel).
+    QFETCH(int, mode);
+    const int cameras = 64;
+    const Visca::Command lockdown = Visca::memoryRecall(1, 5);
+
+    SimulateurVisca::Clock::time_point now;
+    std::vector<std::unique_ptr<LiaisonVirtuelle>> liaisons;
+    for (int remaining = cameras; remaining > 0; remaining -= 7)
+    {
+        liaisons.push_back(std::make_unique<LiaisonVirtuelle>(std::min(remaining, 7), now));
+    }
+    auto step = [&]() {
+        now += 1ms;
+        for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+        {
+            liaison->step();
+        }
+    };
+    auto acknowledged = [&]() {
+        int count = 0;
+        for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+        {
+            count += liaison->acknowledged;
+        }
+        return count;
+    };
+
+    now = SimulateurVisca::Clock::now();
+    for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+    {
+        liaison->enumerate();
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        step();
+    }
+    for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+    {
+        liaison->writes = 0;
+    }
+
+    SimulateurVisca::Clock::time_point start = now;
+    const SimulateurVisca::Clock::time_point limit = start + 10s;
+    if (mode == 0)
+    {
+        for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+        {
+            for (int address = 1; address <= liaison->cameras(); ++address)
+            {
+                Visca::Command command = lockdown;
+                command.setAddress(static_cast<std::uint8_t>(address));
+                int before = liaison->acknowledged;
+                liaison->send(command);
+                while (liaison->acknowledged == before && now < limit)
+                {
+                    step();
+                }
+            }
+        }
+    }
+    else
+    {
+        for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+        {
+            liaison->sendGroup(lockdown, mode == 2);
+        }
+        while (acknowledged() < cameras && now < limit)
+        {
+            step();
+        }
+    }
+
+    double elapsedMs = std::chrono::duration<double, std::milli>(now - start).count();
+    int writes = 0;
+    for (const std::unique_ptr<LiaisonVirtuelle>& liaison : liaisons)
+    {
+        writes += liaison->writes;
+    }
+    qInfo("%d caméras en %.0f ms, %d écritures sur %d ports", acknowledged(), elapsedMs, writes,
+        static_cast<int>(liaisons.size()));
+    QTest::setBenchmarkResult(elapsedMs, QTest::WalltimeMilliseconds);
+    QCOMPARE(acknowledged(), cameras);
+    if (mode != 0)
+    {
+        QCOMPARE(writes, static_cast<int>(liaisons.size()));
+    }
+}
+
+void BancVisca::managerCommands()
+{
+    // 64 caméras pilotées par GestionnaireCameras et son groupe de threads, sur dix ports
+    // simulés à 9600 bauds. Chaque itération envoie une commande à toutes les caméras en même
+    // temps et attend la dernière Completion.
+    ChainesPty chaines;
+    const QList<int> counts = sixtyFourCameras();
+    if (!chaines.start(counts))
+    {
+        QSKIP("SimulateurVisca introuvable à côté de BancVisca");
+    }
+
+    GestionnaireCameras gestionnaire;
+    QSignalSpy enumerated(&gestionnaire, &GestionnaireCameras::chainEnumerated);
+    for (const QString& link : chaines.links())
+    {
+        gestionnaire.addPort(link);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(enumerated.count(), static_cast<int>(counts.size()), 30000);
+    QCOMPARE(gestionnaire.cameraCount(), 64);
+
+    QSet<quint32> waiting;
+    int failed = 0;
+    connect(&gestionnaire, &GestionnaireCameras::commandCompleted, this, [&waiting](int, quint32 id) {
+        waiting.remove(id);
+    });
+    connect(&gestionnaire, &GestionnaireCameras::commandFailed, this, [&waiting, &failed](int, quint32 id, int) {
+        failed += waiting.remove(id) ? 1 : 0;
+    });
+
+    const QList<CameraId> cameras = gestionnaire.cameras();
+    std::uint8_t memory = 0;
+    QBENCHMARK {
+        for (const CameraId& camera : cameras)
+        {
+            waiting.insert(gestionnaire.send(camera, Visca::memorySet(camera.address, memory)));
+        }
+        QTRY_VERIFY_WITH_TIMEOUT(waiting.isEmpty(), 10000);
+        memory = static_cast<std::uint8_t>((memory + 1) % Visca::MEMORY_COUNT);
+    }
+    disconnect(&gestionnaire, nullptr, this, nullptr);
+    QCOMPARE(failed, 0);
+}
+
+void BancVisca::serverRoundTrips_data()
+{
+    QTest::addColumn<bool>("webSocket");
+    QTest::addColumn<bool>("memory");
+
+    // État : lu dans le cache du gestionnaire, mesure le serveur seul ; mémoire : rappel
+    // envoyé à la caméra, l'aller-retour se termine à l'évènement d'aboutissement
+    QTest::newRow("tcp-etat") << false << false;
+    QTest::newRow("websocket-etat") << true << false;
+    QTest::newRow("tcp-memoire") << false << true;
+    QTest::newRow("websocket-memoire") << true << true;
+}
+
+void BancVisca::serverRoundTrips()
+{
+    // Générateur de charge : 200 pupitres connectés à ServeurControle, devant les 64 caméras
+    // simulées de managerCommands. Résultat : allers-retours par seconde pendant 3 s.
+    QFETCH(bool, webSocket);
+    QFETCH(bool, memory);
+    const int clients = 200;
+    const quint16 tcpPort = 45600;              // A côté des ports par défaut de ModeServeur
+    const quint16 webSocketPort = 45601;
+
+    ChainesPty chaines;
+    const QList<int> counts = sixtyFourCameras();
+    if (!chaines.start(counts))
+    {
+        QSKIP("SimulateurVisca introuvable à côté de BancVisca");
+    }
+
+    GestionnaireCameras gestionnaire;
+    QSignalSpy enumerated(&gestionnaire, &GestionnaireCameras::chainEnumerated);
+    for (const QString& link : chaines.links())
+    {
+        gestionnaire.addPort(link);
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(enumerated.count(), static_cast<int>(counts.size()), 30000);
+
+    ServeurControle serveur(gestionnaire);
+    if (!serveur.listen(tcpPort, webSocketPort))
+    {
+        QSKIP("Ports 45600 et 45601 déjà utilisés");
+    }
+
+    GenerateurCharge generateur(webSocket, memory, gestionnaire.cameras());
+    generateur.connectClients(clients, webSocket ? webSocketPort : tcpPort);
+    QTRY_COMPARE_WITH_TIMEOUT(generateur.connected.load(), clients, 10000);
+    QTest::qWait(500);                          // Mise en régime
+
+    const quint64 before = generateur.roundTrips;
+    QElapsedTimer timer;
+    timer.start();
+    QTest::qWait(3000);
+    const double seconds = static_cast<double>(timer.nsecsElapsed()) / 1e9;
+    const double rate = static_cast<double>(generateur.roundTrips - before) / seconds;
+
+    qInfo("%s : %d clients, %.0f allers-retours par seconde", QTest::currentDataTag(), clients, rate);
+    QTest::setBenchmarkResult(rate, QTest::Events);
+    QCOMPARE(generateur.errors.load(), quint64(0));
+}
+
+QTEST_GUILESS_MAIN(BancVisca)
+#include "main.moc"
@@ -0,0 +1,169 @@
+﻿//*********************************************************************************************
+//* Programme : AnalyseurVisca.cpp                                             Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Reconstituer les réponses VISCA à partir d'un flux série lu par morceaux, sans
+//*       allocation : tampon circulaire fixe et automate de découpage sur le terminateur FF.
+//* Programmes associés : ControleCamera.cpp, Visca.h
+//*********************************************************************************************
+
+#include "AnalyseurVisca.h"
+#include <cstring>
+
+static_assert((AnalyseurVisca::RING_SIZE & (AnalyseurVisca::RING_SIZE - 1)) == 0,
+    "La taille du tampon circulaire doit être une puissance de deux");
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la zone contiguë libre du tampon, pour y lire directement depuis le port
+//* Paramètres :
+//*  - std::uint8_t** destination : reçoit l'adresse de la zone libre
+//*
+//* Valeur de retour : std::size_t, le nombre d'octets pouvant être écrits à cette adresse
+//---------------------------------------------------------------------------------------------
+std::size_t AnalyseurVisca::writableSpan(std::uint8_t** destination)
+{
+    std::size_t freeSpace = RING_SIZE - (writeIndex - readIndex);
+    std::size_t offset = writeIndex & (RING_SIZE - 1);
+    std::size_t contiguous = RING_SIZE - offset;
+
+    *destination = ring + offset;
+    return freeSpace < contiguous ? freeSpace : contiguous;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction validant les octets écrits dans la zone donnée par writableSpan()
+//* Paramètres :
+//*  - std::size_t size : le nombre d'octets effectivement écrits
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void AnalyseurVisca::commit(std::size_t size)
+{
+    writeIndex += size;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction copiant des octets reçus dans le tampon circulaire
+//* Paramètres :
+//*  - const std::uint8_t* data : les octets reçus
+//*  - std::size_t size : le nombre d'octets
+//*
+//* Valeur de retour : std::size_t, le nombre d'octets acceptés (le reste est perdu si plein)
+//---------------------------------------------------------------------------------------------
+std::size_t AnalyseurVisca::feed(const std::uint8_t* data, std::size_t size)
+{
+    std::size_t accepted = 0;
+    while (accepted < size)
+    {
+        std::uint8_t* destination = nullptr;
+        std::size_t span = writableSpan(&destination);
+        if (span == 0)
+        {
+            break;
+        }
+        std::size_t chunk = size - accepted < span ? size - accepted : span;
+        std::memcpy(destination, data + accepted, chunk);
+        commit(chunk);
+        accepted += chunk;
+    }
+
+    dropped += size - accepted;
+    return accepted;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction extrayant la prochaine réponse complète du tampon
+//* Paramètres :
+//*  - Visca::Reply& reply : reçoit la réponse décodée
+//*
+//* Valeur de retour : bool, vrai si une réponse complète a été extraite, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool AnalyseurVisca::next(Visca::Reply& reply)
+{
+    while (readIndex != writeIndex)
+    {
+        std::uint8_t byte = ring[readIndex & (RING_SIZE - 1)];
+        ++readIndex;
+
+        switch (state)
+        {
+        case State::WaitHeader:
+            if (isHeader(byte))
+            {
+                startPacket(byte);
+            }
+            else
+            {
+                ++errors;  // Octet hors paquet : on se resynchronise sur le prochain en-tête
+            }
+            break;
+
+        case State::InPacket:
+            if (byte == Visca::TERMINATOR)
+            {
+                packet[packetSize++] = byte;
+                state = State::WaitHeader;
+                reply = Visca::parseReply(packet, packetSize);
+                return true;
+            }
+            if (byte & 0x80)
+            {
+                // Nouvel en-tête avant le terminateur : le paquet précédent est tronqué
+                ++errors;
+                if (isHeader(byte))
+                {
+                    startPacket(byte);
+                }
+                else
+                {
+                    state = State::WaitHeader;
+                }
+            }
+            else if (packetSize >= Visca::MAX_PACKET_SIZE - 1)
+            {
+                ++errors;  // Paquet trop long, terminateur perdu
+                state = State::WaitHeader;
+            }
+            else
+            {
+                packet[packetSize++] = byte;
+            }
+            break;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction vidant le tampon et réinitialisant l'automate (changement de port)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void AnalyseurVisca::reset()
+{
+    readIndex = writeIndex = 0;
+    state = State::WaitHeader;
+    packetSize = 0;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction vérifiant qu'un octet est un en-tête de réponse : 1sss0000 (caméra sss vers le
+//* contrôleur) ou 0x88 (diffusion revenue en bout de chaîne)
+//---------------------------------------------------------------------------------------------
+bool AnalyseurVisca::isHeader(std::uint8_t byte)
+{
+    return byte == Visca::header(Visca::BROADCAST_ADDRESS) || ((byte & 0x8F) == 0x80 && (byte & 0x70) != 0);
+}
+
+void AnalyseurVisca::startPacket(std::uint8_t byte)
+{
+    packet[0] = byte;
+    packetSize = 1;
+    state = State::InPacket;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Visca.h"
+
+//---------------------------------------------------------------------------------------------
+//* Découpage incrémental des réponses VISCA : les octets reçus sont déposés dans un tampon
+//* circulaire de taille fixe puis un automate reconstitue les paquets (en-tête valide ... FF),
+//* même si une réponse arrive en plusieurs morceaux ou si plusieurs arrivent ensemble.
+//---------------------------------------------------------------------------------------------
+class AnalyseurVisca
+{
+public:
+    static constexpr std::size_t RING_SIZE = 256;  // Puissance de deux
+
+    AnalyseurVisca() = default;
+
+    std::size_t writableSpan(std::uint8_t** destination);
+    void commit(std::size_t size);
+    std::size_t feed(const std::uint8_t* data, std::size_t size);
+    bool next(Visca::Reply& reply);
+    void reset();
+
+    std::uint64_t droppedBytes() const { return dropped; }
+    std::uint64_t framingErrors() const { return errors; }
+
+private:
+    enum class State
+    {
+        WaitHeader,
+        InPacket
+    };
+
+    static bool isHeader(std::uint8_t byte);
+    void startPacket(std::uint8_t byte);
+
+    std::uint8_t ring[RING_SIZE] = {};
+    std::size_t readIndex = 0;   // Compteurs libres, ramenés dans le tampon par masque
+    std::size_t writeIndex = 0;
+
+    State state = State::WaitHeader;
+    std::uint8_t packet[Visca::MAX_PACKET_SIZE] = {};
+    std::size_t packetSize = 0;
+
+    std::uint64_t dropped = 0;
+    std::uint64_t errors = 0;
+};
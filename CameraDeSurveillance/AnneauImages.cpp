@@ -0,0 +1,177 @@
+﻿//*********************************************************************************************
+//* Programme : AnneauImages.cpp                                               Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Garder en mémoire les dernières secondes de vidéo pour enregistrer ce qui précède une
+//*       alarme : copie des images par le thread de capture, lecture par le thread d'écriture.
+//* Programmes associés : EnregistreurVideo.cpp, CaptureVideo.cpp
+//*********************************************************************************************
+
+#include "AnneauImages.h"
+#include "Metriques.h"
+#include <QMutexLocker>
+#include <cstring>
+
+namespace
+{
+    std::size_t bytesPerPixel(Video::PixelFormat format)
+    {
+        switch (format)
+        {
+        case Video::PixelFormat::Gray8: return 1;
+        case Video::PixelFormat::Yuyv: return 2;
+        case Video::PixelFormat::Rgb32: return 4;
+        }
+        return 1;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe AnneauImages : la mémoire est allouée et initialisée ici, la
+//* capture n'a ensuite ni allocation ni défaut de page
+//* Paramètres :
+//*  - std::size_t capacityBytes : la taille de l'anneau en octets
+//*  - std::size_t maxFrames : le nombre d'images au plus
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+AnneauImages::AnneauImages(std::size_t capacityBytes, std::size_t maxFrames)
+    : buffer(capacityBytes, 0), frames(maxFrames > 0 ? maxFrames : 1)
+{
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction copiant une image dans l'anneau (lignes sans marge), dans le thread de capture.
+//* Les plus anciennes images sont écrasées pour lui faire de la place, sauf celles qu'un
+//* enregistrement n'a pas encore écrites : l'image est alors refusée.
+//* Paramètres :
+//*  - const Video::Image& image : l'image capturée
+//*
+//* Valeur de retour : bool, vrai si l'image est dans l'anneau, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool AnneauImages::push(const Video::Image& image)
+{
+    const std::size_t rowBytes = static_cast<std::size_t>(image.width) * bytesPerPixel(image.format);
+    const std::size_t size = rowBytes * static_cast<std::size_t>(image.height);
+    const std::uint64_t capacityBytes = buffer.size();
+    if (!image.data || size == 0 || size > capacityBytes)
+    {
+        return false;
+    }
+
+    std::uint64_t start;
+    {
+        QMutexLocker locker(&mutex);
+        // L'image ne passe pas la fin de l'anneau : elle commence alors au début
+        start = head;
+        std::uint64_t offset = start % capacityBytes;
+        if (offset + size > capacityBytes)
+        {
+            start += capacityBytes - offset;
+        }
+        while (first < next && (next - first >= frames.size()
+            || start + size - frames[first % frames.size()].position > capacityBytes))
+        {
+            if (reading && first >= read)
+            {
+                counters.overruns++;
+                Metriques::add(Metrique::Counter::RingOverruns);
+                return false;
+            }
+            ++first;
+            counters.evicted++;
+        }
+
+        Frame& frame = frames[next % frames.size()];
+        frame.captureTime = image.captureTime;
+        frame.sequence = image.sequence;
+        frame.position = start;
+        frame.size = static_cast<std::uint32_t>(size);
+        frame.width = static_cast<std::uint16_t>(image.width);
+        frame.height = static_cast<std::uint16_t>(image.height);
+        frame.format = image.format;
+        head = start + size;
+    }
+
+    // Copie hors verrou : la zone réservée n'est visible du lecteur qu'après publication
+    std::uint8_t* target = buffer.data() + start % capacityBytes;
+    if (static_cast<std::size_t>(image.stride) == rowBytes)
+    {
+        std::memcpy(target, image.data, size);
+    }
+    else
+    {
+        for (int y = 0; y < image.height; ++y)
+        {
+            std::memcpy(target + y * rowBytes, image.data + static_cast<std::size_t>(y) * image.stride, rowBytes);
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    ++next;
+    counters.pushed++;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de lecture, dans le thread d'écriture. startReading place la lecture sur la plus
+//* ancienne image prise à partir de fromTime ; les images lues ne sont rendues à la capture
+//* qu'à consume(), une fois écrites.
+//---------------------------------------------------------------------------------------------
+void AnneauImages::startReading(std::int64_t fromTime)
+{
+    QMutexLocker locker(&mutex);
+    read = first;
+    while (read < next && frames[read % frames.size()].captureTime < fromTime)
+    {
+        ++read;
+    }
+    reading = true;
+}
+
+void AnneauImages::stopReading()
+{
+    QMutexLocker locker(&mutex);
+    reading = false;
+}
+
+bool AnneauImages::isReading() const
+{
+    QMutexLocker locker(&mutex);
+    return reading;
+}
+
+std::size_t AnneauImages::peek(Frame* result, std::size_t max) const
+{
+    QMutexLocker locker(&mutex);
+    std::size_t count = static_cast<std::size_t>(next - read);
+    count = count < max ? count : max;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = frames[(read + i) % frames.size()];
+    }
+    return count;
+}
+
+void AnneauImages::consume(std::size_t count)
+{
+    QMutexLocker locker(&mutex);
+    std::uint64_t available = next - read;
+    read += count < available ? count : available;
+}
+
+AnneauImages::Stats AnneauImages::stats() const
+{
+    QMutexLocker locker(&mutex);
+    Stats result = counters;
+    result.frames = static_cast<std::size_t>(next - first);
+    if (next > first)
+    {
+        result.spanNs = frames[(next - 1) % frames.size()].captureTime - frames[first % frames.size()].captureTime;
+    }
+    return result;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QMutex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "PoolImages.h"
+
+//---------------------------------------------------------------------------------------------
+//* Anneau des dernières secondes de vidéo d'une caméra, alloué une fois pour toutes. Le thread
+//* de capture y copie chaque image (ses tampons retournent au pilote) en écrasant les plus
+//* anciennes ; pendant un enregistrement, le thread d'écriture lit les images à partir d'un
+//* instant passé (avant l'alarme) et celles qu'il n'a pas encore écrites ne sont jamais
+//* écrasées. Chaque image est contiguë dans l'anneau : une suite d'images s'écrit en un ou
+//* deux blocs. Le verrou ne couvre que les descripteurs, jamais la copie des pixels.
+//---------------------------------------------------------------------------------------------
+class AnneauImages
+{
+public:
+    struct Frame
+    {
+        std::int64_t captureTime = 0;
+        std::uint64_t sequence = 0;
+        std::uint64_t position = 0;     // Position dans l'anneau, croissante (modulo capacité)
+        std::uint32_t size = 0;
+        std::uint16_t width = 0;
+        std::uint16_t height = 0;
+        Video::PixelFormat format = Video::PixelFormat::Gray8;
+    };
+
+    struct Stats
+    {
+        std::uint64_t pushed = 0;
+        std::uint64_t evicted = 0;      // Images écrasées par de plus récentes
+        std::uint64_t overruns = 0;     // Images refusées : l'écriture n'a pas suivi
+        std::size_t frames = 0;         // Images présentes
+        std::int64_t spanNs = 0;        // Durée couverte
+    };
+
+    AnneauImages(std::size_t capacityBytes, std::size_t maxFrames);
+
+    AnneauImages(const AnneauImages&) = delete;
+    AnneauImages& operator=(const AnneauImages&) = delete;
+
+    // Thread de capture
+    bool push(const Video::Image& image);
+
+    // Thread d'écriture
+    void startReading(std::int64_t fromTime);
+    void stopReading();
+    bool isReading() const;
+    std::size_t peek(Frame* frames, std::size_t max) const;
+    const std::uint8_t* data(const Frame& frame) const { return buffer.data() + frame.position % buffer.size(); }
+    void consume(std::size_t count);
+
+    std::size_t capacity() const { return buffer.size(); }
+    Stats stats() const;
+
+private:
+    std::vector<std::uint8_t> buffer;
+    std::vector<Frame> frames;
+    mutable QMutex mutex;
+    std::uint64_t head = 0;         // Fin de la dernière image réservée
+    std::uint64_t first = 0;        // Plus ancienne image présente
+    std::uint64_t next = 0;         // Prochaine image publiée
+    std::uint64_t read = 0;         // Prochaine image à lire pendant un enregistrement
+    bool reading = false;
+    Stats counters;
+};
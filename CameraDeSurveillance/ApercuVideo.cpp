@@ -0,0 +1,321 @@
+﻿//*********************************************************************************************
+//* Programme : ApercuVideo.cpp                                                Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Afficher la vidéo de la caméra à côté des commandes PTZ. L'image est prise dans le
+//*       pool de la capture et dessinée depuis son tampon (QImage sans copie) ; seule la
+//*       dernière image compte, les précédentes non affichées ont déjà été rendues au pilote.
+//*       Un clic ou un rectangle tracé dans l'image pilote la caméra (voir ChampVision).
+//* Programmes associés : CaptureVideo.cpp, CameraDeSurveillance.cpp, ChampVision.cpp
+//*********************************************************************************************
+
+#include "ApercuVideo.h"
+#include "CaptureVideo.h"
+#include "Metriques.h"
+#include "PiloteVitesse.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+
+namespace
+{
+    inline std::uint8_t clampByte(int value)
+    {
+        return static_cast<std::uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    // YUV 4:2:2 (BT.601, plage réduite) vers 0xffRRGGBB, deux pixels par groupe Y0 U Y1 V
+    void convertYuyv(const Video::Image& image, QImage& target)
+    {
+        for (int y = 0; y < image.height; ++y)
+        {
+            const std::uint8_t* source = image.data + static_cast<std::size_t>(y) * image.stride;
+            QRgb* line = reinterpret_cast<QRgb*>(target.scanLine(y));
+            for (int x = 0; x + 1 < image.width; x += 2, source += 4)
+            {
+                int d = source[1] - 128;
+                int e = source[3] - 128;
+                int red = 409 * e + 128;
+                int green = -100 * d - 208 * e + 128;
+                int blue = 516 * d + 128;
+                int c0 = 298 * (source[0] - 16);
+                int c1 = 298 * (source[2] - 16);
+                line[x] = qRgb(clampByte((c0 + red) >> 8), clampByte((c0 + green) >> 8), clampByte((c0 + blue) >> 8));
+                line[x + 1] = qRgb(clampByte((c1 + red) >> 8), clampByte((c1 + green) >> 8), clampByte((c1 + blue) >> 8));
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe ApercuVideo
+//* Paramètres :
+//*  - QWidget* parent : le widget parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+ApercuVideo::ApercuVideo(QWidget* parent)
+    : QWidget(parent)
+{
+    // Chaque dessin recouvre tout le widget : inutile d'effacer le fond au préalable
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    fpsClock.start();
+}
+
+ApercuVideo::~ApercuVideo()
+{
+    detach();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction reliant l'aperçu à une capture (qui peut vivre dans un autre thread)
+//* Paramètres :
+//*  - CaptureVideo* source : la capture qui publie les images
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ApercuVideo::attach(CaptureVideo* source)
+{
+    detach();
+    capture = source;
+    pool = &source->pool();
+    message.clear();
+    connect(capture, &CaptureVideo::frameReady, this, &ApercuVideo::onFrameReady, Qt::QueuedConnection);
+    connect(capture, &CaptureVideo::failed, this, &ApercuVideo::showError, Qt::QueuedConnection);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction rendant l'image affichée et déconnectant la capture ; à appeler avant d'arrêter
+//* la capture, dont les tampons ne sont plus valides ensuite
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ApercuVideo::detach()
+{
+    if (!capture)
+    {
+        return;
+    }
+    disconnect(capture, nullptr, this, nullptr);
+    if (slot >= 0)
+    {
+        pool->release(slot);
+        slot = -1;
+    }
+    capture = nullptr;
+    pool = nullptr;
+    fresh = false;
+    update();
+}
+
+ApercuVideo::Stats ApercuVideo::stats() const
+{
+    return current;
+}
+
+void ApercuVideo::showError(const QString& errorString)
+{
+    message = errorString;
+    update();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand la capture a publié une image : la plus récente est prise, celle
+//* qui était affichée retourne à la capture. Plusieurs publications entre deux appels ne
+//* donnent qu'un seul dessin.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ApercuVideo::onFrameReady()
+{
+    if (!capture)
+    {
+        return;
+    }
+    capture->acknowledge();
+    int latest = pool->take();
+    if (latest < 0)
+    {
+        return;
+    }
+    if (slot >= 0)
+    {
+        pool->release(slot);
+    }
+    slot = latest;
+    fresh = true;
+    update();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant l'image affichée sous forme de QImage : une vue sur le tampon de capture
+//* pour la luminance et le RGB32, l'image convertie pour le YUYV (convertie une seule fois
+//* par image reçue)
+//* Paramètres :
+//*  - bool freshImage : vrai si l'image n'a pas encore été dessinée
+//*
+//* Valeur de retour : QImage, l'image à dessiner
+//---------------------------------------------------------------------------------------------
+QImage ApercuVideo::view(bool freshImage)
+{
+    const Video::Image& image = pool->imageAt(slot);
+    switch (image.format)
+    {
+    case Video::PixelFormat::Gray8:
+        return QImage(image.data, image.width, image.height, image.stride, QImage::Format_Grayscale8);
+    case Video::PixelFormat::Rgb32:
+        return QImage(image.data, image.width, image.height, image.stride, QImage::Format_RGB32);
+    case Video::PixelFormat::Yuyv:
+        if (converted.width() != image.width || converted.height() != image.height)
+        {
+            converted = QImage(image.width, image.height, QImage::Format_RGB32);
+            freshImage = true;
+        }
+        if (freshImage)
+        {
+            convertYuyv(image, converted);
+        }
+        return converted;
+    }
+    return QImage();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction de dessin : l'image est mise à l'échelle en gardant ses proportions, puis la
+//* cadence, la latence et le temps processeur sont superposés. La latence est mesurée au
+//* moment du dessin (le balayage de l'écran s'y ajoute, au plus une trame).
+//* Paramètres :
+//*  - QPaintEvent* event : l'événement de dessin
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ApercuVideo::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::black);
+    painter.setPen(Qt::white);
+
+    if (slot < 0)
+    {
+        painter.drawText(rect(), Qt::AlignCenter, message.isEmpty() ? QStringLiteral("Pas de vidéo") : message);
+        return;
+    }
+
+    qint64 cpuStart = CaptureVideo::threadCpuNs();
+    const Video::Image& image = pool->imageAt(slot);
+    QImage frame = view(fresh);
+    QSize size = frame.size().scaled(this->size(), Qt::KeepAspectRatio);
+    QRect target(QPoint((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+    painter.drawImage(target, frame);
+    imageRect = target;
+
+    if (fresh)
+    {
+        fresh = false;
+        qint64 latencyUs = (PiloteVitesse::now() - image.captureTime) / 1000;
+        qint64 cpuUs = (image.captureCpuNs + CaptureVideo::threadCpuNs() - cpuStart) / 1000;
+        current.frames++;
+        current.lastLatencyUs = latencyUs;
+        current.maxLatencyUs = qMax(current.maxLatencyUs, latencyUs);
+        current.totalLatencyUs += latencyUs;
+        current.lastCpuUs = cpuUs;
+        current.totalCpuUs += cpuUs;
+        Metriques::observe(Metrique::Histogram::DisplayLatency, latencyUs);
+        Metriques::observe(Metrique::Histogram::FrameCpu, cpuUs);
+
+        fpsFrames++;
+        qint64 elapsedMs = fpsClock.elapsed();
+        if (elapsedMs >= 1000)
+        {
+            current.fps = fpsFrames * 1000.0 / elapsedMs;
+            fpsFrames = 0;
+            fpsClock.restart();
+        }
+    }
+
+    QString overlay = QStringLiteral("%1 i/s  %2 ms  CPU %3 ms")
+        .arg(current.fps, 0, 'f', 1)
+        .arg(current.lastLatencyUs / 1000.0, 0, 'f', 1)
+        .arg(current.lastCpuUs / 1000.0, 0, 'f', 2);
+    QRect textRect = painter.fontMetrics().boundingRect(overlay).adjusted(-4, -2, 4, 2);
+    textRect.moveTopLeft(target.topLeft() + QPoint(4, 4));
+    painter.fillRect(textRect, QColor(0, 0, 0, 160));
+    painter.drawText(textRect, Qt::AlignCenter, overlay);
+
+    if (!selection.isEmpty())
+    {
+        painter.setPen(QPen(Qt::yellow, 1, Qt::DashLine));
+        painter.drawRect(selection);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de la souris : le bouton gauche enfoncé commence un tracé ; relâché près de son
+//* point de départ, c'est un clic (centrer), sinon le rectangle tracé est à cadrer
+//* Paramètres :
+//*  - QMouseEvent* event : l'événement de la souris
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ApercuVideo::mousePressEvent(QMouseEvent* event)
+{
+    if (event->button() != Qt::LeftButton || slot < 0 || !imageRect.contains(event->position().toPoint()))
+    {
+        QWidget::mousePressEvent(event);
+        return;
+    }
+    dragging = true;
+    dragStart = event->position().toPoint();
+    selection = QRect();
+}
+
+void ApercuVideo::mouseMoveEvent(QMouseEvent* event)
+{
+    if (!dragging)
+    {
+        QWidget::mouseMoveEvent(event);
+        return;
+    }
+    QPoint position = event->position().toPoint();
+    if ((position - dragStart).manhattanLength() >= DRAG_MIN)
+    {
+        selection = QRect(dragStart, position).normalized().intersected(imageRect);
+        update();
+    }
+}
+
+void ApercuVideo::mouseReleaseEvent(QMouseEvent* event)
+{
+    if (!dragging || event->button() != Qt::LeftButton)
+    {
+        QWidget::mouseReleaseEvent(event);
+        return;
+    }
+    dragging = false;
+    double aspect = static_cast<double>(imageRect.width()) / imageRect.height();
+    if (selection.isEmpty())
+    {
+        emit pointClicked(toImage(dragStart), aspect);
+    }
+    else
+    {
+        emit areaSelected(QRectF(toImage(selection.topLeft()), toImage(selection.bottomRight() + QPoint(1, 1))), aspect);
+        selection = QRect();
+        update();
+    }
+}
+
+QPointF ApercuVideo::toImage(const QPoint& position) const
+{
+    return QPointF(static_cast<double>(position.x() - imageRect.left()) / imageRect.width(),
+        static_cast<double>(position.y() - imageRect.top()) / imageRect.height());
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QWidget>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+
+class CaptureVideo;
+class PoolImages;
+
+// Aperçu vidéo à côté des commandes : dessine la dernière image publiée par la capture,
+// directement depuis son tampon, et affiche la cadence, la latence capture -> affichage et
+// le temps processeur par image. Un clic dans l'image émet pointClicked, un rectangle tracé
+// à la souris areaSelected (en fraction de l'image, pour centrer ou cadrer la caméra).
+class ApercuVideo : public QWidget
+{
+    Q_OBJECT
+
+public:
+    static constexpr int DRAG_MIN = 8;     // Déplacement de la souris (pixels) en deçà duquel c'est un clic
+
+    struct Stats
+    {
+        quint64 frames = 0;         // Images dessinées
+        double fps = 0.0;           // Sur la dernière seconde
+        qint64 lastLatencyUs = 0;
+        qint64 maxLatencyUs = 0;
+        qint64 totalLatencyUs = 0;
+        qint64 lastCpuUs = 0;       // Capture et dessin de la dernière image
+        qint64 totalCpuUs = 0;
+    };
+
+    explicit ApercuVideo(QWidget* parent = nullptr);
+    ~ApercuVideo();
+
+    void attach(CaptureVideo* source);
+    void detach();
+    Stats stats() const;
+
+public slots:
+    void showError(const QString& errorString);
+
+signals:
+    void pointClicked(const QPointF& point, double aspect);
+    void areaSelected(const QRectF& area, double aspect);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+
+private slots:
+    void onFrameReady();
+
+private:
+    QImage view(bool freshImage);
+    QPointF toImage(const QPoint& position) const;
+
+    CaptureVideo* capture = nullptr;
+    PoolImages* pool = nullptr;
+    int slot = -1;              // Emplacement de l'image affichée, rendu à la suivante
+    bool fresh = false;         // Image pas encore dessinée
+    QImage converted;           // Image YUYV convertie, allouée une fois pour toutes
+    QString message;
+    Stats current;
+    QElapsedTimer fpsClock;
+    quint64 fpsFrames = 0;
+    QRect imageRect;            // Emplacement de l'image dans le widget au dernier dessin
+    QPoint dragStart;
+    QRect selection;            // Rectangle en cours de tracé, vide sinon
+    bool dragging = false;
+};
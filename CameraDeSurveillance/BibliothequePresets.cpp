@@ -0,0 +1,321 @@
+﻿//*********************************************************************************************
+//* Programme : BibliothequePresets.cpp                                        Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Conserver les positions enregistrées (mémoires de la caméra ou positions absolues) et
+//*       les tournées qui les enchaînent, avec lecture et écriture dans un fichier JSON.
+//* Programmes associés : MoteurTournees.cpp, ControleCamera.cpp
+//*********************************************************************************************
+
+#include "BibliothequePresets.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe BibliothequePresets, ajoute la tournée « balayage » du mode
+//* automatique : la salle est balayée trois fois de gauche à droite puis la caméra revient
+//* au centre
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+BibliothequePresets::BibliothequePresets()
+{
+    Preset left;
+    left.name = "balayage-gauche";
+    left.pan = -1200;
+    left.hasZoom = false;
+    setPreset(left);
+
+    Preset right = left;
+    right.name = "balayage-droite";
+    right.pan = 1200;
+    setPreset(right);
+
+    Preset center;
+    center.name = "centre";
+    setPreset(center);
+
+    Tour sweep;
+    sweep.name = "balayage";
+    for (int pass = 0; pass < 3; ++pass)
+    {
+        sweep.steps.append({ "balayage-gauche", 0 });
+        sweep.steps.append({ "balayage-droite", 0 });
+    }
+    sweep.steps.append({ "centre", 0 });
+    setTour(sweep);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de gestion des positions enregistrées (un nom déjà utilisé est remplacé)
+//---------------------------------------------------------------------------------------------
+void BibliothequePresets::setPreset(const Preset& preset)
+{
+    for (Preset& existing : presets)
+    {
+        if (existing.name == preset.name)
+        {
+            existing = preset;
+            return;
+        }
+    }
+    presets.append(preset);
+}
+
+bool BibliothequePresets::removePreset(const QString& name)
+{
+    for (int i = 0; i < presets.size(); ++i)
+    {
+        if (presets.at(i).name == name)
+        {
+            presets.removeAt(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const Preset* BibliothequePresets::preset(const QString& name) const
+{
+    for (const Preset& preset : presets)
+    {
+        if (preset.name == name)
+        {
+            return &preset;
+        }
+    }
+    return nullptr;
+}
+
+QStringList BibliothequePresets::presetNames() const
+{
+    QStringList names;
+    for (const Preset& preset : presets)
+    {
+        names.append(preset.name);
+    }
+    return names;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de gestion des tournées (un nom déjà utilisé est remplacé)
+//---------------------------------------------------------------------------------------------
+void BibliothequePresets::setTour(const Tour& tour)
+{
+    for (Tour& existing : tours)
+    {
+        if (existing.name == tour.name)
+        {
+            existing = tour;
+            return;
+        }
+    }
+    tours.append(tour);
+}
+
+const Tour* BibliothequePresets::tour(const QString& name) const
+{
+    for (const Tour& tour : tours)
+    {
+        if (tour.name == name)
+        {
+            return &tour;
+        }
+    }
+    return nullptr;
+}
+
+QStringList BibliothequePresets::tourNames() const
+{
+    QStringList names;
+    for (const Tour& tour : tours)
+    {
+        names.append(tour.name);
+    }
+    return names;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de charger des positions et des tournées depuis un fichier JSON :
+//*  { "presets": [ { "name": "porte", "pan": -800, "tilt": 120, "zoom": 4096 },
+//*                 { "name": "entree", "memory": 2 } ],
+//*    "tours": [ { "name": "ronde", "loops": 0,
+//*                 "steps": [ { "preset": "porte", "dwell": 3000 }, { "preset": "entree" } ] } ] }
+//* Les éléments chargés s'ajoutent à ceux déjà présents ou les remplacent s'ils ont le même nom.
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier
+//*  - QString* errorString : reçoit la cause de l'échec (facultatif)
+//*
+//* Valeur de retour : bool, vrai si le fichier a été lu, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool BibliothequePresets::load(const QString& path, QString* errorString)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject())
+    {
+        if (errorString)
+        {
+            *errorString = parseError.errorString();
+        }
+        return false;
+    }
+
+    QJsonObject root = document.object();
+    for (const QJsonValue& value : root.value("presets").toArray())
+    {
+        QJsonObject object = value.toObject();
+        Preset preset;
+        preset.name = object.value("name").toString();
+        if (preset.name.isEmpty())
+        {
+            continue;
+        }
+        preset.memory = object.value("memory").toInt(-1);
+        if (preset.memory >= Visca::MEMORY_COUNT)
+        {
+            preset.memory = -1;
+        }
+        preset.pan = static_cast<qint16>(object.value("pan").toInt());
+        preset.tilt = static_cast<qint16>(object.value("tilt").toInt());
+        preset.hasZoom = object.contains("zoom");
+        preset.zoom = static_cast<quint16>(object.value("zoom").toInt());
+        preset.panSpeed = Visca::clampSpeed(static_cast<std::uint8_t>(object.value("panSpeed").toInt(Visca::PAN_SPEED_MAX)), Visca::PAN_SPEED_MAX);
+        preset.tiltSpeed = Visca::clampSpeed(static_cast<std::uint8_t>(object.value("tiltSpeed").toInt(Visca::TILT_SPEED_MAX)), Visca::TILT_SPEED_MAX);
+        setPreset(preset);
+    }
+
+    for (const QJsonValue& value : root.value("tours").toArray())
+    {
+        QJsonObject object = value.toObject();
+        Tour tour;
+        tour.name = object.value("name").toString();
+        tour.loops = object.value("loops").toInt(1);
+        for (const QJsonValue& stepValue : object.value("steps").toArray())
+        {
+            QJsonObject stepObject = stepValue.toObject();
+            TourStep step;
+            step.preset = stepObject.value("preset").toString();
+            step.dwell = qMax(0, stepObject.value("dwell").toInt());
+            tour.steps.append(step);
+        }
+        if (!tour.name.isEmpty() && !tour.steps.isEmpty())
+        {
+            setTour(tour);
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'enregistrer les positions et les tournées dans un fichier JSON
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier
+//*  - QString* errorString : reçoit la cause de l'échec (facultatif)
+//*
+//* Valeur de retour : bool, vrai si le fichier a été écrit, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool BibliothequePresets::save(const QString& path, QString* errorString) const
+{
+    QJsonArray presetArray;
+    for (const Preset& preset : presets)
+    {
+        QJsonObject object;
+        object.insert("name", preset.name);
+        if (preset.memory >= 0)
+        {
+            object.insert("memory", preset.memory);
+        }
+        else
+        {
+            object.insert("pan", preset.pan);
+            object.insert("tilt", preset.tilt);
+            if (preset.hasZoom)
+            {
+                object.insert("zoom", preset.zoom);
+            }
+            object.insert("panSpeed", preset.panSpeed);
+            object.insert("tiltSpeed", preset.tiltSpeed);
+        }
+        presetArray.append(object);
+    }
+
+    QJsonArray tourArray;
+    for (const Tour& tour : tours)
+    {
+        QJsonArray steps;
+        for (const TourStep& step : tour.steps)
+        {
+            QJsonObject stepObject;
+            stepObject.insert("preset", step.preset);
+            stepObject.insert("dwell", step.dwell);
+            steps.append(stepObject);
+        }
+        QJsonObject object;
+        object.insert("name", tour.name);
+        object.insert("loops", tour.loops);
+        object.insert("steps", steps);
+        tourArray.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("presets", presetArray);
+    root.insert("tours", tourArray);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(QJsonDocument(root).toJson()) < 0)
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant les commandes VISCA qui amènent une caméra sur une position
+//* Pan/tilt et zoom sont deux commandes distinctes : elles occupent chacune un socket et
+//* s'exécutent en même temps.
+//* Paramètres :
+//*  - const Preset& preset : la position
+//*  - std::uint8_t address : l'adresse de la caméra
+//*
+//* Valeur de retour : QList<Visca::Command>, une ou deux commandes
+//---------------------------------------------------------------------------------------------
+QList<Visca::Command> BibliothequePresets::commandsFor(const Preset& preset, std::uint8_t address)
+{
+    QList<Visca::Command> commands;
+    if (preset.memory >= 0)
+    {
+        commands.append(Visca::memoryRecall(address, static_cast<std::uint8_t>(preset.memory)));
+        return commands;
+    }
+
+    commands.append(Visca::absolutePosition(address, preset.panSpeed, preset.tiltSpeed,
+        static_cast<std::uint16_t>(preset.pan), static_cast<std::uint16_t>(preset.tilt)));
+    if (preset.hasZoom)
+    {
+        commands.append(Visca::zoomDirect(address, preset.zoom));
+    }
+    return commands;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "Visca.h"
+
+// Position enregistrée : soit une mémoire de la caméra (CAM_Memory), soit une position absolue
+// pan/tilt/zoom gardée par l'application
+struct Preset
+{
+    QString name;
+    int memory = -1;                                // 0 à 15 : CAM_Memory Recall, -1 : position absolue
+    qint16 pan = 0;
+    qint16 tilt = 0;
+    quint16 zoom = 0;
+    bool hasZoom = true;                            // Faux : le zoom n'est pas modifié
+    quint8 panSpeed = Visca::PAN_SPEED_MAX;
+    quint8 tiltSpeed = Visca::TILT_SPEED_MAX;
+};
+
+struct TourStep
+{
+    QString preset;
+    int dwell = 0;                                  // Temps d'arrêt sur la position (ms)
+};
+
+struct Tour
+{
+    QString name;
+    int loops = 1;                                  // Nombre de passages, 0 pour tourner sans fin
+    QList<TourStep> steps;
+};
+
+class BibliothequePresets
+{
+public:
+    BibliothequePresets();
+
+    void setPreset(const Preset& preset);
+    bool removePreset(const QString& name);
+    const Preset* preset(const QString& name) const;
+    QStringList presetNames() const;
+
+    void setTour(const Tour& tour);
+    const Tour* tour(const QString& name) const;
+    QStringList tourNames() const;
+
+    bool load(const QString& path, QString* errorString = nullptr);
+    bool save(const QString& path, QString* errorString = nullptr) const;
+
+    static QList<Visca::Command> commandsFor(const Preset& preset, std::uint8_t address);
+
+private:
+    QList<Preset> presets;
+    QList<Tour> tours;
+};
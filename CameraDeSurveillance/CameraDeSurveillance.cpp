@@ -13,24 +13,104 @@
 
 #include "CameraDeSurveillance.h"
 #include "ControleCamera.h"
+#include <QGuiApplication>
+#include <QKeyEvent>
+#include <QMetaObject>
+#include <QScreen>
 #include <QSerialPortInfo>
+#include <QSignalBlocker>
 #include <QThread>
+#include <QtGlobal>
 #include <QDebug>
 #include <QString>
 
+namespace
+{
+    // Directions tenues (boutons ou flèches du clavier)
+    enum HeldDirection
+    {
+        HeldUp = 1,
+        HeldDown = 2,
+        HeldLeft = 4,
+        HeldRight = 8
+    };
+
+    int heldDirectionForKey(int key)
+    {
+        switch (key)
+        {
+        case Qt::Key_Up: return HeldUp;
+        case Qt::Key_Down: return HeldDown;
+        case Qt::Key_Left: return HeldLeft;
+        case Qt::Key_Right: return HeldRight;
+        default: return 0;
+        }
+    }
+}
+
 //---------------------------------------------------------------------------------------------
 //* Constructeur de la classe CameraDeSurveillance, initialise l'interface et la connexion des boutons
+//* La communication avec la caméra tourne dans son propre thread : une écriture lente ou une
+//* erreur de port ne bloque jamais la fenêtre.
 //* Paramètres :
 //*  - QWidget* parent : le widget parent (généralement une fenêtre principale)
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
 CameraDeSurveillance::CameraDeSurveillance(QWidget* parent)
-    : QMainWindow(parent), controleCamera(nullptr), port(nullptr)
+    : QMainWindow(parent), controleCamera(nullptr), captureVideo(nullptr), detectionMouvement(nullptr), enregistreurVideo(nullptr), sondeLatence(nullptr), positionLabel(nullptr), linkLabel(nullptr)
 {
     ui.setupUi(this);
     controleCamera = new ControleCamera();  // Création de l'objet ControleCamera
-    
+
+    // ControleCamera et le port série vivent dans le thread de la caméra
+    cameraThread.setObjectName("CameraThread");
+    controleCamera->moveToThread(&cameraThread);
+    connect(&cameraThread, &QThread::finished, controleCamera, &QObject::deleteLater);
+    cameraThread.start();
+
+    // Aperçu vidéo : la capture a son propre thread, l'interface ne fait que dessiner la dernière
+    // image. Source choisie par la variable d'environnement CAMERA_VIDEO_SOURCE (voir CaptureVideo::open)
+    captureVideo = new CaptureVideo();
+    videoThread.setObjectName("VideoThread");
+    captureVideo->moveToThread(&videoThread);
+    connect(&videoThread, &QThread::finished, captureVideo, &QObject::deleteLater);
+    ui.videoPreview->attach(captureVideo);
+
+    // Détection de mouvement sur chaque image, dans le thread de capture ; zones surveillées lues
+    // dans le fichier JSON désigné par CAMERA_ZONES_MOUVEMENT, toute l'image sinon
+    detectionMouvement = new DetectionMouvement(1);
+    QString zonesPath = qEnvironmentVariable("CAMERA_ZONES_MOUVEMENT");
+    QString zonesError;
+    if (!zonesPath.isEmpty() && !detectionMouvement->loadZones(zonesPath, &zonesError))
+    {
+        qWarning() << "Zones de mouvement" << zonesPath << ":" << zonesError;
+    }
+    detectionMouvement->moveToThread(&videoThread);
+    connect(&videoThread, &QThread::finished, detectionMouvement, &QObject::deleteLater);
+    DetectionMouvement* detection = detectionMouvement;
+    captureVideo->addObserver([detection](const Video::Image& image) { detection->process(image); });
+
+    // Enregistrement sur déclenchement : la capture copie chaque image dans l'anneau, le thread
+    // d'écriture y reprend les secondes précédant l'alarme. Segments dans CAMERA_VIDEO_DIR.
+    enregistreurVideo = new EnregistreurVideo(1, EnregistreurVideo::defaultDirectory());
+    recordThread.setObjectName("RecordThread");
+    enregistreurVideo->moveToThread(&recordThread);
+    connect(&recordThread, &QThread::finished, enregistreurVideo, &QObject::deleteLater);
+    EnregistreurVideo* recorder = enregistreurVideo;
+    captureVideo->addObserver([recorder](const Video::Image& image) { recorder->ring().push(image); });
+    recordThread.start();
+    videoThread.start();
+    QString videoSource = CaptureVideo::defaultSource();
+    CaptureVideo* capture = captureVideo;
+    QMetaObject::invokeMethod(capture, [capture, videoSource]() { capture->open(videoSource); }, Qt::QueuedConnection);
+
+    // Sonde de réactivité de l'interface, activée par la variable d'environnement CAMERA_LATENCY_PROBE
+    if (qEnvironmentVariableIsSet("CAMERA_LATENCY_PROBE"))
+    {
+        sondeLatence = new SondeLatence(10, 50, this);
+        sondeLatence->start();
+    }
    
     QList<QSerialPortInfo> availablePorts = QSerialPortInfo::availablePorts();
     for (const QSerialPortInfo& info : availablePorts)
@@ -38,6 +118,51 @@ CameraDeSurveillance::CameraDeSurveillance(QWidget* parent)
         ui.portChoiceComboBox->addItem(info.portName(), QVariant(info.portName()));
     }
 
+    // La consigne est renvoyée bien avant l'arrêt automatique du pilote de vitesse
+    velocityTimer.setInterval(PiloteVitesse::INPUT_TIMEOUT_MS / 3);
+    connect(&velocityTimer, &QTimer::timeout, this, &CameraDeSurveillance::sendVelocity);
+
+    // Position et liaison dans des zones permanentes : les messages temporaires (alarmes,
+    // enregistrement) ne les effacent pas et ne sont pas effacés par elles
+    positionLabel = new QLabel(this);
+    ui.statusBar->addPermanentWidget(positionLabel);
+
+    // Débit et temps de réponse de la liaison, lus chaque seconde sans passer par le thread caméra
+    linkLabel = new QLabel(this);
+    ui.statusBar->addPermanentWidget(linkLabel);
+    linkTimer.setInterval(1000);
+    connect(&linkTimer, &QTimer::timeout, this, &CameraDeSurveillance::updateLinkStats);
+    linkTimer.start();
+
+    // La position est relevée à chaque rafraîchissement de l'écran, pas à chaque réponse
+    QScreen* screen = QGuiApplication::primaryScreen();
+    qreal refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    telemetryTimer.setTimerType(Qt::PreciseTimer);
+    telemetryTimer.setInterval(qMax(1, qRound(1000.0 / refreshRate)));
+    connect(&telemetryTimer, &QTimer::timeout, this, &CameraDeSurveillance::updateTelemetry);
+    telemetryTimer.start();
+
+    // Widgets traduits : leur texte vient de la table des traductions
+    traductions.bind(ui.OpenPortButton, Message::OpenPort);
+    traductions.bind(ui.autobutton, Message::AutoMode);
+    traductions.bind(ui.initbutton, Message::Initialise);
+    traductions.bind(ui.label, Message::Zoom);
+    traductions.bind(ui.label_4, Message::ChangeLanguage);
+    traductions.bind(ui.moveDownButon, Message::MoveDown);
+    traductions.bind(ui.moveLeftButton, Message::MoveLeft);
+    traductions.bind(ui.moveRightButon, Message::MoveRight);
+    traductions.bind(ui.moveUpButton, Message::MoveUp);
+    traductions.bind(ui.powerbutton, Message::PowerOn);
+    traductions.bind(ui.recordButton, Message::Record);
+    traductions.bind([this]() {
+        if (shownSequence != 0)
+        {
+            showPosition(controleCamera->telemetry().latest(1));
+        }
+    });
+    traductions.bind([this]() { updateLinkStats(); });
+    ChangeLanguage();
+
     setupConnections();  // Initialisation des connexions entre boutons et slots
 }
 
@@ -50,14 +175,21 @@ CameraDeSurveillance::CameraDeSurveillance(QWidget* parent)
 //---------------------------------------------------------------------------------------------
 CameraDeSurveillance::~CameraDeSurveillance()
 {
-    if (controleCamera)
-    {
-        delete controleCamera;
-    }
+    // ControleCamera et CaptureVideo sont détruits dans leur thread à la fin de celui-ci (deleteLater) ;
+    // l'aperçu rend d'abord son image, dont le tampon disparaît avec la capture. L'enregistreur,
+    // qui reçoit les images de la capture, s'arrête après elle.
+    ui.videoPreview->detach();
+    videoThread.quit();
+    videoThread.wait();
+    recordThread.quit();
+    recordThread.wait();
+    cameraThread.quit();
+    cameraThread.wait();
 }
 
 //---------------------------------------------------------------------------------------------
 //* Fonction pour établir les connexions entre les boutons de l'interface et les slots correspondants
+//* ControleCamera vivant dans un autre thread, ces connexions sont en file (Qt::QueuedConnection)
 //* Paramètres :
 //*  Aucun paramètre
 //*
@@ -66,400 +198,368 @@ CameraDeSurveillance::~CameraDeSurveillance()
 void CameraDeSurveillance::setupConnections()
 {
     connect(ui.OpenPortButton, &QPushButton::clicked, this, &CameraDeSurveillance::openPort);
-    connect(ui.initbutton, &QPushButton::clicked, this, &CameraDeSurveillance::camInitialisation);
-    connect(ui.powerbutton, &QPushButton::clicked, this, &CameraDeSurveillance::powerOn);
-    connect(ui.moveUpButton, &QPushButton::clicked, this, &CameraDeSurveillance::moveUp);
-    connect(ui.moveDownButon, &QPushButton::clicked, this, &CameraDeSurveillance::moveDown);
-    connect(ui.moveLeftButton, &QPushButton::clicked, this, &CameraDeSurveillance::moveLeft);
-    connect(ui.moveRightButon, &QPushButton::clicked, this, &CameraDeSurveillance::moveRight);
-    connect(ui.autobutton, &QPushButton::clicked, this, &CameraDeSurveillance::autoMode); 
-    connect(ui.zoomVerticalSlider, SIGNAL(valueChanged(int)), this, SLOT(adjustZoom(int)));
+    connect(ui.ChoseLanguage, &QComboBox::currentIndexChanged, this, &CameraDeSurveillance::ChangeLanguage);
+    connect(this, &CameraDeSurveillance::openPortRequested, controleCamera, &ControleCamera::openPort);
+    connect(controleCamera, &ControleCamera::portOpened, this, &CameraDeSurveillance::onPortOpened);
+
+    connect(ui.initbutton, &QPushButton::clicked, controleCamera, &ControleCamera::camInitialisation);
+    connect(ui.powerbutton, &QPushButton::clicked, controleCamera, &ControleCamera::powerON);
+
+    // Les directions se conduisent en vitesse : la caméra bouge tant que le bouton est enfoncé
+    connect(ui.moveUpButton, &QPushButton::pressed, this, [this]() { holdDirection(HeldUp, true, 1.0); });
+    connect(ui.moveUpButton, &QPushButton::released, this, [this]() { holdDirection(HeldUp, false, 1.0); });
+    connect(ui.moveDownButon, &QPushButton::pressed, this, [this]() { holdDirection(HeldDown, true, 1.0); });
+    connect(ui.moveDownButon, &QPushButton::released, this, [this]() { holdDirection(HeldDown, false, 1.0); });
+    connect(ui.moveLeftButton, &QPushButton::pressed, this, [this]() { holdDirection(HeldLeft, true, 1.0); });
+    connect(ui.moveLeftButton, &QPushButton::released, this, [this]() { holdDirection(HeldLeft, false, 1.0); });
+    connect(ui.moveRightButon, &QPushButton::pressed, this, [this]() { holdDirection(HeldRight, true, 1.0); });
+    connect(ui.moveRightButon, &QPushButton::released, this, [this]() { holdDirection(HeldRight, false, 1.0); });
+
+    connect(ui.autobutton, &QPushButton::clicked, controleCamera, &ControleCamera::autoMode);
+    connect(ui.autobutton, &QPushButton::clicked, this, [this]() { triggerRecording(traductions.text(Message::AutoMode)); });
+    connect(ui.recordButton, &QPushButton::clicked, this, [this]() { triggerRecording(traductions.text(Message::Record)); });
+    connect(ui.zoomVerticalSlider, &QSlider::valueChanged, controleCamera, &ControleCamera::adjustZoom);
+
+    // Visée depuis l'aperçu : un clic centre le point, un rectangle est centré et remplit l'image,
+    // pan, tilt et zoom en un seul mouvement absolu
+    connect(ui.videoPreview, &ApercuVideo::pointClicked, this, [this](const QPointF& point, double aspect) {
+        ControleCamera* controle = controleCamera;
+        QMetaObject::invokeMethod(controle, [controle, point, aspect]() { controle->centerOn(1, point, aspect); }, Qt::QueuedConnection);
+    });
+    connect(ui.videoPreview, &ApercuVideo::areaSelected, this, [this](const QRectF& area, double aspect) {
+        ControleCamera* controle = controleCamera;
+        QMetaObject::invokeMethod(controle, [controle, area, aspect]() { controle->zoomToArea(1, area, aspect); }, Qt::QueuedConnection);
+    });
+
+    // Adaptateur débranché puis retrouvé par le chien de garde du thread de la caméra
+    connect(controleCamera, &ControleCamera::linkLost, this, [this](const QString& portName) {
+        ui.portStatusLabel->setText(traductions.text(Message::LinkLost).arg(portName));
+    });
+    connect(controleCamera, &ControleCamera::linkRestored, this, [this](const QString& portName, qint64 reconnectMs) {
+        ui.portStatusLabel->setText(traductions.text(Message::LinkRestored).arg(portName).arg(reconnectMs));
+    });
+    connect(controleCamera, &ControleCamera::availablePortsChanged, this, &CameraDeSurveillance::updatePortList);
+
+    connect(detectionMouvement, &DetectionMouvement::motionStarted, this, &CameraDeSurveillance::onMotionStarted);
+    connect(enregistreurVideo, &EnregistreurVideo::recordingStarted, this, [this](const QString& reason) {
+        ui.statusBar->showMessage(traductions.text(Message::Recording).arg(reason), 5000);
+    });
+    connect(enregistreurVideo, &EnregistreurVideo::failed, this, [this](const QString& errorString) {
+        ui.statusBar->showMessage(traductions.text(Message::RecordingFailed).arg(errorString), 5000);
+    });
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour ouvrir un port série pour la communication avec la caméra
+//* Fonction appelée quand un mouvement est confirmé dans une zone : l'alarme est affichée, la
+//* caméra rejoint la position associée à la zone, s'il y en a une, et la vidéo est enregistrée
+//* si la zone le demande
 //* Paramètres :
-//*  Aucun paramètre
+//*  - quint8 address : l'adresse de la caméra
+//*  - int zone : l'indice de la zone
+//*  - const QString& name : le nom de la zone
+//*  - double fraction : la part de la zone en mouvement
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::openPort()
+void CameraDeSurveillance::onMotionStarted(quint8 address, int zone, const QString& name, double fraction)
 {
-    if (ui.portChoiceComboBox->currentIndex() < 0)
-    {
-        switch (ui.ChoseLanguage->currentIndex()) {
-        case 0:
-            ui.portStatusLabel->setText("Veuillez selectionner un port.");
-            break;
-        case 1:
-            ui.portStatusLabel->setText("Please select a port.");
-            break;
-        case 2:
-            ui.portStatusLabel->setText("Bitte waehlen Sie einen Port.");
-            break;
-        case 3:
-            ui.portStatusLabel->setText("Yarja ikhtiyar manfath.");
-            break;
-        case 4:
-            ui.portStatusLabel->setText("Goulit ul port.");
-            break;
-        case 5:
-            ui.portStatusLabel->setText("Pora otkryt' port.");
-            break;
-        case 6:
-            ui.portStatusLabel->setText("Qing xuanze yi ge duankou.");
-            break;
-        case 7:
-            ui.portStatusLabel->setText("Por favor seleccione un puerto.");
-            break;
-        case 8:
-            ui.portStatusLabel->setText("Molimo odaberite port.");
-            break;
-        case 9:
-            ui.portStatusLabel->setText("Portum aperire selige.");
-            break;
-        case 10:
-            ui.portStatusLabel->setText("Anoigma thyras, parakalw epilogh.");
-            break;
-        }
+    qDebug() << "Mouvement camera" << address << "zone" << name << qRound(fraction * 100) << "%";
+    ui.statusBar->showMessage(traductions.text(Message::MotionDetected).arg(name), 5000);
 
-        return;
-    
+    DetectionMouvement::Zone watched = detectionMouvement->zone(zone);
+    if (!watched.preset.isEmpty())
+    {
+        ControleCamera* controle = controleCamera;
+        QString preset = watched.preset;
+        QMetaObject::invokeMethod(controle, [controle, preset, address]() { controle->gotoPreset(preset, address); }, Qt::QueuedConnection);
     }
+    if (watched.record)
+    {
+        triggerRecording(traductions.text(Message::MotionDetected).arg(name));
+    }
+}
 
-    // Créez un nouveau port série et passez-le à ControleCamera
-    port = new QSerialPort(ui.portChoiceComboBox->currentText());
+//---------------------------------------------------------------------------------------------
+//* Fonction déclenchant (ou prolongeant) l'enregistrement, dans le thread de l'enregistreur
+//* Paramètres :
+//*  - const QString& reason : la cause, affichée dans la barre d'état
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CameraDeSurveillance::triggerRecording(const QString& reason)
+{
+    EnregistreurVideo* recorder = enregistreurVideo;
+    QMetaObject::invokeMethod(recorder, [recorder, reason]() { recorder->trigger(reason); }, Qt::QueuedConnection);
+}
 
-    // Vérifiez si le port peut être ouvert via ControleCamera
-    if (controleCamera->openPort(port))  // Appel de la méthode openPort() dans ControleCamera
+//---------------------------------------------------------------------------------------------
+//* Fonction remplaçant la liste des ports après un branchement ou un débranchement ; la liste
+//* est relevée dans le thread de la caméra, le port choisi reste sélectionné s'il est présent
+//* Paramètres :
+//*  - const QStringList& portNames : les ports présents
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CameraDeSurveillance::updatePortList(const QStringList& portNames)
+{
+    QString selected = ui.portChoiceComboBox->currentText();
+
+    QSignalBlocker blocker(ui.portChoiceComboBox);
+    ui.portChoiceComboBox->clear();
+    for (const QString& portName : portNames)
     {
-        switch (ui.ChoseLanguage->currentIndex()) {
-        case 0:
-            ui.portStatusLabel->setText("Statut port: Ouvert");
-            break;
-        case 1:
-            ui.portStatusLabel->setText("Port status: Open");
-            break;
-        case 2:
-            ui.portStatusLabel->setText("Port status: Offen");
-            break;
-        case 3:
-            ui.portStatusLabel->setText("Statut al manfath: Maftuh");
-            break;
-        case 4:
-            ui.portStatusLabel->setText("Status port: Ouvert");
-            break;
-        case 5:
-            ui.portStatusLabel->setText("Status port: Otkryt");
-            break;
-        case 6:
-            ui.portStatusLabel->setText("Zhuangtai duankou: Daka");
-            break;
-        case 7:
-            ui.portStatusLabel->setText("Estado del puerto: Abierto");
-            break;
-        case 8:
-            ui.portStatusLabel->setText("Status porta: Otvoren");
-            break;
-        case 9:
-            ui.portStatusLabel->setText("Status portus: Apertus");
-            break;
-        case 10:
-            ui.portStatusLabel->setText("Katalogi thyras: Anoigmeni");
-            break;
-        }
+        ui.portChoiceComboBox->addItem(portName, QVariant(portName));
+    }
+    int index = ui.portChoiceComboBox->findText(selected);
+    ui.portChoiceComboBox->setCurrentIndex(index >= 0 ? index : (portNames.isEmpty() ? -1 : 0));
+}
 
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand une direction est enfoncée ou relâchée : la consigne de vitesse est
+//* envoyée aussitôt, puis rafraîchie par velocityTimer tant qu'une direction reste tenue
+//* Paramètres :
+//*  - int direction : la direction (HeldUp, HeldDown, HeldLeft, HeldRight)
+//*  - bool held : vrai à l'appui, faux au relâchement
+//*  - double speed : la vitesse demandée, de 0 à 1
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CameraDeSurveillance::holdDirection(int direction, bool held, double speed)
+{
+    if (held)
+    {
+        heldDirections |= direction;
+        heldSpeed = speed;
     }
     else
     {
-        switch (ui.ChoseLanguage->currentIndex()) {
-        case 0:
-            ui.portStatusLabel->setText("Erreur: " + port->errorString());
-            break;
-        case 1:
-            ui.portStatusLabel->setText("Error: " + port->errorString());
-            break;
-        case 2:
-            ui.portStatusLabel->setText("Fehler: " + port->errorString());
-            break;
-        case 3:
-            ui.portStatusLabel->setText("Khata: " + port->errorString());
-            break;
-        case 4:
-            ui.portStatusLabel->setText("Erreur: " + port->errorString());
-            break;
-        case 5:
-            ui.portStatusLabel->setText("Oshibka: " + port->errorString());
-            break;
-        case 6:
-            ui.portStatusLabel->setText("Cuowu: " + port->errorString());
-            break;
-        case 7:
-            ui.portStatusLabel->setText("Error: " + port->errorString());
-            break;
-        case 8:
-            ui.portStatusLabel->setText("Greska: " + port->errorString());
-            break;
-        case 9:
-            ui.portStatusLabel->setText("Error: " + port->errorString());
-            break;
-        case 10:
-            ui.portStatusLabel->setText("Lathos: " + port->errorString());
-            break;
-        }
+        heldDirections &= ~direction;
+    }
+
+    sendVelocity();
+    if (heldDirections != 0)
+    {
+        velocityTimer.start();
+    }
+    else
+    {
+        velocityTimer.stop();
     }
 }
 
+void CameraDeSurveillance::sendVelocity()
+{
+    double pan = ((heldDirections & HeldRight) ? heldSpeed : 0.0) - ((heldDirections & HeldLeft) ? heldSpeed : 0.0);
+    double tilt = ((heldDirections & HeldUp) ? heldSpeed : 0.0) - ((heldDirections & HeldDown) ? heldSpeed : 0.0);
+
+    // L'instant de la saisie part avec la consigne : le délai mesuré inclut le passage de thread
+    qint64 inputTime = PiloteVitesse::now();
+    ControleCamera* controle = controleCamera;
+    QMetaObject::invokeMethod(controle, [controle, pan, tilt, inputTime]() {
+        controle->setVelocity(1, pan, tilt, inputTime);
+    }, Qt::QueuedConnection);
+}
+
 //---------------------------------------------------------------------------------------------
-//* Fonction pour initialiser la caméra en envoyant une commande spécifique
+//* Fonctions de conduite au clavier : flèches à mi-vitesse, pleine vitesse avec Maj ; la
+//* répétition automatique est ignorée, velocityTimer rafraîchit déjà la consigne.
+//* Échap arrête la caméra en priorité sur toute commande en attente (arrêt d'urgence).
 //* Paramètres :
-//*  Aucun paramètre
+//*  - QKeyEvent* event : la touche
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::camInitialisation()
+void CameraDeSurveillance::keyPressEvent(QKeyEvent* event)
 {
-    controleCamera->camInitialisation();
+    if (event->key() == Qt::Key_Escape)
+    {
+        heldDirections = 0;
+        velocityTimer.stop();
+        ControleCamera* controle = controleCamera;
+        QMetaObject::invokeMethod(controle, [controle]() { controle->emergencyStop(1); }, Qt::QueuedConnection);
+        return;
+    }
+
+    int direction = heldDirectionForKey(event->key());
+    if (direction == 0)
+    {
+        QMainWindow::keyPressEvent(event);
+        return;
+    }
+    if (!event->isAutoRepeat())
+    {
+        holdDirection(direction, true, (event->modifiers() & Qt::ShiftModifier) ? 1.0 : 0.5);
+    }
+}
+
+void CameraDeSurveillance::keyReleaseEvent(QKeyEvent* event)
+{
+    int direction = heldDirectionForKey(event->key());
+    if (direction == 0)
+    {
+        QMainWindow::keyReleaseEvent(event);
+        return;
+    }
+    if (!event->isAutoRepeat())
+    {
+        holdDirection(direction, false, heldSpeed);
+    }
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour allumer la caméra en envoyant une commande spécifique pour l'alimentation
+//* Fonction appelée aux changements d'état de la fenêtre : si elle perd le focus, les touches
+//* tenues ne recevront pas de relâchement, la caméra est arrêtée
 //* Paramètres :
-//*  Aucun paramètre
+//*  - QEvent* event : l'évènement
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::powerOn()
+void CameraDeSurveillance::changeEvent(QEvent* event)
 {
-    controleCamera->powerON();
+    if (event->type() == QEvent::ActivationChange && !isActiveWindow() && heldDirections != 0)
+    {
+        heldDirections = 0;
+        velocityTimer.stop();
+        sendVelocity();
+    }
+    QMainWindow::changeEvent(event);
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour déplacer la caméra vers le haut
+//* Fonction pour ouvrir un port série pour la communication avec la caméra
 //* Paramètres :
 //*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::moveUp()
+void CameraDeSurveillance::openPort()
 {
-    controleCamera->MoveUp();
+    if (ui.portChoiceComboBox->currentIndex() < 0)
+    {
+        ui.portStatusLabel->setText(traductions.text(Message::SelectPort));
+        return;
+    }
+
+    // L'ouverture se fait dans le thread de la caméra, le résultat revient par onPortOpened()
+    emit openPortRequested(ui.portChoiceComboBox->currentText());
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour déplacer la caméra vers le bas
+//* Fonction appelée quand le thread de la caméra a tenté d'ouvrir le port, affiche le statut
 //* Paramètres :
-//*  Aucun paramètre
+//*  - bool success : vrai si le port est ouvert
+//*  - const QString& errorString : le message d'erreur du port en cas d'échec
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::moveDown()
+void CameraDeSurveillance::onPortOpened(bool success, const QString& errorString)
 {
-    controleCamera->MoveDown();
+    if (success)
+    {
+        ui.portStatusLabel->setText(traductions.text(Message::PortOpen));
+    }
+    else
+    {
+        ui.portStatusLabel->setText(traductions.text(Message::PortError).arg(errorString));
+    }
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour déplacer la caméra vers la gauche
+//* Fonction appelée à chaque rafraîchissement de l'écran : vide le canal de télémétrie de la
+//* caméra et, si sa position a changé, met à jour le curseur de zoom et la barre d'état.
+//* La position vient du cache de ControleCamera, l'interface n'interroge jamais la caméra.
 //* Paramètres :
 //*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::moveLeft()
+void CameraDeSurveillance::updateTelemetry()
 {
-    controleCamera->MoveLeft();
+    CanalTelemetrie& telemetrie = controleCamera->telemetry();
+    if (telemetrie.drain() == 0)
+    {
+        return;
+    }
+
+    const Telemetrie::Snapshot& state = telemetrie.latest(1);
+    if (state.sequence == shownSequence)
+    {
+        return;
+    }
+    shownSequence = state.sequence;
+
+    // Le curseur suit le zoom réel sauf s'il est tenu par l'utilisateur ; sans bloquer ses
+    // signaux, la mise à jour renverrait une commande de zoom à la caméra
+    if (!ui.zoomVerticalSlider->isSliderDown())
+    {
+        QSignalBlocker blocker(ui.zoomVerticalSlider);
+        ui.zoomVerticalSlider->setValue(state.zoom);
+    }
+
+    showPosition(state);
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour déplacer la caméra vers la droite
+//* Fonction écrivant la position de la caméra dans la zone permanente de la barre d'état
 //* Paramètres :
-//*  Aucun paramètre
+//*  - const Telemetrie::Snapshot& state : le dernier instantané de la caméra
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::moveRight()
+void CameraDeSurveillance::showPosition(const Telemetrie::Snapshot& state)
 {
-    controleCamera->MoveRight();
+    QString text = traductions.text(Message::Position).arg(state.pan).arg(state.tilt).arg(state.zoom);
+    if (state.flags & Telemetrie::MOVING)
+    {
+        text.append("   ...");
+    }
+    positionLabel->setText(text);
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour activer le mode automatique de la caméra
+//* Fonction affichant les statistiques de la liaison série : débit négocié, octets par seconde
+//* émis et reçus, temps d'aller-retour médian et 95e centile, taux d'erreur, renvois et délais
+//* dépassés, dans la langue courante (aussi appelée au changement de langue)
 //* Paramètres :
 //*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void CameraDeSurveillance::autoMode()
+void CameraDeSurveillance::updateLinkStats()
 {
-    controleCamera->autoMode();
+    StatistiquesLiaison::Snapshot stats = controleCamera->linkStats();
+    if (stats.baudRate == 0)
+    {
+        linkLabel->clear();
+        return;
+    }
+
+    auto milliseconds = [](qint64 us) { return us < 0 ? QString(">1000") : QString::number(us / 1000); };
+    linkLabel->setText(traductions.text(Message::LinkStats)
+        .arg(stats.baudRate)
+        .arg(stats.baudConfirmed ? "" : "?")
+        .arg(stats.sendRate, 0, 'f', 0)
+        .arg(stats.receiveRate, 0, 'f', 0)
+        .arg(milliseconds(StatistiquesLiaison::Snapshot::percentileUs(stats.roundTrip, 0.5)))
+        .arg(milliseconds(StatistiquesLiaison::Snapshot::percentileUs(stats.roundTrip, 0.95)))
+        .arg(stats.errorRate() * 100.0, 0, 'f', 1)
+        .arg(stats.retries)
+        .arg(stats.timeouts));
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction pour changer la langue de l'interface graphique
+//* Fonction pour changer la langue de l'interface graphique : les widgets enregistrés dans la
+//* table des traductions sont retraduits en un passage
 //* Paramètres :
 //*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-
 void CameraDeSurveillance::ChangeLanguage()
 {
-    
-    switch (ui.ChoseLanguage->currentIndex())
+    if (traductions.setLanguage(ui.ChoseLanguage->currentIndex()))
     {
-    case 0: 
-        ui.OpenPortButton->setText("Ouvrir le port");
-        ui.autobutton->setText("Mode automatique");
-        ui.initbutton->setText("Initialiser");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Changer la langue");
-        ui.moveDownButon->setText("Descendre");
-        ui.moveLeftButton->setText("Gauche");
-        ui.moveRightButon->setText("Droite");
-        ui.moveUpButton->setText("Monter");
-        ui.powerbutton->setText("Allumer");
-        ui.portStatusLabel->setText("");
-        break;
-          
-    case 1:
-        ui.OpenPortButton->setText("Open Port");
-        ui.autobutton->setText("Automatic mode");
-        ui.initbutton->setText("Initialise");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Changer language");
-        ui.moveDownButon->setText("Down");
-        ui.moveLeftButton->setText("Left");
-        ui.moveRightButon->setText("Right");
-        ui.moveUpButton->setText("Up");
-        ui.powerbutton->setText("Turn On");
-        ui.portStatusLabel->setText("");
-        break;
-
-    case 2:
-        ui.OpenPortButton->setText("Offener Port");
-        ui.autobutton->setText("Automatikmodus");
-        ui.initbutton->setText("Initialisieren");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Sprache andern");
-        ui.moveDownButon->setText("Runterkommen");
-        ui.moveLeftButton->setText("Links");
-        ui.moveRightButon->setText("Rechts");
-        ui.moveUpButton->setText("Nach oben");
-        ui.powerbutton->setText("Zum Leuchten");
-        ui.portStatusLabel->setText("");
-        break;
-
-    case 3:
-        ui.OpenPortButton->setText("Fath Al manfaz");
-        ui.autobutton->setText("telqaa'i");
-        ui.initbutton->setText("Tahyi'aa");
-        ui.label->setText("Takbir");
-        ui.label_4->setText("taghir al logha");
-        ui.moveDownButon->setText("nuzul");
-        ui.moveLeftButton->setText("yasar");
-        ui.moveRightButon->setText("yamin");
-        ui.moveUpButton->setText("sooud");
-        ui.powerbutton->setText("tashghil");
-        ui.portStatusLabel->setText("");
-        break;
-        
-    case 4: 
-        ui.OpenPortButton->setText("Digerin ar porzh");
-        ui.autobutton->setText("Mod emgefre");
-        ui.initbutton->setText("Kregin");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Chench ar yezh");
-        ui.moveDownButon->setText("Diskenn");
-        ui.moveLeftButton->setText("Tu kleiz");
-        ui.moveRightButon->setText("Tu dehou");
-        ui.moveUpButton->setText("Pignat");
-        ui.powerbutton->setText("Prenan");
-        ui.portStatusLabel->setText("");
-        break;
-
-    case 5:
-        ui.OpenPortButton->setText("Otvori port");
-        ui.autobutton->setText("Avtomaticheskij rezhim");
-        ui.initbutton->setText("Initsializirovat'");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Smenit' yazyik");
-        ui.moveDownButon->setText("Vniz");
-        ui.moveLeftButton->setText("Vlevo");
-        ui.moveRightButon->setText("Vpravo");
-        ui.moveUpButton->setText("Vverkh");
-        ui.powerbutton->setText("Vklyuchit'");
-        ui.portStatusLabel->setText("");
-        break;
-
-    case 6:
-        ui.OpenPortButton->setText("da kai duan kou");
-        ui.autobutton->setText("zi dong mo shi");
-        ui.initbutton->setText("chu xin hua");
-        ui.label->setText("zuo fang");
-        ui.label_4->setText("geng huan yu yan");
-        ui.moveDownButon->setText("xiang xia");
-        ui.moveLeftButton->setText("xiang zuo");
-        ui.moveRightButon->setText("xiang you");
-        ui.moveUpButton->setText("xiang shang");
-        ui.powerbutton->setText("da kai dian yuan");
-        ui.portStatusLabel->setText("");
-        break;
-    
-    case 7:
-        ui.OpenPortButton->setText("Abrir puerto");
-        ui.autobutton->setText("Modo automatico");
-        ui.initbutton->setText("Inicializar");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Cambiar idioma");
-        ui.moveDownButon->setText("Bajar");
-        ui.moveLeftButton->setText("Izquierda");
-        ui.moveRightButon->setText("Derecha");
-        ui.moveUpButton->setText("Subir");
-        ui.powerbutton->setText("Encender");
-        ui.portStatusLabel->setText("");
-        break;
-    
-    case 8:
-        ui.OpenPortButton->setText("Otvoriti port");
-        ui.autobutton->setText("Automatski rezim");
-        ui.initbutton->setText("Inicijalizuj");
-        ui.label->setText("Zum");
-        ui.label_4->setText("Promeni jezik");
-        ui.moveDownButon->setText("Nadalje");
-        ui.moveLeftButton->setText("Levo");
-        ui.moveRightButon->setText("Desno");
-        ui.moveUpButton->setText("Gore");
-        ui.powerbutton->setText("Ukljuci");
-        ui.portStatusLabel->setText("");
-        break;
-    
-    case 9:
-        ui.OpenPortButton->setText("Portum aperire");
-        ui.autobutton->setText("Modus automaticus");
-        ui.initbutton->setText("Iniciari");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Mutare linguam");
-        ui.moveDownButon->setText("Descendere");
-        ui.moveLeftButton->setText("Sinistrorsum");
-        ui.moveRightButon->setText("Dextrorsum");
-        ui.moveUpButton->setText("Ascendere");
-        ui.powerbutton->setText("Accendere");
-        ui.portStatusLabel->setText("");
-        break;
-    
-    case 10:
-        ui.OpenPortButton->setText("Anoigma thyras");
-        ui.autobutton->setText("Aftomati leitourgia");
-        ui.initbutton->setText("Arxikopoiisi");
-        ui.label->setText("Zoom");
-        ui.label_4->setText("Allagi glossas");
-        ui.moveDownButon->setText("Kato");
-        ui.moveLeftButton->setText("Aristera");
-        ui.moveRightButon->setText("Dexia");
-        ui.moveUpButton->setText("Epanw");
-        ui.powerbutton->setText("Anoigma");
+        traductions.retranslate();
         ui.portStatusLabel->setText("");
-        break;
     }
-    
 }
@@ -2,8 +2,15 @@
 
 #include <QtWidgets/QMainWindow>
 #include "ui_CameraDeSurveillance.h"
-#include <QSerialPort>
+#include <QThread>
+#include <QTimer>
+#include <QLabel>
 #include "ControleCamera.h"
+#include "CaptureVideo.h"
+#include "DetectionMouvement.h"
+#include "EnregistreurVideo.h"
+#include "SondeLatence.h"
+#include "Traductions.h"
 
 class CameraDeSurveillance : public QMainWindow
 {
@@ -12,22 +19,46 @@ class CameraDeSurveillance : public QMainWindow
 private:
     Ui::CameraDeSurveillanceClass ui;
     ControleCamera* controleCamera;
-    QSerialPort* port;
-    bool waitingForConfirmation = false;
+    QThread cameraThread;
+    CaptureVideo* captureVideo;
+    QThread videoThread;        // Capture de l'aperçu vidéo, à l'écart de l'interface et de la caméra
+    DetectionMouvement* detectionMouvement;
+    EnregistreurVideo* enregistreurVideo;
+    QThread recordThread;       // Écriture des enregistrements, pour que la capture n'attende jamais le disque
+    SondeLatence* sondeLatence;
+    QTimer velocityTimer;       // Rafraîchit la consigne de vitesse tant qu'une direction est tenue
+    int heldDirections = 0;
+    double heldSpeed = 1.0;
+    Traductions traductions;
+    QLabel* positionLabel;      // Position de la caméra, dans la barre d'état
+    QLabel* linkLabel;          // Statistiques de la liaison série, dans la barre d'état
+    QTimer linkTimer;
+    QTimer telemetryTimer;      // Relève la télémétrie au rythme de l'écran
+    quint64 shownSequence = 0;  // Dernier instantané affiché
     void setupConnections();
+    void holdDirection(int direction, bool held, double speed);
+    void sendVelocity();
+    void triggerRecording(const QString& reason);
+    void showPosition(const Telemetrie::Snapshot& state);
 
 public:
     CameraDeSurveillance(QWidget* parent = nullptr);
     ~CameraDeSurveillance();
 
+protected:
+    void keyPressEvent(QKeyEvent* event) override;
+    void keyReleaseEvent(QKeyEvent* event) override;
+    void changeEvent(QEvent* event) override;
+
+signals:
+    void openPortRequested(const QString& portName);
+
 private slots:
     void openPort();
-    void camInitialisation();
-    void powerOn();
-    void moveUp();
-    void moveDown();
-    void moveLeft();
-    void moveRight();
-    void autoMode();  
+    void onPortOpened(bool success, const QString& errorString);
+    void updateTelemetry();
+    void updatePortList(const QStringList& portNames);
+    void updateLinkStats();
+    void onMotionStarted(quint8 address, int zone, const QString& name, double fraction);
     void ChangeLanguage();
 };
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Canal de télémétrie entre le thread d'une chaîne (seul producteur) et un consommateur
+//* (l'interface) : un anneau sans verrou d'instantanés de taille fixe. Le producteur y copie un
+//* instantané à chaque changement, sans allocation ni évènement Qt ; le consommateur vide
+//* l'anneau au rythme de l'affichage et ne garde que le dernier instantané de chaque caméra.
+//---------------------------------------------------------------------------------------------
+namespace Telemetrie
+{
+    constexpr std::uint8_t VALID = 0x01;    // Au moins une réponse de position reçue
+    constexpr std::uint8_t MOVING = 0x02;   // Position qui change
+
+    // Adresse 0 : instantané de la chaîne (compteurs seuls), 1 à 7 : caméras
+    struct Snapshot
+    {
+        std::uint64_t sequence;     // Numéro d'émission sur le canal, à partir de 1
+        std::int64_t time;          // Instant de l'émission (ns, PiloteVitesse::now())
+        std::uint32_t completed;    // Commandes terminées sur la chaîne depuis l'ouverture du port
+        std::uint32_t failed;       // Commandes en échec sur la chaîne
+        std::int16_t pan;
+        std::int16_t tilt;
+        std::uint16_t zoom;
+        std::uint8_t address;
+        std::uint8_t flags;
+    };
+
+    static_assert(sizeof(Snapshot) == 32, "Instantané de télémétrie de 32 octets");
+}
+
+class CanalTelemetrie
+{
+public:
+    // 256 emplacements : à 60 Hz d'affichage, l'anneau ne se remplit qu'au-delà de 15 000
+    // instantanés par seconde ; un instantané perdu est remplacé par le suivant, complet lui aussi
+    static constexpr std::size_t CAPACITY = 256;
+    static constexpr int ADDRESS_SLOTS = 8;
+
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "Capacité en puissance de deux");
+
+    // Producteur : copie l'instantané dans l'anneau, faux s'il est plein
+    bool push(Telemetrie::Snapshot snapshot)
+    {
+        std::uint64_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        snapshot.sequence = position + 1;
+        slots[position & (CAPACITY - 1)] = snapshot;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consommateur : vide l'anneau et renvoie le nombre d'instantanés lus
+    std::size_t drain()
+    {
+        std::uint64_t position = tail.load(std::memory_order_relaxed);
+        std::uint64_t end = head.load(std::memory_order_acquire);
+        std::size_t count = static_cast<std::size_t>(end - position);
+
+        for (; position != end; ++position)
+        {
+            const Telemetrie::Snapshot& snapshot = slots[position & (CAPACITY - 1)];
+            latestSnapshots[snapshot.address % ADDRESS_SLOTS] = snapshot;
+        }
+        tail.store(end, std::memory_order_release);
+        return count;
+    }
+
+    // Consommateur : dernier instantané lu pour une adresse (sequence = 0 si aucun)
+    const Telemetrie::Snapshot& latest(std::uint8_t address) const
+    {
+        return latestSnapshots[address % ADDRESS_SLOTS];
+    }
+
+    std::uint64_t pushedCount() const { return head.load(std::memory_order_relaxed); }
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Indices sur des lignes de cache séparées : producteur et consommateur ne se gênent pas
+    alignas(64) std::atomic<std::uint64_t> head{ 0 };
+    alignas(64) std::atomic<std::uint64_t> tail{ 0 };
+    alignas(64) std::atomic<std::uint64_t> dropped{ 0 };
+    alignas(64) Telemetrie::Snapshot slots[CAPACITY] = {};
+    Telemetrie::Snapshot latestSnapshots[ADDRESS_SLOTS] = {};
+};
@@ -0,0 +1,678 @@
+﻿//*********************************************************************************************
+//* Programme : CaptureVideo.cpp                                               Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Capturer les images de l'aperçu vidéo sans les copier : les tampons mmap du pilote
+//*       V4L2 (ou un fichier projeté en mémoire, ou une mire synthétique pour les essais) sont
+//*       publiés tels quels dans le pool d'images, puis rendus au pilote une fois affichés ou
+//*       remplacés par une image plus récente.
+//* Programmes associés : ApercuVideo.cpp, PoolImages.h
+//*********************************************************************************************
+
+#include "CaptureVideo.h"
+#include "Metriques.h"
+#include "PiloteVitesse.h"
+#include <QSocketNotifier>
+#include <QStringList>
+#include <QtGlobal>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Formats acceptés par l'aperçu, du moins coûteux à afficher au plus coûteux
+    bool parseFormat(const QString& name, Video::PixelFormat& format)
+    {
+        if (name == "gray" || name == "grey")
+        {
+            format = Video::PixelFormat::Gray8;
+        }
+        else if (name == "yuyv")
+        {
+            format = Video::PixelFormat::Yuyv;
+        }
+        else if (name == "rgb32")
+        {
+            format = Video::PixelFormat::Rgb32;
+        }
+        else
+        {
+            return false;
+        }
+        return true;
+    }
+
+    int bytesPerPixel(Video::PixelFormat format)
+    {
+        switch (format)
+        {
+        case Video::PixelFormat::Gray8: return 1;
+        case Video::PixelFormat::Yuyv: return 2;
+        case Video::PixelFormat::Rgb32: return 4;
+        }
+        return 1;
+    }
+
+    bool parseSize(const QString& text, int& width, int& height)
+    {
+        QStringList parts = text.split('x');
+        bool okWidth = false;
+        bool okHeight = false;
+        if (parts.size() == 2)
+        {
+            width = parts[0].toInt(&okWidth);
+            height = parts[1].toInt(&okHeight);
+        }
+        return okWidth && okHeight && width > 0 && height > 0 && width % 2 == 0;
+    }
+
+#ifdef Q_OS_LINUX
+    int xioctl(int fd, unsigned long request, void* argument)
+    {
+        int result;
+        do
+        {
+            result = ::ioctl(fd, request, argument);
+        } while (result == -1 && errno == EINTR);
+        return result;
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe CaptureVideo
+//* Paramètres :
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+CaptureVideo::CaptureVideo(QObject* parent)
+    : QObject(parent), frameTimer(this)
+{
+    frameTimer.setTimerType(Qt::PreciseTimer);
+}
+
+CaptureVideo::~CaptureVideo()
+{
+    close();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la source par défaut : la variable d'environnement CAMERA_VIDEO_SOURCE,
+//* sinon la première caméra V4L2 si elle existe, sinon aucune
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : QString, la description de la source (voir open())
+//---------------------------------------------------------------------------------------------
+QString CaptureVideo::defaultSource()
+{
+    QString source = qEnvironmentVariable("CAMERA_VIDEO_SOURCE");
+#ifdef Q_OS_LINUX
+    if (source.isEmpty() && QFile::exists("/dev/video0"))
+    {
+        source = "v4l2:/dev/video0";
+    }
+#endif
+    return source;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le temps processeur consommé par le thread appelant
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : qint64, le temps processeur en ns
+//---------------------------------------------------------------------------------------------
+qint64 CaptureVideo::threadCpuNs()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel, &user))
+    {
+        return 0;
+    }
+    // Unités de 100 ns
+    quint64 kernelTime = (static_cast<quint64>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    quint64 userTime = (static_cast<quint64>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return static_cast<qint64>((kernelTime + userTime) * 100);
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+    {
+        return 0;
+    }
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
+CaptureVideo::Stats CaptureVideo::stats() const
+{
+    Stats result;
+    result.frames = images.publishedCount();
+    result.dropped = images.droppedCount();
+    result.lastCpuNs = lastCpuNs.load(std::memory_order_relaxed);
+    result.totalCpuNs = totalCpuNs.load(std::memory_order_relaxed);
+    return result;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée par l'aperçu avant de prendre une image : la prochaine publication émettra
+//* de nouveau frameReady. Entre-temps, les images publiées se remplacent sans signal.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::acknowledge()
+{
+    notified.store(false, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ajoutant un traitement des images (détection de mouvement...) ; à appeler avant
+//* open(), les traitements étant ensuite appelés depuis le thread de capture
+//* Paramètres :
+//*  - Observer observer : le traitement, appelé pour chaque image avant sa publication
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::addObserver(Observer observer)
+{
+    observers.push_back(std::move(observer));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ouvrant la source vidéo ; une seule source par objet, pour toute sa durée de vie
+//* Paramètres :
+//*  - const QString& source : "v4l2:/dev/videoN" (ou directement "/dev/videoN"),
+//*    "fichier:chemin:LxH[:gray|yuyv|rgb32[:ips]]" pour des images brutes mises bout à bout,
+//*    ou "synthetique[:LxH[:ips]]" pour une mire animée
+//*
+//* Valeur de retour : aucun (failed est émis si la source ne peut pas être ouverte)
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::open(const QString& source)
+{
+    if (kind != Kind::None || source.isEmpty())
+    {
+        return;
+    }
+
+    QStringList parts = source.split(':');
+    const QString& type = parts[0];
+
+    if (type == "v4l2" || source.startsWith("/dev/"))
+    {
+        openDevice(type == "v4l2" ? source.mid(5) : source);
+    }
+    else if (type == "fichier" && parts.size() >= 3)
+    {
+        int width = 0;
+        int height = 0;
+        Video::PixelFormat pixelFormat = Video::PixelFormat::Gray8;
+        int fps = DEFAULT_FPS;
+        // Le chemin peut contenir ':' (lecteur Windows) : la taille est le dernier champ LxH
+        int sizeIndex = parts.size() - 1;
+        while (sizeIndex > 1 && !parts[sizeIndex].contains('x'))
+        {
+            --sizeIndex;
+        }
+        if (!parseSize(parts[sizeIndex], width, height)
+            || (sizeIndex + 1 < parts.size() && !parseFormat(parts[sizeIndex + 1], pixelFormat)))
+        {
+            emit failed(tr("Source vidéo invalide : %1").arg(source));
+            return;
+        }
+        if (sizeIndex + 2 < parts.size())
+        {
+            fps = parts[sizeIndex + 2].toInt();
+        }
+        openFile(parts.mid(1, sizeIndex - 1).join(':'), width, height, pixelFormat, fps > 0 ? fps : DEFAULT_FPS);
+    }
+    else if (type == "synthetique")
+    {
+        int width = 640;
+        int height = 360;
+        int fps = parts.size() >= 3 ? parts[2].toInt() : DEFAULT_FPS;
+        if (parts.size() >= 2 && !parseSize(parts[1], width, height))
+        {
+            emit failed(tr("Source vidéo invalide : %1").arg(source));
+            return;
+        }
+        openSynthetic(width, height, fps > 0 ? fps : DEFAULT_FPS);
+    }
+    else
+    {
+        emit failed(tr("Source vidéo inconnue : %1").arg(source));
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction arrêtant la capture et libérant les tampons ; l'aperçu doit avoir rendu son image
+//* auparavant (ApercuVideo::detach), ses pixels n'étant plus valides ensuite
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::close()
+{
+    frameTimer.stop();
+    frameTimer.disconnect(this);
+
+#ifdef Q_OS_LINUX
+    if (fd >= 0)
+    {
+        delete notifier;
+        notifier = nullptr;
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(fd, VIDIOC_STREAMOFF, &type);
+        for (int i = 0; i < bufferCount; ++i)
+        {
+            if (mapped[i])
+            {
+                ::munmap(mapped[i], mappedLength[i]);
+                mapped[i] = nullptr;
+            }
+        }
+        ::close(fd);
+        fd = -1;
+        bufferCount = 0;
+    }
+#endif
+
+    if (fileData)
+    {
+        file.unmap(const_cast<uchar*>(fileData));
+        fileData = nullptr;
+    }
+    file.close();
+    kind = Kind::None;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ouvrant un périphérique V4L2 en mode streaming mmap. Le format d'image est choisi
+//* pour être affiché sans conversion (luminance, puis RGB32) ; à défaut, YUYV, que tous les
+//* pilotes UVC proposent, est converti à l'affichage.
+//* Paramètres :
+//*  - const QString& path : le chemin du périphérique
+//*
+//* Valeur de retour : bool, vrai si la capture a démarré
+//---------------------------------------------------------------------------------------------
+bool CaptureVideo::openDevice(const QString& path)
+{
+#ifdef Q_OS_LINUX
+    fd = ::open(QFile::encodeName(path).constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
+    {
+        emit failed(tr("%1 : %2").arg(path, QString::fromLocal8Bit(std::strerror(errno))));
+        return false;
+    }
+
+    v4l2_capability capability{};
+    quint32 caps = 0;
+    if (xioctl(fd, VIDIOC_QUERYCAP, &capability) == 0)
+    {
+        caps = (capability.capabilities & V4L2_CAP_DEVICE_CAPS) ? capability.device_caps : capability.capabilities;
+    }
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING))
+    {
+        emit failed(tr("%1 : pas de capture vidéo en streaming").arg(path));
+        close();
+        return false;
+    }
+
+    v4l2_format deviceFormat{};
+    deviceFormat.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(fd, VIDIOC_G_FMT, &deviceFormat);
+
+    const struct
+    {
+        quint32 fourcc;
+        Video::PixelFormat format;
+    } candidates[] = {
+        { V4L2_PIX_FMT_GREY, Video::PixelFormat::Gray8 },
+        { V4L2_PIX_FMT_XRGB32, Video::PixelFormat::Rgb32 },
+        { V4L2_PIX_FMT_YUYV, Video::PixelFormat::Yuyv }
+    };
+    bool accepted = false;
+    for (const auto& candidate : candidates)
+    {
+        v4l2_format requested = deviceFormat;
+        requested.fmt.pix.pixelformat = candidate.fourcc;
+        requested.fmt.pix.field = V4L2_FIELD_NONE;
+        if (xioctl(fd, VIDIOC_S_FMT, &requested) == 0 && requested.fmt.pix.pixelformat == candidate.fourcc)
+        {
+            format.width = static_cast<int>(requested.fmt.pix.width);
+            format.height = static_cast<int>(requested.fmt.pix.height);
+            format.stride = static_cast<int>(requested.fmt.pix.bytesperline);
+            format.format = candidate.format;
+            accepted = true;
+            break;
+        }
+    }
+    if (!accepted)
+    {
+        emit failed(tr("%1 : aucun format d'image pris en charge (GREY, XRGB32, YUYV)").arg(path));
+        close();
+        return false;
+    }
+    if (format.stride == 0)
+    {
+        format.stride = format.width * bytesPerPixel(format.format);
+    }
+
+    // Un tampon chez l'aperçu, un publié en attente : il en reste au moins un pour le pilote
+    v4l2_requestbuffers request{};
+    request.count = POOL_SIZE;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &request) != 0 || request.count < 3)
+    {
+        emit failed(tr("%1 : tampons mmap indisponibles").arg(path));
+        close();
+        return false;
+    }
+    bufferCount = qMin(static_cast<int>(request.count), static_cast<int>(POOL_SIZE));
+
+    // Emplacement i du pool = tampon i du pilote ; tous sont d'abord chez le pilote
+    for (int i = 0; i < POOL_SIZE; ++i)
+    {
+        images.acquire();
+    }
+    for (int i = 0; i < bufferCount; ++i)
+    {
+        v4l2_buffer buffer{};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = static_cast<quint32>(i);
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buffer) != 0)
+        {
+            emit failed(tr("%1 : tampon %2 introuvable").arg(path).arg(i));
+            close();
+            return false;
+        }
+        void* address = ::mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buffer.m.offset);
+        if (address == MAP_FAILED)
+        {
+            emit failed(tr("%1 : mmap impossible").arg(path));
+            close();
+            return false;
+        }
+        mapped[i] = address;
+        mappedLength[i] = buffer.length;
+        xioctl(fd, VIDIOC_QBUF, &buffer);
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) != 0)
+    {
+        emit failed(tr("%1 : démarrage de la capture impossible").arg(path));
+        close();
+        return false;
+    }
+
+    kind = Kind::Device;
+    notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &CaptureVideo::onDeviceReadable);
+    return true;
+#else
+    emit failed(tr("%1 : capture V4L2 disponible sous Linux seulement").arg(path));
+    return false;
+#endif
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ouvrant un fichier d'images brutes mises bout à bout, projeté en mémoire et lu en
+//* boucle à la cadence demandée
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier
+//*  - int width, int height : les dimensions des images
+//*  - Video::PixelFormat pixelFormat : le format des pixels
+//*  - int fps : la cadence de lecture
+//*
+//* Valeur de retour : bool, vrai si la lecture a démarré
+//---------------------------------------------------------------------------------------------
+bool CaptureVideo::openFile(const QString& path, int width, int height, Video::PixelFormat pixelFormat, int fps)
+{
+    format.width = width;
+    format.height = height;
+    format.stride = width * bytesPerPixel(pixelFormat);
+    format.format = pixelFormat;
+    frameBytes = static_cast<qint64>(format.stride) * height;
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < frameBytes)
+    {
+        emit failed(tr("%1 : fichier d'images illisible ou trop court").arg(path));
+        file.close();
+        return false;
+    }
+    fileData = file.map(0, file.size());
+    if (!fileData)
+    {
+        emit failed(tr("%1 : projection en mémoire impossible").arg(path));
+        file.close();
+        return false;
+    }
+    frameCount = file.size() / frameBytes;
+    fileFrame = 0;
+
+    kind = Kind::File;
+    connect(&frameTimer, &QTimer::timeout, this, &CaptureVideo::onFileTick);
+    frameTimer.start(qMax(1, 1000 / fps));
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction démarrant la mire synthétique : un tampon préalloué par emplacement du pool
+//* Paramètres :
+//*  - int width, int height : les dimensions des images
+//*  - int fps : la cadence
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::openSynthetic(int width, int height, int fps)
+{
+    format.width = width;
+    format.height = height;
+    format.stride = width;
+    format.format = Video::PixelFormat::Gray8;
+    for (std::vector<std::uint8_t>& buffer : synthetic)
+    {
+        buffer.assign(static_cast<std::size_t>(width) * height, 0);
+    }
+
+    kind = Kind::Synthetic;
+    connect(&frameTimer, &QTimer::timeout, this, &CaptureVideo::onSyntheticTick);
+    frameTimer.start(qMax(1, 1000 / fps));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand le pilote V4L2 a rempli un tampon : il est publié tel quel, puis les
+//* tampons rendus par l'aperçu (ou remplacés) sont remis au pilote
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::onDeviceReadable()
+{
+#ifdef Q_OS_LINUX
+    qint64 cpuStart = threadCpuNs();
+
+    v4l2_buffer buffer{};
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_DQBUF, &buffer) != 0)
+    {
+        if (errno != EAGAIN)
+        {
+            emit failed(tr("Capture vidéo interrompue : %1").arg(QString::fromLocal8Bit(std::strerror(errno))));
+            close();
+        }
+        return;
+    }
+
+    // Horodatage du pilote si son horloge est celle de PiloteVitesse::now() (CLOCK_MONOTONIC)
+    qint64 captureTime = PiloteVitesse::now();
+    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC)
+    {
+        captureTime = static_cast<qint64>(buffer.timestamp.tv_sec) * 1000000000
+            + static_cast<qint64>(buffer.timestamp.tv_usec) * 1000;
+    }
+
+    int slot = static_cast<int>(buffer.index);
+    if (slot >= bufferCount || (buffer.flags & V4L2_BUF_FLAG_ERROR))
+    {
+        xioctl(fd, VIDIOC_QBUF, &buffer);
+        return;
+    }
+    images.image(slot).data = static_cast<const std::uint8_t*>(mapped[slot]);
+    publish(slot, captureTime, cpuStart);
+    requeueFreeBuffers();
+#endif
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction remettant au pilote les tampons libérés par l'aperçu ou par une publication
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::requeueFreeBuffers()
+{
+#ifdef Q_OS_LINUX
+    int slot;
+    while ((slot = images.acquire()) >= 0)
+    {
+        v4l2_buffer buffer{};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = static_cast<quint32>(slot);
+        xioctl(fd, VIDIOC_QBUF, &buffer);
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction publiant l'image suivante du fichier : elle pointe directement dans la projection
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::onFileTick()
+{
+    qint64 cpuStart = threadCpuNs();
+    int slot = images.acquire();
+    if (slot < 0)
+    {
+        return;
+    }
+    images.image(slot).data = fileData + fileFrame * frameBytes;
+    fileFrame = (fileFrame + 1) % frameCount;
+    publish(slot, PiloteVitesse::now(), cpuStart);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction dessinant l'image suivante de la mire (bandes diagonales et carré mobiles) dans le
+//* tampon de l'emplacement réservé
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::onSyntheticTick()
+{
+    qint64 cpuStart = threadCpuNs();
+    int slot = images.acquire();
+    if (slot < 0)
+    {
+        return;
+    }
+
+    std::uint8_t* pixels = synthetic[slot].data();
+    int shift = static_cast<int>(sequence * 4);
+    for (int y = 0; y < format.height; ++y)
+    {
+        std::uint8_t* row = pixels + static_cast<std::size_t>(y) * format.stride;
+        for (int x = 0; x < format.width; ++x)
+        {
+            row[x] = static_cast<std::uint8_t>(((x + y + shift) & 0x3F) + 48);
+        }
+    }
+    int side = format.height / 6;
+    int period = qMax(1, format.width - side);
+    int left = static_cast<int>((sequence * 6) % (2 * period));
+    left = left < period ? left : 2 * period - left;
+    int top = (format.height - side) / 2;
+    for (int y = top; y < top + side; ++y)
+    {
+        std::memset(pixels + static_cast<std::size_t>(y) * format.stride + left, 0xF0, static_cast<std::size_t>(side));
+    }
+
+    images.image(slot).data = pixels;
+    publish(slot, PiloteVitesse::now(), cpuStart);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction complétant la description d'une image, la passant aux traitements puis la publiant
+//* dans le pool ; le temps processeur des traitements compte dans celui de l'image. L'aperçu
+//* n'est prévenu que s'il a déjà pris l'image précédente, une image périmée n'attend jamais en file
+//* Paramètres :
+//*  - int slot : l'emplacement, dont les pixels sont déjà renseignés
+//*  - qint64 captureTime : l'instant de la capture (ns, horloge de PiloteVitesse::now())
+//*  - qint64 cpuStart : le temps processeur du thread au début du traitement de l'image
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void CaptureVideo::publish(int slot, qint64 captureTime, qint64 cpuStart)
+{
+    Video::Image& image = images.image(slot);
+    image.width = format.width;
+    image.height = format.height;
+    image.stride = format.stride;
+    image.format = format.format;
+    image.captureTime = captureTime;
+    image.sequence = ++sequence;
+    for (const Observer& observer : observers)
+    {
+        observer(image);
+    }
+    image.captureCpuNs = threadCpuNs() - cpuStart;
+
+    quint64 dropped = images.droppedCount();
+    images.publish(slot);
+    Metriques::add(Metrique::Counter::FramesCaptured);
+    if (images.droppedCount() != dropped)
+    {
+        Metriques::add(Metrique::Counter::FramesDropped);
+    }
+    lastCpuNs.store(image.captureCpuNs, std::memory_order_relaxed);
+    totalCpuNs.store(totalCpuNs.load(std::memory_order_relaxed) + image.captureCpuNs, std::memory_order_relaxed);
+
+    if (!notified.exchange(true, std::memory_order_acq_rel))
+    {
+        emit frameReady();
+    }
+}
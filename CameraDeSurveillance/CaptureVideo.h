@@ -0,0 +1,97 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include "PoolImages.h"
+
+class QSocketNotifier;
+
+// Source vidéo de l'aperçu, dans son propre thread : tampons mmap d'un périphérique V4L2,
+// fichier d'images brutes projeté en mémoire ou mire synthétique. Les images sont publiées
+// dans le pool sans copie ; frameReady n'est émis que si l'aperçu a pris la précédente.
+class CaptureVideo : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int POOL_SIZE = 4;     // Tampons du pilote ou emplacements de la source
+    static constexpr int DEFAULT_FPS = 30;
+
+    // Traitement d'une image dans le thread de capture, avant sa publication (les pixels ne
+    // changent pas pendant l'appel)
+    using Observer = std::function<void(const Video::Image&)>;
+
+    struct Stats
+    {
+        quint64 frames = 0;
+        quint64 dropped = 0;        // Images remplacées avant d'avoir été affichées
+        qint64 lastCpuNs = 0;       // Temps processeur de la capture de la dernière image
+        qint64 totalCpuNs = 0;
+    };
+
+    explicit CaptureVideo(QObject* parent = nullptr);
+    ~CaptureVideo();
+
+    PoolImages& pool() { return images; }
+    Stats stats() const;
+    void acknowledge();
+    void addObserver(Observer observer);
+
+    static QString defaultSource();
+    static qint64 threadCpuNs();
+
+public slots:
+    void open(const QString& source);
+    void close();
+
+signals:
+    void frameReady();
+    void failed(const QString& errorString);
+
+private slots:
+    void onDeviceReadable();
+    void onFileTick();
+    void onSyntheticTick();
+
+private:
+    enum class Kind { None, Device, File, Synthetic };
+
+    bool openDevice(const QString& path);
+    bool openFile(const QString& path, int width, int height, Video::PixelFormat format, int fps);
+    void openSynthetic(int width, int height, int fps);
+    void requeueFreeBuffers();
+    void publish(int slot, qint64 captureTime, qint64 cpuStart);
+
+    PoolImages images{ POOL_SIZE };
+    std::vector<Observer> observers;
+    Kind kind = Kind::None;
+    QTimer frameTimer;
+    std::atomic<bool> notified{ false };    // Un frameReady est en route vers l'aperçu
+    std::atomic<qint64> lastCpuNs{ 0 };
+    std::atomic<qint64> totalCpuNs{ 0 };
+    quint64 sequence = 0;
+
+    // Périphérique V4L2
+    int fd = -1;
+    QSocketNotifier* notifier = nullptr;
+    void* mapped[POOL_SIZE] = {};
+    std::size_t mappedLength[POOL_SIZE] = {};
+    int bufferCount = 0;
+
+    // Fichier d'images brutes
+    QFile file;
+    const uchar* fileData = nullptr;
+    qint64 frameBytes = 0;
+    qint64 frameCount = 0;
+    qint64 fileFrame = 0;
+
+    // Mire synthétique
+    std::vector<std::uint8_t> synthetic[POOL_SIZE];
+
+    Video::Image format;        // Dimensions et format des images de la source ouverte
+};
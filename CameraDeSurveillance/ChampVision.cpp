@@ -0,0 +1,150 @@
+﻿//*********************************************************************************************
+//* Programme : ChampVision.cpp                                                Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Convertir un clic ou un rectangle tracé dans l'aperçu vidéo en visée absolue
+//*       (AbsolutePosition et CAM_Zoom Direct) à partir du champ de vision de l'objectif.
+//* Programmes associés : ControleCamera.cpp, ApercuVideo.cpp
+//*********************************************************************************************
+
+#include "ChampVision.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    constexpr double PI = 3.14159265358979323846;
+
+    // Position du zoom pour chaque grossissement entier de 1x à 18x (courbe type de l'objectif
+    // EVI-D70, à recaler si la caméra installée diffère) ; interpolation sur le logarithme du
+    // grossissement entre deux points
+    constexpr std::uint16_t ZOOM_TABLE[] = {
+        0x0000, 0x16A1, 0x2063, 0x2628, 0x2A1D, 0x2D13, 0x2F6D, 0x3161, 0x330D,
+        0x3486, 0x35D7, 0x3709, 0x3820, 0x3920, 0x3A0A, 0x3ADD, 0x3B9C, 0x4000 };
+    constexpr int TABLE_SIZE = static_cast<int>(sizeof(ZOOM_TABLE) / sizeof(ZOOM_TABLE[0]));
+    static_assert(TABLE_SIZE == static_cast<int>(ChampVision::MAX_MAGNIFICATION), "Un point par grossissement entier");
+
+    double radians(double degrees)
+    {
+        return degrees * PI / 180.0;
+    }
+
+    double degrees(double radians)
+    {
+        return radians * 180.0 / PI;
+    }
+
+    // Demi-champ horizontal exprimé en tangente : inversement proportionnel au grossissement
+    double halfTangent(std::uint16_t zoom)
+    {
+        return std::tan(radians(ChampVision::WIDE_FOV / 2.0)) / ChampVision::magnification(zoom);
+    }
+
+    ChampVision::Pose clamped(double pan, double tilt, double zoom)
+    {
+        ChampVision::Pose pose;
+        pose.pan = static_cast<std::int16_t>(std::clamp(std::lround(pan), long(ChampVision::PAN_MIN), long(ChampVision::PAN_MAX)));
+        pose.tilt = static_cast<std::int16_t>(std::clamp(std::lround(tilt), long(ChampVision::TILT_MIN), long(ChampVision::TILT_MAX)));
+        pose.zoom = static_cast<std::uint16_t>(std::clamp(std::lround(zoom), 0L, long(ChampVision::ZOOM_MAX)));
+        return pose;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de l'objectif : grossissement d'une position du zoom, position donnant un
+//* grossissement et champ horizontal en degrés
+//---------------------------------------------------------------------------------------------
+double ChampVision::magnification(std::uint16_t zoom)
+{
+    zoom = std::min(zoom, ZOOM_MAX);
+    int index = 0;
+    while (index < TABLE_SIZE - 2 && zoom > ZOOM_TABLE[index + 1])
+    {
+        ++index;
+    }
+    double fraction = static_cast<double>(zoom - ZOOM_TABLE[index]) / (ZOOM_TABLE[index + 1] - ZOOM_TABLE[index]);
+    return std::exp(std::log(index + 1.0) + fraction * (std::log(index + 2.0) - std::log(index + 1.0)));
+}
+
+std::uint16_t ChampVision::zoomFor(double magnification)
+{
+    magnification = std::clamp(magnification, 1.0, MAX_MAGNIFICATION);
+    int index = std::min(static_cast<int>(magnification) - 1, TABLE_SIZE - 2);
+    double fraction = (std::log(magnification) - std::log(index + 1.0)) / (std::log(index + 2.0) - std::log(index + 1.0));
+    return static_cast<std::uint16_t>(std::lround(ZOOM_TABLE[index] + fraction * (ZOOM_TABLE[index + 1] - ZOOM_TABLE[index])));
+}
+
+double ChampVision::horizontalFov(std::uint16_t zoom)
+{
+    return 2.0 * degrees(std::atan(halfTangent(zoom)));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la direction (pan et tilt en unités VISCA) d'un point de l'image : le rayon
+//* du point est tourné du tilt puis du pan de la visée, sans approximation des petits angles
+//* Paramètres :
+//*  - const Pose& pose : la visée courante
+//*  - double x, double y : le point, en fraction de l'image
+//*  - double aspect : le rapport largeur / hauteur de l'image
+//*  - double& pan, double& tilt : reçoivent la direction du point
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ChampVision::direction(const Pose& pose, double x, double y, double aspect, double& pan, double& tilt)
+{
+    double tangent = halfTangent(pose.zoom);
+    double a = (2.0 * x - 1.0) * tangent;
+    double b = (1.0 - 2.0 * y) * tangent / (aspect > 0.0 ? aspect : 16.0 / 9.0);
+
+    double p = radians(pose.pan / UNITS_PER_DEGREE);
+    double t = radians(pose.tilt / UNITS_PER_DEGREE);
+    // Axe optique, droite et haut de l'image dans le repère de la salle
+    double dx = std::cos(t) * std::sin(p) + a * std::cos(p) - b * std::sin(t) * std::sin(p);
+    double dy = std::sin(t) + b * std::cos(t);
+    double dz = std::cos(t) * std::cos(p) - a * std::sin(p) - b * std::sin(t) * std::cos(p);
+
+    pan = degrees(std::atan2(dx, dz)) * UNITS_PER_DEGREE;
+    tilt = degrees(std::atan2(dy, std::hypot(dx, dz))) * UNITS_PER_DEGREE;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la visée qui centre un point de l'image, sans changer le zoom
+//* Paramètres :
+//*  - const Pose& pose : la visée courante
+//*  - double x, double y : le point cliqué, en fraction de l'image
+//*  - double aspect : le rapport largeur / hauteur de l'image
+//*
+//* Valeur de retour : Pose, la visée à envoyer (bornée aux butées)
+//---------------------------------------------------------------------------------------------
+ChampVision::Pose ChampVision::centerOn(const Pose& pose, double x, double y, double aspect)
+{
+    double pan;
+    double tilt;
+    direction(pose, x, y, aspect, pan, tilt);
+    return clamped(pan, tilt, pose.zoom);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la visée qui cadre un rectangle de l'image : son centre devient le centre
+//* de l'image et sa plus grande dimension (relative à l'image) la remplit. Dans le modèle du
+//* sténopé, le champ en tangente est inversement proportionnel au grossissement.
+//* Paramètres :
+//*  - const Pose& pose : la visée courante
+//*  - double left, double top, double width, double height : le rectangle, en fraction de l'image
+//*  - double aspect : le rapport largeur / hauteur de l'image
+//*
+//* Valeur de retour : Pose, la visée à envoyer (bornée aux butées et au zoom optique)
+//---------------------------------------------------------------------------------------------
+ChampVision::Pose ChampVision::frame(const Pose& pose, double left, double top, double width, double height, double aspect)
+{
+    double pan;
+    double tilt;
+    direction(pose, left + width / 2.0, top + height / 2.0, aspect, pan, tilt);
+    double extent = std::max(std::abs(width), std::abs(height));
+    double target = extent > 0.0 ? magnification(pose.zoom) / extent : MAX_MAGNIFICATION;
+    return clamped(pan, tilt, zoomFor(target));
+}
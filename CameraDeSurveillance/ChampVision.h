@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Modèle optique d'une caméra EVI-D70 : grossissement de l'objectif (18x) pour chaque position
+//* du zoom, champ horizontal qui en découle et correspondance entre un point de l'image et une
+//* direction pan/tilt (sténopé, pixels carrés). Il donne la visée absolue qui centre un point
+//* cliqué dans l'aperçu, ou qui cadre un rectangle tracé dans l'aperçu, en un seul mouvement.
+//---------------------------------------------------------------------------------------------
+class ChampVision
+{
+public:
+    static constexpr double UNITS_PER_DEGREE = 14.4;    // Unités VISCA de pan et de tilt
+    static constexpr int PAN_MIN = -2448;               // -170° à +170°
+    static constexpr int PAN_MAX = 2448;
+    static constexpr int TILT_MIN = -432;               // -30° à +90°
+    static constexpr int TILT_MAX = 1296;
+    static constexpr std::uint16_t ZOOM_MAX = 0x4000;   // Zoom optique maximal
+    static constexpr double WIDE_FOV = 48.0;            // Champ horizontal en grand angle (degrés)
+    static constexpr double MAX_MAGNIFICATION = 18.0;
+
+    // Visée absolue d'une caméra, en unités VISCA
+    struct Pose
+    {
+        std::int16_t pan = 0;
+        std::int16_t tilt = 0;
+        std::uint16_t zoom = 0;
+    };
+
+    static double magnification(std::uint16_t zoom);
+    static std::uint16_t zoomFor(double magnification);
+    static double horizontalFov(std::uint16_t zoom);
+
+    // x et y en fraction de l'image (0,0 en haut à gauche), aspect = largeur / hauteur
+    static void direction(const Pose& pose, double x, double y, double aspect, double& pan, double& tilt);
+    static Pose centerOn(const Pose& pose, double x, double y, double aspect);
+    static Pose frame(const Pose& pose, double left, double top, double width, double height, double aspect);
+};
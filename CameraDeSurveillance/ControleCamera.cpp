@@ -1,21 +1,110 @@
-//*********************************************************************************************
+﻿//*********************************************************************************************
 //* Programme : ControleCamera.cpp                                              Date : 15/11/2024
 //*--------------------------------------------------------------------------------------------
-//* Dernire mise  jour : 15/11/2024
+//* Dernière mise à jour : 15/11/2024
 //*
-//* Programmeurs : Lemaire Kvin                                               Classe : BTSCIEL2
-//*                Tellier No
+//* Programmeurs : Lemaire Kévin                                               Classe : BTSCIEL2
+//*                Tellier Néo
 //*--------------------------------------------------------------------------------------------
-//* But : Grer les commandes de la camra de surveillance via un port srie, y compris 
+//* But : Gérer les commandes de la caméra de surveillance via un port série, y compris 
 //*       l'ouverture du port, l'envoi des commandes, et le traitement des confirmations.
-//* Programmes associs : CameraDeSurveillance.cpp
+//* Programmes associés : CameraDeSurveillance.cpp
 //*********************************************************************************************
 
 #include "ControleCamera.h"
+#include "Metriques.h"
 #include <QThread>
 #include <QDebug>
 
-ControleCamera::ControleCamera() {}
+ControleCamera::ControleCamera(QObject* parent)
+    : QObject(parent),
+      transactions([this](const char* data, qint64 size) { return writeToPort(data, size); }, this),
+      ordonnanceur(transactions, this),
+      etat(ordonnanceur, this),
+      tournees([this](const Visca::Command& command, quint32 id) {
+          return sendCommand(command, CommandClass::None, id, CommandPriority::Background);
+      }, this),
+      pilote([this](const Visca::Command& command) { return sendCommand(command, CommandClass::PanTiltDrive); }, this),
+      negociation([this](const char* data, qint64 size) { return transmit(data, size); }, this),
+      statistiques(this),
+      surveillance([this](const Visca::Command& command) {
+          return sendCommand(command, CommandClass::None, 0, CommandPriority::Background);
+      }, this)
+{
+    // transactions et ordonnanceur sont enfants de ControleCamera : moveToThread() les déplace avec lui
+    qRegisterMetaType<Visca::Reply>();
+
+    // Les résultats des transactions sont relayés tels quels à l'interface
+    connect(&transactions, &TransactionsVisca::commandAcknowledged, this, &ControleCamera::commandAcknowledged);
+    connect(&transactions, &TransactionsVisca::commandCompleted, this, &ControleCamera::commandCompleted);
+    connect(&transactions, &TransactionsVisca::commandFailed, this, &ControleCamera::commandFailed);
+    connect(&transactions, &TransactionsVisca::inquiryCompleted, this, &ControleCamera::inquiryCompleted);
+    connect(&ordonnanceur, &OrdonnanceurCommandes::commandCoalesced, this, &ControleCamera::commandCoalesced);
+    connect(&transactions, &TransactionsVisca::inquiryCompleted, this, &ControleCamera::onInquiryCompleted);
+
+    // Le cache de position se nourrit des réponses aux interrogations qu'il a lancées
+    connect(&transactions, &TransactionsVisca::inquiryCompleted, &etat, &EtatCameras::onInquiryCompleted);
+    connect(&transactions, &TransactionsVisca::commandFailed, &etat, &EtatCameras::onCommandFailed);
+    connect(&etat, &EtatCameras::stateChanged, this, &ControleCamera::stateChanged);
+
+    // Télémétrie vers l'interface : un instantané copié dans l'anneau, ni allocation ni évènement
+    connect(&etat, &EtatCameras::stateChanged, this, [this](quint8 address, const CameraState& state) {
+        publishTelemetry(address, &state);
+    });
+    connect(&transactions, &TransactionsVisca::commandCompleted, this, [this]() {
+        ++completedCount;
+        publishTelemetry(0, nullptr);
+    });
+    connect(&transactions, &TransactionsVisca::commandFailed, this, [this]() {
+        ++failedCount;
+        publishTelemetry(0, nullptr);
+    });
+
+    // Les tournées avancent au rythme des Completion renvoyées par les caméras
+    connect(&transactions, &TransactionsVisca::commandCompleted, &tournees, &MoteurTournees::onCommandCompleted);
+    connect(&transactions, &TransactionsVisca::commandFailed, &tournees, &MoteurTournees::onCommandFailed);
+
+    // Une commande abandonnée en file au profit d'un arrêt échoue comme une commande annulée
+    connect(&ordonnanceur, &OrdonnanceurCommandes::commandDropped, this, &ControleCamera::commandFailed);
+    connect(&ordonnanceur, &OrdonnanceurCommandes::commandDropped, &tournees, &MoteurTournees::onCommandFailed);
+    connect(&ordonnanceur, &OrdonnanceurCommandes::commandDropped, &etat, &EtatCameras::onCommandFailed);
+    connect(&tournees, &MoteurTournees::stepReached, this, &ControleCamera::tourStepReached);
+    connect(&tournees, &MoteurTournees::tourFinished, this, &ControleCamera::tourFinished);
+
+    // Une entrée de vitesse qui se tait arrête la caméra
+    connect(&pilote, &PiloteVitesse::inputTimedOut, this, &ControleCamera::velocityTimedOut);
+
+    // Le port n'est annoncé ouvert qu'une fois son débit choisi
+    connect(&negociation, &NegociationDebit::finished, this, &ControleCamera::onBaudRateNegotiated);
+
+    // Temps d'aller-retour comptés depuis l'écriture de chaque paquet
+    connect(&transactions, &TransactionsVisca::commandSent, &statistiques, &StatistiquesLiaison::onCommandSent);
+    connect(&transactions, &TransactionsVisca::commandAcknowledged, &statistiques, &StatistiquesLiaison::onFirstReply);
+    connect(&transactions, &TransactionsVisca::commandCompleted, &statistiques, &StatistiquesLiaison::onCommandCompleted);
+    connect(&transactions, &TransactionsVisca::commandFailed, &statistiques, &StatistiquesLiaison::onCommandFailed);
+    connect(&transactions, &TransactionsVisca::commandRetried, &statistiques, &StatistiquesLiaison::onCommandRetried);
+    connect(&transactions, &TransactionsVisca::commandTimedOut, &statistiques, &StatistiquesLiaison::onCommandTimedOut);
+    connect(&transactions, &TransactionsVisca::recoveryStarted, &statistiques, &StatistiquesLiaison::onRecoveryStarted);
+    connect(&transactions, &TransactionsVisca::inquiryCompleted, &statistiques, [this](quint32 id) {
+        statistiques.onFirstReply(id);
+        statistiques.onCommandCompleted(id);
+    });
+
+    // Chien de garde : la fermeture du port attend la fin du signal d'erreur qui l'a déclenchée
+    connect(&surveillance, &SurveillanceLiaison::linkLost, this, &ControleCamera::linkLost);
+    connect(&surveillance, &SurveillanceLiaison::linkLost, this, &ControleCamera::onLinkLost, Qt::QueuedConnection);
+    connect(&surveillance, &SurveillanceLiaison::reconnectRequested, this, &ControleCamera::onReconnectRequested);
+    connect(&surveillance, &SurveillanceLiaison::reconnected, this, &ControleCamera::linkRestored);
+    connect(&surveillance, &SurveillanceLiaison::availablePortsChanged, this, &ControleCamera::availablePortsChanged);
+
+    // Les positions sont rétablies une fois les tampons des caméras vidés par IF_Clear
+    connect(&transactions, &TransactionsVisca::commandCompleted, this, [this](quint32 id) {
+        if (id != 0 && id == restoreAfter)
+        {
+            restorePositions();
+        }
+    });
+}
 
 ControleCamera::~ControleCamera()
 {
@@ -27,223 +116,866 @@ ControleCamera::~ControleCamera()
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant d'ouvrir le port srie pour communiquer avec la camra
-//* Paramtres :
-//*  - QSerialPort* newPort : le port srie  ouvrir pour la communication avec la camra
+//* Fonction permettant d'ouvrir le port série pour communiquer avec la caméra
+//* Le port est créé ici, dans le thread de la caméra : l'interface ne le manipule jamais.
+//* Paramètres :
+//*  - const QString& portName : le nom du port série à ouvrir pour la communication avec la caméra
 //*
-//* Valeur de retour : bool, vrai si le port est ouvert avec succs, sinon faux.
+//* Valeur de retour : bool, vrai si le port est ouvert avec succès, sinon faux.
 //---------------------------------------------------------------------------------------------
-bool ControleCamera::openPort(QSerialPort* newPort)
+bool ControleCamera::openPort(const QString& portName)
 {
-    if (newPort)
+    // Un port choisi par l'utilisateur remplace la surveillance de l'ancien
+    surveillance.stop();
+    restorePending = false;
+    restoreAfter = 0;
+    return open(portName);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ouvrant un port, à la demande de l'utilisateur ou du chien de garde (reconnexion)
+//* Paramètres :
+//*  - const QString& portName : le nom ou le chemin du port série
+//*
+//* Valeur de retour : bool, vrai si le port est ouvert avec succès, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::open(const QString& portName)
+{
+    closePort();
+
+    // Créer le nouveau port, enfant de ControleCamera pour rester dans son thread
+    port = new QSerialPort(portName, this);
+    openedPortName = portName;
+
+    // Configuration du port série
+    port->setBaudRate(QSerialPort::Baud9600);
+    port->setDataBits(QSerialPort::Data8);
+    port->setParity(QSerialPort::NoParity);
+    port->setStopBits(QSerialPort::OneStop);
+    port->setFlowControl(QSerialPort::NoFlowControl);
+
+    // Essayer d'ouvrir le port
+    if (port->open(QIODevice::ReadWrite))
     {
-        // Fermer et supprimer le port existant si ncessaire
-        if (port && port->isOpen())
+        connect(port, &QSerialPort::readyRead, this, &ControleCamera::onSerialPortReadyRead);
+        connect(port, &QSerialPort::errorOccurred, &surveillance, &SurveillanceLiaison::onPortError);
+
+        // Trace permanente du trafic série, désactivée par CAMERA_TRACE=0
+        if (qEnvironmentVariable("CAMERA_TRACE") != "0")
         {
-            port->close();
+            enregistreur.open(EnregistreurTrafic::defaultPath(portName));
         }
 
-        // Affecter le nouveau port
-        port = newPort;
+        // Le débit mémorisé pour ce port est essayé en premier ; portOpened() suit la négociation
+        isportOpen = false;
+        negociation.start(port, NegociationDebit::savedRate(portName));
+        return true;
+    }
 
-        // Configuration du port srie
-        port->setBaudRate(QSerialPort::Baud9600);
-        port->setDataBits(QSerialPort::Data8);
-        port->setParity(QSerialPort::NoParity);
-        port->setStopBits(QSerialPort::OneStop);
-        port->setFlowControl(QSerialPort::NoFlowControl);
+    isportOpen = false;
+    enregistreur.close();
+    etat.track(0);
 
-        // Essayer d'ouvrir le port
-        if (port->open(QIODevice::ReadWrite))
-        {
-            isportOpen = true;
-            return true;
-        }
-        else
-        {
-            isportOpen = false;
-            return false;
-        }
+    // Pendant une reconnexion, l'échec est silencieux : l'adaptateur sera cherché de nouveau
+    if (surveillance.isReconnecting())
+    {
+        surveillance.reconnectFailed();
+        return false;
     }
+    emit portOpened(false, port->errorString());
     return false;
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant d'initialiser la camra en envoyant une commande spcifique
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction fermant le port courant ; les transactions en cours ne recevront plus de réponse
+//* Paramètres :
+//*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void ControleCamera::camInitialisation()
+void ControleCamera::closePort()
 {
-    if (checkPort())
+    if (port)
     {
-        writeToPort("81 01 06 04 FF");
+        disconnect(port, nullptr, this, nullptr);
+        disconnect(port, nullptr, &surveillance, nullptr);
+        if (port->isOpen())
+        {
+            port->close();
+        }
+        delete port;
+        port = nullptr;
     }
+    isportOpen = false;
+
+    tournees.stopAll();
+    pilote.reset();
+    negociation.cancel();
+    statistiques.reset();
+    completedCount = 0;
+    failedCount = 0;
+    ordonnanceur.clear();
+    transactions.reset();
+    analyseur.reset();
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant d'allumer la camra en envoyant une commande spcifique pour l'alimentation
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction appelée quand le chien de garde déclare la liaison perdue : les positions connues
+//* sont gardées et le port est fermé jusqu'au retour de l'adaptateur
+//* Paramètres :
+//*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void ControleCamera::powerON()
+void ControleCamera::onLinkLost()
 {
-    if (checkPort())
+    // Un autre port a pu être ouvert par l'utilisateur entre la détection et cet appel
+    if (!surveillance.isReconnecting())
+    {
+        return;
+    }
+
+    for (quint8 address = 1; address < 8; ++address)
     {
-        writeToPort("81 01 04 00 02 FF");
+        restoreStates[address] = etat.state(address);
     }
+    restorePending = true;
+    restoreAfter = 0;
+
+    closePort();
+    enregistreur.close();
+    etat.track(0);
+}
+
+void ControleCamera::onReconnectRequested(const QString& portName)
+{
+    open(portName);
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant de dplacer la camra vers le haut
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction appelée à la fin de la négociation du débit : le port devient utilisable
+//* Paramètres :
+//*  - qint32 baudRate : le débit retenu
+//*  - bool confirmed : vrai si la caméra a répondu à ce débit, faux pour le débit par défaut
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
-void ControleCamera::MoveUp()
+void ControleCamera::onBaudRateNegotiated(qint32 baudRate, bool confirmed)
 {
-    writeToPort("81 01 06 01 18 14 03 01 FF");
+    qDebug() << "Débit du port :" << baudRate << "bauds" << (confirmed ? "" : "(aucune réponse, débit par défaut)");
+    analyseur.reset();
+    pilote.setBaudRate(baudRate);
+    statistiques.setBaudRate(baudRate, confirmed);
+
+    isportOpen = true;
+    etat.track(1);  // Caméra 1 par défaut, la numérotation de la chaîne peut en ajouter
+
+    // Reprise après une perte : la chaîne est renumérotée puis les positions sont rétablies
+    if (surveillance.isReconnecting())
+    {
+        surveillance.reconnectFinished(openedPortName);
+        enumerateChain();
+        return;
+    }
+
+    surveillance.watch(openedPortName);
+    emit portOpened(true, QString());
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant de dplacer la camra vers le bas
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction permettant d'initialiser la caméra en envoyant une commande spécifique
+//* Paramètres :
+//*  Aucun paramètre
 //*
-//* Valeur de retour : aucun
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
 //---------------------------------------------------------------------------------------------
-void ControleCamera::MoveDown()
+quint32 ControleCamera::camInitialisation()
 {
-    writeToPort("81 01 06 01 18 14 03 02 FF");
+    return sendCommand(Visca::home());
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant de dplacer la camra vers la gauche
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction permettant d'allumer la caméra en envoyant une commande spécifique pour l'alimentation
+//* Paramètres :
+//*  Aucun paramètre
 //*
-//* Valeur de retour : aucun
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
 //---------------------------------------------------------------------------------------------
-void ControleCamera::MoveLeft()
+quint32 ControleCamera::powerON()
 {
-    writeToPort("81 01 06 01 18 14 01 03 FF");
+    return sendCommand(Visca::powerOn());
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant de dplacer la camra vers la droite
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction permettant de déplacer la caméra vers le haut
+//* Paramètres :
+//*  Aucun paramètre
 //*
-//* Valeur de retour : aucun
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::MoveUp()
+{
+    return sendCommand(Visca::panTiltDrive(1, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+        Visca::PanDirection::Stop, Visca::TiltDirection::Up), CommandClass::PanTiltDrive);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de déplacer la caméra vers le bas
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::MoveDown()
+{
+    return sendCommand(Visca::panTiltDrive(1, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+        Visca::PanDirection::Stop, Visca::TiltDirection::Down), CommandClass::PanTiltDrive);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de déplacer la caméra vers la gauche
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
 //---------------------------------------------------------------------------------------------
-void ControleCamera::MoveRight()
+quint32 ControleCamera::MoveLeft()
 {
-    writeToPort("81 01 06 01 18 14 02 03 FF");
+    return sendCommand(Visca::panTiltDrive(1, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+        Visca::PanDirection::Left, Visca::TiltDirection::Stop), CommandClass::PanTiltDrive);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de déplacer la caméra vers la droite
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::MoveRight()
+{
+    return sendCommand(Visca::panTiltDrive(1, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+        Visca::PanDirection::Right, Visca::TiltDirection::Stop), CommandClass::PanTiltDrive);
 }
 
 //---------------------------------------------------------------------------------------------
 //* Fonction permettant d'activer un mode automatique qui balaye la salle trois fois de suite
-//* Paramtres :
-//*  Aucun paramtre
+//* C'est la tournée « balayage » : chaque extrémité est atteinte (Completion) avant de
+//* repartir dans l'autre sens, puis la caméra revient au centre.
+//* Paramètres :
+//*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
 void ControleCamera::autoMode()
 {
-    writeToPort("81 01 06 03 18 14 09 09 09 09 00 00 00 00 FF");
-    writeToPort("81 01 06 03 18 14 05 05 05 05 00 00 00 00 FF");
+    startTour("balayage", 1);
 }
 
-//* Fonction permettant d'ajuster le zoom de la camra en fonction de la valeur du curseur
-//* Paramtres :
-//*  - int zoomValue : la valeur du zoom de 0 (large)  1023 (rapproch)
+//* Fonction permettant d'ajuster le zoom de la caméra en fonction de la valeur du curseur
+//* Paramètres :
+//*  - int zoomValue : la valeur du zoom de 0 (large) à 16384 (rapproché, 0x4000)
 //* 
-//* Valeur de retour : aucun
-void ControleCamera::adjustZoom(int zoomValue)
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+quint32 ControleCamera::adjustZoom(int zoomValue)
+{
+    // La valeur du zoom varie entre 0 (large) et 0x4000 (rapproché), comme la réponse à CAM_ZoomPosInq
+    // Elle est découpée en quatre quartets 0p 0q 0r 0s par l'encodeur VISCA.
+    // Une valeur encore en attente est remplacée : seule la dernière position du curseur est envoyée.
+    // Hors de la plage optique, la position est ramenée à la borne la plus proche.
+    zoomValue = qBound(0, zoomValue, static_cast<int>(ChampVision::ZOOM_MAX));
+    return sendCommand(Visca::zoomDirect(1, static_cast<std::uint16_t>(zoomValue)), CommandClass::ZoomAbsolute);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'ajuster la mise au point de la caméra
+//* Paramètres :
+//*  - int focusValue : la position de mise au point (CAM_Focus Direct)
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::adjustFocus(int focusValue)
+{
+    return sendCommand(Visca::focusDirect(1, static_cast<std::uint16_t>(focusValue)), CommandClass::Focus);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction amenant une caméra sur une visée absolue en un seul mouvement : AbsolutePosition et
+//* CAM_Zoom Direct partent l'un derrière l'autre et s'exécutent en même temps dans deux sockets.
+//* Une visée encore en attente (clics rapprochés) est remplacée par la nouvelle.
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra
+//*  - qint16 pan, qint16 tilt : la direction visée (unités VISCA)
+//*  - quint16 zoom : la position du zoom (0 à 0x4000)
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction du pan/tilt (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::moveTo(quint8 address, qint16 pan, qint16 tilt, quint16 zoom)
 {
-    if (checkPort())
+    quint32 id = sendCommand(Visca::absolutePosition(address, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+        static_cast<std::uint16_t>(pan), static_cast<std::uint16_t>(tilt)), CommandClass::PanTiltDrive);
+    if (id != 0)
     {
-        // La valeur du zoom varie entre 0 (large) et 1023 (rapproch)
-        // Conversion de zoomValue en hexadcimal pour envoyer la commande correspondante.
-        QString zoomCommand = QString("81 01 04 47 0%1 0%2 0%3 0%4 FF")
-            .arg(zoomValue & 0xFF, 2, 16, QLatin1Char('0'))  // Premier octet
-            .arg((zoomValue >> 8) & 0xFF, 2, 16, QLatin1Char('0'))  // Deuxime octet
-            .arg("00")  // Valeur fixe
-            .arg("00");  // Valeur fixe
-        writeToPort(zoomCommand);  // Envoi de la commande  la camra
+        sendCommand(Visca::zoomDirect(address, qMin<quint16>(zoom, ChampVision::ZOOM_MAX)), CommandClass::ZoomAbsolute);
     }
+    return id;
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant de vrifier si le port srie est ouvert pour la communication
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonctions pilotant la caméra depuis l'aperçu vidéo, à partir de sa dernière position connue :
+//* centrer le point cliqué, ou centrer et remplir l'image avec le rectangle tracé
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra
+//*  - const QPointF& point / const QRectF& area : en fraction de l'image (0,0 en haut à gauche)
+//*  - double aspect : le rapport largeur / hauteur de l'image
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si la position est inconnue)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::centerOn(quint8 address, const QPointF& point, double aspect)
+{
+    CameraState state = etat.state(address);
+    if (!state.valid)
+    {
+        return 0;
+    }
+    ChampVision::Pose pose{ state.pan, state.tilt, state.zoom };
+    ChampVision::Pose target = ChampVision::centerOn(pose, point.x(), point.y(), aspect);
+    return moveTo(address, target.pan, target.tilt, target.zoom);
+}
+
+quint32 ControleCamera::zoomToArea(quint8 address, const QRectF& area, double aspect)
+{
+    CameraState state = etat.state(address);
+    if (!state.valid)
+    {
+        return 0;
+    }
+    ChampVision::Pose pose{ state.pan, state.tilt, state.zoom };
+    ChampVision::Pose target = ChampVision::frame(pose, area.left(), area.top(), area.width(), area.height(), aspect);
+    return moveTo(address, target.pan, target.tilt, target.zoom);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'arrêter immédiatement une caméra : la tournée et la conduite en vitesse
+//* sont interrompues, les mouvements en attente abandonnés et ceux en cours annulés (Cancel)
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra
+//*
+//* Valeur de retour : quint32, l'identifiant de l'arrêt Pan-tiltDrive (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::emergencyStop(quint8 address)
+{
+    tournees.stop(address);
+    pilote.setVelocity(address, 0.0, 0.0);
+
+    quint32 id = sendCommand(Visca::panTiltStop(address), CommandClass::PanTiltDrive, 0, CommandPriority::Emergency);
+    sendCommand(Visca::zoomStop(address), CommandClass::None, 0, CommandPriority::Emergency);
+    return id;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de vérifier si le port série est ouvert pour la communication
+//* Paramètres :
+//*  Aucun paramètre
 //*
 //* Valeur de retour : bool, vrai si le port est ouvert, sinon faux.
 //---------------------------------------------------------------------------------------------
 bool ControleCamera::checkPort()
 {
+    if (negociation.isRunning())
+    {
+        qDebug() << "Erreur: négociation du débit en cours.";
+        return false;
+    }
+
     if (port && port->isOpen())
     {
         return true;
     }
 
-    qDebug() << "Erreur: Port srie non ouvert.";
+    if (surveillance.isReconnecting())
+    {
+        qDebug() << "Erreur: liaison perdue, reconnexion en cours.";
+        return false;
+    }
+
+    qDebug() << "Erreur: Port série non ouvert.";
     return false;
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction permettant d'crire une commande sur le port srie pour la camra
-//* Paramtres :
-//*  - QString command : la commande  envoyer  la camra sous forme de chane hexadcimale
+//* Fonction permettant de numéroter les caméras de la chaîne (AddressSet en diffusion)
+//* Le nombre de caméras trouvées est annoncé par le signal chainEnumerated().
+//* Paramètres :
+//*  Aucun paramètre
 //*
-//* Valeur de retour : bool, vrai si la commande a t envoye avec succs, sinon faux.
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
 //---------------------------------------------------------------------------------------------
-bool ControleCamera::writeToPort(const QString& command)
+quint32 ControleCamera::enumerateChain()
 {
-    if (!checkPort())
+    return sendCommand(Visca::addressSet());
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions permettant d'enregistrer ou de rappeler une mémoire de la caméra (CAM_Memory)
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra
+//*  - int memory : le numéro de la mémoire (0 à 15)
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 en cas d'erreur)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::storeMemory(quint8 address, int memory)
+{
+    if (memory < 0 || memory >= Visca::MEMORY_COUNT)
+    {
+        return 0;
+    }
+    return sendCommand(Visca::memorySet(address, static_cast<std::uint8_t>(memory)));
+}
+
+quint32 ControleCamera::recallMemory(quint8 address, int memory)
+{
+    if (memory < 0 || memory >= Visca::MEMORY_COUNT)
+    {
+        return 0;
+    }
+    return sendCommand(Visca::memoryRecall(address, static_cast<std::uint8_t>(memory)));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'enregistrer la position actuelle d'une caméra sous un nom
+//* Sans mémoire, la position vient du cache (pan/tilt/zoom absolus gardés par l'application) ;
+//* avec une mémoire, la caméra l'enregistre elle-même (CAM_Memory Set).
+//* Paramètres :
+//*  - const QString& name : le nom de la position
+//*  - quint8 address : l'adresse de la caméra
+//*  - int memory : la mémoire de la caméra à utiliser (0 à 15), ou -1
+//*
+//* Valeur de retour : bool, vrai si la position est enregistrée, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::capturePreset(const QString& name, quint8 address, int memory)
+{
+    Preset preset;
+    preset.name = name;
+
+    if (memory >= 0)
+    {
+        if (storeMemory(address, memory) == 0)
+        {
+            return false;
+        }
+        preset.memory = memory;
+    }
+    else
+    {
+        CameraState state = etat.state(address);
+        if (!state.valid)
+        {
+            return false;
+        }
+        preset.pan = state.pan;
+        preset.tilt = state.tilt;
+        preset.zoom = state.zoom;
+    }
+
+    presets.setPreset(preset);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'amener une caméra sur une position enregistrée
+//* Paramètres :
+//*  - const QString& name : le nom de la position
+//*  - quint8 address : l'adresse de la caméra
+//*
+//* Valeur de retour : bool, vrai si les commandes sont parties, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::gotoPreset(const QString& name, quint8 address)
+{
+    const Preset* preset = presets.preset(name);
+    if (!preset)
     {
         return false;
     }
 
-    QByteArray data = QByteArray::fromHex(command.toLatin1());
-    qint64 bytesWritten = port->write(data);
+    for (const Visca::Command& command : BibliothequePresets::commandsFor(*preset, address))
+    {
+        if (sendCommand(command) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions permettant de charger ou d'enregistrer les positions et les tournées (JSON)
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier
+//*
+//* Valeur de retour : bool, vrai en cas de succès, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::loadPresets(const QString& path)
+{
+    QString errorString;
+    if (!presets.load(path, &errorString))
+    {
+        qDebug() << "Erreur de lecture des tournées" << path << ":" << errorString;
+        return false;
+    }
+    return true;
+}
+
+bool ControleCamera::savePresets(const QString& path)
+{
+    QString errorString;
+    if (!presets.save(path, &errorString))
+    {
+        qDebug() << "Erreur d'écriture des tournées" << path << ":" << errorString;
+        return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions permettant de lancer ou d'arrêter une tournée sur une caméra
+//* Paramètres :
+//*  - const QString& name : le nom de la tournée
+//*  - quint8 address : l'adresse de la caméra
+//*
+//* Valeur de retour : bool, vrai si la tournée a démarré, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::startTour(const QString& name, quint8 address)
+{
+    const Tour* tour = presets.tour(name);
+    if (!tour || !checkPort())
+    {
+        return false;
+    }
+    return tournees.start(address, *tour, presets);
+}
+
+void ControleCamera::stopTour(quint8 address)
+{
+    tournees.stop(address);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant une consigne de vitesse (conduite continue) ; elle doit être rafraîchie
+//* tant que l'entrée est maintenue, sinon la caméra s'arrête après PiloteVitesse::INPUT_TIMEOUT_MS
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra
+//*  - double pan : la vitesse horizontale, -1 (gauche) à 1 (droite), 0 à l'arrêt
+//*  - double tilt : la vitesse verticale, -1 (bas) à 1 (haut), 0 à l'arrêt
+//*  - qint64 inputTime : l'instant de la saisie (PiloteVitesse::now()), pour la mesure de délai
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ControleCamera::setVelocity(quint8 address, double pan, double tilt, qint64 inputTime)
+{
+    pilote.setVelocity(address, pan, tilt, inputTime);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de confier une commande à l'ordonnanceur, pour n'importe quelle caméra
+//* de la chaîne (l'adresse est dans l'en-tête de la commande)
+//* Paramètres :
+//*  - const Visca::Command& command : la commande à envoyer
+//*  - CommandClass commandClass : sa classe de regroupement (None pour ne jamais la remplacer)
+//*  - quint32 id : l'identifiant réservé par TransactionsVisca::allocateId(), ou 0
+//*  - CommandPriority priority : sa file (Automatic : arrêt, alimentation, mouvement ou interrogation)
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port n'est pas ouvert)
+//---------------------------------------------------------------------------------------------
+quint32 ControleCamera::sendCommand(const Visca::Command& command, CommandClass commandClass, quint32 id,
+    CommandPriority priority)
+{
+    if (!checkPort())
+    {
+        return 0;
+    }
+    etat.noteCommand(command);
+    return ordonnanceur.schedule(command, commandClass, id, priority);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction confiant plusieurs commandes à l'ordonnanceur d'un coup (part d'une commande de
+//* groupe) : celles qui peuvent partir tout de suite sont écrites en une seule fois
+//* Paramètres :
+//*  - const QList<Visca::Command>& commands : les commandes, une par caméra ou une diffusion
+//*  - CommandClass commandClass : leur classe de regroupement
+//*  - const QList<quint32>& ids : leurs identifiants, réservés par TransactionsVisca::allocateId()
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ControleCamera::sendCommands(const QList<Visca::Command>& commands, CommandClass commandClass, const QList<quint32>& ids)
+{
+    transactions.holdWrites();
+    for (int index = 0; index < commands.size(); ++index)
+    {
+        sendCommand(commands.at(index), commandClass, index < ids.size() ? ids.at(index) : 0);
+    }
+    transactions.releaseWrites();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'écrire une commande sur le port série pour la caméra
+//* Paramètres :
+//*  - const char* data : le paquet VISCA binaire à envoyer (voir Visca.h)
+//*  - qint64 size : le nombre d'octets du paquet, terminateur FF compris
+//*
+//* Valeur de retour : bool, vrai si la commande a été envoyée avec succès, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::writeToPort(const char* data, qint64 size)
+{
+    return checkPort() && transmit(data, size);
+}
+
+bool ControleCamera::transmit(const char* data, qint64 size)
+{
+    // Le paquet est copié directement dans le tampon d'écriture du port, sans conversion texte
+    qint64 bytesWritten = port->write(data, size);
 
     if (bytesWritten == -1)
     {
         qDebug() << "Erreur lors de l'envoi de la commande: " << port->errorString();
+        Metriques::add(Metrique::Counter::WriteErrors);
         return false;
     }
 
-    // Attente de confirmation (port peut tre en mode asynchrone)
-    this->waitingForConfirmation = true;
+    // Le paquet part vers le pilote du port sans attendre le prochain tour de boucle
+    port->flush();
 
+    enregistreur.record(Trace::Direction::Transmit, data, size);
+    statistiques.addSent(size);
+    Metriques::add(Metrique::Counter::BytesSent, static_cast<quint64>(size));
+    pilote.noteTransmitted(data, size);
     return true;
 }
 
 //---------------------------------------------------------------------------------------------
-//* Fonction appele lorsque des donnes sont reues depuis le port srie, permettant de traiter la rponse
-//* Paramtres :
-//*  Aucun paramtre
+//* Fonction permettant de savoir si des commandes sont encore en attente ou en cours d'exécution
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : bool, vrai si au moins une transaction n'est pas terminée, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ControleCamera::isBusy() const
+{
+    return ordonnanceur.pendingCount() > 0 || !transactions.isIdle();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant les compteurs de l'ordonnanceur (commandes reçues, envoyées, remplacées,
+//* abandonnées ou annulées au profit d'un arrêt, délai des arrêts)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : OrdonnanceurCommandes::Counters, les compteurs courants
+//---------------------------------------------------------------------------------------------
+OrdonnanceurCommandes::Counters ControleCamera::schedulerCounters() const
+{
+    return ordonnanceur.counters();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la dernière position connue d'une caméra, sans l'interroger
+//* Elle peut être appelée depuis l'interface : le cache est protégé par un verrou.
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra (1 à 7)
+//*
+//* Valeur de retour : CameraState, l'état en cache
+//---------------------------------------------------------------------------------------------
+CameraState ControleCamera::cameraState(quint8 address) const
+{
+    return etat.state(address);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant les mesures du délai entre une consigne de vitesse et l'écriture de sa
+//* commande sur le port ; elle peut être appelée depuis l'interface
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : PiloteVitesse::Stats, les mesures depuis le démarrage
+//---------------------------------------------------------------------------------------------
+PiloteVitesse::Stats ControleCamera::velocityStats() const
+{
+    return pilote.stats();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant les statistiques de la liaison série (débit, allers-retours, erreurs) ;
+//* elle peut être appelée depuis l'interface
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : StatistiquesLiaison::Snapshot, les statistiques depuis l'ouverture du port
+//---------------------------------------------------------------------------------------------
+StatistiquesLiaison::Snapshot ControleCamera::linkStats() const
+{
+    return statistiques.snapshot();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le canal de télémétrie de la chaîne ; l'interface en est le seul
+//* consommateur et le vide à son rythme (CanalTelemetrie::drain())
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : CanalTelemetrie&, le canal
+//---------------------------------------------------------------------------------------------
+CanalTelemetrie& ControleCamera::telemetry()
+{
+    return telemetrie;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction copiant un instantané dans le canal de télémétrie (thread de la chaîne)
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra, 0 pour les seuls compteurs de la chaîne
+//*  - const CameraState* state : l'état de la caméra, ou nullptr
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ControleCamera::publishTelemetry(quint8 address, const CameraState* state)
+{
+    Telemetrie::Snapshot snapshot = {};
+    snapshot.time = PiloteVitesse::now();
+    snapshot.completed = completedCount;
+    snapshot.failed = failedCount;
+    snapshot.address = address;
+    if (state)
+    {
+        snapshot.pan = state->pan;
+        snapshot.tilt = state->tilt;
+        snapshot.zoom = state->zoom;
+        snapshot.flags = static_cast<std::uint8_t>((state->valid ? Telemetrie::VALID : 0) | (state->moving ? Telemetrie::MOVING : 0));
+    }
+    telemetrie.push(snapshot);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ramenant chaque caméra de la chaîne à sa dernière position connue avant la perte
+//* de la liaison (AbsolutePosition et CAM_Zoom Direct)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ControleCamera::restorePositions()
+{
+    restorePending = false;
+    restoreAfter = 0;
+
+    for (int address = 1; address <= restoreCount && address < 8; ++address)
+    {
+        const CameraState& state = restoreStates[address];
+        if (!state.valid)
+        {
+            continue;
+        }
+
+        std::uint8_t target = static_cast<std::uint8_t>(address);
+        sendCommand(Visca::absolutePosition(target, Visca::PAN_SPEED_MAX, Visca::TILT_SPEED_MAX,
+            static_cast<std::uint16_t>(state.pan), static_cast<std::uint16_t>(state.tilt)));
+        sendCommand(Visca::zoomDirect(target, state.zoom));
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant les mesures du chien de garde (pertes, temps de reconnexion) ; elle peut
+//* être appelée depuis l'interface
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : SurveillanceLiaison::Stats, les mesures depuis le démarrage
+//---------------------------------------------------------------------------------------------
+SurveillanceLiaison::Stats ControleCamera::watchdogStats() const
+{
+    return surveillance.stats();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée lorsque des données sont reçues depuis le port série, permettant de traiter la réponse
+//* Paramètres :
+//*  Aucun paramètre
 //*
 //* Valeur de retour : aucun
 //---------------------------------------------------------------------------------------------
 void ControleCamera::onSerialPortReadyRead()
 {
-    QByteArray receivedData = port->readAll();
+    Visca::Reply reply;
+    quint64 replies = 0;
+    std::uint64_t framingErrors = analyseur.framingErrors();
+
+    // Lecture directe dans le tampon circulaire de l'analyseur : une réponse coupée entre deux
+    // lectures est complétée à la suivante, plusieurs réponses reçues ensemble sont séparées
+    while (port->bytesAvailable() > 0)
+    {
+        std::uint8_t* destination = nullptr;
+        std::size_t span = analyseur.writableSpan(&destination);
+        if (span == 0)
+        {
+            break;
+        }
+
+        qint64 bytesRead = port->read(reinterpret_cast<char*>(destination), static_cast<qint64>(span));
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+        analyseur.commit(static_cast<std::size_t>(bytesRead));
+        surveillance.noteReceived();
+        enregistreur.record(Trace::Direction::Receive, reinterpret_cast<const char*>(destination), bytesRead);
+        statistiques.addReceived(bytesRead);
+        Metriques::add(Metrique::Counter::BytesReceived, static_cast<quint64>(bytesRead));
 
-    // Traitement des donnes reues
-    qDebug() << "Donnes reues: " << receivedData;
+        // Pendant la négociation du débit, les réponses ne concernent que la sonde
+        while (analyseur.next(reply))
+        {
+            ++replies;
+            if (negociation.isRunning())
+            {
+                negociation.handleReply(reply);
+            }
+            else
+            {
+                transactions.handleReply(reply);
+            }
+        }
+    }
+    statistiques.setFramingErrors(analyseur.framingErrors());
+    Metriques::add(Metrique::Counter::Replies, replies);
+    Metriques::add(Metrique::Counter::FramingErrors, analyseur.framingErrors() - framingErrors);
+}
 
-    // Si la confirmation est reue (par exemple, un 'Q' ou 'R' dans la rponse)
-    if (receivedData.contains('Q') || receivedData.contains('R'))
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à chaque réponse d'interrogation, traite le retour de l'AddressSet
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*  - const Visca::Reply& reply : la réponse décodée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ControleCamera::onInquiryCompleted(quint32 id, const Visca::Reply& reply)
+{
+    Q_UNUSED(id);
+
+    if (reply.type == Visca::ReplyType::AddressSet)
     {
-        waitingForConfirmation = false;
-        qDebug() << "Rponse reue, confirmation!";
+        // 88 30 0w FF : w est l'adresse que prendrait une caméra supplémentaire
+        int cameraCount = reply.bytes[2] > 0 ? reply.bytes[2] - 1 : 0;
+        qDebug() << "Chaîne VISCA :" << cameraCount << "caméra(s)";
+
+        // Vider les tampons de commande de toutes les caméras renumérotées
+        quint32 clearId = sendCommand(Visca::ifClear());
+        etat.track(cameraCount);
+        if (restorePending)
+        {
+            restoreAfter = clearId;
+            restoreCount = cameraCount;
+        }
+        emit chainEnumerated(cameraCount);
     }
 }
\ No newline at end of file
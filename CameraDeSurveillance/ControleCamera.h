@@ -1,33 +1,120 @@
 #pragma once
 
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
 #include <QSerialPort>
 #include <QTimer>
+#include "Visca.h"
+#include "TransactionsVisca.h"
+#include "AnalyseurVisca.h"
+#include "OrdonnanceurCommandes.h"
+#include "EtatCameras.h"
+#include "BibliothequePresets.h"
+#include "MoteurTournees.h"
+#include "PiloteVitesse.h"
+#include "NegociationDebit.h"
+#include "StatistiquesLiaison.h"
+#include "EnregistreurTrafic.h"
+#include "CanalTelemetrie.h"
+#include "SurveillanceLiaison.h"
+#include "ChampVision.h"
 
-class ControleCamera
+class ControleCamera : public QObject
 {
+    Q_OBJECT
+
 private:
     QSerialPort* port = nullptr;
     bool isportOpen = false;
+    TransactionsVisca transactions;
+    AnalyseurVisca analyseur;
+    OrdonnanceurCommandes ordonnanceur;
+    EtatCameras etat;
+    BibliothequePresets presets;
+    MoteurTournees tournees;
+    PiloteVitesse pilote;
+    NegociationDebit negociation;
+    StatistiquesLiaison statistiques;
+    EnregistreurTrafic enregistreur;
+    CanalTelemetrie telemetrie;
+    SurveillanceLiaison surveillance;
+    QString openedPortName;
+    CameraState restoreStates[8];   // Positions à rétablir après une reconnexion
+    bool restorePending = false;
+    quint32 restoreAfter = 0;       // IF_Clear de la renumérotation, à attendre avant de rétablir
+    int restoreCount = 0;
+    quint32 completedCount = 0;
+    quint32 failedCount = 0;
 
 public:
-    ControleCamera();
+    ControleCamera(QObject* parent = nullptr);
     ~ControleCamera();
 
+    bool isBusy() const;
+    OrdonnanceurCommandes::Counters schedulerCounters() const;
+    CameraState cameraState(quint8 address = 1) const;
+    PiloteVitesse::Stats velocityStats() const;
+    StatistiquesLiaison::Snapshot linkStats() const;
+    CanalTelemetrie& telemetry();
+    SurveillanceLiaison::Stats watchdogStats() const;
+
 public slots:
-    bool waitingForConfirmation = false;
-
-    bool openPort(QSerialPort* newPort);
-    void camInitialisation();
-    void powerON();
-    void MoveUp();
-    void MoveDown();
-    void MoveLeft();
-    void MoveRight();
+    bool openPort(const QString& portName);
+    quint32 camInitialisation();
+    quint32 powerON();
+    quint32 MoveUp();
+    quint32 MoveDown();
+    quint32 MoveLeft();
+    quint32 MoveRight();
     void autoMode();
-    void adjustZoom(int zoomValue);
+    quint32 adjustZoom(int zoomValue);
+    quint32 adjustFocus(int focusValue);
+    quint32 moveTo(quint8 address, qint16 pan, qint16 tilt, quint16 zoom);
+    quint32 centerOn(quint8 address, const QPointF& point, double aspect);
+    quint32 zoomToArea(quint8 address, const QRectF& area, double aspect);
+    quint32 enumerateChain();
+    quint32 storeMemory(quint8 address, int memory);
+    quint32 recallMemory(quint8 address, int memory);
+    bool capturePreset(const QString& name, quint8 address = 1, int memory = -1);
+    bool gotoPreset(const QString& name, quint8 address = 1);
+    bool loadPresets(const QString& path);
+    bool savePresets(const QString& path);
+    bool startTour(const QString& name, quint8 address = 1);
+    void stopTour(quint8 address = 1);
+    void setVelocity(quint8 address, double pan, double tilt, qint64 inputTime = 0);
+    quint32 emergencyStop(quint8 address = 1);
+    quint32 sendCommand(const Visca::Command& command, CommandClass commandClass = CommandClass::None, quint32 id = 0,
+        CommandPriority priority = CommandPriority::Automatic);
+    void sendCommands(const QList<Visca::Command>& commands, CommandClass commandClass, const QList<quint32>& ids);
+
+signals:
+    void portOpened(bool success, const QString& errorString);
+    void commandAcknowledged(quint32 id, int socket);
+    void commandCompleted(quint32 id);
+    void commandFailed(quint32 id, int errorCode);
+    void commandCoalesced(quint32 supersededId, quint32 replacementId);
+    void chainEnumerated(int cameraCount);
+    void inquiryCompleted(quint32 id, const Visca::Reply& reply);
+    void stateChanged(quint8 address, const CameraState& state);
+    void tourStepReached(quint8 address, const QString& preset);
+    void tourFinished(quint8 address, const QString& tour);
+    void velocityTimedOut(quint8 address);
+    void linkLost(const QString& portName);
+    void linkRestored(const QString& portName, qint64 reconnectMs);
+    void availablePortsChanged(const QStringList& portNames);
 
 private:
+    bool open(const QString& portName);
+    void closePort();
     bool checkPort();
-    bool writeToPort(const QString& command);
+    bool writeToPort(const char* data, qint64 size);
+    bool transmit(const char* data, qint64 size);
+    void onBaudRateNegotiated(qint32 baudRate, bool confirmed);
+    void onLinkLost();
+    void onReconnectRequested(const QString& portName);
+    void restorePositions();
     void onSerialPortReadyRead();
+    void onInquiryCompleted(quint32 id, const Visca::Reply& reply);
+    void publishTelemetry(quint8 address, const CameraState* state);
 };
@@ -0,0 +1,290 @@
+﻿//*********************************************************************************************
+//* Programme : DetectionMouvement.cpp                                         Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Détecter le mouvement dans les zones surveillées d'une caméra : chaque image est
+//*       réduite à sa luminance au quart, comparée au fond et à l'image précédente par les
+//*       noyaux vectoriels, puis les alarmes sont confirmées et levées zone par zone.
+//* Programmes associés : NoyauxMouvement.cpp, CaptureVideo.cpp, CameraDeSurveillance.cpp
+//*********************************************************************************************
+
+#include "DetectionMouvement.h"
+#include "Metriques.h"
+#include "PiloteVitesse.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <algorithm>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe DetectionMouvement ; sans zone configurée, toute l'image est
+//* surveillée
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra filmée
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+DetectionMouvement::DetectionMouvement(quint8 address, QObject* parent)
+    : QObject(parent), cameraAddress(address)
+{
+    Zone whole;
+    whole.name = "image";
+    zoneList.append(whole);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de configuration, appelées depuis n'importe quel thread : le masque des zones
+//* est reconstruit par le thread de capture avant l'image suivante
+//---------------------------------------------------------------------------------------------
+void DetectionMouvement::setZones(const QList<Zone>& zones)
+{
+    QMutexLocker locker(&mutex);
+    zoneList = zones.mid(0, MAX_ZONES);
+    dirty = true;
+}
+
+QList<DetectionMouvement::Zone> DetectionMouvement::zones() const
+{
+    QMutexLocker locker(&mutex);
+    return zoneList;
+}
+
+DetectionMouvement::Zone DetectionMouvement::zone(int index) const
+{
+    QMutexLocker locker(&mutex);
+    return zoneList.value(index);
+}
+
+void DetectionMouvement::setThreshold(std::uint8_t value)
+{
+    QMutexLocker locker(&mutex);
+    threshold = value;
+}
+
+void DetectionMouvement::setIsa(NoyauxMouvement::Isa value)
+{
+    QMutexLocker locker(&mutex);
+    isa = value;
+}
+
+DetectionMouvement::Stats DetectionMouvement::stats() const
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction lisant les zones surveillées dans un fichier JSON :
+//* { "threshold": 24, "zones": [ { "name": "porte", "x": 0.1, "y": 0.2, "width": 0.3,
+//*   "height": 0.5, "trigger": 0.02, "preset": "entree", "record": true } ] }
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier
+//*  - QString* errorString : reçoit la cause de l'échec, si non nul
+//*
+//* Valeur de retour : bool, vrai si le fichier a été lu, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool DetectionMouvement::loadZones(const QString& path, QString* errorString)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        if (errorString)
+        {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject())
+    {
+        if (errorString)
+        {
+            *errorString = parseError.errorString();
+        }
+        return false;
+    }
+
+    QJsonObject root = document.object();
+    QList<Zone> loaded;
+    for (const QJsonValue& value : root.value("zones").toArray())
+    {
+        QJsonObject object = value.toObject();
+        Zone zone;
+        zone.name = object.value("name").toString(QString("zone %1").arg(loaded.size() + 1));
+        zone.area = QRectF(object.value("x").toDouble(), object.value("y").toDouble(),
+            object.value("width").toDouble(1.0), object.value("height").toDouble(1.0)).intersected(QRectF(0.0, 0.0, 1.0, 1.0));
+        zone.trigger = qBound(0.0001, object.value("trigger").toDouble(zone.trigger), 1.0);
+        zone.preset = object.value("preset").toString();
+        zone.record = object.value("record").toBool(zone.record);
+        if (!zone.area.isEmpty())
+        {
+            loaded.append(zone);
+        }
+    }
+    if (loaded.isEmpty())
+    {
+        if (errorString)
+        {
+            *errorString = tr("Aucune zone valide");
+        }
+        return false;
+    }
+
+    setZones(loaded);
+    if (root.contains("threshold"))
+    {
+        setThreshold(static_cast<std::uint8_t>(qBound(1, root.value("threshold").toInt(), 255)));
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction reconstruisant le masque des zones pour une image réduite (appelée sous verrou) :
+//* chaque pixel porte un bit par zone qui le contient, 0 s'il n'est pas surveillé
+//* Paramètres :
+//*  - int reducedWidth, int reducedHeight : les dimensions de l'image réduite
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void DetectionMouvement::rebuild(int reducedWidth, int reducedHeight)
+{
+    width = reducedWidth;
+    height = reducedHeight;
+    std::size_t count = static_cast<std::size_t>(width) * height;
+    reduced.assign(count, 0);
+    previous.assign(count, 0);
+    background.assign(count, 0);
+    mask.assign(count, 0);
+    primed = false;
+
+    zoneCount = static_cast<int>(std::min<qsizetype>(zoneList.size(), MAX_ZONES));
+    for (int index = 0; index < zoneCount; ++index)
+    {
+        const Zone& zone = zoneList.at(index);
+        int left = qBound(0, qRound(zone.area.left() * width), width);
+        int right = qBound(0, qRound(zone.area.right() * width), width);
+        int top = qBound(0, qRound(zone.area.top() * height), height);
+        int bottom = qBound(0, qRound(zone.area.bottom() * height), height);
+        const std::uint8_t bit = static_cast<std::uint8_t>(1u << index);
+        for (int y = top; y < bottom; ++y)
+        {
+            std::uint8_t* row = mask.data() + static_cast<std::size_t>(y) * width;
+            for (int x = left; x < right; ++x)
+            {
+                row[x] |= bit;
+            }
+        }
+
+        ZoneState& state = states[index];
+        state = ZoneState();
+        state.pixels = static_cast<std::uint32_t>(qMax(0, right - left) * qMax(0, bottom - top));
+        state.trigger = zone.trigger;
+        names[index] = zone.name;
+    }
+    dirty = false;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction traitant une image, dans le thread de capture et avant sa publication. Une zone
+//* passe en alarme après CONFIRM_FRAMES images au-dessus de son seuil et en sort après
+//* HOLD_MS sans mouvement.
+//* Paramètres :
+//*  - const Video::Image& image : l'image capturée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void DetectionMouvement::process(const Video::Image& image)
+{
+    qint64 start = PiloteVitesse::now();
+    const int reducedWidth = image.width / NoyauxMouvement::SCALE;
+    const int reducedHeight = image.height / NoyauxMouvement::SCALE;
+    if (!image.data || reducedWidth == 0 || reducedHeight == 0)
+    {
+        return;
+    }
+
+    std::uint8_t frameThreshold;
+    NoyauxMouvement::Isa frameIsa;
+    {
+        QMutexLocker locker(&mutex);
+        if (dirty || reducedWidth != width || reducedHeight != height)
+        {
+            rebuild(reducedWidth, reducedHeight);
+        }
+        frameThreshold = threshold;
+        frameIsa = isa;
+    }
+
+    switch (image.format)
+    {
+    case Video::PixelFormat::Gray8:
+        NoyauxMouvement::downscaleGray(image.data, image.stride, image.width, image.height, reduced.data(), frameIsa);
+        break;
+    case Video::PixelFormat::Yuyv:
+        NoyauxMouvement::downscaleYuyv(image.data, image.stride, image.width, image.height, reduced.data(), frameIsa);
+        break;
+    case Video::PixelFormat::Rgb32:
+        NoyauxMouvement::downscaleRgb32(image.data, image.stride, image.width, image.height, reduced.data());
+        break;
+    }
+
+    // Première image : elle devient le fond
+    if (!primed)
+    {
+        background = reduced;
+        previous.swap(reduced);
+        primed = true;
+        return;
+    }
+
+    std::uint32_t counts[MAX_ZONES] = {};
+    NoyauxMouvement::detect(reduced.data(), previous.data(), background.data(), mask.data(),
+        static_cast<int>(reduced.size()), frameThreshold, LEARN_SHIFT, zoneCount, counts, frameIsa);
+    previous.swap(reduced);
+
+    quint64 events = 0;
+    for (int index = 0; index < zoneCount; ++index)
+    {
+        ZoneState& state = states[index];
+        double fraction = state.pixels ? static_cast<double>(counts[index]) / state.pixels : 0.0;
+        if (fraction >= state.trigger)
+        {
+            state.lastMotion = image.captureTime;
+            if (!state.active && ++state.confirmations >= CONFIRM_FRAMES)
+            {
+                state.active = true;
+                ++events;
+                Metriques::add(Metrique::Counter::MotionEvents);
+                emit motionStarted(cameraAddress, index, names[index], fraction);
+            }
+        }
+        else
+        {
+            state.confirmations = 0;
+            if (state.active && image.captureTime - state.lastMotion > HOLD_MS * 1000000)
+            {
+                state.active = false;
+                emit motionStopped(cameraAddress, index, names[index]);
+            }
+        }
+    }
+
+    qint64 elapsedUs = (PiloteVitesse::now() - start) / 1000;
+    Metriques::observe(Metrique::Histogram::MotionProcessing, elapsedUs);
+    QMutexLocker locker(&mutex);
+    current.frames++;
+    current.events += events;
+    current.lastUs = elapsedUs;
+    current.maxUs = qMax(current.maxUs, elapsedUs);
+    current.totalUs += elapsedUs;
+}
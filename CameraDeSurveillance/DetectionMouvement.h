@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QMutex>
+#include <QRectF>
+#include <QString>
+#include <vector>
+#include "NoyauxMouvement.h"
+#include "PoolImages.h"
+
+// Détection de mouvement sur les images d'une caméra, appelée dans le thread de capture pour
+// chaque image. Un mouvement confirmé dans une zone émet motionStarted ; la zone peut alors
+// rappeler une position de la caméra (voir Zone).
+class DetectionMouvement : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_ZONES = NoyauxMouvement::MAX_ZONES;
+    static constexpr std::uint8_t DEFAULT_THRESHOLD = 24;  // Écart de luminance au fond
+    static constexpr int LEARN_SHIFT = 4;           // Le fond suit l'image à 1/16 par image
+    static constexpr int CONFIRM_FRAMES = 2;        // Images consécutives avant l'alarme
+    static constexpr qint64 HOLD_MS = 2000;         // Calme avant la fin de l'alarme
+
+    struct Zone
+    {
+        QString name;
+        QRectF area{ 0.0, 0.0, 1.0, 1.0 };  // En fraction de l'image
+        double trigger = 0.02;              // Part de la zone en mouvement déclenchant l'alarme
+        QString preset;                     // Position rappelée à l'alarme, vide si aucune
+        bool record = false;                // Enregistre la vidéo à l'alarme
+    };
+
+    struct Stats
+    {
+        quint64 frames = 0;
+        quint64 events = 0;
+        qint64 lastUs = 0;          // Temps de traitement de la dernière image
+        qint64 maxUs = 0;
+        qint64 totalUs = 0;
+    };
+
+    explicit DetectionMouvement(quint8 address = 1, QObject* parent = nullptr);
+
+    void setZones(const QList<Zone>& zones);
+    bool loadZones(const QString& path, QString* errorString = nullptr);
+    QList<Zone> zones() const;
+    Zone zone(int index) const;
+    void setThreshold(std::uint8_t threshold);
+    void setIsa(NoyauxMouvement::Isa isa);
+    quint8 address() const { return cameraAddress; }
+    Stats stats() const;
+
+    void process(const Video::Image& image);
+
+signals:
+    void motionStarted(quint8 address, int zone, const QString& name, double fraction);
+    void motionStopped(quint8 address, int zone, const QString& name);
+
+private:
+    struct ZoneState
+    {
+        std::uint32_t pixels = 0;   // Pixels de la zone dans l'image réduite
+        double trigger = 0.0;
+        int confirmations = 0;
+        bool active = false;
+        qint64 lastMotion = 0;      // ns
+    };
+
+    void rebuild(int width, int height);
+
+    const quint8 cameraAddress;
+    mutable QMutex mutex;       // Zones et réglages, modifiés depuis l'interface
+    QList<Zone> zoneList;
+    bool dirty = true;          // Masque à reconstruire avant la prochaine image
+    std::uint8_t threshold = DEFAULT_THRESHOLD;
+    NoyauxMouvement::Isa isa = NoyauxMouvement::best();
+    Stats current;
+
+    // Utilisés par le seul thread de capture
+    int width = 0;              // Dimensions de l'image réduite
+    int height = 0;
+    bool primed = false;        // Fond et image précédente initialisés
+    std::vector<std::uint8_t> reduced;
+    std::vector<std::uint8_t> previous;
+    std::vector<std::uint8_t> background;
+    std::vector<std::uint8_t> mask;
+    ZoneState states[MAX_ZONES];
+    int zoneCount = 0;
+    QString names[MAX_ZONES];
+};
@@ -0,0 +1,170 @@
+﻿//*********************************************************************************************
+//* Programme : EnregistreurTrafic.cpp                                         Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Garder en permanence une trace horodatée de tous les octets envoyés et reçus sur le
+//*       port série, dans un fichier circulaire projeté en mémoire relu par RejeuTrafic.
+//* Programmes associés : ControleCamera.cpp, FormatTrace.h
+//*********************************************************************************************
+
+#include "EnregistreurTrafic.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+#include <atomic>
+#include <cstring>
+
+EnregistreurTrafic::~EnregistreurTrafic()
+{
+    close();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'ouvrir (ou de créer) le fichier de trace ; un fichier existant de
+//* même capacité est prolongé, la nouvelle session commence par un enregistrement Session
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier .trc
+//*  - std::uint32_t capacity : le nombre d'enregistrements de l'anneau (puissance de deux)
+//*
+//* Valeur de retour : bool, vrai si la trace est active, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool EnregistreurTrafic::open(const QString& path, std::uint32_t capacity)
+{
+    close();
+
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    {
+        return false;
+    }
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite))
+    {
+        qDebug() << "Trace série désactivée :" << file.errorString();
+        return false;
+    }
+
+    // La taille est fixée à la création : aucune écriture ne fait grossir le fichier
+    qint64 size = static_cast<qint64>(Trace::fileSize(capacity));
+    bool reuse = file.size() == size;
+    if (!reuse && !file.resize(size))
+    {
+        qDebug() << "Trace série désactivée :" << file.errorString();
+        file.close();
+        return false;
+    }
+
+    uchar* memory = file.map(0, size);
+    if (!memory)
+    {
+        qDebug() << "Trace série désactivée :" << file.errorString();
+        file.close();
+        return false;
+    }
+
+    header = reinterpret_cast<Trace::FileHeader*>(memory);
+    records = reinterpret_cast<Trace::Record*>(memory + sizeof(Trace::FileHeader));
+    mask = capacity - 1;
+
+    if (!reuse || std::memcmp(header->magic, Trace::MAGIC, sizeof(Trace::MAGIC)) != 0
+        || header->version != Trace::VERSION || header->capacity != capacity)
+    {
+        std::memset(header, 0, sizeof(Trace::FileHeader));
+        std::memcpy(header->magic, Trace::MAGIC, sizeof(Trace::MAGIC));
+        header->version = Trace::VERSION;
+        header->recordSize = sizeof(Trace::Record);
+        header->capacity = capacity;
+        header->written = 0;
+    }
+
+    clock.start();
+    qint64 epoch = QDateTime::currentMSecsSinceEpoch();
+    append(Trace::Direction::Session, reinterpret_cast<const std::uint8_t*>(&epoch), sizeof(epoch), 0);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de fermer la trace (les pages projetées sont écrites par le système)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurTrafic::close()
+{
+    if (header)
+    {
+        file.unmap(reinterpret_cast<uchar*>(header));
+        header = nullptr;
+        records = nullptr;
+    }
+    if (file.isOpen())
+    {
+        file.close();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction enregistrant des octets échangés ; un bloc plus long qu'un enregistrement est
+//* découpé sur plusieurs enregistrements de même horodatage
+//* Paramètres :
+//*  - Trace::Direction direction : émission ou réception
+//*  - const char* data : les octets
+//*  - qint64 size : leur nombre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurTrafic::record(Trace::Direction direction, const char* data, qint64 size)
+{
+    if (!header || size <= 0)
+    {
+        return;
+    }
+
+    std::uint64_t time = static_cast<std::uint64_t>(clock.nsecsElapsed());
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+    std::size_t remaining = static_cast<std::size_t>(size);
+
+    while (remaining > 0)
+    {
+        std::size_t chunk = remaining < Trace::RECORD_DATA ? remaining : Trace::RECORD_DATA;
+        append(direction, bytes, chunk, time);
+        bytes += chunk;
+        remaining -= chunk;
+    }
+}
+
+void EnregistreurTrafic::append(Trace::Direction direction, const std::uint8_t* data, std::size_t size, std::uint64_t time)
+{
+    std::uint64_t index = header->written;
+    Trace::Record& slot = records[index & mask];
+
+    slot.time = time;
+    slot.direction = direction;
+    slot.size = static_cast<std::uint8_t>(size);
+    std::memcpy(slot.data, data, size);
+
+    // Un lecteur du fichier en cours d'écriture ne voit le compteur qu'après l'enregistrement
+    std::atomic_thread_fence(std::memory_order_release);
+    header->written = index + 1;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le fichier de trace d'un port : visca-<port>.trc dans le dossier désigné
+//* par la variable d'environnement CAMERA_TRACE_DIR, ou dans le dossier temporaire
+//* Paramètres :
+//*  - const QString& portName : le nom du port série (COM3, /dev/ttyUSB0...)
+//*
+//* Valeur de retour : QString, le chemin du fichier
+//---------------------------------------------------------------------------------------------
+QString EnregistreurTrafic::defaultPath(const QString& portName)
+{
+    QString directory = qEnvironmentVariableIsSet("CAMERA_TRACE_DIR")
+        ? qEnvironmentVariable("CAMERA_TRACE_DIR") : QDir::tempPath();
+    return QDir(directory).filePath(QString("visca-%1.trc").arg(QFileInfo(portName).fileName()));
+}
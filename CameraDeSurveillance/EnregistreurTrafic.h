@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include "FormatTrace.h"
+
+// Enregistre les octets échangés avec une chaîne de caméras dans un fichier .trc projeté en
+// mémoire ; un enregistrement coûte une copie de 32 octets, sans allocation ni appel système
+class EnregistreurTrafic
+{
+public:
+    EnregistreurTrafic() = default;
+    ~EnregistreurTrafic();
+
+    EnregistreurTrafic(const EnregistreurTrafic&) = delete;
+    EnregistreurTrafic& operator=(const EnregistreurTrafic&) = delete;
+
+    bool open(const QString& path, std::uint32_t capacity = Trace::DEFAULT_CAPACITY);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    void record(Trace::Direction direction, const char* data, qint64 size);
+
+    quint64 recordCount() const { return header ? header->written : 0; }
+    QString fileName() const { return file.fileName(); }
+
+    static QString defaultPath(const QString& portName);
+
+private:
+    void append(Trace::Direction direction, const std::uint8_t* data, std::size_t size, std::uint64_t time);
+
+    QFile file;
+    Trace::FileHeader* header = nullptr;
+    Trace::Record* records = nullptr;
+    std::uint64_t mask = 0;
+    QElapsedTimer clock;
+};
@@ -0,0 +1,319 @@
+﻿//*********************************************************************************************
+//* Programme : EnregistreurVideo.cpp                                          Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Enregistrer la vidéo d'une caméra sur déclenchement, secondes précédentes comprises :
+//*       les images de l'anneau sont écrites par lots dans des segments indexés, hors du
+//*       thread de capture.
+//* Programmes associés : AnneauImages.cpp, FormatSegment.h, CameraDeSurveillance.cpp
+//*********************************************************************************************
+
+#include "EnregistreurVideo.h"
+#include "Metriques.h"
+#include "PiloteVitesse.h"
+#include <QDateTime>
+#include <QDir>
+#include <QStandardPaths>
+#include <QtGlobal>
+#include <cstring>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe EnregistreurVideo ; l'anneau est alloué ici, une fois pour toutes
+//* Paramètres :
+//*  - quint8 address : l'adresse de la caméra filmée
+//*  - const QString& directory : le dossier des segments
+//*  - std::size_t ringBytes : la taille de l'anneau, qui borne la durée gardée avant l'alarme
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+EnregistreurVideo::EnregistreurVideo(quint8 address, const QString& directory, std::size_t ringBytes, QObject* parent)
+    : QObject(parent), anneau(ringBytes, RING_FRAMES), cameraAddress(address), outputDirectory(directory), flushTimer(this)
+{
+    flushTimer.setInterval(FLUSH_INTERVAL_MS);
+    connect(&flushTimer, &QTimer::timeout, this, &EnregistreurVideo::flush);
+    pendingIndex.reserve(BATCH_FRAMES);
+}
+
+EnregistreurVideo::~EnregistreurVideo()
+{
+    closeSegment();
+}
+
+EnregistreurVideo::Stats EnregistreurVideo::stats() const
+{
+    Stats result;
+    result.frames = framesWritten.load(std::memory_order_relaxed);
+    result.bytes = bytesWritten.load(std::memory_order_relaxed);
+    result.writes = writeCount.load(std::memory_order_relaxed);
+    result.segments = segmentCount.load(std::memory_order_relaxed);
+    result.lastFlushUs = lastFlushUs.load(std::memory_order_relaxed);
+    result.maxFlushUs = maxFlushUs.load(std::memory_order_relaxed);
+    return result;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le dossier des enregistrements : celui désigné par la variable
+//* d'environnement CAMERA_VIDEO_DIR, le dossier des vidéos de l'utilisateur ou le dossier
+//* temporaire
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : QString, le chemin du dossier
+//---------------------------------------------------------------------------------------------
+QString EnregistreurVideo::defaultDirectory()
+{
+    if (qEnvironmentVariableIsSet("CAMERA_VIDEO_DIR"))
+    {
+        return qEnvironmentVariable("CAMERA_VIDEO_DIR");
+    }
+    QString movies = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
+    return movies.isEmpty() ? QDir::tempPath() : QDir(movies).filePath("CameraDeSurveillance");
+}
+
+//---------------------------------------------------------------------------------------------
+//* Slot déclenchant l'enregistrement : les images des PRE_EVENT_MS dernières millisecondes
+//* encore dans l'anneau sont écrites, puis les suivantes jusqu'à POST_EVENT_MS après le
+//* dernier déclenchement (un déclenchement pendant l'enregistrement le prolonge)
+//* Paramètres :
+//*  - const QString& reason : la cause (bouton, zone en alarme, mode automatique)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurVideo::trigger(const QString& reason)
+{
+    qint64 now = PiloteVitesse::now();
+    stopAt = qMax(stopAt, now + static_cast<qint64>(POST_EVENT_MS) * 1000000);
+    if (isRecording())
+    {
+        return;
+    }
+
+    anneau.startReading(now - static_cast<qint64>(PRE_EVENT_MS) * 1000000);
+    recording.store(true, std::memory_order_relaxed);
+    sessionFrames = 0;
+    flushTimer.start();
+    emit recordingStarted(reason);
+    flush();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Slot arrêtant l'enregistrement après les images déjà capturées
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurVideo::stop()
+{
+    if (isRecording())
+    {
+        stopAt = PiloteVitesse::now();
+        flush();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction écrivant les images en attente dans l'anneau, toutes les FLUSH_INTERVAL_MS. Les
+//* images d'un lot qui se suivent dans l'anneau partent en une seule écriture, leurs entrées
+//* d'index en une autre ; elles ne sont rendues à la capture qu'une fois écrites.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurVideo::flush()
+{
+    if (!isRecording())
+    {
+        return;
+    }
+
+    qint64 start = PiloteVitesse::now();
+    AnneauImages::Frame batch[BATCH_FRAMES];
+    bool done = false;
+    bool ok = true;
+    std::size_t count;
+    while (ok && !done && (count = anneau.peek(batch, BATCH_FRAMES)) > 0)
+    {
+        const std::uint8_t* runData = nullptr;
+        qint64 runSize = 0;
+        std::size_t used = 0;
+        for (; used < count; ++used)
+        {
+            const AnneauImages::Frame& frame = batch[used];
+            if (frame.captureTime > stopAt)
+            {
+                done = true;
+                break;
+            }
+
+            // Nouveau segment à l'échéance ou au changement de format de la source
+            if (!segmentFile.isOpen() || frame.captureTime - segmentStart >= static_cast<qint64>(SEGMENT_MS) * 1000000
+                || frame.width != header.width || frame.height != header.height
+                || static_cast<std::uint8_t>(frame.format) != header.format)
+            {
+                ok = writeRun(runData, runSize);
+                runSize = 0;
+                closeSegment();
+                ok = ok && openSegment(frame);
+                if (!ok)
+                {
+                    break;
+                }
+            }
+
+            const std::uint8_t* data = anneau.data(frame);
+            if (runSize > 0 && data != runData + runSize)
+            {
+                ok = writeRun(runData, runSize);
+                runSize = 0;
+                if (!ok)
+                {
+                    break;
+                }
+            }
+            if (runSize == 0)
+            {
+                runData = data;
+            }
+            runSize += frame.size;
+
+            Segment::IndexEntry entry = {};
+            entry.captureTime = frame.captureTime;
+            entry.offset = segmentOffset;
+            entry.size = frame.size;
+            entry.sequence = frame.sequence;
+            pendingIndex.push_back(entry);
+            segmentOffset += frame.size;
+        }
+
+        ok = ok && writeRun(runData, runSize);
+        if (ok && !pendingIndex.empty())
+        {
+            qint64 indexSize = static_cast<qint64>(pendingIndex.size() * sizeof(Segment::IndexEntry));
+            ok = indexFile.write(reinterpret_cast<const char*>(pendingIndex.data()), indexSize) == indexSize;
+            pendingIndex.clear();
+        }
+        if (ok)
+        {
+            anneau.consume(used);
+            sessionFrames += used;
+            framesWritten.fetch_add(used, std::memory_order_relaxed);
+            Metriques::add(Metrique::Counter::FramesRecorded, used);
+        }
+    }
+
+    if (!ok)
+    {
+        emit failed(segmentFile.errorString().isEmpty() ? indexFile.errorString() : segmentFile.errorString());
+        done = true;
+    }
+    // Plus rien dans l'anneau et l'échéance passée : aucune image à enregistrer ne viendra
+    if (!done && PiloteVitesse::now() > stopAt)
+    {
+        done = true;
+    }
+
+    qint64 elapsedUs = (PiloteVitesse::now() - start) / 1000;
+    Metriques::observe(Metrique::Histogram::RecordFlush, elapsedUs);
+    lastFlushUs.store(elapsedUs, std::memory_order_relaxed);
+    maxFlushUs.store(qMax(maxFlushUs.load(std::memory_order_relaxed), elapsedUs), std::memory_order_relaxed);
+
+    if (done)
+    {
+        finish();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction ouvrant un segment pour une image : cam<adresse>-<date de l'image>.vseg et .vidx,
+//* écrits sans tampon intermédiaire (chaque écriture est un appel système)
+//* Paramètres :
+//*  - const AnneauImages::Frame& frame : la première image du segment
+//*
+//* Valeur de retour : bool, vrai si le segment est ouvert, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool EnregistreurVideo::openSegment(const AnneauImages::Frame& frame)
+{
+    qint64 wallStartMs = QDateTime::currentMSecsSinceEpoch() - (PiloteVitesse::now() - frame.captureTime) / 1000000;
+    QDir directory(outputDirectory);
+    directory.mkpath(".");
+    QString base = directory.filePath(QString("cam%1-%2").arg(cameraAddress)
+        .arg(QDateTime::fromMSecsSinceEpoch(wallStartMs).toString("yyyyMMdd-HHmmss-zzz")));
+
+    segmentFile.setFileName(base + ".vseg");
+    indexFile.setFileName(base + ".vidx");
+    if (!segmentFile.open(QIODevice::WriteOnly | QIODevice::Unbuffered)
+        || !indexFile.open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+    {
+        return false;
+    }
+
+    header = {};
+    std::memcpy(header.magic, Segment::MAGIC, sizeof(Segment::MAGIC));
+    header.version = Segment::VERSION;
+    header.address = cameraAddress;
+    header.format = static_cast<std::uint8_t>(frame.format);
+    header.width = frame.width;
+    header.height = frame.height;
+    header.startTime = frame.captureTime;
+    header.wallStartMs = wallStartMs;
+    if (segmentFile.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header))
+    {
+        return false;
+    }
+
+    segmentStart = frame.captureTime;
+    segmentOffset = sizeof(header);
+    segmentCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction fermant le segment ouvert, après avoir écrit les entrées d'index en attente
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EnregistreurVideo::closeSegment()
+{
+    if (indexFile.isOpen() && !pendingIndex.empty())
+    {
+        indexFile.write(reinterpret_cast<const char*>(pendingIndex.data()),
+            static_cast<qint64>(pendingIndex.size() * sizeof(Segment::IndexEntry)));
+    }
+    pendingIndex.clear();
+    segmentFile.close();
+    indexFile.close();
+}
+
+bool EnregistreurVideo::writeRun(const std::uint8_t* data, qint64 size)
+{
+    if (size == 0)
+    {
+        return true;
+    }
+    writeCount.fetch_add(1, std::memory_order_relaxed);
+    if (segmentFile.write(reinterpret_cast<const char*>(data), size) != size)
+    {
+        return false;
+    }
+    bytesWritten.fetch_add(static_cast<quint64>(size), std::memory_order_relaxed);
+    return true;
+}
+
+void EnregistreurVideo::finish()
+{
+    flushTimer.stop();
+    closeSegment();
+    anneau.stopReading();
+    recording.store(false, std::memory_order_relaxed);
+    stopAt = 0;
+    emit recordingStopped(sessionFrames);
+}
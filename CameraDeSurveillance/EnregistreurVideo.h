@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+#include <atomic>
+#include <vector>
+#include "AnneauImages.h"
+#include "FormatSegment.h"
+
+// Enregistreur d'une caméra, dans son propre thread. Le thread de capture copie chaque image
+// dans l'anneau (ring().push) ; sur déclenchement (bouton, alarme de mouvement, mode
+// automatique), les PRE_EVENT_MS secondes qui précèdent puis les images suivantes sont écrites
+// par lots dans des segments de SEGMENT_MS (voir FormatSegment.h), jusqu'à POST_EVENT_MS après
+// le dernier déclenchement. Les écritures sont séquentielles et la capture n'attend jamais.
+class EnregistreurVideo : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int PRE_EVENT_MS = 10000;
+    static constexpr int POST_EVENT_MS = 10000;
+    static constexpr int SEGMENT_MS = 60000;
+    static constexpr int FLUSH_INTERVAL_MS = 100;
+    static constexpr std::size_t RING_BYTES = 256u * 1024 * 1024;
+    static constexpr std::size_t RING_FRAMES = 2048;
+    static constexpr std::size_t BATCH_FRAMES = 64;     // Images lues dans l'anneau par passage
+
+    struct Stats
+    {
+        quint64 frames = 0;         // Images écrites
+        quint64 bytes = 0;
+        quint64 writes = 0;         // Appels d'écriture des images
+        quint64 segments = 0;
+        qint64 lastFlushUs = 0;
+        qint64 maxFlushUs = 0;
+    };
+
+    EnregistreurVideo(quint8 address, const QString& directory, std::size_t ringBytes = RING_BYTES, QObject* parent = nullptr);
+    ~EnregistreurVideo();
+
+    AnneauImages& ring() { return anneau; }
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+    Stats stats() const;
+
+    static QString defaultDirectory();
+
+public slots:
+    void trigger(const QString& reason);
+    void stop();
+    void flush();
+
+signals:
+    void recordingStarted(const QString& reason);
+    void recordingStopped(quint64 frames);
+    void failed(const QString& errorString);
+
+private:
+    bool openSegment(const AnneauImages::Frame& frame);
+    void closeSegment();
+    bool writeRun(const std::uint8_t* data, qint64 size);
+    void finish();
+
+    AnneauImages anneau;
+    quint8 cameraAddress;
+    QString outputDirectory;
+    QTimer flushTimer;
+    std::atomic<bool> recording{ false };
+    qint64 stopAt = 0;              // Fin de l'enregistrement (ns, horloge de capture)
+    quint64 sessionFrames = 0;
+
+    // Segment ouvert
+    QFile segmentFile;
+    QFile indexFile;
+    Segment::FileHeader header = {};
+    qint64 segmentStart = 0;
+    std::uint64_t segmentOffset = 0;
+    std::vector<Segment::IndexEntry> pendingIndex;
+
+    std::atomic<quint64> framesWritten{ 0 };
+    std::atomic<quint64> bytesWritten{ 0 };
+    std::atomic<quint64> writeCount{ 0 };
+    std::atomic<quint64> segmentCount{ 0 };
+    std::atomic<qint64> lastFlushUs{ 0 };
+    std::atomic<qint64> maxFlushUs{ 0 };
+};
@@ -0,0 +1,286 @@
+﻿//*********************************************************************************************
+//* Programme : EtatCameras.cpp                                                Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Conserver la position connue de chaque caméra (pan, tilt, zoom) en l'interrogeant à
+//*       un rythme adapté : souvent pendant un déplacement, rarement à l'arrêt, pour laisser
+//*       la liaison série libre pour les commandes. L'interface lit ce cache.
+//* Programmes associés : ControleCamera.cpp, OrdonnanceurCommandes.cpp
+//*********************************************************************************************
+
+#include "EtatCameras.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe EtatCameras
+//* Paramètres :
+//*  - OrdonnanceurCommandes& ordonnanceur : la file par laquelle passent les interrogations
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+EtatCameras::EtatCameras(OrdonnanceurCommandes& ordonnanceur, QObject* parent)
+    : QObject(parent), ordonnanceur(ordonnanceur), timer(this)
+{
+    qRegisterMetaType<CameraState>();
+
+    clock.start();
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &EtatCameras::poll);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction choisissant les caméras suivies : adresses 1 à cameraCount
+//* Paramètres :
+//*  - int cameraCount : le nombre de caméras de la chaîne (0 arrête le suivi)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::track(int cameraCount)
+{
+    QMutexLocker locker(&mutex);
+    for (int address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        // Les interrogations en cours ont été abandonnées avec l'ancien port ou l'ancienne chaîne
+        tracking[address] = Tracking();
+        tracking[address].tracked = address <= cameraCount;
+        states[address] = CameraState();
+    }
+    locker.unlock();
+
+    schedulePoll();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction signalant une commande envoyée : un déplacement peut commencer, l'interrogation
+//* passe au rythme rapide
+//* Paramètres :
+//*  - const Visca::Command& command : la commande transmise à l'ordonnanceur
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::noteCommand(const Visca::Command& command)
+{
+    std::uint8_t address = command.address();
+    if (address == Visca::BROADCAST_ADDRESS && command.bytes[1] == 0x01 && command.bytes[2] != 0x00)
+    {
+        // Commande de groupe (pas IF_Clear) : toutes les caméras de la chaîne se déplacent
+        for (std::uint8_t camera = 1; camera < ADDRESS_SLOTS; ++camera)
+        {
+            Visca::Command routed = command;
+            routed.setAddress(camera);
+            noteCommand(routed);
+        }
+        return;
+    }
+    if (command.isInquiry() || address == 0 || address >= ADDRESS_SLOTS || !tracking[address].tracked)
+    {
+        return;
+    }
+
+    qint64 now = clock.elapsed();
+    tracking[address].lastMotion = now;
+    tracking[address].nextPoll = std::min(tracking[address].nextPoll, now + FAST_INTERVAL);
+    schedulePoll();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le dernier état connu d'une caméra ; elle peut être appelée depuis
+//* n'importe quel thread et n'envoie rien à la caméra
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7)
+//*
+//* Valeur de retour : CameraState, l'état en cache (valid est faux si rien n'a été reçu)
+//---------------------------------------------------------------------------------------------
+CameraState EtatCameras::state(std::uint8_t address) const
+{
+    QMutexLocker locker(&mutex);
+    return address < ADDRESS_SLOTS ? states[address] : CameraState();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à l'échéance du minuteur : interroge les caméras dont c'est le tour
+//* Une caméra dont les réponses précédentes ne sont pas revenues n'est pas réinterrogée.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::poll()
+{
+    qint64 now = clock.elapsed();
+
+    for (std::uint8_t address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        Tracking& entry = tracking[address];
+        if (!entry.tracked || entry.panTiltId != 0 || entry.zoomId != 0 || entry.nextPoll > now)
+        {
+            continue;
+        }
+
+        // Le zoom n'est demandé qu'à la réponse pan/tilt : une caméra n'a qu'une interrogation
+        // en cours, la seconde attendrait sa place dans la file des transactions
+        entry.panTiltId = ordonnanceur.schedule(Visca::panTiltPosInquiry(address));
+        entry.nextPoll = now + interval(entry, now);
+    }
+
+    schedulePoll();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à chaque réponse d'interrogation : met à jour le cache si elle répond à
+//* une interrogation de position lancée par le suivi ; la réponse pan/tilt lance celle du zoom
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*  - const Visca::Reply& reply : la réponse décodée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::onInquiryCompleted(quint32 id, const Visca::Reply& reply)
+{
+    std::uint8_t address = reply.address;
+    if (reply.type != Visca::ReplyType::InquiryReply || address == 0 || address >= ADDRESS_SLOTS)
+    {
+        return;
+    }
+
+    Tracking& entry = tracking[address];
+    CameraState updated = state(address);
+
+    if (id == entry.panTiltId && reply.size == 11)
+    {
+        entry.panTiltId = 0;
+        entry.zoomId = ordonnanceur.schedule(Visca::zoomPosInquiry(address));
+        updated.pan = static_cast<qint16>(Visca::replyValue(reply, 2));
+        updated.tilt = static_cast<qint16>(Visca::replyValue(reply, 6));
+    }
+    else if (id == entry.zoomId && reply.size == 7)
+    {
+        entry.zoomId = 0;
+        updated.zoom = Visca::replyValue(reply, 2);
+    }
+    else
+    {
+        return;
+    }
+
+    publish(address, updated);
+    schedulePoll();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand une transaction échoue : une interrogation perdue est relancée au
+//* prochain tour
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*  - int errorCode : le code d'erreur (non utilisé)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::onCommandFailed(quint32 id, int errorCode)
+{
+    Q_UNUSED(errorCode);
+
+    for (Tracking& entry : tracking)
+    {
+        if (entry.panTiltId == id)
+        {
+            entry.panTiltId = 0;
+        }
+        if (entry.zoomId == id)
+        {
+            entry.zoomId = 0;
+        }
+    }
+    schedulePoll();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction enregistrant un nouvel état ; le signal stateChanged() n'est émis que si quelque
+//* chose a changé, pour ne pas réveiller l'interface à chaque interrogation
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*  - const CameraState& updated : l'état décodé de la réponse
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::publish(std::uint8_t address, const CameraState& updated)
+{
+    qint64 now = clock.elapsed();
+    Tracking& entry = tracking[address];
+
+    QMutexLocker locker(&mutex);
+    CameraState& current = states[address];
+
+    bool positionChanged = current.pan != updated.pan || current.tilt != updated.tilt || current.zoom != updated.zoom;
+    if (current.valid && positionChanged)
+    {
+        entry.lastMotion = now;
+    }
+
+    CameraState next = updated;
+    next.valid = true;
+    next.moving = now - entry.lastMotion < SLOW_AFTER;
+    next.updated = now;
+
+    bool changed = !current.valid || positionChanged || current.moving != next.moving;
+    current = next;
+    locker.unlock();
+
+    if (changed)
+    {
+        emit stateChanged(address, next);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le délai avant la prochaine interrogation d'une caméra
+//* Paramètres :
+//*  - const Tracking& entry : le suivi de la caméra
+//*  - qint64 now : l'instant courant
+//*
+//* Valeur de retour : int, le délai en millisecondes
+//---------------------------------------------------------------------------------------------
+int EtatCameras::interval(const Tracking& entry, qint64 now) const
+{
+    qint64 still = now - entry.lastMotion;
+    if (still < SLOW_AFTER)
+    {
+        return FAST_INTERVAL;
+    }
+    return still < IDLE_AFTER ? SLOW_INTERVAL : IDLE_INTERVAL;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction réarmant le minuteur sur la prochaine échéance d'interrogation
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void EtatCameras::schedulePoll()
+{
+    qint64 now = clock.elapsed();
+    qint64 next = -1;
+
+    for (const Tracking& entry : tracking)
+    {
+        // Une caméra qui attend ses réponses sera replanifiée à leur arrivée
+        if (entry.tracked && entry.panTiltId == 0 && entry.zoomId == 0)
+        {
+            next = next < 0 ? entry.nextPoll : std::min(next, entry.nextPoll);
+        }
+    }
+
+    if (next < 0)
+    {
+        timer.stop();
+        return;
+    }
+    timer.start(static_cast<int>(std::max<qint64>(next - now, 0)));
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QTimer>
+#include "Visca.h"
+#include "TransactionsVisca.h"
+#include "OrdonnanceurCommandes.h"
+
+// Dernier état connu d'une caméra, rafraîchi par les interrogations de position
+struct CameraState
+{
+    bool valid = false;         // Au moins une réponse reçue depuis l'ouverture du port
+    bool moving = false;        // Commande de déplacement récente ou position qui change
+    qint16 pan = 0;
+    qint16 tilt = 0;
+    quint16 zoom = 0;
+    qint64 updated = 0;         // Instant de la dernière réponse (ms depuis le démarrage du suivi)
+};
+
+Q_DECLARE_METATYPE(CameraState)
+
+class EtatCameras : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Rythmes d'interrogation (ms) : rapide pendant un déplacement, lent puis veille à l'arrêt
+    static constexpr int FAST_INTERVAL = 100;
+    static constexpr int SLOW_INTERVAL = 1000;
+    static constexpr int IDLE_INTERVAL = 5000;
+    static constexpr int SLOW_AFTER = 1000;     // Temps sans mouvement avant le rythme lent
+    static constexpr int IDLE_AFTER = 10000;    // Temps sans mouvement avant le rythme de veille
+
+    explicit EtatCameras(OrdonnanceurCommandes& ordonnanceur, QObject* parent = nullptr);
+
+    void track(int cameraCount);
+    void noteCommand(const Visca::Command& command);
+    CameraState state(std::uint8_t address) const;
+
+signals:
+    void stateChanged(quint8 address, const CameraState& state);
+
+public slots:
+    void onInquiryCompleted(quint32 id, const Visca::Reply& reply);
+    void onCommandFailed(quint32 id, int errorCode);
+
+private slots:
+    void poll();
+
+private:
+    // Suivi d'une adresse : interrogations en cours et dernier mouvement observé
+    struct Tracking
+    {
+        bool tracked = false;
+        quint32 panTiltId = 0;
+        quint32 zoomId = 0;
+        qint64 nextPoll = 0;
+        qint64 lastMotion = -IDLE_AFTER;
+    };
+
+    static constexpr int ADDRESS_SLOTS = 8;     // Adresses 1 à 7
+
+    int interval(const Tracking& tracking, qint64 now) const;
+    void publish(std::uint8_t address, const CameraState& updated);
+    void schedulePoll();
+
+    OrdonnanceurCommandes& ordonnanceur;
+    QTimer timer;
+    QElapsedTimer clock;
+    Tracking tracking[ADDRESS_SLOTS];
+
+    // Lu depuis n'importe quel thread (interface, API), écrit dans le thread de la caméra
+    mutable QMutex mutex;
+    CameraState states[ADDRESS_SLOTS];
+};
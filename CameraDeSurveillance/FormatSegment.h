@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Format des enregistrements vidéo, découpés en segments d'une durée fixe. Chaque segment est
+//* une paire de fichiers écrits séquentiellement :
+//*  - .vseg : un en-tête de 64 octets suivi des images mises bout à bout, sans séparateur ;
+//*  - .vidx : une entrée de 32 octets par image (instant, position et taille dans le .vseg),
+//*    triées par instant : une recherche dichotomique donne l'image d'un instant donné.
+//* Les deux fichiers sont utilisables même si l'application s'arrête en cours de segment.
+//---------------------------------------------------------------------------------------------
+namespace Segment
+{
+    constexpr char MAGIC[8] = { 'C', 'A', 'M', 'V', 'I', 'D', 'E', 'O' };
+    constexpr std::uint32_t VERSION = 1;
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint8_t address;           // Adresse VISCA de la caméra filmée
+        std::uint8_t format;            // Video::PixelFormat des images (brutes, lignes sans marge)
+        std::uint16_t reserved;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::int64_t startTime;         // Instant de la première image (ns, horloge monotone)
+        std::int64_t wallStartMs;       // Heure murale correspondante (ms depuis 1970)
+        std::uint8_t padding[24];
+    };
+
+    struct IndexEntry
+    {
+        std::int64_t captureTime;       // ns, même horloge que startTime
+        std::uint64_t offset;           // Position de l'image dans le .vseg
+        std::uint32_t size;
+        std::uint32_t reserved;
+        std::uint64_t sequence;         // Numéro de l'image dans la capture
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "En-tête de segment de 64 octets");
+    static_assert(sizeof(IndexEntry) == 32, "Entrée d'index de 32 octets");
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Format des fichiers d'enregistrement du trafic série (.trc) : un en-tête de 64 octets suivi
+//* d'un anneau d'enregistrements de 32 octets. Le compteur 'written' de l'en-tête donne le
+//* nombre total d'enregistrements écrits ; l'enregistrement n est à l'emplacement n % capacity.
+//* Ce format est partagé par l'application (EnregistreurTrafic) et l'outil RejeuTrafic.
+//---------------------------------------------------------------------------------------------
+namespace Trace
+{
+    constexpr char MAGIC[8] = { 'V', 'I', 'S', 'C', 'A', 'T', 'R', 'C' };
+    constexpr std::uint32_t VERSION = 1;
+    constexpr std::uint32_t DEFAULT_CAPACITY = 65536;   // 2 Mo de trafic, puissance de deux
+    constexpr std::size_t RECORD_DATA = 22;             // Octets de données par enregistrement
+
+    enum class Direction : std::uint8_t
+    {
+        Transmit = 0,       // Octets écrits vers la caméra
+        Receive = 1,        // Octets lus depuis la caméra
+        Session = 2         // Début de session : data = heure murale en ms depuis 1970 (8 octets)
+    };
+
+    struct FileHeader
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t recordSize;
+        std::uint32_t capacity;     // Nombre d'emplacements, puissance de deux
+        std::uint32_t reserved;
+        std::uint64_t written;      // Nombre total d'enregistrements écrits depuis la création
+        std::uint8_t padding[32];
+    };
+
+    struct Record
+    {
+        std::uint64_t time;         // Nanosecondes depuis le début de la session (horloge monotone)
+        Direction direction;
+        std::uint8_t size;          // Octets utiles dans data
+        std::uint8_t data[RECORD_DATA];
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "En-tête de trace de 64 octets");
+    static_assert(sizeof(Record) == 32, "Enregistrement de trace de 32 octets");
+
+    constexpr std::uint64_t fileSize(std::uint32_t capacity)
+    {
+        return sizeof(FileHeader) + static_cast<std::uint64_t>(capacity) * sizeof(Record);
+    }
+}
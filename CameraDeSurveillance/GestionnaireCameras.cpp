@@ -0,0 +1,457 @@
+﻿//*********************************************************************************************
+//* Programme : GestionnaireCameras.cpp                                        Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Piloter plusieurs ports série portant chacun une chaîne de caméras VISCA : ouverture,
+//*       numérotation des caméras (AddressSet) et routage des commandes par (port, adresse).
+//*       Les ports sont répartis sur un petit groupe de threads, pas un thread par caméra.
+//*       Les commandes de groupe partent en parallèle sur toutes les chaînes concernées.
+//* Programmes associés : ControleCamera.cpp
+//*********************************************************************************************
+
+#include "GestionnaireCameras.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QDebug>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe GestionnaireCameras, démarre le groupe de threads des ports
+//* Paramètres :
+//*  - int threadCount : le nombre de threads (0 = nombre de cœurs, plafonné à 4)
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+GestionnaireCameras::GestionnaireCameras(int threadCount, QObject* parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<CameraId>();
+    qRegisterMetaType<Visca::Reply>();
+
+    // Une chaîne à 9600 bauds occupe très peu un cœur : quelques threads suffisent pour 64 caméras
+    if (threadCount <= 0)
+    {
+        threadCount = qBound(1, QThread::idealThreadCount(), 4);
+    }
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        QThread* worker = new QThread(this);
+        worker->setObjectName(QString("CameraPool-%1").arg(i));
+        worker->start();
+        workers.append(worker);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Destructeur de la classe GestionnaireCameras, arrête les threads et détruit les chaînes
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+GestionnaireCameras::~GestionnaireCameras()
+{
+    for (QThread* worker : workers)
+    {
+        worker->quit();
+        worker->wait();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'ajouter un port : il est ouvert puis sa chaîne est numérotée
+//* Paramètres :
+//*  - const QString& portName : le nom du port série
+//*
+//* Valeur de retour : int, l'indice du port dans le gestionnaire
+//---------------------------------------------------------------------------------------------
+int GestionnaireCameras::addPort(const QString& portName)
+{
+    int index = chains.size();
+
+    Chain chain;
+    chain.portName = portName;
+    chain.controle = new ControleCamera();
+    chain.controle->moveToThread(workers.at(index % workers.size()));
+    connect(workers.at(index % workers.size()), &QThread::finished, chain.controle, &QObject::deleteLater);
+    chains.append(chain);
+
+    ControleCamera* controle = chain.controle;
+
+    connect(controle, &ControleCamera::portOpened, this, [this, index, controle](bool success, const QString& errorString) {
+        emit portOpened(index, success, errorString);
+        if (success)
+        {
+            QMetaObject::invokeMethod(controle, [controle]() { controle->enumerateChain(); }, Qt::QueuedConnection);
+        }
+    });
+    connect(controle, &ControleCamera::chainEnumerated, this, [this, index](int cameraCount) {
+        chains[index].cameraCount = cameraCount;
+        emit chainEnumerated(index, cameraCount);
+    });
+    connect(controle, &ControleCamera::commandCompleted, this, [this, index](quint32 id) {
+        emit commandCompleted(index, id);
+    });
+    connect(controle, &ControleCamera::commandFailed, this, [this, index](quint32 id, int errorCode) {
+        emit commandFailed(index, id, errorCode);
+    });
+    connect(controle, &ControleCamera::commandCoalesced, this, [this, index](quint32 supersededId, quint32 replacementId) {
+        emit commandCoalesced(index, supersededId, replacementId);
+    });
+    connect(controle, &ControleCamera::inquiryCompleted, this, [this, index](quint32 id, const Visca::Reply& reply) {
+        emit inquiryCompleted(index, id, reply);
+    });
+    connect(controle, &ControleCamera::stateChanged, this, [this, index](quint8 address, const CameraState& state) {
+        CameraId camera;
+        camera.port = index;
+        camera.address = address;
+        emit stateChanged(camera, state);
+    });
+    connect(controle, &ControleCamera::tourFinished, this, [this, index](quint8 address, const QString& tour) {
+        CameraId camera;
+        camera.port = index;
+        camera.address = address;
+        emit tourFinished(camera, tour);
+    });
+    connect(controle, &ControleCamera::linkLost, this, [this, index]() {
+        emit linkLost(index);
+    });
+    connect(controle, &ControleCamera::linkRestored, this, [this, index](const QString& portName, qint64 reconnectMs) {
+        chains[index].portName = portName;  // L'adaptateur a pu revenir sous un autre nom
+        emit linkRestored(index, reconnectMs);
+    });
+
+    QMetaObject::invokeMethod(controle, [controle, portName]() { controle->openPort(portName); }, Qt::QueuedConnection);
+    return index;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions d'accès aux chaînes et aux caméras découvertes
+//---------------------------------------------------------------------------------------------
+int GestionnaireCameras::portCount() const
+{
+    return chains.size();
+}
+
+QString GestionnaireCameras::portName(int port) const
+{
+    return port >= 0 && port < chains.size() ? chains.at(port).portName : QString();
+}
+
+ControleCamera* GestionnaireCameras::chain(int port) const
+{
+    return port >= 0 && port < chains.size() ? chains.at(port).controle : nullptr;
+}
+
+QList<CameraId> GestionnaireCameras::cameras() const
+{
+    QList<CameraId> list;
+    for (int port = 0; port < chains.size(); ++port)
+    {
+        for (int address = 1; address <= chains.at(port).cameraCount; ++address)
+        {
+            CameraId camera;
+            camera.port = port;
+            camera.address = static_cast<quint8>(address);
+            list.append(camera);
+        }
+    }
+    return list;
+}
+
+int GestionnaireCameras::cameraCount() const
+{
+    int count = 0;
+    for (const Chain& chain : chains)
+    {
+        count += chain.cameraCount;
+    }
+    return count;
+}
+
+bool GestionnaireCameras::contains(const CameraId& camera) const
+{
+    return camera.port >= 0 && camera.port < chains.size()
+        && camera.address >= 1 && camera.address <= chains.at(camera.port).cameraCount;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la dernière position connue d'une caméra, lue dans le cache de sa chaîne
+//* Paramètres :
+//*  - const CameraId& camera : la caméra
+//*
+//* Valeur de retour : CameraState, l'état en cache (valid est faux si la caméra est inconnue)
+//---------------------------------------------------------------------------------------------
+CameraState GestionnaireCameras::state(const CameraId& camera) const
+{
+    ControleCamera* controle = chain(camera.port);
+    return controle ? controle->cameraState(camera.address) : CameraState();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'envoyer une commande à une caméra ; elle est exécutée dans le thread
+//* de sa chaîne, l'appelant n'attend jamais le port
+//* Paramètres :
+//*  - const CameraId& camera : la caméra destinataire
+//*  - const Visca::Command& command : la commande (son adresse est remplacée par celle de la caméra)
+//*  - CommandClass commandClass : sa classe de regroupement dans l'ordonnanceur
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction (0 si le port est inconnu)
+//---------------------------------------------------------------------------------------------
+quint32 GestionnaireCameras::send(const CameraId& camera, const Visca::Command& command, CommandClass commandClass)
+{
+    ControleCamera* controle = chain(camera.port);
+    if (!controle)
+    {
+        return 0;
+    }
+
+    Visca::Command routed = command;
+    routed.setAddress(camera.address);
+    quint32 id = TransactionsVisca::allocateId();
+
+    QMetaObject::invokeMethod(controle, [controle, routed, commandClass, id]() {
+        controle->sendCommand(routed, commandClass, id);
+    }, Qt::QueuedConnection);
+    return id;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de charger un fichier de positions et de tournées dans chaque chaîne,
+//* et les groupes de caméras qu'il définit
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier JSON
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::loadPresets(const QString& path)
+{
+    for (const Chain& chain : chains)
+    {
+        ControleCamera* controle = chain.controle;
+        QMetaObject::invokeMethod(controle, [controle, path]() { controle->loadPresets(path); }, Qt::QueuedConnection);
+    }
+    loadGroups(path);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction lisant la section des groupes du fichier de positions :
+//*  { "groups": [ { "name": "confinement", "cameras": [ { "port": 0 }, { "port": 1, "address": 3 } ] } ] }
+//* Un membre sans adresse désigne toutes les caméras de son port.
+//* Paramètres :
+//*  - const QString& path : le chemin du fichier JSON
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::loadGroups(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll());
+    for (const QJsonValue& value : document.object().value("groups").toArray())
+    {
+        QJsonObject object = value.toObject();
+        QList<CameraId> members;
+        for (const QJsonValue& memberValue : object.value("cameras").toArray())
+        {
+            QJsonObject member = memberValue.toObject();
+            CameraId camera;
+            camera.port = member.value("port").toInt(-1);
+            camera.address = static_cast<quint8>(qBound(0, member.value("address").toInt(0), 7));
+            members.append(camera);
+        }
+        defineGroup(object.value("name").toString(), members);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de gestion des groupes de caméras
+//* Paramètres :
+//*  - const QString& name : le nom du groupe
+//*  - const QList<CameraId>& members : ses caméras (adresse 0 : toutes celles du port)
+//*
+//* Valeur de retour : group() donne les caméras présentes du groupe, sans doublon
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::defineGroup(const QString& name, const QList<CameraId>& members)
+{
+    if (!name.isEmpty())
+    {
+        groupMembers.insert(name, members);
+    }
+}
+
+void GestionnaireCameras::removeGroup(const QString& name)
+{
+    groupMembers.remove(name);
+}
+
+QStringList GestionnaireCameras::groups() const
+{
+    return groupMembers.keys();
+}
+
+QList<CameraId> GestionnaireCameras::group(const QString& name) const
+{
+    QList<CameraId> list;
+    for (const CameraId& member : groupMembers.value(name))
+    {
+        if (member.port < 0 || member.port >= chains.size())
+        {
+            continue;
+        }
+
+        int first = member.address == 0 ? 1 : member.address;
+        int last = member.address == 0 ? chains.at(member.port).cameraCount : member.address;
+        for (int address = first; address <= last; ++address)
+        {
+            CameraId camera;
+            camera.port = member.port;
+            camera.address = static_cast<quint8>(address);
+            if (contains(camera) && !list.contains(camera))
+            {
+                list.append(camera);
+            }
+        }
+    }
+    return list;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction envoyant la même commande à toutes les caméras d'un groupe. Sur une chaîne dont
+//* toutes les caméras sont dans le groupe, elle part une seule fois en diffusion (88), qui
+//* revient au contrôleur une fois passée par chaque caméra ; sinon elle est adressée à
+//* chaque membre de la chaîne, et toutes ces copies partent en une écriture. Chaque chaîne
+//* reçoit sa part dans son propre thread : les ports travaillent en parallèle.
+//* Paramètres :
+//*  - const QString& name : le nom du groupe
+//*  - const Visca::Command& command : la commande (son adresse est remplacée)
+//*  - CommandClass commandClass : sa classe de regroupement dans l'ordonnanceur
+//*
+//* Valeur de retour : QList<quint32>, les identifiants des transactions, un par diffusion ou
+//*                    par caméra adressée (vide si aucun membre n'est présent)
+//---------------------------------------------------------------------------------------------
+QList<quint32> GestionnaireCameras::sendGroup(const QString& name, const Visca::Command& command, CommandClass commandClass)
+{
+    QMap<int, QList<quint8>> addresses;
+    for (const CameraId& camera : group(name))
+    {
+        addresses[camera.port].append(camera.address);
+    }
+
+    QList<quint32> ids;
+    for (auto it = addresses.cbegin(); it != addresses.cend(); ++it)
+    {
+        ControleCamera* controle = chain(it.key());
+        QList<Visca::Command> commands;
+        Visca::Command routed = command;
+
+        // Une interrogation diffusée mêlerait les réponses : elle reste adressée
+        bool wholeChain = it.value().size() > 1 && it.value().size() == chains.at(it.key()).cameraCount;
+        if (wholeChain && !command.isInquiry())
+        {
+            routed.setAddress(Visca::BROADCAST_ADDRESS);
+            commands.append(routed);
+        }
+        else
+        {
+            for (quint8 address : it.value())
+            {
+                routed.setAddress(address);
+                commands.append(routed);
+            }
+        }
+
+        QList<quint32> chainIds;
+        for (int index = 0; index < commands.size(); ++index)
+        {
+            chainIds.append(TransactionsVisca::allocateId());
+        }
+        ids.append(chainIds);
+
+        QMetaObject::invokeMethod(controle, [controle, commands, commandClass, chainIds]() {
+            controle->sendCommands(commands, commandClass, chainIds);
+        }, Qt::QueuedConnection);
+    }
+    return ids;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'amener une caméra à une position enregistrée de sa chaîne
+//* Paramètres :
+//*  - const CameraId& camera : la caméra
+//*  - const QString& preset : le nom de la position
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::gotoPreset(const CameraId& camera, const QString& preset)
+{
+    ControleCamera* controle = chain(camera.port);
+    if (controle)
+    {
+        quint8 address = camera.address;
+        QMetaObject::invokeMethod(controle, [controle, preset, address]() { controle->gotoPreset(preset, address); }, Qt::QueuedConnection);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant une consigne de vitesse à une caméra (voir ControleCamera::setVelocity) ;
+//* l'instant de la saisie est pris ici, avant le passage au thread de la chaîne
+//* Paramètres :
+//*  - const CameraId& camera : la caméra
+//*  - double pan, tilt : les vitesses, de -1 à 1
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::setVelocity(const CameraId& camera, double pan, double tilt)
+{
+    ControleCamera* controle = chain(camera.port);
+    if (controle)
+    {
+        quint8 address = camera.address;
+        qint64 inputTime = PiloteVitesse::now();
+        QMetaObject::invokeMethod(controle, [controle, address, pan, tilt, inputTime]() {
+            controle->setVelocity(address, pan, tilt, inputTime);
+        }, Qt::QueuedConnection);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions permettant de lancer ou d'arrêter une tournée ; toutes les tournées d'une chaîne
+//* sont menées par son thread, quel que soit leur nombre
+//* Paramètres :
+//*  - const CameraId& camera : la caméra
+//*  - const QString& tour : le nom de la tournée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void GestionnaireCameras::startTour(const CameraId& camera, const QString& tour)
+{
+    ControleCamera* controle = chain(camera.port);
+    if (controle)
+    {
+        quint8 address = camera.address;
+        QMetaObject::invokeMethod(controle, [controle, tour, address]() { controle->startTour(tour, address); }, Qt::QueuedConnection);
+    }
+}
+
+void GestionnaireCameras::stopTour(const CameraId& camera)
+{
+    ControleCamera* controle = chain(camera.port);
+    if (controle)
+    {
+        quint8 address = camera.address;
+        QMetaObject::invokeMethod(controle, [controle, address]() { controle->stopTour(address); }, Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include "ControleCamera.h"
+
+// Identifie une caméra : port (chaîne VISCA) et adresse sur cette chaîne (1 à 7) ; dans un
+// groupe, l'adresse 0 désigne toutes les caméras du port
+struct CameraId
+{
+    int port = -1;
+    quint8 address = 0;
+
+    bool operator==(const CameraId& other) const { return port == other.port && address == other.address; }
+};
+
+Q_DECLARE_METATYPE(CameraId)
+
+class GestionnaireCameras : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GestionnaireCameras(int threadCount = 0, QObject* parent = nullptr);
+    ~GestionnaireCameras();
+
+    int addPort(const QString& portName);
+    int portCount() const;
+    QString portName(int port) const;
+    QList<CameraId> cameras() const;
+    int cameraCount() const;
+    bool contains(const CameraId& camera) const;
+    ControleCamera* chain(int port) const;
+    CameraState state(const CameraId& camera) const;
+
+    quint32 send(const CameraId& camera, const Visca::Command& command, CommandClass commandClass = CommandClass::None);
+    void loadPresets(const QString& path);
+    void gotoPreset(const CameraId& camera, const QString& preset);
+    void setVelocity(const CameraId& camera, double pan, double tilt);
+    void startTour(const CameraId& camera, const QString& tour);
+    void stopTour(const CameraId& camera);
+
+    void defineGroup(const QString& name, const QList<CameraId>& members);
+    void removeGroup(const QString& name);
+    QStringList groups() const;
+    QList<CameraId> group(const QString& name) const;
+    QList<quint32> sendGroup(const QString& name, const Visca::Command& command, CommandClass commandClass = CommandClass::None);
+
+signals:
+    void portOpened(int port, bool success, const QString& errorString);
+    void chainEnumerated(int port, int cameraCount);
+    void commandCompleted(int port, quint32 id);
+    void commandFailed(int port, quint32 id, int errorCode);
+    void commandCoalesced(int port, quint32 supersededId, quint32 replacementId);
+    void inquiryCompleted(int port, quint32 id, const Visca::Reply& reply);
+    void stateChanged(const CameraId& camera, const CameraState& state);
+    void tourFinished(const CameraId& camera, const QString& tour);
+    void linkLost(int port);
+    void linkRestored(int port, qint64 reconnectMs);
+
+private:
+    struct Chain
+    {
+        QString portName;
+        ControleCamera* controle = nullptr;
+        int cameraCount = 0;
+    };
+
+    void loadGroups(const QString& path);
+
+    QList<QThread*> workers;
+    QList<Chain> chains;
+    QMap<QString, QList<CameraId>> groupMembers;
+};
@@ -0,0 +1,196 @@
+﻿//*********************************************************************************************
+//* Programme : Metriques.cpp                                                  Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Additionner les tranches de métriques des threads et les mettre au format texte de
+//*       Prometheus pour le point d'accès /metrics.
+//* Programmes associés : ServeurMetriques.cpp, TransactionsVisca.cpp, OrdonnanceurCommandes.cpp
+//*********************************************************************************************
+
+#include "Metriques.h"
+
+std::atomic<Metriques::Shard*> Metriques::shards(nullptr);
+
+namespace
+{
+    struct Description
+    {
+        const char* name;
+        const char* help;
+    };
+
+    // Indexés par Metrique::Counter, Metrique::Gauge et Metrique::Histogram
+    const Description COUNTERS[] = {
+        { "visca_commands_sent_total", "VISCA command packets written to the serial ports." },
+        { "visca_bytes_sent_total", "Bytes written to the serial ports." },
+        { "visca_bytes_received_total", "Bytes read from the serial ports." },
+        { "visca_replies_total", "VISCA replies framed by the reply parser." },
+        { "visca_framing_errors_total", "Bytes or packets rejected by the reply parser." },
+        { "visca_command_errors_total", "Commands that failed (VISCA error, write error or cancellation)." },
+        { "visca_write_errors_total", "Packets the serial port refused to write." },
+        { "visca_scheduled_total", "Commands received by the schedulers." },
+        { "visca_coalesced_total", "Commands replaced by a newer one before being sent." },
+        { "visca_preempted_total", "Queued commands dropped in favour of a stop." },
+        { "visca_retries_total", "Commands sent again after a lost reply or a full command buffer." },
+        { "visca_timeouts_total", "Replies that did not arrive in time." },
+        { "visca_socket_recoveries_total", "IF_Clear sent to free the sockets of a camera." },
+        { "video_frames_captured_total", "Frames published by the video capture." },
+        { "video_frames_dropped_total", "Frames replaced by a newer one before being displayed." },
+        { "video_motion_events_total", "Motion alarms raised in the watched zones." },
+        { "video_frames_recorded_total", "Frames written to the recording segments." },
+        { "video_ring_overruns_total", "Frames refused by the pre-event ring because recording fell behind." }
+    };
+
+    const Description GAUGES[] = {
+        { "visca_queue_depth", "Commands waiting in the schedulers." }
+    };
+
+    const Description HISTOGRAMS[] = {
+        { "visca_ack_latency_seconds", "Time from sending a command to its ACK or inquiry reply." },
+        { "visca_completion_latency_seconds", "Time from sending a command to its Completion." },
+        { "visca_stop_latency_seconds", "Time from scheduling a stop to writing it." },
+        { "video_display_latency_seconds", "Time from capturing a frame to painting it in the preview." },
+        { "video_frame_cpu_seconds", "CPU time spent on a frame by the capture and preview threads." },
+        { "video_motion_processing_seconds", "Time spent detecting motion in a frame." },
+        { "video_record_flush_seconds", "Time spent writing a batch of frames to a recording segment." }
+    };
+
+    static_assert(sizeof(COUNTERS) / sizeof(COUNTERS[0]) == Metriques::COUNTER_COUNT, "Un nom par compteur");
+    static_assert(sizeof(GAUGES) / sizeof(GAUGES[0]) == Metriques::GAUGE_COUNT, "Un nom par jauge");
+    static_assert(sizeof(HISTOGRAMS) / sizeof(HISTOGRAMS[0]) == Metriques::HISTOGRAM_COUNT, "Un nom par histogramme");
+
+    void header(QByteArray& text, const Description& description, const char* type)
+    {
+        text += "# HELP ";
+        text += description.name;
+        text += ' ';
+        text += description.help;
+        text += "\n# TYPE ";
+        text += description.name;
+        text += ' ';
+        text += type;
+        text += '\n';
+    }
+
+    QByteArray seconds(qint64 us)
+    {
+        return QByteArray::number(static_cast<double>(us) / 1e6, 'g', 10);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction créant la tranche du thread appelant et l'ajoutant à la liste sans verrou ;
+//* appelée une seule fois par thread, à sa première mesure
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : Shard*, la tranche du thread
+//---------------------------------------------------------------------------------------------
+Metriques::Shard* Metriques::attach()
+{
+    Shard* shard = new Shard;
+    Shard* head = shards.load(std::memory_order_relaxed);
+    do
+    {
+        shard->next = head;
+    } while (!shards.compare_exchange_weak(head, shard, std::memory_order_release, std::memory_order_relaxed));
+    return shard;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de lecture : somme des tranches de tous les threads
+//---------------------------------------------------------------------------------------------
+quint64 Metriques::counter(Metrique::Counter counter)
+{
+    quint64 total = 0;
+    for (Shard* shard = shards.load(std::memory_order_acquire); shard; shard = shard->next)
+    {
+        total += shard->counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+qint64 Metriques::gauge(Metrique::Gauge gauge)
+{
+    quint64 total = 0;
+    for (Shard* shard = shards.load(std::memory_order_acquire); shard; shard = shard->next)
+    {
+        total += shard->gauges[static_cast<int>(gauge)].load(std::memory_order_relaxed);
+    }
+    return static_cast<qint64>(total);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction produisant toutes les métriques au format d'exposition texte de Prometheus (0.0.4)
+//* Les tranches sont lues sans arrêter les threads : chaque valeur est exacte, l'ensemble est
+//* cohérent à quelques incréments près.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : QByteArray, le corps de la réponse à /metrics
+//---------------------------------------------------------------------------------------------
+QByteArray Metriques::render()
+{
+    QByteArray text;
+    text.reserve(4096);
+
+    for (int index = 0; index < COUNTER_COUNT; ++index)
+    {
+        header(text, COUNTERS[index], "counter");
+        text += COUNTERS[index].name;
+        text += ' ';
+        text += QByteArray::number(counter(static_cast<Metrique::Counter>(index)));
+        text += '\n';
+    }
+
+    for (int index = 0; index < GAUGE_COUNT; ++index)
+    {
+        header(text, GAUGES[index], "gauge");
+        text += GAUGES[index].name;
+        text += ' ';
+        text += QByteArray::number(gauge(static_cast<Metrique::Gauge>(index)));
+        text += '\n';
+    }
+
+    for (int index = 0; index < HISTOGRAM_COUNT; ++index)
+    {
+        quint64 buckets[BUCKET_COUNT] = {};
+        quint64 sum = 0;
+        for (Shard* shard = shards.load(std::memory_order_acquire); shard; shard = shard->next)
+        {
+            for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+            {
+                buckets[bucket] += shard->buckets[index][bucket].load(std::memory_order_relaxed);
+            }
+            sum += shard->sums[index].load(std::memory_order_relaxed);
+        }
+
+        // Les classes de Prometheus sont cumulées : chacune compte tout ce qui est sous sa borne
+        header(text, HISTOGRAMS[index], "histogram");
+        quint64 cumulated = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; ++bucket)
+        {
+            cumulated += buckets[bucket];
+            text += HISTOGRAMS[index].name;
+            text += "_bucket{le=\"";
+            text += bucket < BUCKET_COUNT - 1 ? seconds(BUCKET_LIMITS_US[bucket]) : QByteArray("+Inf");
+            text += "\"} ";
+            text += QByteArray::number(cumulated);
+            text += '\n';
+        }
+        text += HISTOGRAMS[index].name;
+        text += "_sum ";
+        text += seconds(static_cast<qint64>(sum));
+        text += '\n';
+        text += HISTOGRAMS[index].name;
+        text += "_count ";
+        text += QByteArray::number(cumulated);
+        text += '\n';
+    }
+
+    return text;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <atomic>
+
+//---------------------------------------------------------------------------------------------
+//* Registre des métriques de tout le programme : compteurs, jauges et histogrammes de latence
+//* à classes fixes. Chaque thread incrémente sa propre tranche (aucun verrou ni instruction
+//* atomique de lecture-modification-écriture, quelques nanosecondes par incrément) ; les
+//* tranches sont additionnées à la lecture, au format texte de Prometheus.
+//---------------------------------------------------------------------------------------------
+namespace Metrique
+{
+    enum class Counter
+    {
+        CommandsSent,       // Paquets de commande écrits sur les ports
+        BytesSent,
+        BytesReceived,
+        Replies,            // Réponses découpées par l'analyseur
+        FramingErrors,      // Octets ou paquets rejetés par l'analyseur
+        Errors,             // Commandes en échec (erreur VISCA, écriture, annulation)
+        WriteErrors,        // Écritures refusées par le port
+        Scheduled,          // Commandes reçues par les ordonnanceurs
+        Coalesced,          // Commandes remplacées avant envoi
+        Preempted,          // Commandes en attente abandonnées au profit d'un arrêt
+        Retries,            // Commandes renvoyées (réponse perdue ou tampon plein)
+        Timeouts,           // Réponses attendues en vain
+        Recoveries,         // IF_Clear envoyés pour libérer les sockets d'une caméra
+        FramesCaptured,     // Images publiées par la capture vidéo
+        FramesDropped,      // Images remplacées avant d'avoir été affichées
+        MotionEvents,       // Alarmes de mouvement levées
+        FramesRecorded,     // Images écrites dans les segments d'enregistrement
+        RingOverruns,       // Images refusées par l'anneau : l'écriture n'a pas suivi
+        Count
+    };
+
+    // Jauges tenues par variations : leur valeur est la somme des variations de toutes les tranches
+    enum class Gauge
+    {
+        QueueDepth,         // Commandes en attente dans les ordonnanceurs
+        Count
+    };
+
+    enum class Histogram
+    {
+        AckLatency,         // Envoi -> ACK ou réponse d'interrogation
+        CompletionLatency,  // Envoi -> Completion
+        StopLatency,        // Planification d'un arrêt -> écriture
+        DisplayLatency,     // Capture d'une image -> dessin dans l'aperçu
+        FrameCpu,           // Temps processeur d'une image (capture et dessin)
+        MotionProcessing,   // Détection de mouvement sur une image
+        RecordFlush,        // Écriture d'un lot d'images dans un segment
+        Count
+    };
+}
+
+class Metriques
+{
+public:
+    static constexpr int COUNTER_COUNT = static_cast<int>(Metrique::Counter::Count);
+    static constexpr int GAUGE_COUNT = static_cast<int>(Metrique::Gauge::Count);
+    static constexpr int HISTOGRAM_COUNT = static_cast<int>(Metrique::Histogram::Count);
+    static constexpr int BUCKET_COUNT = 12;
+    // Bornes supérieures des classes, en µs ; la dernière classe est au-delà (+Inf)
+    static constexpr qint64 BUCKET_LIMITS_US[BUCKET_COUNT - 1] = {
+        100, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 1000000 };
+
+    static void add(Metrique::Counter counter, quint64 value = 1)
+    {
+        bump(local().counters[static_cast<int>(counter)], value);
+    }
+
+    static void adjust(Metrique::Gauge gauge, qint64 delta)
+    {
+        bump(local().gauges[static_cast<int>(gauge)], static_cast<quint64>(delta));
+    }
+
+    static void observe(Metrique::Histogram histogram, qint64 us)
+    {
+        Shard& shard = local();
+        int index = static_cast<int>(histogram);
+        bump(shard.buckets[index][bucket(us)], 1);
+        bump(shard.sums[index], static_cast<quint64>(us < 0 ? 0 : us));
+    }
+
+    static quint64 counter(Metrique::Counter counter);
+    static qint64 gauge(Metrique::Gauge gauge);
+    static QByteArray render();
+
+private:
+    // Une tranche par thread, alignée sur une ligne de cache : deux threads n'écrivent jamais
+    // la même ligne. Les tranches ne sont jamais libérées (le nombre de threads est fixe).
+    struct alignas(64) Shard
+    {
+        std::atomic<quint64> counters[COUNTER_COUNT] = {};
+        std::atomic<quint64> gauges[GAUGE_COUNT] = {};     // Variations en complément à deux
+        std::atomic<quint64> buckets[HISTOGRAM_COUNT][BUCKET_COUNT] = {};
+        std::atomic<quint64> sums[HISTOGRAM_COUNT] = {};   // µs
+        Shard* next = nullptr;
+    };
+
+    // Seul le thread propriétaire écrit : une lecture et une écriture relâchées suffisent
+    static void bump(std::atomic<quint64>& value, quint64 delta)
+    {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static int bucket(qint64 us)
+    {
+        int index = 0;
+        while (index < BUCKET_COUNT - 1 && us > BUCKET_LIMITS_US[index])
+        {
+            ++index;
+        }
+        return index;
+    }
+
+    static Shard& local()
+    {
+        thread_local Shard* shard = attach();
+        return *shard;
+    }
+
+    static Shard* attach();
+
+    static std::atomic<Shard*> shards;
+};
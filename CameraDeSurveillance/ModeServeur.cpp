@@ -0,0 +1,65 @@
+﻿//*********************************************************************************************
+//* Programme : ModeServeur.cpp                                                Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Faire tourner les chaînes de caméras sans fenêtre, derrière le serveur de commande et
+//*       le point d'accès des métriques. Utilisé par l'application (--serveur) et par le démon
+//*       ServeurCameras, qui ne dépend pas des widgets.
+//* Programmes associés : main.cpp, ../ServeurCameras/main.cpp, ServeurControle.cpp
+//*********************************************************************************************
+
+#include "ModeServeur.h"
+#include "GestionnaireCameras.h"
+#include "ServeurControle.h"
+#include "ServeurMetriques.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+int runServer(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "serveur", "Serveur de commande sans interface (ignore par ServeurCameras)." });
+    parser.addOption({ "port", "Port serie d'une chaine de cameras (repetable).", "port" });
+    parser.addOption({ "tcp", "Port TCP du protocole binaire (0 = desactive).", "tcp", "5600" });
+    parser.addOption({ "ws", "Port WebSocket du protocole JSON (0 = desactive).", "ws", "5601" });
+    parser.addOption({ "metriques", "Port HTTP local des metriques /metrics (0 = desactive).", "metriques", "9464" });
+    parser.addOption({ "presets", "Fichier de positions, de tournees et de groupes de cameras.", "presets" });
+    parser.process(a);
+
+    if (parser.values("port").isEmpty())
+    {
+        qCritical("Aucun port serie : utiliser --port");
+        return 2;
+    }
+
+    GestionnaireCameras gestionnaire;
+    for (const QString& port : parser.values("port"))
+    {
+        gestionnaire.addPort(port);
+    }
+    if (parser.isSet("presets"))
+    {
+        gestionnaire.loadPresets(parser.value("presets"));
+    }
+
+    ServeurControle serveur(gestionnaire);
+    if (!serveur.listen(parser.value("tcp").toUShort(), parser.value("ws").toUShort()))
+    {
+        return 1;
+    }
+
+    ServeurMetriques metriques;
+    quint16 metricsPort = parser.value("metriques").toUShort();
+    if (metricsPort != 0 && !metriques.listen(metricsPort))
+    {
+        return 1;
+    }
+    return a.exec();
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+// Mode serveur, sans fenetre : partage entre l'application (--serveur) et le demon ServeurCameras
+//   --port COM3 [--port COM4] [--tcp 5600] [--ws 5601] [--metriques 9464] [--presets positions.json]
+int runServer(int argc, char *argv[]);
@@ -0,0 +1,284 @@
+﻿//*********************************************************************************************
+//* Programme : MoteurTournees.cpp                                             Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Dérouler des tournées de positions sur les caméras d'une chaîne : chaque étape part
+//*       quand la précédente a renvoyé sa Completion et que son temps d'arrêt est écoulé.
+//*       Toutes les tournées partagent le thread de la chaîne et un seul minuteur.
+//* Programmes associés : BibliothequePresets.cpp, ControleCamera.cpp
+//*********************************************************************************************
+
+#include "MoteurTournees.h"
+#include "TransactionsVisca.h"
+#include <QDebug>
+#include <algorithm>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe MoteurTournees
+//* Paramètres :
+//*  - Sender sender : la fonction qui confie une commande à l'ordonnanceur
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+MoteurTournees::MoteurTournees(Sender sender, QObject* parent)
+    : QObject(parent), sender(std::move(sender)), timer(this)
+{
+    clock.start();
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &MoteurTournees::onTimeout);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de lancer une tournée sur une caméra ; une tournée déjà en cours sur
+//* cette caméra est remplacée
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7)
+//*  - const Tour& tour : la tournée
+//*  - const BibliothequePresets& presets : les positions qu'elle référence
+//*
+//* Valeur de retour : bool, vrai si la tournée a démarré, faux si une position est inconnue
+//---------------------------------------------------------------------------------------------
+bool MoteurTournees::start(std::uint8_t address, const Tour& tour, const BibliothequePresets& presets)
+{
+    if (address == 0 || address >= ADDRESS_SLOTS || tour.steps.isEmpty())
+    {
+        return false;
+    }
+
+    Running running;
+    running.active = true;
+    running.name = tour.name;
+    running.loops = tour.loops;
+
+    for (const TourStep& step : tour.steps)
+    {
+        const Preset* preset = presets.preset(step.preset);
+        if (!preset)
+        {
+            qDebug() << "Tournée" << tour.name << ": position inconnue" << step.preset;
+            return false;
+        }
+
+        Stage stage;
+        stage.preset = step.preset;
+        stage.commands = BibliothequePresets::commandsFor(*preset, address);
+        stage.dwell = step.dwell;
+        running.stages.append(stage);
+    }
+
+    tours[address] = running;
+    issue(address);
+    return tours[address].active;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'arrêter la tournée d'une caméra ; le déplacement en cours se termine
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::stop(std::uint8_t address)
+{
+    if (address < ADDRESS_SLOTS)
+    {
+        tours[address] = Running();
+        scheduleTimer();
+    }
+}
+
+void MoteurTournees::stopAll()
+{
+    for (Running& running : tours)
+    {
+        running = Running();
+    }
+    timer.stop();
+}
+
+bool MoteurTournees::isRunning(std::uint8_t address) const
+{
+    return address < ADDRESS_SLOTS && tours[address].active;
+}
+
+int MoteurTournees::runningCount() const
+{
+    return static_cast<int>(std::count_if(std::begin(tours), std::end(tours), [](const Running& running) {
+        return running.active;
+    }));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions appelées à chaque fin de transaction : une étape est atteinte quand toutes ses
+//* commandes sont terminées. Une commande en échec ne bloque pas la tournée.
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::onCommandCompleted(quint32 id)
+{
+    resolve(id);
+}
+
+void MoteurTournees::onCommandFailed(quint32 id, int errorCode)
+{
+    Q_UNUSED(errorCode);
+    resolve(id);
+}
+
+void MoteurTournees::resolve(quint32 id)
+{
+    for (std::uint8_t address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        Running& running = tours[address];
+        if (running.active && running.waiting.removeOne(id) && running.waiting.isEmpty() && !running.issuing)
+        {
+            arrived(address);
+            return;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction envoyant les commandes de l'étape courante ; pan/tilt et zoom partent ensemble et
+//* s'exécutent en parallèle sur les deux sockets de la caméra
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::issue(std::uint8_t address)
+{
+    Running& running = tours[address];
+    const Stage& stage = running.stages.at(running.index);
+
+    // Les identifiants sont réservés avant l'envoi : une erreur d'écriture signalée pendant
+    // l'appel retrouve ainsi son étape
+    QList<quint32> ids;
+    for (int i = 0; i < stage.commands.size(); ++i)
+    {
+        ids.append(TransactionsVisca::allocateId());
+    }
+    running.waiting = ids;
+    running.dwellUntil = -1;
+    running.issuing = true;
+
+    for (int i = 0; i < stage.commands.size(); ++i)
+    {
+        if (!sender || sender(stage.commands.at(i), ids.at(i)) == 0)
+        {
+            // Port fermé : la tournée s'arrête
+            tours[address] = Running();
+            scheduleTimer();
+            return;
+        }
+    }
+
+    // Toutes les commandes ont échoué pendant l'envoi : la tournée s'arrête au lieu de boucler
+    running.issuing = false;
+    if (running.waiting.isEmpty())
+    {
+        qDebug() << "Tournée" << running.name << "interrompue : écriture impossible";
+        tours[address] = Running();
+        scheduleTimer();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand la caméra est arrivée sur la position de l'étape courante
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::arrived(std::uint8_t address)
+{
+    Running& running = tours[address];
+    const Stage& stage = running.stages.at(running.index);
+    emit stepReached(address, stage.preset);
+
+    if (stage.dwell > 0)
+    {
+        running.dwellUntil = clock.elapsed() + stage.dwell;
+        scheduleTimer();
+        return;
+    }
+    advance(address);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction passant à l'étape suivante, au passage suivant ou terminant la tournée
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::advance(std::uint8_t address)
+{
+    Running& running = tours[address];
+    running.dwellUntil = -1;
+
+    if (++running.index >= running.stages.size())
+    {
+        running.index = 0;
+        ++running.loop;
+        if (running.loops > 0 && running.loop >= running.loops)
+        {
+            QString name = running.name;
+            tours[address] = Running();
+            scheduleTimer();
+            emit tourFinished(address, name);
+            return;
+        }
+    }
+    issue(address);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à l'échéance du minuteur : relance les caméras dont le temps d'arrêt est fini
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::onTimeout()
+{
+    qint64 now = clock.elapsed();
+    for (std::uint8_t address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        Running& running = tours[address];
+        if (running.active && running.dwellUntil >= 0 && running.dwellUntil <= now)
+        {
+            advance(address);
+        }
+    }
+    scheduleTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction réarmant le minuteur sur le prochain temps d'arrêt à échéance
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void MoteurTournees::scheduleTimer()
+{
+    qint64 next = -1;
+    for (const Running& running : tours)
+    {
+        if (running.active && running.dwellUntil >= 0)
+        {
+            next = next < 0 ? running.dwellUntil : std::min(next, running.dwellUntil);
+        }
+    }
+
+    if (next < 0)
+    {
+        timer.stop();
+        return;
+    }
+    timer.start(static_cast<int>(std::max<qint64>(next - clock.elapsed(), 0)));
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QList>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include "Visca.h"
+#include "BibliothequePresets.h"
+
+class MoteurTournees : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Envoie une commande sous l'identifiant réservé, renvoie 0 si elle n'a pas pu être confiée
+    using Sender = std::function<quint32(const Visca::Command&, quint32)>;
+
+    explicit MoteurTournees(Sender sender, QObject* parent = nullptr);
+
+    bool start(std::uint8_t address, const Tour& tour, const BibliothequePresets& presets);
+    void stop(std::uint8_t address);
+    void stopAll();
+    bool isRunning(std::uint8_t address) const;
+    int runningCount() const;
+
+signals:
+    void stepReached(quint8 address, const QString& preset);
+    void tourFinished(quint8 address, const QString& tour);
+
+public slots:
+    void onCommandCompleted(quint32 id);
+    void onCommandFailed(quint32 id, int errorCode);
+
+private slots:
+    void onTimeout();
+
+private:
+    // Étape prête à l'envoi : les paquets sont encodés une fois au démarrage de la tournée
+    struct Stage
+    {
+        QString preset;
+        QList<Visca::Command> commands;
+        int dwell = 0;
+    };
+
+    // Tournée en cours sur une caméra : une simple machine à états, pas de thread
+    struct Running
+    {
+        bool active = false;
+        QString name;
+        QList<Stage> stages;
+        int loops = 1;
+        int loop = 0;
+        int index = 0;
+        QList<quint32> waiting;         // Transactions de l'étape dont la Completion est attendue
+        bool issuing = false;           // Envoi de l'étape en cours (un échec peut revenir aussitôt)
+        qint64 dwellUntil = -1;         // Fin du temps d'arrêt, -1 si aucun
+    };
+
+    static constexpr int ADDRESS_SLOTS = 8;     // Adresses 1 à 7
+
+    void issue(std::uint8_t address);
+    void arrived(std::uint8_t address);
+    void advance(std::uint8_t address);
+    void resolve(quint32 id);
+    void scheduleTimer();
+
+    Sender sender;
+    QTimer timer;
+    QElapsedTimer clock;
+    Running tours[ADDRESS_SLOTS];
+};
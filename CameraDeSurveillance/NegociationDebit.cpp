@@ -0,0 +1,177 @@
+﻿//*********************************************************************************************
+//* Programme : NegociationDebit.cpp                                           Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Choisir le débit du port série à l'ouverture : chaque débit pris en charge est essayé
+//*       du plus rapide au plus lent avec une interrogation d'alimentation, le premier auquel
+//*       la caméra répond ATTEMPTS fois de suite est retenu et mémorisé pour ce port.
+//* Programmes associés : ControleCamera.cpp
+//*********************************************************************************************
+
+#include "NegociationDebit.h"
+#include <QSerialPort>
+#include <QSettings>
+#include <QDebug>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe NegociationDebit
+//* Paramètres :
+//*  - Writer writer : la fonction qui écrit un paquet sur le port
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+NegociationDebit::NegociationDebit(Writer writer, QObject* parent)
+    : QObject(parent),
+    writer(std::move(writer)),
+    timer(this)
+{
+    timer.setSingleShot(true);
+    connect(&timer, &QTimer::timeout, this, &NegociationDebit::onTimeout);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction lançant la négociation sur un port ouvert ; le résultat est annoncé par finished()
+//* Paramètres :
+//*  - QSerialPort* serialPort : le port, déjà ouvert
+//*  - qint32 preferredRate : le débit à essayer en premier (mémorisé), 0 si aucun
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void NegociationDebit::start(QSerialPort* serialPort, qint32 preferredRate)
+{
+    port = serialPort;
+    candidates.clear();
+
+    if (preferredRate > 0)
+    {
+        candidates.append(preferredRate);
+    }
+    for (qint32 rate : RATES)
+    {
+        if (rate != preferredRate)
+        {
+            candidates.append(rate);
+        }
+    }
+
+    tryRate();
+}
+
+void NegociationDebit::cancel()
+{
+    timer.stop();
+    port = nullptr;
+    candidates.clear();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction recevant les réponses de la caméra pendant la négociation ; seule une réponse
+//* complète à l'interrogation d'alimentation de la caméra 1 compte, les octets reçus au
+//* mauvais débit ne ressemblent jamais à ce paquet
+//* Paramètres :
+//*  - const Visca::Reply& reply : la réponse décodée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void NegociationDebit::handleReply(const Visca::Reply& reply)
+{
+    bool powerReply = reply.type == Visca::ReplyType::InquiryReply && reply.address == 1
+        && reply.size == 4 && (reply.bytes[2] == 0x02 || reply.bytes[2] == 0x03);
+    if (!isRunning() || !powerReply)
+    {
+        return;
+    }
+
+    timer.stop();
+    if (++successes >= ATTEMPTS)
+    {
+        finish(candidates.first(), true);
+        return;
+    }
+    sendProbe();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions lisant et écrivant le débit mémorisé d'un port
+//* Paramètres :
+//*  - const QString& portName : le nom du port série
+//*  - qint32 baudRate : le débit à mémoriser
+//*
+//* Valeur de retour : qint32, le débit mémorisé (0 si aucun)
+//---------------------------------------------------------------------------------------------
+qint32 NegociationDebit::savedRate(const QString& portName)
+{
+    QSettings settings("CameraDeSurveillance", "CameraDeSurveillance");
+    return settings.value(QString("ports/%1/baudRate").arg(portName), 0).toInt();
+}
+
+void NegociationDebit::saveRate(const QString& portName, qint32 baudRate)
+{
+    QSettings settings("CameraDeSurveillance", "CameraDeSurveillance");
+    settings.setValue(QString("ports/%1/baudRate").arg(portName), baudRate);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand une réponse n'est pas arrivée à temps : le débit en cours est
+//* abandonné, le suivant est essayé
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void NegociationDebit::onTimeout()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    qDebug() << "Pas de réponse à" << candidates.first() << "bauds";
+    candidates.removeFirst();
+    tryRate();
+}
+
+void NegociationDebit::tryRate()
+{
+    if (candidates.isEmpty())
+    {
+        // Aucune réponse (caméra absente ou éteinte) : débit d'usine, non mémorisé
+        finish(DEFAULT_RATE, false);
+        return;
+    }
+
+    port->setBaudRate(candidates.first());
+    port->clear();
+    successes = 0;
+    sendProbe();
+}
+
+void NegociationDebit::sendProbe()
+{
+    constexpr auto probe = Visca::powerInquiry(1);
+    if (!writer(probe.data(), static_cast<qint64>(probe.size())))
+    {
+        finish(DEFAULT_RATE, false);
+        return;
+    }
+    timer.start(REPLY_TIMEOUT_MS);
+}
+
+void NegociationDebit::finish(qint32 baudRate, bool confirmed)
+{
+    QSerialPort* serialPort = port;
+    cancel();
+
+    serialPort->setBaudRate(baudRate);
+    serialPort->clear();
+    if (confirmed)
+    {
+        saveRate(serialPort->portName(), baudRate);
+    }
+    emit finished(baudRate, confirmed);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include "Visca.h"
+
+class QSerialPort;
+
+// Recherche à l'ouverture du port le débit le plus rapide auquel la caméra 1 répond à chaque
+// fois ; le débit trouvé est mémorisé par port et essayé en premier à l'ouverture suivante
+class NegociationDebit : public QObject
+{
+    Q_OBJECT
+
+public:
+    using Writer = std::function<bool(const char*, qint64)>;
+
+    static constexpr qint32 RATES[] = { 38400, 19200, 9600 };  // Du plus rapide au plus lent
+    static constexpr qint32 DEFAULT_RATE = 9600;                // Débit d'usine des caméras VISCA
+    static constexpr int ATTEMPTS = 3;                          // Réponses exigées par débit
+    static constexpr int REPLY_TIMEOUT_MS = 200;
+
+    explicit NegociationDebit(Writer writer, QObject* parent = nullptr);
+
+    void start(QSerialPort* serialPort, qint32 preferredRate = 0);
+    void cancel();
+    bool isRunning() const { return port != nullptr; }
+    void handleReply(const Visca::Reply& reply);
+
+    static qint32 savedRate(const QString& portName);
+    static void saveRate(const QString& portName, qint32 baudRate);
+
+signals:
+    void finished(qint32 baudRate, bool confirmed);
+
+private slots:
+    void onTimeout();
+
+private:
+    void tryRate();
+    void sendProbe();
+    void finish(qint32 baudRate, bool confirmed);
+
+    Writer writer;
+    QSerialPort* port = nullptr;
+    QList<qint32> candidates;       // Débits restant à essayer, le premier est en cours
+    int successes = 0;
+    QTimer timer;
+};
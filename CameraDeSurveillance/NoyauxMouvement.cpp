@@ -0,0 +1,512 @@
+﻿//*********************************************************************************************
+//* Programme : NoyauxMouvement.cpp                                            Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Noyaux de la détection de mouvement en version scalaire, SSE2 et AVX2. Les versions
+//*       vectorielles sont compilées avec leur jeu d'instructions (attribut target sous GCC et
+//*       Clang) et choisies à l'exécution selon le processeur : le programme reste utilisable
+//*       sur une machine sans AVX2, et hors x86 seule la version scalaire existe.
+//* Programmes associés : DetectionMouvement.cpp
+//*********************************************************************************************
+
+#include "NoyauxMouvement.h"
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MOUVEMENT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CIBLE_SSE2
+#define CIBLE_AVX2
+#else
+#define CIBLE_SSE2 __attribute__((target("sse2")))
+#define CIBLE_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using Isa = NoyauxMouvement::Isa;
+
+namespace
+{
+    inline std::uint8_t average(int a, int b)
+    {
+        return static_cast<std::uint8_t>((a + b + 1) >> 1);    // Arrondi de _mm_avg_epu8
+    }
+
+    inline int absoluteDifference(int a, int b)
+    {
+        return a > b ? a - b : b - a;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // Versions scalaires, aussi utilisées pour les pixels en fin de ligne des autres versions
+    //-----------------------------------------------------------------------------------------
+    void downscaleScalar(const std::uint8_t* first, const std::uint8_t* second, int pixelStep, int from, int outWidth, std::uint8_t* target)
+    {
+        for (int x = from; x < outWidth; ++x)
+        {
+            int sum = 0;
+            for (int k = 0; k < NoyauxMouvement::SCALE; ++k)
+            {
+                int offset = (x * NoyauxMouvement::SCALE + k) * pixelStep;
+                sum += average(first[offset], second[offset]);
+            }
+            target[x] = static_cast<std::uint8_t>((sum + 2) >> 2);
+        }
+    }
+
+    void detectScalar(const std::uint8_t* current, const std::uint8_t* previous, std::uint8_t* background,
+        const std::uint8_t* mask, int from, int count, int threshold, int learnShift, int zoneCount, std::uint32_t* counts)
+    {
+        int frameThreshold = threshold >> 1;
+        for (int i = from; i < count; ++i)
+        {
+            int pixel = current[i];
+            int base = background[i];
+            if (mask[i] && absoluteDifference(pixel, base) > threshold && absoluteDifference(pixel, previous[i]) > frameThreshold)
+            {
+                for (int zone = 0; zone < zoneCount; ++zone)
+                {
+                    counts[zone] += (mask[i] >> zone) & 1u;
+                }
+            }
+            int learned = pixel;
+            for (int step = 0; step < learnShift; ++step)
+            {
+                learned = average(base, learned);
+            }
+            background[i] = static_cast<std::uint8_t>(learned);
+        }
+    }
+
+#ifdef MOUVEMENT_X86
+    //-----------------------------------------------------------------------------------------
+    // SSE2 : 16 pixels par itération
+    //-----------------------------------------------------------------------------------------
+
+    // Sommes de 4 pixels consécutifs (1 octet par pixel) : 4 entiers 32 bits
+    CIBLE_SSE2 inline __m128i quadSumsGray(__m128i pixels)
+    {
+        const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+        __m128i pairs = _mm_add_epi16(_mm_and_si128(pixels, lowBytes), _mm_srli_epi16(pixels, 8));
+        return _mm_madd_epi16(pairs, _mm_set1_epi16(1));
+    }
+
+    // Sommes de 4 luminances consécutives de 32 octets YUYV (16 pixels) : 4 entiers 32 bits
+    CIBLE_SSE2 inline __m128i quadSumsYuyv(__m128i first, __m128i second)
+    {
+        const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+        const __m128i ones = _mm_set1_epi16(1);
+        __m128i pairs = _mm_packs_epi32(_mm_madd_epi16(_mm_and_si128(first, lowBytes), ones),
+            _mm_madd_epi16(_mm_and_si128(second, lowBytes), ones));
+        return _mm_madd_epi16(pairs, ones);
+    }
+
+    // (somme + 2) / 4 de 16 sommes de 4 pixels, dans l'ordre
+    CIBLE_SSE2 inline __m128i packQuads(__m128i q0, __m128i q1, __m128i q2, __m128i q3)
+    {
+        const __m128i rounding = _mm_set1_epi16(2);
+        __m128i low = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(q0, q1), rounding), 2);
+        __m128i high = _mm_srli_epi16(_mm_add_epi16(_mm_packs_epi32(q2, q3), rounding), 2);
+        return _mm_packus_epi16(low, high);
+    }
+
+    CIBLE_SSE2 inline __m128i rowAverage(const std::uint8_t* first, const std::uint8_t* second, int offset)
+    {
+        return _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(first + offset)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + offset)));
+    }
+
+    CIBLE_SSE2 int downscaleGraySse2(const std::uint8_t* first, const std::uint8_t* second, int outWidth, std::uint8_t* target)
+    {
+        int x = 0;
+        for (; x + 16 <= outWidth; x += 16)
+        {
+            const int offset = x * 4;
+            __m128i result = packQuads(quadSumsGray(rowAverage(first, second, offset)),
+                quadSumsGray(rowAverage(first, second, offset + 16)),
+                quadSumsGray(rowAverage(first, second, offset + 32)),
+                quadSumsGray(rowAverage(first, second, offset + 48)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x), result);
+        }
+        return x;
+    }
+
+    CIBLE_SSE2 int downscaleYuyvSse2(const std::uint8_t* first, const std::uint8_t* second, int outWidth, std::uint8_t* target)
+    {
+        int x = 0;
+        for (; x + 16 <= outWidth; x += 16)
+        {
+            const int offset = x * 8;
+            __m128i q[4];
+            for (int block = 0; block < 4; ++block)
+            {
+                q[block] = quadSumsYuyv(rowAverage(first, second, offset + block * 32),
+                    rowAverage(first, second, offset + block * 32 + 16));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + x), packQuads(q[0], q[1], q[2], q[3]));
+        }
+        return x;
+    }
+
+    // Compteurs 8 bits par zone, vidés dans counts avant de déborder (255 itérations au plus)
+    CIBLE_SSE2 int detectSse2(const std::uint8_t* current, const std::uint8_t* previous, std::uint8_t* background,
+        const std::uint8_t* mask, int count, int threshold, int learnShift, int zoneCount, std::uint32_t* counts)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i backgroundThreshold = _mm_set1_epi8(static_cast<char>(threshold));
+        const __m128i frameThreshold = _mm_set1_epi8(static_cast<char>(threshold >> 1));
+        __m128i accumulators[NoyauxMouvement::MAX_ZONES];
+        for (int zone = 0; zone < zoneCount; ++zone)
+        {
+            accumulators[zone] = zero;
+        }
+
+        int i = 0;
+        int pending = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i));
+            __m128i before = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i));
+            __m128i base = _mm_loadu_si128(reinterpret_cast<const __m128i*>(background + i));
+            __m128i zones = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + i));
+
+            __m128i fromBackground = _mm_or_si128(_mm_subs_epu8(pixel, base), _mm_subs_epu8(base, pixel));
+            __m128i fromPrevious = _mm_or_si128(_mm_subs_epu8(pixel, before), _mm_subs_epu8(before, pixel));
+            // 0xFF là où l'écart ne dépasse pas le seuil
+            __m128i still = _mm_or_si128(_mm_cmpeq_epi8(_mm_subs_epu8(fromBackground, backgroundThreshold), zero),
+                _mm_cmpeq_epi8(_mm_subs_epu8(fromPrevious, frameThreshold), zero));
+            __m128i moving = _mm_andnot_si128(still, zones);
+            for (int zone = 0; zone < zoneCount; ++zone)
+            {
+                const __m128i bit = _mm_set1_epi8(static_cast<char>(1 << zone));
+                accumulators[zone] = _mm_sub_epi8(accumulators[zone], _mm_cmpeq_epi8(_mm_and_si128(moving, bit), bit));
+            }
+
+            __m128i learned = pixel;
+            for (int step = 0; step < learnShift; ++step)
+            {
+                learned = _mm_avg_epu8(base, learned);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(background + i), learned);
+
+            if (++pending == 255 || i + 32 > count)
+            {
+                for (int zone = 0; zone < zoneCount; ++zone)
+                {
+                    __m128i sums = _mm_sad_epu8(accumulators[zone], zero);
+                    counts[zone] += static_cast<std::uint32_t>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+                    accumulators[zone] = zero;
+                }
+                pending = 0;
+            }
+        }
+        return i;
+    }
+
+    //-----------------------------------------------------------------------------------------
+    // AVX2 : 32 pixels par itération ; les instructions de regroupement travaillant par moitié
+    // de registre, l'ordre des pixels est rétabli par une permutation
+    //-----------------------------------------------------------------------------------------
+    CIBLE_AVX2 inline __m256i quadSumsGray256(__m256i pixels)
+    {
+        const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+        __m256i pairs = _mm256_add_epi16(_mm256_and_si256(pixels, lowBytes), _mm256_srli_epi16(pixels, 8));
+        return _mm256_madd_epi16(pairs, _mm256_set1_epi16(1));
+    }
+
+    CIBLE_AVX2 inline __m256i quadSumsYuyv256(__m256i first, __m256i second)
+    {
+        const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i pairs = _mm256_packs_epi32(_mm256_madd_epi16(_mm256_and_si256(first, lowBytes), ones),
+            _mm256_madd_epi16(_mm256_and_si256(second, lowBytes), ones));
+        // Moitié basse : sommes 0, 1, 4, 5 ; moitié haute : 2, 3, 6, 7
+        return _mm256_permutevar8x32_epi32(_mm256_madd_epi16(pairs, ones), _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7));
+    }
+
+    CIBLE_AVX2 inline __m256i packQuads256(__m256i q0, __m256i q1, __m256i q2, __m256i q3)
+    {
+        const __m256i rounding = _mm256_set1_epi16(2);
+        __m256i low = _mm256_srli_epi16(_mm256_add_epi16(_mm256_packs_epi32(q0, q1), rounding), 2);
+        __m256i high = _mm256_srli_epi16(_mm256_add_epi16(_mm256_packs_epi32(q2, q3), rounding), 2);
+        // Groupes de 4 pixels dans l'ordre 0, 2, 4, 6 puis 1, 3, 5, 7
+        return _mm256_permutevar8x32_epi32(_mm256_packus_epi16(low, high), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+    }
+
+    CIBLE_AVX2 inline __m256i rowAverage256(const std::uint8_t* first, const std::uint8_t* second, int offset)
+    {
+        return _mm256_avg_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + offset)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + offset)));
+    }
+
+    CIBLE_AVX2 int downscaleGrayAvx2(const std::uint8_t* first, const std::uint8_t* second, int outWidth, std::uint8_t* target)
+    {
+        int x = 0;
+        for (; x + 32 <= outWidth; x += 32)
+        {
+            const int offset = x * 4;
+            __m256i result = packQuads256(quadSumsGray256(rowAverage256(first, second, offset)),
+                quadSumsGray256(rowAverage256(first, second, offset + 32)),
+                quadSumsGray256(rowAverage256(first, second, offset + 64)),
+                quadSumsGray256(rowAverage256(first, second, offset + 96)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x), result);
+        }
+        return x;
+    }
+
+    CIBLE_AVX2 int downscaleYuyvAvx2(const std::uint8_t* first, const std::uint8_t* second, int outWidth, std::uint8_t* target)
+    {
+        int x = 0;
+        for (; x + 32 <= outWidth; x += 32)
+        {
+            const int offset = x * 8;
+            __m256i q[4];
+            for (int block = 0; block < 4; ++block)
+            {
+                q[block] = quadSumsYuyv256(rowAverage256(first, second, offset + block * 64),
+                    rowAverage256(first, second, offset + block * 64 + 32));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x), packQuads256(q[0], q[1], q[2], q[3]));
+        }
+        return x;
+    }
+
+    CIBLE_AVX2 int detectAvx2(const std::uint8_t* current, const std::uint8_t* previous, std::uint8_t* background,
+        const std::uint8_t* mask, int count, int threshold, int learnShift, int zoneCount, std::uint32_t* counts)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i backgroundThreshold = _mm256_set1_epi8(static_cast<char>(threshold));
+        const __m256i frameThreshold = _mm256_set1_epi8(static_cast<char>(threshold >> 1));
+        __m256i accumulators[NoyauxMouvement::MAX_ZONES];
+        for (int zone = 0; zone < zoneCount; ++zone)
+        {
+            accumulators[zone] = zero;
+        }
+
+        int i = 0;
+        int pending = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            __m256i pixel = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current + i));
+            __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous + i));
+            __m256i base = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(background + i));
+            __m256i zones = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mask + i));
+
+            __m256i fromBackground = _mm256_or_si256(_mm256_subs_epu8(pixel, base), _mm256_subs_epu8(base, pixel));
+            __m256i fromPrevious = _mm256_or_si256(_mm256_subs_epu8(pixel, before), _mm256_subs_epu8(before, pixel));
+            __m256i still = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_subs_epu8(fromBackground, backgroundThreshold), zero),
+                _mm256_cmpeq_epi8(_mm256_subs_epu8(fromPrevious, frameThreshold), zero));
+            __m256i moving = _mm256_andnot_si256(still, zones);
+            for (int zone = 0; zone < zoneCount; ++zone)
+            {
+                const __m256i bit = _mm256_set1_epi8(static_cast<char>(1 << zone));
+                accumulators[zone] = _mm256_sub_epi8(accumulators[zone], _mm256_cmpeq_epi8(_mm256_and_si256(moving, bit), bit));
+            }
+
+            __m256i learned = pixel;
+            for (int step = 0; step < learnShift; ++step)
+            {
+                learned = _mm256_avg_epu8(base, learned);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(background + i), learned);
+
+            if (++pending == 255 || i + 64 > count)
+            {
+                for (int zone = 0; zone < zoneCount; ++zone)
+                {
+                    __m256i sums = _mm256_sad_epu8(accumulators[zone], zero);
+                    __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+                    counts[zone] += static_cast<std::uint32_t>(_mm_cvtsi128_si32(halves) + _mm_cvtsi128_si32(_mm_srli_si128(halves, 8)));
+                    accumulators[zone] = zero;
+                }
+                pending = 0;
+            }
+        }
+        return i;
+    }
+
+    Isa detectIsa()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        // AVX2 utilisable seulement si le système sauvegarde les registres YMM (XCR0 bits 1 et 2)
+        if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if (info[1] & (1 << 5))
+            {
+                return Isa::Avx2;
+            }
+        }
+        return Isa::Sse2;
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+        {
+            return Isa::Avx2;
+        }
+        return __builtin_cpu_supports("sse2") ? Isa::Sse2 : Isa::Scalar;
+#endif
+    }
+#else
+    Isa detectIsa()
+    {
+        return Isa::Scalar;
+    }
+#endif
+
+    // Un jeu d'instructions absent du processeur est remplacé par le meilleur disponible
+    Isa usable(Isa isa)
+    {
+        return NoyauxMouvement::supported(isa) ? isa : NoyauxMouvement::best();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions donnant le meilleur jeu d'instructions du processeur (déterminé une seule fois)
+//---------------------------------------------------------------------------------------------
+NoyauxMouvement::Isa NoyauxMouvement::best()
+{
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+bool NoyauxMouvement::supported(Isa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(best());
+}
+
+const char* NoyauxMouvement::name(Isa isa)
+{
+    switch (isa)
+    {
+    case Isa::Scalar: return "scalaire";
+    case Isa::Sse2: return "sse2";
+    case Isa::Avx2: return "avx2";
+    }
+    return "";
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de réduction par 4 d'une image
+//* Paramètres :
+//*  - const std::uint8_t* source : le premier octet de l'image
+//*  - int stride : les octets par ligne
+//*  - int width, int height : les dimensions en pixels
+//*  - std::uint8_t* target : la luminance réduite, (width / 4) x (height / 4) octets
+//*  - Isa isa : le jeu d'instructions à utiliser
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void NoyauxMouvement::downscaleGray(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target, Isa isa)
+{
+    isa = usable(isa);
+    const int outWidth = width / SCALE;
+    const int outHeight = height / SCALE;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const std::uint8_t* first = source + static_cast<std::size_t>(y * SCALE + 1) * stride;
+        const std::uint8_t* second = first + stride;
+        std::uint8_t* row = target + static_cast<std::size_t>(y) * outWidth;
+        int x = 0;
+#ifdef MOUVEMENT_X86
+        if (isa == Isa::Avx2)
+        {
+            x = downscaleGrayAvx2(first, second, outWidth, row);
+        }
+        else if (isa == Isa::Sse2)
+        {
+            x = downscaleGraySse2(first, second, outWidth, row);
+        }
+#endif
+        downscaleScalar(first, second, 1, x, outWidth, row);
+    }
+}
+
+void NoyauxMouvement::downscaleYuyv(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target, Isa isa)
+{
+    isa = usable(isa);
+    const int outWidth = width / SCALE;
+    const int outHeight = height / SCALE;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const std::uint8_t* first = source + static_cast<std::size_t>(y * SCALE + 1) * stride;
+        const std::uint8_t* second = first + stride;
+        std::uint8_t* row = target + static_cast<std::size_t>(y) * outWidth;
+        int x = 0;
+#ifdef MOUVEMENT_X86
+        if (isa == Isa::Avx2)
+        {
+            x = downscaleYuyvAvx2(first, second, outWidth, row);
+        }
+        else if (isa == Isa::Sse2)
+        {
+            x = downscaleYuyvSse2(first, second, outWidth, row);
+        }
+#endif
+        downscaleScalar(first, second, 2, x, outWidth, row);
+    }
+}
+
+// Le vert (octet 1 de 0xffRRGGBB en mémoire petit-boutiste) tient lieu de luminance
+void NoyauxMouvement::downscaleRgb32(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target)
+{
+    const int outWidth = width / SCALE;
+    const int outHeight = height / SCALE;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const std::uint8_t* first = source + static_cast<std::size_t>(y * SCALE + 1) * stride + 1;
+        downscaleScalar(first, first + stride, 4, 0, outWidth, target + static_cast<std::size_t>(y) * outWidth);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction comparant l'image réduite au fond et à l'image précédente
+//* Paramètres :
+//*  - const std::uint8_t* current, previous : les images réduites courante et précédente
+//*  - std::uint8_t* background : le fond, mis à jour
+//*  - const std::uint8_t* mask : les zones de chaque pixel (bit z pour la zone z, 0 : ignoré)
+//*  - int count : le nombre de pixels
+//*  - std::uint8_t threshold : l'écart au fond à partir duquel un pixel bouge
+//*  - int learnShift : la vitesse d'apprentissage du fond (1 / 2^learnShift par image)
+//*  - int zoneCount : le nombre de zones utilisées
+//*  - std::uint32_t counts[] : les pixels en mouvement par zone, remis à zéro au préalable
+//*  - Isa isa : le jeu d'instructions à utiliser
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void NoyauxMouvement::detect(const std::uint8_t* current, const std::uint8_t* previous, std::uint8_t* background,
+    const std::uint8_t* mask, int count, std::uint8_t threshold, int learnShift,
+    int zoneCount, std::uint32_t counts[MAX_ZONES], Isa isa)
+{
+    isa = usable(isa);
+    zoneCount = zoneCount < MAX_ZONES ? zoneCount : MAX_ZONES;
+    for (int zone = 0; zone < zoneCount; ++zone)
+    {
+        counts[zone] = 0;
+    }
+
+    int i = 0;
+#ifdef MOUVEMENT_X86
+    if (isa == Isa::Avx2)
+    {
+        i = detectAvx2(current, previous, background, mask, count, threshold, learnShift, zoneCount, counts);
+    }
+    else if (isa == Isa::Sse2)
+    {
+        i = detectSse2(current, previous, background, mask, count, threshold, learnShift, zoneCount, counts);
+    }
+#endif
+    detectScalar(current, previous, background, mask, i, count, threshold, learnShift, zoneCount, counts);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Noyaux de calcul de la détection de mouvement, sur la luminance réduite par 4 dans chaque
+//* sens (1080p -> 480x270) : réduction des images, puis comparaison de chaque pixel au fond
+//* et à l'image précédente, comptage par zone et mise à jour du fond. Chaque noyau existe en
+//* version scalaire, SSE2 et AVX2 (x86, choisie à l'exécution) ; les trois versions donnent
+//* exactement le même résultat.
+//---------------------------------------------------------------------------------------------
+class NoyauxMouvement
+{
+public:
+    enum class Isa
+    {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    static constexpr int SCALE = 4;         // Réduction dans chaque sens
+    static constexpr int MAX_ZONES = 8;     // Un bit par zone dans le masque
+
+    static Isa best();
+    static bool supported(Isa isa);
+    static const char* name(Isa isa);
+
+    // Réduction : moyenne des lignes 4y+1 et 4y+2, puis de 4 pixels consécutifs ; la cible
+    // fait (width / 4) x (height / 4) octets, sans marge
+    static void downscaleGray(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target, Isa isa);
+    static void downscaleYuyv(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target, Isa isa);
+    static void downscaleRgb32(const std::uint8_t* source, int stride, int width, int height, std::uint8_t* target);
+
+    // Un pixel bouge s'il s'écarte du fond de plus de threshold et de l'image précédente de
+    // plus de threshold / 2 (les variations lentes d'éclairage sont ignorées). counts[z]
+    // reçoit le nombre de pixels en mouvement dont le bit z du masque est levé ; le fond se
+    // rapproche de l'image courante de 1 / 2^learnShift.
+    static void detect(const std::uint8_t* current, const std::uint8_t* previous, std::uint8_t* background,
+        const std::uint8_t* mask, int count, std::uint8_t threshold, int learnShift,
+        int zoneCount, std::uint32_t counts[MAX_ZONES], Isa isa);
+};
@@ -0,0 +1,302 @@
+﻿//*********************************************************************************************
+//* Programme : OrdonnanceurCommandes.cpp                                      Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Réguler le flux de commandes vers la caméra : seules les dernières valeurs du zoom,
+//*       du déplacement et de la mise au point sont envoyées, au rythme des sockets libres,
+//*       et les arrêts passent devant tout le reste (files de priorité, Cancel).
+//* Programmes associés : ControleCamera.cpp, TransactionsVisca.cpp
+//*********************************************************************************************
+
+#include "OrdonnanceurCommandes.h"
+#include "Metriques.h"
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe OrdonnanceurCommandes
+//* Paramètres :
+//*  - TransactionsVisca& transactions : le moteur de transactions qui écrit sur le port
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+OrdonnanceurCommandes::OrdonnanceurCommandes(TransactionsVisca& transactions, QObject* parent)
+    : QObject(parent), transactions(transactions)
+{
+    clock.start();
+
+    // Un socket se libère à chaque fin de commande : on envoie alors la suivante
+    connect(&transactions, &TransactionsVisca::commandCompleted, this, &OrdonnanceurCommandes::pump);
+    connect(&transactions, &TransactionsVisca::commandFailed, this, &OrdonnanceurCommandes::pump);
+    connect(&transactions, &TransactionsVisca::inquiryCompleted, this, &OrdonnanceurCommandes::pump);
+    connect(&transactions, &TransactionsVisca::cameraReady, this, &OrdonnanceurCommandes::pump);
+}
+
+OrdonnanceurCommandes::~OrdonnanceurCommandes()
+{
+    clear();    // Les commandes restées en file ne comptent plus dans la profondeur des files
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de planifier une commande
+//* Paramètres :
+//*  - const Visca::Command& command : la commande à envoyer
+//*  - CommandClass commandClass : sa classe ; une commande en attente de la même classe et pour
+//*                                la même caméra est remplacée, en gardant sa place dans la file
+//*  - quint32 id : l'identifiant déjà réservé par TransactionsVisca::allocateId(), ou 0
+//*  - CommandPriority priority : sa file ; Automatic la déduit de la commande (priorityOf)
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction
+//---------------------------------------------------------------------------------------------
+quint32 OrdonnanceurCommandes::schedule(const Visca::Command& command, CommandClass commandClass, quint32 id,
+    CommandPriority priority)
+{
+    ++stats.scheduled;
+    Metriques::add(Metrique::Counter::Scheduled);
+    if (id == 0)
+    {
+        id = TransactionsVisca::allocateId();
+    }
+    if (priority == CommandPriority::Automatic)
+    {
+        priority = priorityOf(command);
+    }
+
+    Entry entry;
+    entry.id = id;
+    entry.commandClass = commandClass;
+    entry.command = command;
+    entry.scheduledAt = clock.nsecsElapsed();
+
+    int level = static_cast<int>(priority);
+    if (commandClass != CommandClass::None && coalesce(entry, level))
+    {
+        return id;
+    }
+
+    // Un arrêt rend caduc tout mouvement encore prévu pour cette caméra
+    if (priority == CommandPriority::Emergency)
+    {
+        preempt(command.address());
+    }
+
+    queues[level].append(entry);
+    Metriques::adjust(Metrique::Gauge::QueueDepth, 1);
+    pump();
+    return id;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction remplaçant la commande en attente de même classe et de même caméra
+//* Dans la même file, elle garde sa place ; dans une file moins prioritaire (un arrêt qui
+//* remplace un déplacement), elle en est retirée et la nouvelle commande rejoint sa propre
+//* file. Une commande plus prioritaire n'est jamais remplacée : un déplacement ne doit pas
+//* faire disparaître l'arrêt d'urgence qui le précède.
+//* Paramètres :
+//*  - const Entry& entry : la nouvelle commande
+//*  - int level : sa file
+//*
+//* Valeur de retour : bool, vrai si la commande a pris la place de l'ancienne, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool OrdonnanceurCommandes::coalesce(const Entry& entry, int level)
+{
+    for (int other = level; other < PRIORITY_COUNT; ++other)
+    {
+        QList<Entry>& queue = queues[other];
+        for (int index = 0; index < queue.size(); ++index)
+        {
+            Entry& queued = queue[index];
+            if (queued.commandClass != entry.commandClass || queued.command.address() != entry.command.address())
+            {
+                continue;
+            }
+
+            quint32 supersededId = queued.id;
+            ++stats.coalesced;
+            Metriques::add(Metrique::Counter::Coalesced);
+            if (other == level)
+            {
+                qint64 scheduledAt = queued.scheduledAt;
+                queued = entry;
+                queued.scheduledAt = scheduledAt;
+            }
+            else
+            {
+                queue.removeAt(index);
+                Metriques::adjust(Metrique::Gauge::QueueDepth, -1);
+            }
+            emit commandCoalesced(supersededId, entry.id);
+            return other == level;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction faisant place à un arrêt : les mouvements en attente pour la caméra sont
+//* abandonnés et, si ses sockets sont pris, les commandes en cours sont annulées (Cancel)
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra, ou 8 pour toute la chaîne (arrêt diffusé)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void OrdonnanceurCommandes::preempt(std::uint8_t address)
+{
+    for (int level = static_cast<int>(CommandPriority::Motion); level < PRIORITY_COUNT; ++level)
+    {
+        QList<Entry>& queue = queues[level];
+        int index = 0;
+        while (index < queue.size())
+        {
+            // Les interrogations ne déplacent pas la caméra : elles restent en file
+            std::uint8_t queued = queue.at(index).command.address();
+            if ((address != Visca::BROADCAST_ADDRESS && queued != address) || queue.at(index).command.isInquiry())
+            {
+                ++index;
+                continue;
+            }
+
+            quint32 id = queue.takeAt(index).id;
+            ++stats.preempted;
+            Metriques::add(Metrique::Counter::Preempted);
+            Metriques::adjust(Metrique::Gauge::QueueDepth, -1);
+            emit commandDropped(id, Visca::CommandCancelled);
+        }
+    }
+
+    std::uint8_t first = address == Visca::BROADCAST_ADDRESS ? 1 : address;
+    std::uint8_t last = address == Visca::BROADCAST_ADDRESS ? Visca::BROADCAST_ADDRESS - 1 : address;
+    for (std::uint8_t camera = first; camera <= last; ++camera)
+    {
+        if (!transactions.canAccept(camera))
+        {
+            stats.cancelled += static_cast<quint64>(transactions.cancel(camera));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'abandonner les commandes qui n'ont pas encore été envoyées
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void OrdonnanceurCommandes::clear()
+{
+    Metriques::adjust(Metrique::Gauge::QueueDepth, -pendingCount());
+    for (QList<Entry>& queue : queues)
+    {
+        queue.clear();
+    }
+}
+
+int OrdonnanceurCommandes::pendingCount() const
+{
+    int count = 0;
+    for (const QList<Entry>& queue : queues)
+    {
+        count += queue.size();
+    }
+    return count;
+}
+
+int OrdonnanceurCommandes::pendingCount(CommandPriority priority) const
+{
+    int level = static_cast<int>(priority);
+    return level < PRIORITY_COUNT ? queues[level].size() : 0;
+}
+
+OrdonnanceurCommandes::Counters OrdonnanceurCommandes::counters() const
+{
+    return stats;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant la file d'une commande d'après son contenu
+//* Paramètres :
+//*  - const Visca::Command& command : la commande
+//*
+//* Valeur de retour : CommandPriority, la priorité de la commande
+//---------------------------------------------------------------------------------------------
+CommandPriority OrdonnanceurCommandes::priorityOf(const Visca::Command& command)
+{
+    if (command.isStop())
+    {
+        return CommandPriority::Emergency;
+    }
+    // Diffusion de service (AddressSet, IF_Clear) et CAM_Power : 8x 01 04 00 ... ; une autre
+    // commande de diffusion (commande de groupe) est rangée d'après son contenu
+    if ((command.address() == Visca::BROADCAST_ADDRESS && (command.bytes[1] == 0x30 || command.bytes[2] == 0x00))
+        || (command.size == 6 && command.bytes[1] == 0x01 && command.bytes[2] == 0x04 && command.bytes[3] == 0x00))
+    {
+        return CommandPriority::Power;
+    }
+    if (command.isInquiry())
+    {
+        return CommandPriority::Background;
+    }
+    return CommandPriority::Motion;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction transmettant les commandes en attente tant que leurs caméras peuvent en accepter,
+//* file par file en commençant par les arrêts
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void OrdonnanceurCommandes::pump()
+{
+    bool blocked[16][2] = {};
+    transactions.holdWrites();
+
+    for (int level = 0; level < PRIORITY_COUNT; ++level)
+    {
+        QList<Entry>& queue = queues[level];
+
+        int index = 0;
+        while (index < queue.size())
+        {
+            std::uint8_t address = queue.at(index).command.address() & 0x0F;
+            bool inquiry = queue.at(index).command.isInquiry();
+
+            // Une caméra occupée garde ses commandes dans l'ordre sans retarder les autres ; une
+            // commande bloquée n'est jamais doublée par une commande moins prioritaire. Les
+            // interrogations n'occupent pas de socket : elles ont leur propre file d'attente et
+            // partent pendant un déplacement, sans jamais retenir un arrêt.
+            if (blocked[address][inquiry] || !transactions.canAccept(address, inquiry))
+            {
+                blocked[address][inquiry] = true;
+                ++index;
+                continue;
+            }
+
+            Entry entry = queue.takeAt(index);
+            ++stats.issued;
+            Metriques::adjust(Metrique::Gauge::QueueDepth, -1);
+
+            if (level == static_cast<int>(CommandPriority::Emergency))
+            {
+                qint64 delayUs = (clock.nsecsElapsed() - entry.scheduledAt) / 1000;
+                ++stats.stops;
+                stats.lastStopUs = delayUs;
+                if (delayUs > stats.maxStopUs)
+                {
+                    stats.maxStopUs = delayUs;
+                }
+                Metriques::observe(Metrique::Histogram::StopLatency, delayUs);
+            }
+
+            // Seuls les mouvements et les tâches de fond peuvent être annulés par un arrêt
+            transactions.submit(entry.command, entry.id, level >= static_cast<int>(CommandPriority::Motion));
+        }
+    }
+
+    // Tout ce qui part maintenant, pour toutes les caméras de la chaîne, tient en une écriture
+    transactions.releaseWrites();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QElapsedTimer>
+#include "Visca.h"
+#include "TransactionsVisca.h"
+
+// Classe de commande : une nouvelle valeur remplace celle encore en attente de la même classe
+enum class CommandClass
+{
+    None,           // Jamais regroupée (alimentation, initialisation, interrogations...)
+    ZoomAbsolute,
+    PanTiltDrive,
+    Focus
+};
+
+// Priorité d'une commande : une file par niveau, la plus haute est toujours servie d'abord
+enum class CommandPriority
+{
+    Emergency,      // Arrêts : passent devant tout, annulent les mouvements en cours
+    Power,          // Alimentation, initialisation, diffusion (AddressSet, IF_Clear)
+    Motion,         // Commandes de l'opérateur
+    Background,     // Interrogations de position, tournées
+    Automatic       // Déduite de la commande par priorityOf()
+};
+
+class OrdonnanceurCommandes : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Counters
+    {
+        quint64 scheduled = 0;   // Commandes reçues
+        quint64 issued = 0;      // Commandes réellement transmises à la caméra
+        quint64 coalesced = 0;   // Commandes remplacées avant envoi
+        quint64 preempted = 0;   // Commandes en attente abandonnées au profit d'un arrêt
+        quint64 cancelled = 0;   // Commandes en cours annulées (Cancel) au profit d'un arrêt
+        quint64 stops = 0;       // Arrêts transmis
+        qint64 lastStopUs = 0;   // Délai entre la planification d'un arrêt et son écriture
+        qint64 maxStopUs = 0;
+    };
+
+    static constexpr int PRIORITY_COUNT = 4;
+
+    explicit OrdonnanceurCommandes(TransactionsVisca& transactions, QObject* parent = nullptr);
+    ~OrdonnanceurCommandes();
+
+    quint32 schedule(const Visca::Command& command, CommandClass commandClass = CommandClass::None, quint32 id = 0,
+        CommandPriority priority = CommandPriority::Automatic);
+    void clear();
+
+    int pendingCount() const;
+    int pendingCount(CommandPriority priority) const;
+    Counters counters() const;
+    static CommandPriority priorityOf(const Visca::Command& command);
+
+signals:
+    void commandCoalesced(quint32 supersededId, quint32 replacementId);
+    void commandDropped(quint32 id, int errorCode);
+
+private slots:
+    void pump();
+
+private:
+    struct Entry
+    {
+        quint32 id = 0;
+        CommandClass commandClass = CommandClass::None;
+        Visca::Command command;
+        qint64 scheduledAt = 0;     // Instant de planification (ns), pour le délai des arrêts
+    };
+
+    bool coalesce(const Entry& entry, int level);
+    void preempt(std::uint8_t address);
+
+    TransactionsVisca& transactions;
+    QList<Entry> queues[PRIORITY_COUNT];
+    QElapsedTimer clock;
+    Counters stats;
+};
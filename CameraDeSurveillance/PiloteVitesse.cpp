@@ -0,0 +1,309 @@
+﻿//*********************************************************************************************
+//* Programme : PiloteVitesse.cpp                                              Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Piloter les caméras en vitesse depuis une entrée continue (touches maintenues, pupitre
+//*       réseau) : la consigne est convertie en vitesses VISCA (01 à 18 / 01 à 14), limitée au
+//*       débit de la liaison, et la caméra est arrêtée au relâchement ou si l'entrée se tait.
+//*       Le délai entre la consigne et l'écriture sur le port est mesuré.
+//* Programmes associés : ControleCamera.cpp, OrdonnanceurCommandes.cpp
+//*********************************************************************************************
+
+#include "PiloteVitesse.h"
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <cstring>
+
+namespace
+{
+    constexpr std::size_t DRIVE_SIZE = 9;       // 8x 01 06 01 VV WW 0p 0t FF
+
+    bool isStop(const Visca::Command& command)
+    {
+        return command.bytes[6] == static_cast<std::uint8_t>(Visca::PanDirection::Stop)
+            && command.bytes[7] == static_cast<std::uint8_t>(Visca::TiltDirection::Stop);
+    }
+
+    bool sameCommand(const Visca::Command& a, const Visca::Command& b)
+    {
+        return a.size == b.size && std::memcmp(a.bytes, b.bytes, a.size) == 0;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe PiloteVitesse
+//* Paramètres :
+//*  - Sender sender : la fonction qui confie une commande à l'ordonnanceur de la chaîne
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+PiloteVitesse::PiloteVitesse(Sender sender, QObject* parent)
+    : QObject(parent),
+    sender(std::move(sender)),
+    timer(this)
+{
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &PiloteVitesse::onTimeout);
+    setBaudRate(9600);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction réglant la limite de débit sur la vitesse du port : une commande Pan-tiltDrive
+//* (9 octets de 10 bits) au plus par durée de trame
+//* Paramètres :
+//*  - qint32 baudRate : la vitesse du port en bauds
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::setBaudRate(qint32 baudRate)
+{
+    if (baudRate <= 0)
+    {
+        return;
+    }
+
+    frameNs = static_cast<qint64>(DRIVE_SIZE) * 10 * 1000000000LL / baudRate;
+
+    QMutexLocker locker(&statsMutex);
+    current.budgetUs = frameNs / 1000;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction remplaçant l'horloge des consignes, de la limite de débit et de l'arrêt
+//* automatique ; un test en temps virtuel l'avance lui-même et appelle l'échéance du minuteur
+//* Paramètres :
+//*  - Clock clock : la fonction donnant l'instant courant en nanoseconde, vide pour now()
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::setClock(Clock clock)
+{
+    this->clock = clock ? std::move(clock) : Clock(&PiloteVitesse::now);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant une nouvelle consigne de vitesse ; la même consigne répétée ne renvoie rien
+//* et ne fait que repousser l'arrêt automatique
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7)
+//*  - double pan : la vitesse horizontale, -1 (gauche) à 1 (droite)
+//*  - double tilt : la vitesse verticale, -1 (bas) à 1 (haut)
+//*  - qint64 inputTime : l'instant de la saisie (PiloteVitesse::now()), 0 pour maintenant
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::setVelocity(std::uint8_t address, double pan, double tilt, qint64 inputTime)
+{
+    if (address < 1 || address >= ADDRESS_SLOTS)
+    {
+        return;
+    }
+
+    qint64 time = clock();
+    Drive& drive = drives[address];
+    drive.lastInput = time;
+
+    Visca::Command command = encode(address, pan, tilt);
+    bool stop = isStop(command);
+    bool unchanged = drive.sent.size == 0 ? stop : sameCommand(command, drive.hasPending ? drive.pending : drive.sent);
+    if (unchanged)
+    {
+        scheduleTimer();
+        return;
+    }
+
+    drive.pending = command;
+    drive.hasPending = true;
+    drive.pendingInput = inputTime > 0 ? inputTime : time;
+
+    // L'arrêt part sans attendre ; une nouvelle vitesse attend la fin de la trame précédente
+    if (stop || time - drive.lastSend >= frameNs)
+    {
+        flush(address, time);
+    }
+    scheduleTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction oubliant les consignes en cours sans rien envoyer (changement de port)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::reset()
+{
+    timer.stop();
+    for (Drive& drive : drives)
+    {
+        drive = Drive();
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée pour chaque paquet écrit sur le port : termine la mesure de délai de la
+//* consigne de sa caméra
+//* Paramètres :
+//*  - const char* data : le paquet écrit
+//*  - qint64 size : sa taille
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::noteTransmitted(const char* data, qint64 size)
+{
+    const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(data);
+    if (size != static_cast<qint64>(DRIVE_SIZE) || bytes[1] != 0x01 || bytes[2] != 0x06 || bytes[3] != 0x01)
+    {
+        return;
+    }
+
+    std::uint8_t address = bytes[0] & 0x0F;
+    if (address < 1 || address >= ADDRESS_SLOTS || drives[address].measureFrom == 0)
+    {
+        return;
+    }
+
+    qint64 delayUs = (clock() - drives[address].measureFrom) / 1000;
+    drives[address].measureFrom = 0;
+
+    QMutexLocker locker(&statsMutex);
+    ++current.samples;
+    current.lastUs = delayUs;
+    current.maxUs = qMax(current.maxUs, delayUs);
+    current.totalUs += delayUs;
+    if (delayUs > current.budgetUs)
+    {
+        ++current.overBudget;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions donnant les mesures de délai (depuis n'importe quel thread) et l'horloge monotone
+//* commune aux saisies et aux mesures, en nanosecondes
+//---------------------------------------------------------------------------------------------
+PiloteVitesse::Stats PiloteVitesse::stats() const
+{
+    QMutexLocker locker(&statsMutex);
+    return current;
+}
+
+qint64 PiloteVitesse::now()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à l'échéance du minuteur : envoie les consignes retenues par la limite de
+//* débit et arrête les caméras dont la consigne n'a pas été rafraîchie à temps
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void PiloteVitesse::onTimeout()
+{
+    qint64 time = clock();
+
+    for (std::uint8_t address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        Drive& drive = drives[address];
+
+        if (drive.moving && time - drive.lastInput >= INPUT_TIMEOUT_MS * 1000000LL)
+        {
+            drive.pending = Visca::panTiltStop(address);
+            drive.hasPending = true;
+            drive.pendingInput = time;
+            flush(address, time);
+            emit inputTimedOut(address);
+        }
+        else if (drive.hasPending && time - drive.lastSend >= frameNs)
+        {
+            flush(address, time);
+        }
+    }
+
+    scheduleTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction convertissant une consigne en commande Pan-tiltDrive ; une valeur non numérique
+//* (NaN) est traitée comme l'arrêt de l'axe
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*  - double pan, tilt : les consignes, -1 à 1
+//*
+//* Valeur de retour : Visca::Command, la commande (Pan-tiltDrive Stop si les deux axes sont à l'arrêt)
+//---------------------------------------------------------------------------------------------
+Visca::Command PiloteVitesse::encode(std::uint8_t address, double pan, double tilt)
+{
+    auto speed = [](double value, std::uint8_t max) {
+        double magnitude = (qMin(qAbs(value), 1.0) - DEAD_ZONE) / (1.0 - DEAD_ZONE);
+        return static_cast<std::uint8_t>(1 + qRound(magnitude * (max - 1)));
+    };
+
+    bool panStill = !(qAbs(pan) >= DEAD_ZONE);
+    bool tiltStill = !(qAbs(tilt) >= DEAD_ZONE);
+    if (panStill && tiltStill)
+    {
+        return Visca::panTiltStop(address);
+    }
+
+    return Visca::panTiltDrive(address,
+        panStill ? 1 : speed(pan, Visca::PAN_SPEED_MAX),
+        tiltStill ? 1 : speed(tilt, Visca::TILT_SPEED_MAX),
+        panStill ? Visca::PanDirection::Stop : (pan > 0 ? Visca::PanDirection::Right : Visca::PanDirection::Left),
+        tiltStill ? Visca::TiltDirection::Stop : (tilt > 0 ? Visca::TiltDirection::Up : Visca::TiltDirection::Down));
+}
+
+void PiloteVitesse::flush(std::uint8_t address, qint64 time)
+{
+    Drive& drive = drives[address];
+    drive.hasPending = false;
+
+    // La mesure commence avant l'envoi : un port libre écrit le paquet pendant cet appel.
+    // Classe PanTiltDrive : si la caméra est occupée, seule la dernière consigne attend.
+    drive.measureFrom = drive.pendingInput;
+    if (sender(drive.pending) == 0)
+    {
+        drive.measureFrom = 0;
+        drive.moving = false;
+        return;
+    }
+
+    drive.sent = drive.pending;
+    drive.lastSend = time;
+    drive.moving = !isStop(drive.sent);
+}
+
+void PiloteVitesse::scheduleTimer()
+{
+    qint64 next = -1;
+    for (std::uint8_t address = 1; address < ADDRESS_SLOTS; ++address)
+    {
+        const Drive& drive = drives[address];
+        if (drive.hasPending)
+        {
+            qint64 due = drive.lastSend + frameNs;
+            next = next < 0 ? due : qMin(next, due);
+        }
+        if (drive.moving)
+        {
+            qint64 due = drive.lastInput + INPUT_TIMEOUT_MS * 1000000LL;
+            next = next < 0 ? due : qMin(next, due);
+        }
+    }
+
+    if (next < 0)
+    {
+        timer.stop();
+        return;
+    }
+    timer.start(static_cast<int>(qMax<qint64>(0, (next - clock() + 999999) / 1000000)));
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QTimer>
+#include <functional>
+#include "Visca.h"
+
+// Conduite en vitesse : une consigne analogique (-1 à 1 par axe) devient une commande
+// Pan-tiltDrive, envoyée au plus une fois par durée de trame et arrêtée (03 03) au relâchement
+// ou si la consigne n'est plus rafraîchie
+class PiloteVitesse : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Confie une commande Pan-tiltDrive à l'ordonnanceur, renvoie 0 si elle n'a pas pu l'être
+    using Sender = std::function<quint32(const Visca::Command&)>;
+    // Horloge en nanosecondes : now() par défaut, une horloge virtuelle dans les tests
+    using Clock = std::function<qint64()>;
+
+    // Délai entre la consigne et l'écriture sur le port, comparé à la durée d'une trame
+    struct Stats
+    {
+        quint64 samples = 0;
+        quint64 overBudget = 0;     // Mesures supérieures à la durée d'une trame
+        qint64 lastUs = 0;
+        qint64 maxUs = 0;
+        qint64 totalUs = 0;
+        qint64 budgetUs = 0;
+    };
+
+    static constexpr int INPUT_TIMEOUT_MS = 300;    // Consigne non rafraîchie : arrêt
+    static constexpr double DEAD_ZONE = 0.05;       // En dessous, l'axe est à l'arrêt
+
+    explicit PiloteVitesse(Sender sender, QObject* parent = nullptr);
+
+    void setBaudRate(qint32 baudRate);
+    void setClock(Clock clock);
+    void setVelocity(std::uint8_t address, double pan, double tilt, qint64 inputTime = 0);
+    void reset();
+    void noteTransmitted(const char* data, qint64 size);
+
+    Stats stats() const;
+    static qint64 now();
+
+signals:
+    void inputTimedOut(quint8 address);
+
+private slots:
+    void onTimeout();
+
+private:
+    struct Drive
+    {
+        bool moving = false;
+        Visca::Command sent;            // Dernière commande confiée à l'ordonnanceur
+        Visca::Command pending;         // Consigne retenue par la limite de débit
+        bool hasPending = false;
+        qint64 pendingInput = 0;        // Horodatage de la consigne retenue (ns)
+        qint64 lastSend = 0;
+        qint64 lastInput = 0;
+        qint64 measureFrom = 0;         // Horodatage de la consigne en route vers le port, 0 si aucune
+    };
+
+    static constexpr int ADDRESS_SLOTS = 8;     // Adresses 1 à 7
+
+    static Visca::Command encode(std::uint8_t address, double pan, double tilt);
+    void flush(std::uint8_t address, qint64 time);
+    void scheduleTimer();
+
+    Sender sender;
+    Clock clock = &PiloteVitesse::now;
+    QTimer timer;
+    qint64 frameNs = 0;                 // Durée d'émission d'une commande Pan-tiltDrive
+    Drive drives[ADDRESS_SLOTS];
+    mutable QMutex statsMutex;
+    Stats current;
+};
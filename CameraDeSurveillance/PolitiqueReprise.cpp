@@ -0,0 +1,139 @@
+﻿//*********************************************************************************************
+//* Programme : PolitiqueReprise.cpp                                           Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Dire combien de temps attendre chaque réponse d'une commande VISCA et si elle peut
+//*       être renvoyée quand cette réponse ne vient pas (octets perdus sur la liaison).
+//* Programmes associés : TransactionsVisca.cpp, Visca.h
+//*********************************************************************************************
+
+#include "PolitiqueReprise.h"
+
+namespace
+{
+    bool isPanTilt(const Visca::Command& command)
+    {
+        return command.size >= 5 && command.bytes[1] == 0x01 && command.bytes[2] == 0x06;
+    }
+
+    bool isCamera(const Visca::Command& command)
+    {
+        return command.size >= 5 && command.bytes[1] == 0x01 && command.bytes[2] == 0x04;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le délai d'attente de l'ACK, ou de la réponse pour une interrogation ou une
+//* commande de diffusion (qui font le tour de la chaîne)
+//* Paramètres :
+//*  - const Visca::Command& command : la commande envoyée
+//*
+//* Valeur de retour : std::int64_t, le délai en ms
+//---------------------------------------------------------------------------------------------
+std::int64_t PolitiqueReprise::ackTimeoutMs(const Visca::Command& command)
+{
+    // Une diffusion traverse les 7 caméras de la chaîne avant de revenir
+    return command.address() == Visca::BROADCAST_ADDRESS ? 4 * ACK_TIMEOUT_MS : ACK_TIMEOUT_MS;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant le délai d'attente de la Completion après l'ACK, d'après la durée
+//* d'exécution attendue : immédiate pour les mouvements continus, plusieurs secondes pour un
+//* déplacement absolu ou le rappel d'une position, bien plus pour la mise sous tension
+//* Paramètres :
+//*  - const Visca::Command& command : la commande acceptée par la caméra
+//*
+//* Valeur de retour : std::int64_t, le délai en ms
+//---------------------------------------------------------------------------------------------
+std::int64_t PolitiqueReprise::completionTimeoutMs(const Visca::Command& command)
+{
+    if (isPanTilt(command))
+    {
+        switch (command.bytes[3])
+        {
+        case 0x01:              // Pan-tiltDrive : la Completion suit l'ACK
+            return 1000;
+        case 0x02:              // AbsolutePosition, RelativePosition : course complète à vitesse lente
+        case 0x03:
+        case 0x04:              // Home
+            return 20000;
+        case 0x05:              // Reset : aller-retour sur les deux axes
+            return 40000;
+        }
+    }
+    else if (isCamera(command))
+    {
+        switch (command.bytes[3])
+        {
+        case 0x00:              // CAM_Power : démarrage de la caméra
+            return 30000;
+        case 0x07:              // CAM_Zoom et CAM_Focus Stop/Tele/Wide : immédiats
+        case 0x08:
+            return 1000;
+        case 0x47:              // Zoom et Focus Direct : course complète de l'objectif
+        case 0x48:
+            return 8000;
+        case 0x3F:              // CAM_Memory : le rappel déplace la caméra
+            return command.bytes[4] == 0x02 ? 20000 : 2000;
+        }
+    }
+    return 3000;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction indiquant si la commande peut être renvoyée sans changer son effet quand on ne sait
+//* pas si la caméra l'a exécutée : consignes absolues, vitesses, interrogations. Un déplacement
+//* relatif exécuté deux fois irait deux fois plus loin : il n'est jamais renvoyé.
+//* Paramètres :
+//*  - const Visca::Command& command : la commande
+//*
+//* Valeur de retour : bool, vrai si la commande peut être renvoyée, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool PolitiqueReprise::isIdempotent(const Visca::Command& command)
+{
+    // AddressSet et IF_Clear ; une autre diffusion est jugée sur son contenu, comme pour une caméra
+    if (command.isInquiry() || (command.address() == Visca::BROADCAST_ADDRESS && (command.bytes[1] == 0x30 || command.bytes[2] == 0x00)))
+    {
+        return true;
+    }
+    if (isPanTilt(command))
+    {
+        return command.bytes[3] != 0x03;
+    }
+    if (isCamera(command))
+    {
+        switch (command.bytes[3])
+        {
+        case 0x00:
+        case 0x07:
+        case 0x08:
+        case 0x47:
+        case 0x48:
+        case 0x3F:
+            return true;
+        }
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant l'attente avant un nouvel essai, après un refus « tampon plein » (60 03)
+//* comme après une réponse qui n'est pas venue
+//* Paramètres :
+//*  - int attempt : le numéro de l'essai à venir (1 pour le premier renvoi)
+//*
+//* Valeur de retour : std::int64_t, l'attente en ms, doublée à chaque essai et plafonnée
+//---------------------------------------------------------------------------------------------
+std::int64_t PolitiqueReprise::backoffMs(int attempt)
+{
+    std::int64_t delay = BACKOFF_BASE_MS;
+    for (int index = 1; index < attempt && delay < BACKOFF_MAX_MS; ++index)
+    {
+        delay *= 2;
+    }
+    return delay < BACKOFF_MAX_MS ? delay : BACKOFF_MAX_MS;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include "Visca.h"
+
+//---------------------------------------------------------------------------------------------
+//* Politique de reprise des commandes VISCA sur une liaison qui perd des octets : délai
+//* d'attente de chaque réponse selon la durée d'exécution attendue de la commande, commandes
+//* qui peuvent être renvoyées sans effet de bord et attente croissante entre les essais.
+//---------------------------------------------------------------------------------------------
+class PolitiqueReprise
+{
+public:
+    static constexpr int MAX_RETRIES = 3;               // Renvois au plus après le premier essai
+    static constexpr std::int64_t ACK_TIMEOUT_MS = 300; // Envoi -> ACK ou réponse d'interrogation
+    static constexpr std::int64_t RECOVERY_TIMEOUT_MS = 500;   // IF_Clear d'une caméra -> y0 50 FF
+    static constexpr std::int64_t BACKOFF_BASE_MS = 20; // Avant chaque renvoi : 20, 40, 80 ms...
+    static constexpr std::int64_t BACKOFF_MAX_MS = 320;
+
+    static std::int64_t ackTimeoutMs(const Visca::Command& command);
+    static std::int64_t completionTimeoutMs(const Visca::Command& command);
+    static bool isIdempotent(const Visca::Command& command);
+    static std::int64_t backoffMs(int attempt);
+};
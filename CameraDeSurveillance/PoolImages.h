@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Images vidéo échangées entre le thread de capture (seul producteur) et l'aperçu (seul
+//* consommateur) sans copie : un petit nombre d'emplacements réutilisables, dont les pixels
+//* restent là où la source les a produits (tampons mmap du pilote V4L2, fichier projeté en
+//* mémoire ou tampon préalloué). Seule la dernière image publiée est gardée : une image que
+//* l'aperçu n'a pas encore prise est rendue à la capture quand une plus récente arrive.
+//---------------------------------------------------------------------------------------------
+namespace Video
+{
+    enum class PixelFormat : std::uint8_t
+    {
+        Gray8,      // Luminance seule, 1 octet par pixel
+        Yuyv,       // YUV 4:2:2 entrelacé (Y0 U Y1 V), 2 octets par pixel
+        Rgb32       // 0xffRRGGBB, 4 octets par pixel
+    };
+
+    struct Image
+    {
+        const std::uint8_t* data = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;                 // Octets par ligne
+        PixelFormat format = PixelFormat::Gray8;
+        std::int64_t captureTime = 0;   // Instant de la capture (ns, horloge monotone de PiloteVitesse::now())
+        std::uint64_t sequence = 0;     // Numéro de l'image depuis le début de la capture
+        std::int64_t captureCpuNs = 0;  // Temps processeur du thread de capture pour cette image
+    };
+}
+
+class PoolImages
+{
+public:
+    static constexpr int MAX_SLOTS = 32;
+
+    // Tous les emplacements sont d'abord chez le producteur (libres)
+    explicit PoolImages(int slotCount)
+        : count(slotCount < MAX_SLOTS ? slotCount : MAX_SLOTS),
+        freeMask(count == 32 ? 0xFFFFFFFFu : ((1u << count) - 1u))
+    {
+    }
+
+    int slotCount() const { return count; }
+
+    // Producteur : réserve un emplacement libre, -1 si l'aperçu les tient tous
+    int acquire()
+    {
+        std::uint32_t mask = freeMask.load(std::memory_order_acquire);
+        while (mask != 0)
+        {
+            int slot = lowestBit(mask);
+            if (freeMask.compare_exchange_weak(mask, mask & ~(1u << slot), std::memory_order_acquire))
+            {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+    // Producteur : description de l'image d'un emplacement réservé, à remplir avant publish()
+    Video::Image& image(int slot) { return images[slot]; }
+
+    // Producteur : rend l'image disponible ; l'image précédente encore non prise est rendue
+    // au producteur (image périmée, jamais mise en file)
+    void publish(int slot)
+    {
+        published.fetch_add(1, std::memory_order_relaxed);
+        int previous = latest.exchange(slot, std::memory_order_acq_rel);
+        if (previous >= 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            release(previous);
+        }
+    }
+
+    // Consommateur : prend la dernière image publiée, -1 s'il n'y en a pas de nouvelle
+    int take()
+    {
+        return latest.exchange(-1, std::memory_order_acq_rel);
+    }
+
+    const Video::Image& imageAt(int slot) const { return images[slot]; }
+
+    // Consommateur (ou producteur pour une image abandonnée) : l'emplacement redevient libre
+    void release(int slot)
+    {
+        freeMask.fetch_or(1u << slot, std::memory_order_release);
+    }
+
+    std::uint64_t publishedCount() const { return published.load(std::memory_order_relaxed); }
+    std::uint64_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static int lowestBit(std::uint32_t mask)
+    {
+        int bit = 0;
+        while ((mask & 1u) == 0)
+        {
+            mask >>= 1;
+            ++bit;
+        }
+        return bit;
+    }
+
+    const int count;
+    Video::Image images[MAX_SLOTS];
+    alignas(64) std::atomic<std::uint32_t> freeMask;
+    alignas(64) std::atomic<int> latest{ -1 };
+    alignas(64) std::atomic<std::uint64_t> published{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+};
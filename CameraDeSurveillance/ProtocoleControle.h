@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Protocole binaire du serveur de commande (ServeurControle), entiers en petit-boutiste.
+//*
+//* Requête : u16 longueur | u8 opération | u8 port | u8 adresse | u32 étiquette | paramètres
+//* Réponse : u16 longueur | u8 opération|0x80 | u8 statut | u32 étiquette | données
+//* Évènement : u16 longueur | u8 évènement | données
+//*
+//* La longueur compte les octets qui la suivent. L'étiquette est choisie par le client et
+//* renvoyée telle quelle ; une commande acceptée répond avec l'identifiant de sa transaction
+//* (u32), dont l'aboutissement est ensuite signalé par un évènement.
+//---------------------------------------------------------------------------------------------
+namespace ProtocoleControle
+{
+    constexpr std::size_t LENGTH_SIZE = 2;
+    constexpr std::size_t REQUEST_HEADER = 7;       // opération, port, adresse, étiquette
+    constexpr std::size_t MAX_FRAME = 256;          // Longueur maximale d'une trame (hors longueur)
+    constexpr std::uint8_t REPLY_FLAG = 0x80;
+
+    enum class Operation : std::uint8_t
+    {
+        Drive = 0x01,           // u8 vitesse pan, u8 vitesse tilt, u8 sens pan, u8 sens tilt (Visca)
+        Stop = 0x02,
+        Zoom = 0x03,            // u16 position (0 à 0x4000)
+        Focus = 0x04,           // u16 position
+        Absolute = 0x05,        // i16 pan, i16 tilt, u8 vitesse pan, u8 vitesse tilt
+        Preset = 0x06,          // nom de la position (UTF-8, reste de la trame)
+        Memory = 0x07,          // u8 mémoire de la caméra (0 à 15)
+        StartTour = 0x08,       // nom de la tournée (UTF-8, reste de la trame)
+        StopTour = 0x09,
+        Velocity = 0x0A,        // i8 pan, i8 tilt (-100 à 100 %) ; à renvoyer au moins toutes les
+                                // 300 ms tant que la conduite dure, sinon la caméra s'arrête
+        State = 0x10,           // Réponse : état (voir Event::State, sans port ni adresse)
+        Cameras = 0x11,         // Réponse : u8 nombre puis (u8 port, u8 adresse) par caméra
+        Subscribe = 0x12,       // u8 1 pour recevoir les évènements State, 0 pour les arrêter
+        GroupMemory = 0x13      // u8 mémoire (0 à 15) puis nom du groupe (UTF-8), port et
+                                // adresse ignorés : tout le groupe rappelle sa position mémoire
+    };
+
+    enum class Status : std::uint8_t
+    {
+        Ok = 0,
+        UnknownCamera = 1,
+        BadRequest = 2,
+        Busy = 3,               // Trop de commandes en cours, ou d'opérations sans transaction
+                                // (Preset, tournées, Velocity, GroupMemory) plus d'une par 10 ms
+                                // en moyenne, pour ce client : réessayer plus tard
+        Failed = 4
+    };
+
+    enum class Event : std::uint8_t
+    {
+        Completed = 0xC0,       // u32 transaction
+        Failed = 0xC1,          // u32 transaction, i32 code d'erreur
+        Coalesced = 0xC2,       // u32 transaction remplacée, u32 transaction qui la remplace
+        State = 0xC3            // u8 port, u8 adresse, u8 drapeaux (1 valide, 2 en mouvement),
+                                // i16 pan, i16 tilt, u16 zoom
+    };
+}
@@ -0,0 +1,925 @@
+﻿//*********************************************************************************************
+//* Programme : ServeurControle.cpp                                            Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Exposer les caméras du gestionnaire aux pupitres de la salle de contrôle, en TCP
+//*       (trames binaires de ProtocoleControle.h) et en WebSocket (messages JSON). Chaque
+//*       client a un nombre borné de commandes en cours et de données en attente d'envoi :
+//*       un client trop rapide est freiné, un client qui ne lit plus est déconnecté.
+//* Programmes associés : GestionnaireCameras.cpp, ProtocoleControle.h, main.cpp
+//*********************************************************************************************
+
+#include "ServeurControle.h"
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QWebSocket>
+#include <QWebSocketServer>
+#include <QtEndian>
+#include <QDebug>
+
+using ProtocoleControle::Operation;
+using ProtocoleControle::Status;
+using ProtocoleControle::Event;
+
+namespace
+{
+    // Noms JSON des opérations, dans l'ordre de leur recherche
+    struct OperationName
+    {
+        const char* name;
+        Operation op;
+    };
+
+    const OperationName OPERATION_NAMES[] = {
+        { "drive", Operation::Drive },
+        { "stop", Operation::Stop },
+        { "zoom", Operation::Zoom },
+        { "focus", Operation::Focus },
+        { "absolute", Operation::Absolute },
+        { "preset", Operation::Preset },
+        { "memory", Operation::Memory },
+        { "tour", Operation::StartTour },
+        { "stopTour", Operation::StopTour },
+        { "velocity", Operation::Velocity },
+        { "state", Operation::State },
+        { "cameras", Operation::Cameras },
+        { "subscribe", Operation::Subscribe },
+        { "groupMemory", Operation::GroupMemory }
+    };
+
+    // Indexé par Status
+    const char* const STATUS_NAMES[] = { "ok", "unknownCamera", "badRequest", "busy", "failed" };
+
+    template <typename T>
+    void put(QByteArray& frame, T value)
+    {
+        char bytes[sizeof(T)];
+        qToLittleEndian(value, bytes);
+        frame.append(bytes, sizeof(T));
+    }
+
+    template <typename T>
+    T get(const QByteArray& frame, int offset)
+    {
+        return qFromLittleEndian<T>(frame.constData() + offset);
+    }
+
+    // Ajoute la longueur en tête d'une trame
+    QByteArray withLength(const QByteArray& body)
+    {
+        QByteArray frame;
+        frame.reserve(static_cast<int>(ProtocoleControle::LENGTH_SIZE) + body.size());
+        put<quint16>(frame, static_cast<quint16>(body.size()));
+        frame.append(body);
+        return frame;
+    }
+
+    void putState(QByteArray& frame, const CameraState& state)
+    {
+        put<quint8>(frame, static_cast<quint8>((state.valid ? 1 : 0) | (state.moving ? 2 : 0)));
+        put<qint16>(frame, state.pan);
+        put<qint16>(frame, state.tilt);
+        put<quint16>(frame, state.zoom);
+    }
+
+    QJsonObject stateObject(const CameraId& camera, const CameraState& state)
+    {
+        QJsonObject object;
+        object.insert("port", camera.port);
+        object.insert("address", camera.address);
+        object.insert("valid", state.valid);
+        object.insert("moving", state.moving);
+        object.insert("pan", state.pan);
+        object.insert("tilt", state.tilt);
+        object.insert("zoom", state.zoom);
+        return object;
+    }
+
+    int stateKey(const CameraId& camera)
+    {
+        return camera.port * 16 + camera.address;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe ServeurControle
+//* Paramètres :
+//*  - GestionnaireCameras& gestionnaire : les chaînes de caméras à exposer
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+ServeurControle::ServeurControle(GestionnaireCameras& gestionnaire, QObject* parent)
+    : QObject(parent),
+    gestionnaire(gestionnaire)
+{
+    clock.start();
+    connect(&gestionnaire, &GestionnaireCameras::commandCompleted, this, &ServeurControle::onCommandCompleted);
+    connect(&gestionnaire, &GestionnaireCameras::commandFailed, this, &ServeurControle::onCommandFailed);
+    connect(&gestionnaire, &GestionnaireCameras::commandCoalesced, this, &ServeurControle::onCommandCoalesced);
+    connect(&gestionnaire, &GestionnaireCameras::stateChanged, this, &ServeurControle::onStateChanged);
+}
+
+ServeurControle::~ServeurControle()
+{
+    for (Client* client : clients)
+    {
+        delete client;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'ouvrir les ports d'écoute
+//* Paramètres :
+//*  - quint16 tcpPort : le port TCP du protocole binaire (0 = pas d'écoute TCP)
+//*  - quint16 webSocketPort : le port WebSocket du protocole JSON (0 = pas d'écoute WebSocket)
+//*
+//* Valeur de retour : bool, vrai si les écoutes demandées sont ouvertes, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ServeurControle::listen(quint16 tcpPort, quint16 webSocketPort)
+{
+    if (tcpPort != 0)
+    {
+        tcpServer = new QTcpServer(this);
+        tcpServer->setMaxPendingConnections(MAX_CLIENTS);
+        connect(tcpServer, &QTcpServer::newConnection, this, &ServeurControle::onTcpConnection);
+        if (!tcpServer->listen(QHostAddress::Any, tcpPort))
+        {
+            qDebug() << "Écoute TCP impossible sur le port" << tcpPort << ":" << tcpServer->errorString();
+            return false;
+        }
+    }
+
+    if (webSocketPort != 0)
+    {
+        webSocketServer = new QWebSocketServer("CameraDeSurveillance", QWebSocketServer::NonSecureMode, this);
+        webSocketServer->setMaxPendingConnections(MAX_CLIENTS);
+        connect(webSocketServer, &QWebSocketServer::newConnection, this, &ServeurControle::onWebSocketConnection);
+        if (!webSocketServer->listen(QHostAddress::Any, webSocketPort))
+        {
+            qDebug() << "Écoute WebSocket impossible sur le port" << webSocketPort << ":" << webSocketServer->errorString();
+            return false;
+        }
+    }
+
+    return tcpServer || webSocketServer;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions appelées à l'arrivée d'un client ; au-delà de MAX_CLIENTS il est refusé
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onTcpConnection()
+{
+    while (tcpServer->hasPendingConnections())
+    {
+        QTcpSocket* socket = tcpServer->nextPendingConnection();
+        if (clients.size() >= MAX_CLIENTS)
+        {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        // Tampon de lecture plafonné : un client en attente n'est plus lu, TCP freine l'émetteur
+        socket->setReadBufferSize(MAX_READ_BUFFER);
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        Client* client = addClient(socket, nullptr);
+        connect(socket, &QTcpSocket::readyRead, this, [this, client]() { onTcpReadyRead(client); });
+        connect(socket, &QTcpSocket::bytesWritten, this, [this, client](qint64 bytes) { onBytesWritten(client, bytes); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, client]() { removeClient(client); });
+    }
+}
+
+void ServeurControle::onWebSocketConnection()
+{
+    while (webSocketServer->hasPendingConnections())
+    {
+        QWebSocket* socket = webSocketServer->nextPendingConnection();
+        if (clients.size() >= MAX_CLIENTS)
+        {
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        socket->setReadBufferSize(MAX_READ_BUFFER);
+
+        Client* client = addClient(nullptr, socket);
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, client](const QString& message) {
+            onWebSocketMessage(client, message);
+        });
+        connect(socket, &QWebSocket::bytesWritten, this, [this, client](qint64 bytes) { onBytesWritten(client, bytes); });
+        connect(socket, &QWebSocket::disconnected, this, [this, client]() { removeClient(client); });
+    }
+}
+
+ServeurControle::Client* ServeurControle::addClient(QTcpSocket* tcp, QWebSocket* web)
+{
+    Client* client = new Client();
+    client->tcp = tcp;
+    client->web = web;
+    clients.append(client);
+    return client;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à la déconnexion d'un client : ses transactions en cours sont oubliées,
+//* elles se terminent normalement côté caméra
+//* Paramètres :
+//*  - Client* client : le client
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::removeClient(Client* client)
+{
+    if (!clients.removeOne(client))
+    {
+        return;
+    }
+
+    for (auto it = owners.begin(); it != owners.end(); )
+    {
+        if (it.value() == client)
+        {
+            it = owners.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    QObject* socket = client->tcp ? static_cast<QObject*>(client->tcp) : static_cast<QObject*>(client->web);
+    socket->disconnect(this);
+    socket->deleteLater();
+    delete client;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction traitant les trames TCP reçues. Tant que le client a MAX_IN_FLIGHT commandes en
+//* cours, ses octets restent dans la socket ; la lecture reprend à l'aboutissement de l'une
+//* d'elles.
+//* Paramètres :
+//*  - Client* client : le client
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onTcpReadyRead(Client* client)
+{
+    const int lengthSize = static_cast<int>(ProtocoleControle::LENGTH_SIZE);
+
+    while (!client->closing && client->inFlight < MAX_IN_FLIGHT)
+    {
+        quint16 length = client->input.size() >= lengthSize ? get<quint16>(client->input, 0) : 0;
+        if (client->input.size() >= lengthSize
+            && (length < ProtocoleControle::REQUEST_HEADER || length > ProtocoleControle::MAX_FRAME))
+        {
+            // Découpage perdu : on ne peut pas se resynchroniser sur ce flux
+            qDebug() << "Client TCP" << client->tcp->peerAddress().toString() << ": trame invalide";
+            client->closing = true;
+            client->tcp->abort();
+            return;
+        }
+
+        if (client->input.size() < lengthSize || client->input.size() < lengthSize + length)
+        {
+            QByteArray received = client->tcp->read(MAX_READ_BUFFER);
+            if (received.isEmpty())
+            {
+                return;
+            }
+            client->input.append(received);
+            continue;
+        }
+
+        QByteArray frame = client->input.mid(lengthSize, length);
+        client->input.remove(0, lengthSize + length);
+
+        Request request;
+        if (decodeFrame(frame, request))
+        {
+            reply(client, request, execute(client, request));
+        }
+        else
+        {
+            Response response;
+            response.status = Status::BadRequest;
+            reply(client, request, response);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction traitant un message JSON ; un client WebSocket ne peut pas être freiné par sa
+//* socket, au-delà de MAX_IN_FLIGHT ses commandes reçoivent le statut "busy"
+//* Paramètres :
+//*  - Client* client : le client
+//*  - const QString& message : le message reçu
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onWebSocketMessage(Client* client, const QString& message)
+{
+    if (client->closing)
+    {
+        return;
+    }
+
+    Request request;
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(message.toUtf8(), &error);
+    if (error.error == QJsonParseError::NoError && document.isObject() && decodeJson(document.object(), request))
+    {
+        reply(client, request, execute(client, request));
+    }
+    else
+    {
+        Response response;
+        response.status = Status::BadRequest;
+        reply(client, request, response);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction exécutant une requête décodée, quel que soit son protocole
+//* Paramètres :
+//*  - Client* client : le client demandeur
+//*  - const Request& request : la requête
+//*
+//* Valeur de retour : Response, le statut et l'identifiant de la transaction éventuelle
+//---------------------------------------------------------------------------------------------
+ServeurControle::Response ServeurControle::execute(Client* client, const Request& request)
+{
+    Response response;
+
+    if (request.op == Operation::Cameras)
+    {
+        return response;
+    }
+    if (request.op == Operation::Subscribe)
+    {
+        client->subscribed = request.enable;
+        client->pendingStates.clear();
+        return response;
+    }
+    if ((request.op == Operation::Preset || request.op == Operation::StartTour || request.op == Operation::StopTour
+            || request.op == Operation::Velocity || request.op == Operation::GroupMemory)
+        && !admitUntracked(client))
+    {
+        response.status = Status::Busy;
+        return response;
+    }
+    if (request.op == Operation::GroupMemory)
+    {
+        // Sans suivi par le client : une diffusion par chaîne complète, sinon une par caméra
+        if (gestionnaire.sendGroup(request.name, Visca::memoryRecall(1, request.memory)).isEmpty())
+        {
+            response.status = Status::UnknownCamera;
+        }
+        return response;
+    }
+    if (!gestionnaire.contains(request.camera))
+    {
+        response.status = Status::UnknownCamera;
+        return response;
+    }
+
+    quint8 address = request.camera.address;
+    Visca::Command command;
+    CommandClass commandClass = CommandClass::None;
+
+    switch (request.op)
+    {
+    case Operation::Drive:
+        command = Visca::panTiltDrive(address, request.panSpeed, request.tiltSpeed, request.panDirection, request.tiltDirection);
+        commandClass = CommandClass::PanTiltDrive;
+        break;
+    case Operation::Stop:
+        command = Visca::panTiltStop(address);
+        commandClass = CommandClass::PanTiltDrive;
+        break;
+    case Operation::Zoom:
+        command = Visca::zoomDirect(address, qMin<quint16>(request.position, 0x4000));
+        commandClass = CommandClass::ZoomAbsolute;
+        break;
+    case Operation::Focus:
+        command = Visca::focusDirect(address, request.position);
+        commandClass = CommandClass::Focus;
+        break;
+    case Operation::Absolute:
+        command = Visca::absolutePosition(address, request.panSpeed, request.tiltSpeed,
+            static_cast<quint16>(request.pan), static_cast<quint16>(request.tilt));
+        commandClass = CommandClass::PanTiltDrive;
+        break;
+    case Operation::Memory:
+        command = Visca::memoryRecall(address, request.memory);
+        break;
+    case Operation::Preset:
+        gestionnaire.gotoPreset(request.camera, request.name);
+        return response;
+    case Operation::StartTour:
+        gestionnaire.startTour(request.camera, request.name);
+        return response;
+    case Operation::StopTour:
+        gestionnaire.stopTour(request.camera);
+        return response;
+    case Operation::Velocity:
+        // Sans transaction : les consignes répétées ne font que prolonger la conduite
+        gestionnaire.setVelocity(request.camera, request.panRate, request.tiltRate);
+        return response;
+    default:
+        // Operation::State : lue dans le cache au moment de la réponse
+        return response;
+    }
+
+    if (client->inFlight >= MAX_IN_FLIGHT)
+    {
+        response.status = Status::Busy;
+        return response;
+    }
+
+    response.id = gestionnaire.send(request.camera, command, commandClass);
+    if (response.id == 0)
+    {
+        response.status = Status::Failed;
+        return response;
+    }
+
+    owners.insert(response.id, client);
+    ++client->inFlight;
+    return response;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction limitant les opérations sans transaction (position nommée, tournée, conduite en
+//* vitesse, mémoire de groupe) : rien ne signale leur fin, elles ne peuvent pas compter dans
+//* inFlight. Elles sont refusées tant que le client a MAX_IN_FLIGHT commandes en cours, et
+//* au-delà d'une rafale de MAX_IN_FLIGHT, d'une par UNTRACKED_INTERVAL_MS.
+//* Paramètres :
+//*  - Client* client : le client demandeur
+//*
+//* Valeur de retour : bool, vrai si l'opération peut être exécutée, faux pour répondre "busy"
+//---------------------------------------------------------------------------------------------
+bool ServeurControle::admitUntracked(Client* client)
+{
+    qint64 now = clock.elapsed();
+    qint64 next = qMax(client->untrackedAt, now);
+
+    if (client->inFlight >= MAX_IN_FLIGHT || next - now >= MAX_IN_FLIGHT * UNTRACKED_INTERVAL_MS)
+    {
+        return false;
+    }
+    client->untrackedAt = next + UNTRACKED_INTERVAL_MS;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de décodage d'une requête binaire ou JSON
+//* Paramètres :
+//*  - const QByteArray& frame / const QJsonObject& object : la requête reçue
+//*  - Request& request : la requête décodée (opération et étiquette sont remplies même si
+//*    la suite est invalide, pour pouvoir répondre)
+//*
+//* Valeur de retour : bool, vrai si la requête est complète et valide, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ServeurControle::decodeFrame(const QByteArray& frame, Request& request) const
+{
+    const int header = static_cast<int>(ProtocoleControle::REQUEST_HEADER);
+    request.op = static_cast<Operation>(static_cast<quint8>(frame.at(0)));
+    request.camera.port = static_cast<quint8>(frame.at(1));
+    request.camera.address = static_cast<quint8>(frame.at(2));
+    request.tag = get<quint32>(frame, 3);
+
+    int payload = frame.size() - header;
+    switch (request.op)
+    {
+    case Operation::Drive:
+    {
+        if (payload < 4)
+        {
+            return false;
+        }
+        quint8 pan = static_cast<quint8>(frame.at(header + 2));
+        quint8 tilt = static_cast<quint8>(frame.at(header + 3));
+        if (pan < 1 || pan > 3 || tilt < 1 || tilt > 3)
+        {
+            return false;
+        }
+        request.panSpeed = static_cast<quint8>(frame.at(header));
+        request.tiltSpeed = static_cast<quint8>(frame.at(header + 1));
+        request.panDirection = static_cast<Visca::PanDirection>(pan);
+        request.tiltDirection = static_cast<Visca::TiltDirection>(tilt);
+        return true;
+    }
+    case Operation::Zoom:
+    case Operation::Focus:
+        if (payload < 2)
+        {
+            return false;
+        }
+        request.position = get<quint16>(frame, header);
+        return true;
+    case Operation::Absolute:
+        if (payload < 6)
+        {
+            return false;
+        }
+        request.pan = get<qint16>(frame, header);
+        request.tilt = get<qint16>(frame, header + 2);
+        request.panSpeed = static_cast<quint8>(frame.at(header + 4));
+        request.tiltSpeed = static_cast<quint8>(frame.at(header + 5));
+        return true;
+    case Operation::Memory:
+        if (payload < 1 || static_cast<quint8>(frame.at(header)) >= Visca::MEMORY_COUNT)
+        {
+            return false;
+        }
+        request.memory = static_cast<quint8>(frame.at(header));
+        return true;
+    case Operation::GroupMemory:
+        if (payload < 2 || static_cast<quint8>(frame.at(header)) >= Visca::MEMORY_COUNT)
+        {
+            return false;
+        }
+        request.memory = static_cast<quint8>(frame.at(header));
+        request.name = QString::fromUtf8(frame.constData() + header + 1, payload - 1);
+        return true;
+    case Operation::Subscribe:
+        if (payload < 1)
+        {
+            return false;
+        }
+        request.enable = frame.at(header) != 0;
+        return true;
+    case Operation::Velocity:
+        if (payload < 2)
+        {
+            return false;
+        }
+        request.panRate = static_cast<qint8>(frame.at(header)) / 100.0;
+        request.tiltRate = static_cast<qint8>(frame.at(header + 1)) / 100.0;
+        return true;
+    case Operation::Preset:
+    case Operation::StartTour:
+        request.name = QString::fromUtf8(frame.constData() + header, payload);
+        return !request.name.isEmpty();
+    case Operation::Stop:
+    case Operation::StopTour:
+    case Operation::State:
+    case Operation::Cameras:
+        return true;
+    }
+    return false;
+}
+
+bool ServeurControle::decodeJson(const QJsonObject& object, Request& request) const
+{
+    request.tag = static_cast<quint32>(object.value("tag").toDouble());
+    request.camera.port = object.value("port").toInt(0);
+    request.camera.address = static_cast<quint8>(object.value("address").toInt(1));
+
+    QString name = object.value("op").toString();
+    bool known = false;
+    for (const OperationName& operation : OPERATION_NAMES)
+    {
+        if (name == QLatin1String(operation.name))
+        {
+            request.op = operation.op;
+            known = true;
+            break;
+        }
+    }
+    if (!known)
+    {
+        return false;
+    }
+
+    switch (request.op)
+    {
+    case Operation::Drive:
+    {
+        QString pan = object.value("pan").toString();
+        QString tilt = object.value("tilt").toString();
+        request.panDirection = pan == "left" ? Visca::PanDirection::Left
+            : pan == "right" ? Visca::PanDirection::Right : Visca::PanDirection::Stop;
+        request.tiltDirection = tilt == "up" ? Visca::TiltDirection::Up
+            : tilt == "down" ? Visca::TiltDirection::Down : Visca::TiltDirection::Stop;
+        request.panSpeed = static_cast<quint8>(object.value("panSpeed").toInt(Visca::PAN_SPEED_MAX / 2));
+        request.tiltSpeed = static_cast<quint8>(object.value("tiltSpeed").toInt(Visca::TILT_SPEED_MAX / 2));
+        return true;
+    }
+    case Operation::Zoom:
+    case Operation::Focus:
+        if (!object.value("position").isDouble())
+        {
+            return false;
+        }
+        request.position = static_cast<quint16>(qBound(0, object.value("position").toInt(), 0xFFFF));
+        return true;
+    case Operation::Absolute:
+        request.pan = static_cast<qint16>(object.value("pan").toInt());
+        request.tilt = static_cast<qint16>(object.value("tilt").toInt());
+        request.panSpeed = static_cast<quint8>(object.value("panSpeed").toInt(Visca::PAN_SPEED_MAX));
+        request.tiltSpeed = static_cast<quint8>(object.value("tiltSpeed").toInt(Visca::TILT_SPEED_MAX));
+        return true;
+    case Operation::Memory:
+    case Operation::GroupMemory:
+    {
+        int memory = object.value("memory").toInt(-1);
+        if (memory < 0 || memory >= Visca::MEMORY_COUNT)
+        {
+            return false;
+        }
+        request.memory = static_cast<quint8>(memory);
+        request.name = object.value("name").toString();
+        return request.op == Operation::Memory || !request.name.isEmpty();
+    }
+    case Operation::Subscribe:
+        request.enable = object.value("enable").toBool(true);
+        return true;
+    case Operation::Velocity:
+        request.panRate = qBound(-1.0, object.value("pan").toDouble(), 1.0);
+        request.tiltRate = qBound(-1.0, object.value("tilt").toDouble(), 1.0);
+        return true;
+    case Operation::Preset:
+    case Operation::StartTour:
+        request.name = object.value("name").toString();
+        return !request.name.isEmpty();
+    default:
+        return true;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction envoyant la réponse à une requête dans le protocole du client
+//* Paramètres :
+//*  - Client* client : le client
+//*  - const Request& request : la requête
+//*  - const Response& response : son résultat
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::reply(Client* client, const Request& request, const Response& response)
+{
+    bool ok = response.status == Status::Ok;
+
+    if (client->tcp)
+    {
+        QByteArray body;
+        put<quint8>(body, static_cast<quint8>(static_cast<quint8>(request.op) | ProtocoleControle::REPLY_FLAG));
+        put<quint8>(body, static_cast<quint8>(response.status));
+        put<quint32>(body, request.tag);
+
+        if (ok && request.op == Operation::State)
+        {
+            putState(body, gestionnaire.state(request.camera));
+        }
+        else if (ok && request.op == Operation::Cameras)
+        {
+            QList<CameraId> cameras = gestionnaire.cameras();
+            put<quint8>(body, static_cast<quint8>(cameras.size()));
+            for (const CameraId& camera : cameras)
+            {
+                put<quint8>(body, static_cast<quint8>(camera.port));
+                put<quint8>(body, camera.address);
+            }
+        }
+        else if (response.id != 0)
+        {
+            put<quint32>(body, response.id);
+        }
+        sendFrame(client, withLength(body));
+        return;
+    }
+
+    QJsonObject object;
+    object.insert("tag", static_cast<double>(request.tag));
+    object.insert("status", STATUS_NAMES[static_cast<int>(response.status)]);
+
+    if (ok && request.op == Operation::State)
+    {
+        object.insert("state", stateObject(request.camera, gestionnaire.state(request.camera)));
+    }
+    else if (ok && request.op == Operation::Cameras)
+    {
+        QJsonArray cameras;
+        for (const CameraId& camera : gestionnaire.cameras())
+        {
+            QJsonObject entry;
+            entry.insert("port", camera.port);
+            entry.insert("address", camera.address);
+            cameras.append(entry);
+        }
+        object.insert("cameras", cameras);
+    }
+    else if (response.id != 0)
+    {
+        object.insert("id", static_cast<double>(response.id));
+    }
+    sendJson(client, object);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions appelées à l'aboutissement d'une transaction : l'évènement n'est envoyé qu'au
+//* client qui l'a demandée, qui peut alors en lancer une autre
+//* Paramètres :
+//*  - int port : la chaîne de la caméra
+//*  - quint32 id : l'identifiant de la transaction
+//*  - int errorCode : le code d'erreur VISCA (échec)
+//*  - quint32 supersededId, replacementId : la commande remplacée et sa remplaçante
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onCommandCompleted(int port, quint32 id)
+{
+    Q_UNUSED(port);
+    QByteArray body;
+    put<quint8>(body, static_cast<quint8>(Event::Completed));
+    put<quint32>(body, id);
+
+    QJsonObject event;
+    event.insert("event", "completed");
+    event.insert("id", static_cast<double>(id));
+    finishTransaction(id, withLength(body), event);
+}
+
+void ServeurControle::onCommandFailed(int port, quint32 id, int errorCode)
+{
+    Q_UNUSED(port);
+    QByteArray body;
+    put<quint8>(body, static_cast<quint8>(Event::Failed));
+    put<quint32>(body, id);
+    put<qint32>(body, errorCode);
+
+    QJsonObject event;
+    event.insert("event", "failed");
+    event.insert("id", static_cast<double>(id));
+    event.insert("code", errorCode);
+    finishTransaction(id, withLength(body), event);
+}
+
+void ServeurControle::onCommandCoalesced(int port, quint32 supersededId, quint32 replacementId)
+{
+    Q_UNUSED(port);
+    QByteArray body;
+    put<quint8>(body, static_cast<quint8>(Event::Coalesced));
+    put<quint32>(body, supersededId);
+    put<quint32>(body, replacementId);
+
+    QJsonObject event;
+    event.insert("event", "coalesced");
+    event.insert("id", static_cast<double>(supersededId));
+    event.insert("by", static_cast<double>(replacementId));
+    finishTransaction(supersededId, withLength(body), event);
+}
+
+void ServeurControle::finishTransaction(quint32 id, const QByteArray& frame, const QJsonObject& event)
+{
+    Client* client = owners.take(id);
+    if (!client)
+    {
+        return;
+    }
+
+    --client->inFlight;
+    if (client->tcp)
+    {
+        sendFrame(client, frame);
+        onTcpReadyRead(client);
+    }
+    else
+    {
+        sendJson(client, event);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction diffusant un nouvel état aux clients abonnés ; pour un client dont la socket est
+//* encombrée, seul le dernier état de chaque caméra est gardé et envoyé une fois dégagée
+//* Paramètres :
+//*  - const CameraId& camera : la caméra
+//*  - const CameraState& state : son état
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onStateChanged(const CameraId& camera, const CameraState& state)
+{
+    for (Client* client : clients)
+    {
+        if (!client->subscribed || client->closing)
+        {
+            continue;
+        }
+        if (client->pendingOutput > CONGESTED_OUTPUT)
+        {
+            client->pendingStates.insert(stateKey(camera), state);
+        }
+        else
+        {
+            sendState(client, camera, state);
+        }
+    }
+}
+
+void ServeurControle::sendState(Client* client, const CameraId& camera, const CameraState& state)
+{
+    if (client->tcp)
+    {
+        QByteArray body;
+        put<quint8>(body, static_cast<quint8>(Event::State));
+        put<quint8>(body, static_cast<quint8>(camera.port));
+        put<quint8>(body, camera.address);
+        putState(body, state);
+        sendFrame(client, withLength(body));
+    }
+    else
+    {
+        QJsonObject event = stateObject(camera, state);
+        event.insert("event", "state");
+        sendJson(client, event);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée quand la socket d'un client a écrit des octets : une fois la congestion
+//* résorbée, les états retenus sont envoyés
+//* Paramètres :
+//*  - Client* client : le client
+//*  - qint64 bytes : le nombre d'octets écrits
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurControle::onBytesWritten(Client* client, qint64 bytes)
+{
+    client->pendingOutput = qMax<qint64>(0, client->pendingOutput - bytes);
+
+    if (client->pendingOutput <= CONGESTED_OUTPUT && !client->pendingStates.isEmpty())
+    {
+        QHash<int, CameraState> states;
+        states.swap(client->pendingStates);
+        for (auto it = states.cbegin(); it != states.cend(); ++it)
+        {
+            CameraId camera;
+            camera.port = it.key() / 16;
+            camera.address = static_cast<quint8>(it.key() % 16);
+            sendState(client, camera, it.value());
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions d'envoi : les octets confiés à la socket sont comptés, un client qui laisse
+//* dépasser MAX_OUTPUT est déconnecté (après la fin du traitement en cours)
+//---------------------------------------------------------------------------------------------
+void ServeurControle::sendFrame(Client* client, const QByteArray& frame)
+{
+    if (!client->closing)
+    {
+        client->tcp->write(frame);
+        account(client, frame.size());
+    }
+}
+
+void ServeurControle::sendJson(Client* client, const QJsonObject& object)
+{
+    if (!client->closing)
+    {
+        account(client, client->web->sendTextMessage(QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact))));
+    }
+}
+
+void ServeurControle::account(Client* client, qint64 bytes)
+{
+    client->pendingOutput += bytes;
+    if (client->pendingOutput <= MAX_OUTPUT)
+    {
+        return;
+    }
+
+    qDebug() << "Client trop lent, déconnecté :" << client->pendingOutput << "octets en attente";
+    client->closing = true;
+    if (client->tcp)
+    {
+        QTcpSocket* socket = client->tcp;
+        QMetaObject::invokeMethod(socket, [socket]() { socket->abort(); }, Qt::QueuedConnection);
+    }
+    else
+    {
+        QWebSocket* socket = client->web;
+        QMetaObject::invokeMethod(socket, [socket]() { socket->abort(); }, Qt::QueuedConnection);
+    }
+}
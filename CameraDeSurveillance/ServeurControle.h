@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "GestionnaireCameras.h"
+#include "ProtocoleControle.h"
+
+class QTcpServer;
+class QTcpSocket;
+class QWebSocket;
+class QWebSocketServer;
+class QJsonObject;
+
+// Serveur de commande sans interface : les pupitres se connectent en TCP (ProtocoleControle.h)
+// ou en WebSocket (JSON) et leurs commandes passent par l'ordonnanceur de chaque chaîne.
+// Tous les clients sont servis par la boucle d'évènements du thread du serveur.
+class ServeurControle : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int MAX_CLIENTS = 1024;
+    static constexpr int MAX_IN_FLIGHT = 16;                // Commandes en cours par client
+    static constexpr qint64 UNTRACKED_INTERVAL_MS = 10;     // Opérations sans transaction : une
+                                                            // par 10 ms, rafales de MAX_IN_FLIGHT
+    static constexpr qint64 MAX_READ_BUFFER = 4096;         // Octets lus d'avance par client TCP
+    static constexpr qint64 CONGESTED_OUTPUT = 16 * 1024;   // Au-delà, les états sont fusionnés
+    static constexpr qint64 MAX_OUTPUT = 256 * 1024;        // Au-delà, le client est déconnecté
+
+    explicit ServeurControle(GestionnaireCameras& gestionnaire, QObject* parent = nullptr);
+    ~ServeurControle();
+
+    bool listen(quint16 tcpPort, quint16 webSocketPort);
+    int clientCount() const { return clients.size(); }
+
+private:
+    struct Request
+    {
+        ProtocoleControle::Operation op = ProtocoleControle::Operation::Stop;
+        CameraId camera;
+        quint32 tag = 0;
+        quint8 panSpeed = 0;
+        quint8 tiltSpeed = 0;
+        Visca::PanDirection panDirection = Visca::PanDirection::Stop;
+        Visca::TiltDirection tiltDirection = Visca::TiltDirection::Stop;
+        qint16 pan = 0;
+        qint16 tilt = 0;
+        quint16 position = 0;
+        double panRate = 0.0;
+        double tiltRate = 0.0;
+        quint8 memory = 0;
+        bool enable = false;
+        QString name;
+    };
+
+    struct Response
+    {
+        ProtocoleControle::Status status = ProtocoleControle::Status::Ok;
+        quint32 id = 0;
+    };
+
+    struct Client
+    {
+        QTcpSocket* tcp = nullptr;
+        QWebSocket* web = nullptr;
+        QByteArray input;                   // Trames TCP incomplètes
+        int inFlight = 0;
+        qint64 untrackedAt = 0;             // Instant où la prochaine opération sans transaction
+                                            // ne prend plus rien sur la rafale (ms)
+        qint64 pendingOutput = 0;           // Octets confiés à la socket et pas encore écrits
+        bool subscribed = false;
+        bool closing = false;
+        QHash<int, CameraState> pendingStates;  // États retenus pendant une congestion
+    };
+
+    void onTcpConnection();
+    void onWebSocketConnection();
+    void onTcpReadyRead(Client* client);
+    void onWebSocketMessage(Client* client, const QString& message);
+    void onBytesWritten(Client* client, qint64 bytes);
+    void onCommandCompleted(int port, quint32 id);
+    void onCommandFailed(int port, quint32 id, int errorCode);
+    void onCommandCoalesced(int port, quint32 supersededId, quint32 replacementId);
+    void onStateChanged(const CameraId& camera, const CameraState& state);
+
+    Client* addClient(QTcpSocket* tcp, QWebSocket* web);
+    void removeClient(Client* client);
+    Response execute(Client* client, const Request& request);
+    bool admitUntracked(Client* client);
+    void finishTransaction(quint32 id, const QByteArray& frame, const QJsonObject& event);
+
+    bool decodeFrame(const QByteArray& frame, Request& request) const;
+    bool decodeJson(const QJsonObject& object, Request& request) const;
+    void reply(Client* client, const Request& request, const Response& response);
+    void sendState(Client* client, const CameraId& camera, const CameraState& state);
+    void sendFrame(Client* client, const QByteArray& frame);
+    void sendJson(Client* client, const QJsonObject& object);
+    void account(Client* client, qint64 bytes);
+
+    GestionnaireCameras& gestionnaire;
+    QTcpServer* tcpServer = nullptr;
+    QWebSocketServer* webSocketServer = nullptr;
+    QList<Client*> clients;
+    QHash<quint32, Client*> owners;         // Transaction en cours -> client qui l'a demandée
+    QElapsedTimer clock;
+};
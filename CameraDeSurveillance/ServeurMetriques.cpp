@@ -0,0 +1,149 @@
+﻿//*********************************************************************************************
+//* Programme : ServeurMetriques.cpp                                           Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Exposer les métriques du programme en HTTP sur l'interface locale (GET /metrics),
+//*       pour qu'un serveur Prometheus les relève en production.
+//* Programmes associés : Metriques.cpp, main.cpp
+//*********************************************************************************************
+
+#include "ServeurMetriques.h"
+#include "Metriques.h"
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QDebug>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe ServeurMetriques
+//* Paramètres :
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+ServeurMetriques::ServeurMetriques(QObject* parent)
+    : QObject(parent)
+{
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'ouvrir l'écoute, sur l'interface locale seulement
+//* Paramètres :
+//*  - quint16 port : le port TCP du point d'accès
+//*
+//* Valeur de retour : bool, vrai si l'écoute est ouverte, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool ServeurMetriques::listen(quint16 port)
+{
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &ServeurMetriques::onConnection);
+    if (!server->listen(QHostAddress::LocalHost, port))
+    {
+        qDebug() << "Écoute des métriques impossible sur le port" << port << ":" << server->errorString();
+        return false;
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à l'arrivée d'une connexion ; une connexion muette est fermée après
+//* REQUEST_TIMEOUT_MS
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurMetriques::onConnection()
+{
+    while (server->hasPendingConnections())
+    {
+        QTcpSocket* socket = server->nextPendingConnection();
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        QTimer::singleShot(REQUEST_TIMEOUT_MS, socket, [socket]() { socket->abort(); });
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction traitant la requête une fois ses en-têtes complets
+//* Paramètres :
+//*  - QTcpSocket* socket : la connexion du client
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurMetriques::onReadyRead(QTcpSocket* socket)
+{
+    QByteArray request = socket->peek(MAX_REQUEST);
+    int end = request.indexOf("\r\n\r\n");
+    if (end < 0)
+    {
+        if (request.size() >= MAX_REQUEST)
+        {
+            respond(socket, "431 Request Header Fields Too Large", "text/plain", QByteArray());
+        }
+        return;
+    }
+    socket->read(end + 4);
+
+    // Ligne de requête : méthode, chemin (éventuellement suivi de paramètres), version
+    QList<QByteArray> line = request.left(request.indexOf("\r\n")).split(' ');
+    if (line.size() != 3 || !line.at(2).startsWith("HTTP/"))
+    {
+        respond(socket, "400 Bad Request", "text/plain", QByteArray());
+        return;
+    }
+
+    QByteArray path = line.at(1);
+    int query = path.indexOf('?');
+    if (query >= 0)
+    {
+        path.truncate(query);
+    }
+
+    if (path != "/metrics")
+    {
+        respond(socket, "404 Not Found", "text/plain", QByteArray());
+    }
+    else if (line.at(0) != "GET")
+    {
+        respond(socket, "405 Method Not Allowed", "text/plain", QByteArray());
+    }
+    else
+    {
+        ++scrapes;
+        respond(socket, "200 OK", "text/plain; version=0.0.4; charset=utf-8", Metriques::render());
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction écrivant la réponse puis fermant la connexion
+//* Paramètres :
+//*  - QTcpSocket* socket : la connexion du client
+//*  - const char* status : le code et le libellé HTTP
+//*  - const QByteArray& contentType : le type du corps
+//*  - const QByteArray& body : le corps de la réponse
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void ServeurMetriques::respond(QTcpSocket* socket, const char* status, const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response;
+    response.reserve(128 + body.size());
+    response += "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += contentType;
+    response += "\r\nContent-Length: ";
+    response += QByteArray::number(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    response += body;
+
+    socket->disconnect(this);
+    socket->write(response);
+    socket->disconnectFromHost();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+
+class QTcpServer;
+class QTcpSocket;
+
+// Point d'accès HTTP local des métriques : GET /metrics renvoie le registre Metriques au format
+// texte de Prometheus. Une requête par connexion, servie par la boucle d'évènements du thread
+// du serveur ; la lecture du registre ne bloque jamais les threads des chaînes.
+class ServeurMetriques : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr quint16 DEFAULT_PORT = 9464;
+    static constexpr qint64 MAX_REQUEST = 8192;     // Octets d'en-têtes acceptés par requête
+    static constexpr int REQUEST_TIMEOUT_MS = 5000;
+
+    explicit ServeurMetriques(QObject* parent = nullptr);
+
+    bool listen(quint16 port = DEFAULT_PORT);
+    quint64 scrapeCount() const { return scrapes; }
+
+private:
+    void onConnection();
+    void onReadyRead(QTcpSocket* socket);
+    void respond(QTcpSocket* socket, const char* status, const QByteArray& contentType, const QByteArray& body);
+
+    QTcpServer* server = nullptr;
+    quint64 scrapes = 0;
+};
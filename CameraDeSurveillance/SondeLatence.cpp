@@ -0,0 +1,109 @@
+﻿//*********************************************************************************************
+//* Programme : SondeLatence.cpp                                               Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Mesurer les blocages de la boucle d'événements de l'interface : un minuteur périodique
+//*       compare l'heure réelle de chaque tick à l'heure attendue et cumule les retards.
+//* Programmes associés : CameraDeSurveillance.cpp
+//*********************************************************************************************
+
+#include "SondeLatence.h"
+#include <QDebug>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe SondeLatence
+//* Paramètres :
+//*  - int intervalMs : la période du minuteur de mesure
+//*  - int stallThresholdMs : le retard à partir duquel un tick compte comme un blocage
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+SondeLatence::SondeLatence(int intervalMs, int stallThresholdMs, QObject* parent)
+    : QObject(parent), tickTimer(this), reportTimer(this), intervalMs(intervalMs), stallThresholdMs(stallThresholdMs)
+{
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    tickTimer.setInterval(intervalMs);
+    reportTimer.setInterval(10000);
+
+    connect(&tickTimer, &QTimer::timeout, this, &SondeLatence::onTick);
+    connect(&reportTimer, &QTimer::timeout, this, &SondeLatence::report);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de démarrage et d'arrêt de la mesure
+//---------------------------------------------------------------------------------------------
+void SondeLatence::start()
+{
+    reset();
+    clock.start();
+    lastTickUs = 0;
+    tickTimer.start();
+    reportTimer.start();
+}
+
+void SondeLatence::stop()
+{
+    tickTimer.stop();
+    reportTimer.stop();
+}
+
+SondeLatence::Stats SondeLatence::stats() const
+{
+    return current;
+}
+
+void SondeLatence::reset()
+{
+    current = Stats();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à chaque tick : le retard est l'écart entre le temps écoulé depuis le tick
+//* précédent et la période demandée
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SondeLatence::onTick()
+{
+    qint64 nowUs = clock.nsecsElapsed() / 1000;
+    qint64 delayUs = nowUs - lastTickUs - qint64(intervalMs) * 1000;
+    lastTickUs = nowUs;
+
+    if (delayUs < 0)
+    {
+        delayUs = 0;
+    }
+
+    ++current.ticks;
+    current.totalDelayUs += delayUs;
+    if (delayUs > current.maxDelayUs)
+    {
+        current.maxDelayUs = delayUs;
+    }
+    if (delayUs > qint64(stallThresholdMs) * 1000)
+    {
+        ++current.stalls;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction affichant périodiquement le bilan des retards puis repartant de zéro
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SondeLatence::report()
+{
+    qint64 meanUs = current.ticks > 0 ? current.totalDelayUs / qint64(current.ticks) : 0;
+    qDebug() << "Boucle d'événements : retard moyen" << meanUs << "us, max" << current.maxDelayUs
+             << "us, blocages >" << stallThresholdMs << "ms :" << current.stalls << "sur" << current.ticks;
+    reset();
+}
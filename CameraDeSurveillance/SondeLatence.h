@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// Mesure les blocages de la boucle d'événements du thread dans lequel elle vit
+class SondeLatence : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        quint64 ticks = 0;
+        quint64 stalls = 0;          // Retards supérieurs au seuil
+        qint64 maxDelayUs = 0;
+        qint64 totalDelayUs = 0;
+    };
+
+    explicit SondeLatence(int intervalMs = 10, int stallThresholdMs = 50, QObject* parent = nullptr);
+
+    void start();
+    void stop();
+    Stats stats() const;
+    void reset();
+
+private slots:
+    void onTick();
+    void report();
+
+private:
+    QTimer tickTimer;
+    QTimer reportTimer;
+    QElapsedTimer clock;
+    qint64 lastTickUs = 0;
+    int intervalMs;
+    int stallThresholdMs;
+    Stats current;
+};
@@ -0,0 +1,240 @@
+﻿//*********************************************************************************************
+//* Programme : StatistiquesLiaison.cpp                                        Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Mesurer la liaison série d'une chaîne de caméras pour comparer les débits : octets par
+//*       seconde dans chaque sens, histogrammes des temps d'aller-retour et de fin d'exécution
+//*       des commandes, taux d'erreur.
+//* Programmes associés : ControleCamera.cpp, TransactionsVisca.cpp
+//*********************************************************************************************
+
+#include "StatistiquesLiaison.h"
+#include <QMutexLocker>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe StatistiquesLiaison, les débits sont recalculés chaque seconde
+//* Paramètres :
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+StatistiquesLiaison::StatistiquesLiaison(QObject* parent)
+    : QObject(parent),
+    tick(this)
+{
+    clock.start();
+    tick.setInterval(1000);
+    connect(&tick, &QTimer::timeout, this, &StatistiquesLiaison::onTick);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction remettant les compteurs à zéro (nouveau port) et démarrant le calcul des débits,
+//* dans le thread de la chaîne
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void StatistiquesLiaison::reset()
+{
+    sentAt.clear();
+    sentAtTick = 0;
+    receivedAtTick = 0;
+    tick.start();
+
+    QMutexLocker locker(&mutex);
+    current = Snapshot();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions alimentant les compteurs depuis ControleCamera
+//---------------------------------------------------------------------------------------------
+void StatistiquesLiaison::setBaudRate(qint32 baudRate, bool confirmed)
+{
+    QMutexLocker locker(&mutex);
+    current.baudRate = baudRate;
+    current.baudConfirmed = confirmed;
+}
+
+void StatistiquesLiaison::addSent(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    current.bytesSent += static_cast<quint64>(bytes);
+    ++current.commands;
+}
+
+void StatistiquesLiaison::addReceived(qint64 bytes)
+{
+    QMutexLocker locker(&mutex);
+    current.bytesReceived += static_cast<quint64>(bytes);
+}
+
+void StatistiquesLiaison::setFramingErrors(quint64 count)
+{
+    QMutexLocker locker(&mutex);
+    current.framingErrors = count;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant une copie des statistiques ; elle peut être appelée depuis l'interface
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : Snapshot, les statistiques courantes
+//---------------------------------------------------------------------------------------------
+StatistiquesLiaison::Snapshot StatistiquesLiaison::snapshot() const
+{
+    QMutexLocker locker(&mutex);
+    return current;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions suivant chaque transaction, reliées aux signaux de TransactionsVisca : le temps
+//* est compté depuis l'écriture du paquet sur le port
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*  - int errorCode : le code d'erreur (échec)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void StatistiquesLiaison::onCommandSent(quint32 id)
+{
+    // Une réponse perdue laisse sa transaction ici : la table est bornée
+    if (sentAt.size() >= MAX_TRACKED)
+    {
+        sentAt.clear();
+    }
+    sentAt.insert(id, clock.nsecsElapsed());
+}
+
+void StatistiquesLiaison::onFirstReply(quint32 id)
+{
+    auto it = sentAt.constFind(id);
+    if (it == sentAt.constEnd())
+    {
+        return;
+    }
+
+    int index = bucket((clock.nsecsElapsed() - it.value()) / 1000);
+    QMutexLocker locker(&mutex);
+    ++current.roundTrip[index];
+}
+
+void StatistiquesLiaison::onCommandCompleted(quint32 id)
+{
+    if (!sentAt.contains(id))
+    {
+        return;
+    }
+    qint64 sent = sentAt.take(id);
+
+    int index = bucket((clock.nsecsElapsed() - sent) / 1000);
+    QMutexLocker locker(&mutex);
+    ++current.completion[index];
+}
+
+void StatistiquesLiaison::onCommandFailed(quint32 id, int errorCode)
+{
+    Q_UNUSED(errorCode);
+    sentAt.remove(id);
+
+    QMutexLocker locker(&mutex);
+    ++current.failures;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions comptant les effets de la politique de reprise de TransactionsVisca ; un renvoi
+//* repart de son écriture pour le temps d'aller-retour
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*  - int reason : TransactionsVisca::TIMEOUT ou Visca::CommandBufferFull
+//*  - quint8 address : l'adresse de la caméra dont les sockets ont été libérés
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void StatistiquesLiaison::onCommandRetried(quint32 id, int reason)
+{
+    Q_UNUSED(reason);
+    sentAt.remove(id);
+
+    QMutexLocker locker(&mutex);
+    ++current.retries;
+}
+
+void StatistiquesLiaison::onCommandTimedOut(quint32 id)
+{
+    Q_UNUSED(id);
+    QMutexLocker locker(&mutex);
+    ++current.timeouts;
+}
+
+void StatistiquesLiaison::onRecoveryStarted(quint8 address)
+{
+    Q_UNUSED(address);
+    QMutexLocker locker(&mutex);
+    ++current.recoveries;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée chaque seconde : débit de la dernière seconde dans chaque sens
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void StatistiquesLiaison::onTick()
+{
+    QMutexLocker locker(&mutex);
+    current.sendRate = static_cast<double>(current.bytesSent - sentAtTick);
+    current.receiveRate = static_cast<double>(current.bytesReceived - receivedAtTick);
+    sentAtTick = current.bytesSent;
+    receivedAtTick = current.bytesReceived;
+}
+
+int StatistiquesLiaison::bucket(qint64 us)
+{
+    int index = 0;
+    while (index < BUCKET_COUNT - 1 && us > BUCKET_LIMITS_US[index])
+    {
+        ++index;
+    }
+    return index;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant un centile d'histogramme, arrondi à la borne supérieure de sa classe
+//* Paramètres :
+//*  - const quint64 (&histogram)[BUCKET_COUNT] : l'histogramme
+//*  - double fraction : le centile voulu, de 0 à 1 (0.5 pour la médiane)
+//*
+//* Valeur de retour : qint64, la borne en µs (0 si l'histogramme est vide, -1 au-delà de la
+//*                    dernière borne)
+//---------------------------------------------------------------------------------------------
+qint64 StatistiquesLiaison::Snapshot::percentileUs(const quint64 (&histogram)[BUCKET_COUNT], double fraction)
+{
+    quint64 total = 0;
+    for (quint64 count : histogram)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    quint64 rank = static_cast<quint64>(fraction * static_cast<double>(total));
+    quint64 seen = 0;
+    for (int index = 0; index < BUCKET_COUNT - 1; ++index)
+    {
+        seen += histogram[index];
+        if (seen > rank)
+        {
+            return BUCKET_LIMITS_US[index];
+        }
+    }
+    return -1;
+}
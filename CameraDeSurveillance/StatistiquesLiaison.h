@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QTimer>
+#include "Visca.h"
+
+// Statistiques de la liaison série d'une chaîne : débit utile, temps d'aller-retour des
+// commandes (histogrammes) et taux d'erreur. Alimentée dans le thread de la chaîne, lisible
+// depuis n'importe quel thread.
+class StatistiquesLiaison : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int BUCKET_COUNT = 10;
+    // Bornes supérieures des classes des histogrammes, en µs ; la dernière classe est au-delà
+    static constexpr qint64 BUCKET_LIMITS_US[BUCKET_COUNT - 1] = {
+        2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000, 1000000 };
+
+    struct Snapshot
+    {
+        qint32 baudRate = 0;
+        bool baudConfirmed = false;         // Débit validé par la négociation
+        quint64 bytesSent = 0;
+        quint64 bytesReceived = 0;
+        double sendRate = 0.0;              // Octets par seconde, sur la dernière seconde
+        double receiveRate = 0.0;
+        quint64 commands = 0;               // Paquets écrits sur le port
+        quint64 failures = 0;               // Erreurs VISCA et échecs d'écriture
+        quint64 framingErrors = 0;          // Octets rejetés par l'analyseur de réponses
+        quint64 retries = 0;                // Commandes renvoyées (réponse perdue, tampon plein)
+        quint64 timeouts = 0;               // Réponses attendues en vain
+        quint64 recoveries = 0;             // IF_Clear envoyés pour libérer des sockets
+        quint64 roundTrip[BUCKET_COUNT] = {};   // Envoi -> ACK ou réponse d'interrogation
+        quint64 completion[BUCKET_COUNT] = {};  // Envoi -> Completion
+
+        double errorRate() const { return commands > 0 ? static_cast<double>(failures) / commands : 0.0; }
+        double lineLoad() const { return baudRate > 0 ? (sendRate + receiveRate) * 10.0 / baudRate : 0.0; }
+        static qint64 percentileUs(const quint64 (&histogram)[BUCKET_COUNT], double fraction);
+    };
+
+    explicit StatistiquesLiaison(QObject* parent = nullptr);
+
+    void reset();
+    void setBaudRate(qint32 baudRate, bool confirmed);
+    void addSent(qint64 bytes);
+    void addReceived(qint64 bytes);
+    void setFramingErrors(quint64 count);
+    Snapshot snapshot() const;
+
+public slots:
+    void onCommandSent(quint32 id);
+    void onFirstReply(quint32 id);
+    void onCommandCompleted(quint32 id);
+    void onCommandFailed(quint32 id, int errorCode);
+    void onCommandRetried(quint32 id, int reason);
+    void onCommandTimedOut(quint32 id);
+    void onRecoveryStarted(quint8 address);
+
+private slots:
+    void onTick();
+
+private:
+    static constexpr int MAX_TRACKED = 1024;    // Transactions suivies au plus (réponses perdues)
+
+    static int bucket(qint64 us);
+
+    QElapsedTimer clock;
+    QTimer tick;
+    QHash<quint32, qint64> sentAt;              // Transaction -> instant d'écriture (ns)
+    quint64 sentAtTick = 0;
+    quint64 receivedAtTick = 0;
+    mutable QMutex mutex;
+    Snapshot current;
+};
@@ -0,0 +1,306 @@
+﻿//*********************************************************************************************
+//* Programme : SurveillanceLiaison.cpp                                        Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Surveiller la liaison série d'une chaîne : erreurs du port (adaptateur USB débranché)
+//*       et silence de la caméra malgré une interrogation de présence. Après une perte, les
+//*       ports sont réexaminés jusqu'à retrouver le même adaptateur, que ControleCamera rouvre.
+//*       La liste des ports disponibles est aussi relevée ici, hors du thread de l'interface.
+//* Programmes associés : ControleCamera.cpp
+//*********************************************************************************************
+
+#include "SurveillanceLiaison.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSerialPortInfo>
+#include <QDebug>
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe SurveillanceLiaison
+//* Paramètres :
+//*  - Sender sender : la fonction qui confie l'interrogation de présence à l'ordonnanceur
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+SurveillanceLiaison::SurveillanceLiaison(Sender sender, QObject* parent)
+    : QObject(parent), sender(std::move(sender)), heartbeatTimer(this), rescanTimer(this)
+{
+    clock.start();
+
+    // Le minuteur de présence relève aussi la liste des ports : il tourne même sans port ouvert
+    heartbeatTimer.setInterval(1000);
+    connect(&heartbeatTimer, &QTimer::timeout, this, &SurveillanceLiaison::onHeartbeat);
+    heartbeatTimer.start();
+
+    rescanTimer.setInterval(RESCAN_INTERVAL_MS);
+    connect(&rescanTimer, &QTimer::timeout, this, &SurveillanceLiaison::rescan);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction commençant la surveillance d'un port ouvert et dont le débit est choisi ; l'identité
+//* de l'adaptateur (numéro de série, identifiants USB) est relevée pour le retrouver plus tard
+//* Paramètres :
+//*  - const QString& portName : le nom ou le chemin du port, tel que passé à l'ouverture
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::watch(const QString& portName)
+{
+    QSerialPortInfo info(portName);
+
+    adapter = Adapter();
+    adapter.portName = portName;
+    if (!info.isNull())
+    {
+        adapter.serialNumber = info.serialNumber();
+        adapter.vendorId = info.hasVendorIdentifier() ? info.vendorIdentifier() : 0;
+        adapter.productId = info.hasProductIdentifier() ? info.productIdentifier() : 0;
+    }
+
+    watching = true;
+    reconnecting = false;
+    heard = false;
+    lastReceive = clock.elapsed();
+    lastHeartbeat = -1;
+    rescanTimer.stop();
+}
+
+void SurveillanceLiaison::stop()
+{
+    watching = false;
+    reconnecting = false;
+    rescanTimer.stop();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée à chaque réception d'octets : la liaison est vivante
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::noteReceived()
+{
+    lastReceive = clock.elapsed();
+    lastHeartbeat = -1;
+    heard = true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée aux erreurs du port : un adaptateur débranché donne ResourceError (ou
+//* DeviceNotFoundError / PermissionError s'il disparaît pendant l'accès)
+//* Paramètres :
+//*  - QSerialPort::SerialPortError error : l'erreur signalée par le port
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::onPortError(QSerialPort::SerialPortError error)
+{
+    if (!watching || reconnecting)
+    {
+        return;
+    }
+
+    if (error == QSerialPort::ResourceError || error == QSerialPort::DeviceNotFoundError
+        || error == QSerialPort::PermissionError)
+    {
+        lose("erreur du port");
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée chaque seconde : relève les ports, interroge une caméra silencieuse et
+//* déclare la liaison perdue si elle ne répond pas
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::onHeartbeat()
+{
+    scanPorts();
+    if (!watching || reconnecting || !heard)
+    {
+        return;
+    }
+
+    qint64 now = clock.elapsed();
+    qint64 silence = now - lastReceive;
+
+    // L'interrogation a eu le temps d'aboutir : la caméra ou l'adaptateur ne répond plus
+    if (silence >= LOST_AFTER_MS && lastHeartbeat >= 0 && now - lastHeartbeat >= HEARTBEAT_INTERVAL_MS)
+    {
+        lose("silence de la caméra");
+        return;
+    }
+
+    // Le trafic normal suffit à prouver la liaison : on n'interroge que pendant un silence
+    if (silence >= HEARTBEAT_INTERVAL_MS && (lastHeartbeat < 0 || now - lastHeartbeat >= HEARTBEAT_INTERVAL_MS))
+    {
+        if (sender && sender(Visca::powerInquiry(1)) != 0)
+        {
+            lastHeartbeat = now;
+            QMutexLocker locker(&statsMutex);
+            ++current.heartbeats;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction déclarant la liaison perdue : ControleCamera ferme le port (linkLost) et les ports
+//* sont réexaminés jusqu'au retour de l'adaptateur
+//* Paramètres :
+//*  - const char* reason : la cause, pour le journal
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::lose(const char* reason)
+{
+    qDebug() << "Liaison perdue sur" << adapter.portName << ":" << reason;
+    reconnecting = true;
+    lostClock.start();
+    {
+        QMutexLocker locker(&statsMutex);
+        ++current.losses;
+    }
+
+    emit linkLost(adapter.portName);
+    rescanTimer.start();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction cherchant l'adaptateur perdu ; s'il est revenu, ControleCamera est invité à le
+//* rouvrir et l'examen s'interrompt jusqu'au résultat
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::rescan()
+{
+    if (!reconnecting)
+    {
+        rescanTimer.stop();
+        return;
+    }
+
+    QString portName = findAdapter(adapter);
+    if (!portName.isEmpty())
+    {
+        rescanTimer.stop();
+        emit reconnectRequested(portName);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions appelées par ControleCamera à l'issue d'une tentative de réouverture
+//* Paramètres :
+//*  - const QString& portName : le port rouvert, dont le débit vient d'être choisi
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::reconnectFinished(const QString& portName)
+{
+    qint64 elapsedMs = lostClock.elapsed();
+    {
+        QMutexLocker locker(&statsMutex);
+        ++current.reconnects;
+        current.lastReconnectMs = elapsedMs;
+        current.totalReconnectMs += elapsedMs;
+        if (elapsedMs > current.maxReconnectMs)
+        {
+            current.maxReconnectMs = elapsedMs;
+        }
+    }
+
+    qDebug() << "Liaison rétablie sur" << portName << "en" << elapsedMs << "ms";
+    watch(portName);
+    emit reconnected(portName, elapsedMs);
+}
+
+void SurveillanceLiaison::reconnectFailed()
+{
+    if (reconnecting)
+    {
+        rescanTimer.start();
+    }
+}
+
+SurveillanceLiaison::Stats SurveillanceLiaison::stats() const
+{
+    QMutexLocker locker(&statsMutex);
+    return current;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction cherchant un adaptateur parmi les ports présents (udev ou sysfs sous Linux, via
+//* QSerialPortInfo) : par numéro de série et identifiants USB s'ils sont connus, car le port
+//* peut revenir sous un autre nom (ttyUSB0 -> ttyUSB1, COM3 -> COM4) ; sinon par son nom
+//* Paramètres :
+//*  - const Adapter& adapter : l'identité de l'adaptateur
+//*
+//* Valeur de retour : QString, le nom du port à rouvrir, vide si l'adaptateur est absent
+//---------------------------------------------------------------------------------------------
+QString SurveillanceLiaison::findAdapter(const Adapter& adapter)
+{
+    const QList<QSerialPortInfo> ports = QSerialPortInfo::availablePorts();
+
+    if (!adapter.serialNumber.isEmpty())
+    {
+        // Un autre adaptateur peut avoir pris l'ancien nom : seul le numéro de série fait foi
+        for (const QSerialPortInfo& info : ports)
+        {
+            if (info.serialNumber() == adapter.serialNumber
+                && (adapter.vendorId == 0 || info.vendorIdentifier() == adapter.vendorId)
+                && (adapter.productId == 0 || info.productIdentifier() == adapter.productId))
+            {
+                return info.portName();
+            }
+        }
+        return QString();
+    }
+
+    for (const QSerialPortInfo& info : ports)
+    {
+        if (info.portName() == adapter.portName || info.systemLocation() == adapter.portName)
+        {
+            return adapter.portName;
+        }
+    }
+
+    // Chemin complet hors de la liste des ports (pseudo-terminal de SimulateurVisca)
+    if (adapter.portName.contains('/') && QFileInfo::exists(adapter.portName))
+    {
+        return adapter.portName;
+    }
+    return QString();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction relevant les ports présents ; availablePortsChanged() n'est émis qu'en cas de
+//* branchement ou de débranchement
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SurveillanceLiaison::scanPorts()
+{
+    QStringList portNames;
+    for (const QSerialPortInfo& info : QSerialPortInfo::availablePorts())
+    {
+        portNames.append(info.portName());
+    }
+    portNames.sort();
+
+    if (portNames != knownPorts)
+    {
+        knownPorts = portNames;
+        emit availablePortsChanged(portNames);
+    }
+}
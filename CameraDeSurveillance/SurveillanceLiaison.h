@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSerialPort>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <functional>
+#include "Visca.h"
+
+// Chien de garde de la liaison série d'une chaîne : la perte de l'adaptateur est détectée par
+// les erreurs du port ou par le silence de la caméra malgré les interrogations de présence,
+// puis les ports sont réexaminés jusqu'à retrouver le même adaptateur (numéro de série USB)
+class SurveillanceLiaison : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Confie une interrogation de présence à l'ordonnanceur, renvoie 0 si elle n'a pas pu l'être
+    using Sender = std::function<quint32(const Visca::Command&)>;
+
+    struct Stats
+    {
+        quint64 losses = 0;             // Pertes de liaison détectées
+        quint64 reconnects = 0;         // Reconnexions réussies
+        quint64 heartbeats = 0;         // Interrogations de présence envoyées
+        qint64 lastReconnectMs = 0;     // Temps entre la perte et la reprise de la liaison
+        qint64 maxReconnectMs = 0;
+        qint64 totalReconnectMs = 0;
+    };
+
+    // Identité d'un adaptateur, pour le retrouver sous un autre nom après débranchement
+    struct Adapter
+    {
+        QString portName;               // Nom ou chemin passé à l'ouverture
+        QString serialNumber;
+        quint16 vendorId = 0;
+        quint16 productId = 0;
+    };
+
+    static constexpr int HEARTBEAT_INTERVAL_MS = 2000;  // Silence au-delà duquel on interroge
+    static constexpr int LOST_AFTER_MS = 6000;          // Silence malgré l'interrogation : perte
+    static constexpr int RESCAN_INTERVAL_MS = 500;      // Examen des ports pendant la reconnexion
+
+    explicit SurveillanceLiaison(Sender sender, QObject* parent = nullptr);
+
+    void watch(const QString& portName);
+    void stop();
+    void noteReceived();
+    bool isReconnecting() const { return reconnecting; }
+    void reconnectFinished(const QString& portName);
+    void reconnectFailed();
+    Stats stats() const;
+
+    static QString findAdapter(const Adapter& adapter);
+
+public slots:
+    void onPortError(QSerialPort::SerialPortError error);
+
+signals:
+    void linkLost(const QString& portName);
+    void reconnectRequested(const QString& portName);
+    void reconnected(const QString& portName, qint64 elapsedMs);
+    void availablePortsChanged(const QStringList& portNames);
+
+private slots:
+    void onHeartbeat();
+    void rescan();
+
+private:
+    void lose(const char* reason);
+    void scanPorts();
+
+    Sender sender;
+    QTimer heartbeatTimer;
+    QTimer rescanTimer;
+    QElapsedTimer clock;
+    QElapsedTimer lostClock;        // Depuis la perte de la liaison
+    Adapter adapter;
+    bool watching = false;
+    bool reconnecting = false;
+    bool heard = false;             // La caméra a répondu depuis l'ouverture : son silence compte
+    qint64 lastReceive = 0;         // Dernier octet reçu (ms, clock)
+    qint64 lastHeartbeat = -1;      // Dernière interrogation de présence depuis ce silence, -1 si aucune
+    QStringList knownPorts;
+    mutable QMutex statsMutex;
+    Stats current;
+};
@@ -0,0 +1,225 @@
+﻿//*********************************************************************************************
+//* Programme : Traductions.cpp                                                Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Traduire l'interface à partir d'une table constante (langue x message) : chaque texte
+//*       n'existe qu'une fois dans le programme, une langue n'est convertie en QString qu'à sa
+//*       première sélection, et le changement de langue retraduit les widgets en un passage.
+//* Programmes associés : CameraDeSurveillance.cpp
+//*********************************************************************************************
+
+#include "Traductions.h"
+#include <QAbstractButton>
+#include <QLabel>
+
+namespace
+{
+    using Table = const char* const[Traductions::LANGUAGE_COUNT][Traductions::MESSAGE_COUNT];
+
+    // Une ligne par langue, une colonne par identifiant de Message (même ordre)
+    constexpr Table TABLE = {
+        // Français
+        { "Ouvrir le port", "Mode automatique", "Initialiser", "Zoom", "Changer la langue",
+          "Descendre", "Gauche", "Droite", "Monter", "Allumer",
+          "Veuillez selectionner un port.", "Statut port: Ouvert", "Erreur: %1",
+          "Liaison perdue sur %1, reconnexion...", "Liaison rétablie sur %1 en %2 ms",
+          "Mouvement détecté : %1",
+          "Enregistrer", "Enregistrement : %1", "Échec de l'enregistrement : %1",
+          "Pan %1   Tilt %2   Zoom %3",
+          "%1 bd%2   tx %3 o/s   rx %4 o/s   RTT %5 ms (p95 %6 ms)   err %7 %   renvois %8   délais %9" },
+        // English
+        { "Open Port", "Automatic mode", "Initialise", "Zoom", "Change language",
+          "Down", "Left", "Right", "Up", "Turn On",
+          "Please select a port.", "Port status: Open", "Error: %1",
+          "Link lost on %1, reconnecting...", "Link restored on %1 in %2 ms",
+          "Motion detected: %1",
+          "Record", "Recording: %1", "Recording failed: %1",
+          "Pan %1   Tilt %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   retries %8   timeouts %9" },
+        // Deutsch
+        { "Offener Port", "Automatikmodus", "Initialisieren", "Zoom", "Sprache andern",
+          "Runterkommen", "Links", "Rechts", "Nach oben", "Zum Leuchten",
+          "Bitte waehlen Sie einen Port.", "Port status: Offen", "Fehler: %1",
+          "Verbindung zu %1 verloren, neuer Versuch...", "Verbindung zu %1 in %2 ms wiederhergestellt",
+          "Bewegung erkannt: %1",
+          "Aufnehmen", "Aufnahme: %1", "Aufnahme fehlgeschlagen: %1",
+          "Schwenk %1   Neigung %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   Wiederholungen %8   Zeitueberschreitungen %9" },
+        // Arabic
+        { "Fath Al manfaz", "telqaa'i", "Tahyi'aa", "Takbir", "taghir al logha",
+          "nuzul", "yasar", "yamin", "sooud", "tashghil",
+          "Yarja ikhtiyar manfath.", "Statut al manfath: Maftuh", "Khata: %1",
+          "Inqata'a al ittisal 'ala %1, i'adat al ittisal...", "Uida al ittisal 'ala %1 fi %2 ms",
+          "Haraka muktashafa: %1",
+          "Tasjil", "Jari al tasjil: %1", "Fashal al tasjil: %1",
+          "Dawaran %1   Mayl %2   Takbir %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   i'adat %8   muhla %9" },
+        // Breizh
+        { "Digerin ar porzh", "Mod emgefre", "Kregin", "Zoom", "Chench ar yezh",
+          "Diskenn", "Tu kleiz", "Tu dehou", "Pignat", "Prenan",
+          "Goulit ul port.", "Status port: Ouvert", "Erreur: %1",
+          "Kollet al liamm war %1, adkevrea...", "Adsavet al liamm war %1 e %2 ms",
+          "Fiñv dinoet: %1",
+          "Enrollañ", "Oc'h enrollañ: %1", "C'hwitet an enrollañ: %1",
+          "Troenn %1   Stouadur %2   Zoom %3",
+          "%1 bd%2   tx %3 o/s   rx %4 o/s   RTT %5 ms (p95 %6 ms)   err %7 %   adkas %8   dale %9" },
+        // Russian
+        { "Otvori port", "Avtomaticheskij rezhim", "Initsializirovat'", "Zoom", "Smenit' yazyik",
+          "Vniz", "Vlevo", "Vpravo", "Vverkh", "Vklyuchit'",
+          "Pora otkryt' port.", "Status port: Otkryt", "Oshibka: %1",
+          "Svyaz' poteryana na %1, perepodklyuchenie...", "Svyaz' vosstanovlena na %1 za %2 ms",
+          "Obnaruzheno dvizhenie: %1",
+          "Zapisat'", "Zapis': %1", "Oshibka zapisi: %1",
+          "Povorot %1   Naklon %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   povtory %8   tajmauty %9" },
+        // Mandarin
+        { "da kai duan kou", "zi dong mo shi", "chu xin hua", "zuo fang", "geng huan yu yan",
+          "xiang xia", "xiang zuo", "xiang you", "xiang shang", "da kai dian yuan",
+          "Qing xuanze yi ge duankou.", "Zhuangtai duankou: Daka", "Cuowu: %1",
+          "%1 lianjie duankai, zhengzai chongxin lianjie...", "%1 lianjie yi huifu, %2 ms",
+          "Jiance dao yundong: %1",
+          "lu zhi", "zheng zai lu zhi: %1", "lu zhi shi bai: %1",
+          "shui ping %1   fu yang %2   zuo fang %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   chong fa %8   chao shi %9" },
+        // Spanish
+        { "Abrir puerto", "Modo automatico", "Inicializar", "Zoom", "Cambiar idioma",
+          "Bajar", "Izquierda", "Derecha", "Subir", "Encender",
+          "Por favor seleccione un puerto.", "Estado del puerto: Abierto", "Error: %1",
+          "Enlace perdido en %1, reconectando...", "Enlace restablecido en %1 en %2 ms",
+          "Movimiento detectado: %1",
+          "Grabar", "Grabando: %1", "Error de grabacion: %1",
+          "Giro %1   Inclinacion %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   reintentos %8   tiempos agotados %9" },
+        // Serbian
+        { "Otvoriti port", "Automatski rezim", "Inicijalizuj", "Zum", "Promeni jezik",
+          "Nadalje", "Levo", "Desno", "Gore", "Ukljuci",
+          "Molimo odaberite port.", "Status porta: Otvoren", "Greska: %1",
+          "Veza izgubljena na %1, ponovno povezivanje...", "Veza obnovljena na %1 za %2 ms",
+          "Otkriven pokret: %1",
+          "Snimi", "Snimanje: %1", "Snimanje nije uspelo: %1",
+          "Okret %1   Nagib %2   Zum %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   ponavljanja %8   istekla vremena %9" },
+        // Latin
+        { "Portum aperire", "Modus automaticus", "Iniciari", "Zoom", "Mutare linguam",
+          "Descendere", "Sinistrorsum", "Dextrorsum", "Ascendere", "Accendere",
+          "Portum aperire selige.", "Status portus: Apertus", "Error: %1",
+          "Nexus in %1 amissus, iterum conectitur...", "Nexus in %1 restitutus %2 ms",
+          "Motus detectus: %1",
+          "Inscribere", "Inscribitur: %1", "Inscriptio defecit: %1",
+          "Versio %1   Inclinatio %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   iterationes %8   morae %9" },
+        // Greek
+        { "Anoigma thyras", "Aftomati leitourgia", "Arxikopoiisi", "Zoom", "Allagi glossas",
+          "Kato", "Aristera", "Dexia", "Epanw", "Anoigma",
+          "Anoigma thyras, parakalw epilogh.", "Katalogi thyras: Anoigmeni", "Lathos: %1",
+          "Apoleia syndesis sto %1, epanasyndesi...", "Syndesi sto %1 apokatastathike se %2 ms",
+          "Entopistike kinisi: %1",
+          "Eggrafi", "Eggrafi se exelixi: %1", "Apotyxia eggrafis: %1",
+          "Peristrofi %1   Klisi %2   Zoom %3",
+          "%1 bd%2   tx %3 B/s   rx %4 B/s   RTT %5 ms (p95 %6 ms)   err %7 %   epanalipseis %8   lixi xronou %9" },
+    };
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction choisissant la langue ; ses textes sont convertis à la première sélection
+//* Paramètres :
+//*  - int language : l'indice de la langue dans la liste ChoseLanguage
+//*
+//* Valeur de retour : bool, vrai si la langue existe, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool Traductions::setLanguage(int language)
+{
+    if (language < 0 || language >= LANGUAGE_COUNT)
+    {
+        return false;
+    }
+
+    if (!loaded[language])
+    {
+        load(language);
+    }
+    current = language;
+    texts = catalog[language];
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant un texte dans la langue courante ; la chaîne est partagée, pas copiée
+//* Paramètres :
+//*  - Message message : l'identifiant du texte
+//*
+//* Valeur de retour : const QString&, le texte (vide si aucune langue n'est choisie)
+//---------------------------------------------------------------------------------------------
+const QString& Traductions::text(Message message) const
+{
+    static const QString empty;
+    int index = static_cast<int>(message);
+    return texts && index < MESSAGE_COUNT ? texts[index] : empty;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions enregistrant un widget dont le texte suit la langue
+//* Paramètres :
+//*  - QLabel* label / QAbstractButton* button : le widget
+//*  - Message message : l'identifiant de son texte
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void Traductions::bind(QLabel* label, Message message)
+{
+    labels.append(qMakePair(label, message));
+}
+
+void Traductions::bind(QAbstractButton* button, Message message)
+{
+    buttons.append(qMakePair(button, message));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction enregistrant un texte composé : la fonction le recalcule avec text() et l'affiche
+//* Paramètres :
+//*  - std::function<void()> refresh : la fonction appelée à chaque changement de langue
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void Traductions::bind(std::function<void()> refresh)
+{
+    composed.append(std::move(refresh));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant à chaque widget enregistré son texte dans la langue courante, puis
+//* recalculant les textes composés
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void Traductions::retranslate() const
+{
+    for (const QPair<QLabel*, Message>& binding : labels)
+    {
+        binding.first->setText(text(binding.second));
+    }
+    for (const QPair<QAbstractButton*, Message>& binding : buttons)
+    {
+        binding.first->setText(text(binding.second));
+    }
+    for (const std::function<void()>& refresh : composed)
+    {
+        refresh();
+    }
+}
+
+void Traductions::load(int language)
+{
+    for (int message = 0; message < MESSAGE_COUNT; ++message)
+    {
+        catalog[language][message] = QString::fromUtf8(TABLE[language][message]);
+    }
+    loaded[language] = true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <functional>
+
+class QAbstractButton;
+class QLabel;
+
+// Textes de l'interface, repérés par leur identifiant dans la table des traductions
+enum class Message : quint16
+{
+    OpenPort,
+    AutoMode,
+    Initialise,
+    Zoom,
+    ChangeLanguage,
+    MoveDown,
+    MoveLeft,
+    MoveRight,
+    MoveUp,
+    PowerOn,
+    SelectPort,
+    PortOpen,
+    PortError,          // %1 : le message d'erreur du port
+    LinkLost,           // %1 : le port
+    LinkRestored,       // %1 : le port, %2 : le temps de reconnexion en ms
+    MotionDetected,     // %1 : la zone
+    Record,
+    Recording,          // %1 : la cause du déclenchement
+    RecordingFailed,    // %1 : le message d'erreur de l'enregistreur
+    Position,           // %1 : pan, %2 : tilt, %3 : zoom
+    LinkStats,          // %1 : débit, %2 : "?" si non confirmé, %3 / %4 : octets/s émis / reçus,
+                        // %5 / %6 : RTT médian / p95 (ms), %7 : erreurs (%), %8 : renvois,
+                        // %9 : délais dépassés
+    Count
+};
+
+// Table des traductions : les textes d'une langue sont convertis en QString à sa première
+// sélection seulement, puis chaque texte n'est plus qu'une lecture dans un tableau. Les
+// widgets enregistrés sont retraduits en un seul passage au changement de langue, les
+// textes composés (valeurs insérées dans un texte traduit) sont recalculés par leur fonction.
+class Traductions
+{
+public:
+    static constexpr int LANGUAGE_COUNT = 11;   // Dans l'ordre de la liste ChoseLanguage
+    static constexpr int MESSAGE_COUNT = static_cast<int>(Message::Count);
+
+    bool setLanguage(int language);
+    int language() const { return current; }
+    const QString& text(Message message) const;
+
+    void bind(QLabel* label, Message message);
+    void bind(QAbstractButton* button, Message message);
+    void bind(std::function<void()> refresh);
+    void retranslate() const;
+
+private:
+    void load(int language);
+
+    int current = -1;
+    const QString* texts = nullptr;     // Textes de la langue courante
+    QString catalog[LANGUAGE_COUNT][MESSAGE_COUNT];
+    bool loaded[LANGUAGE_COUNT] = {};
+    QList<QPair<QLabel*, Message>> labels;
+    QList<QPair<QAbstractButton*, Message>> buttons;
+    QList<std::function<void()>> composed;
+};
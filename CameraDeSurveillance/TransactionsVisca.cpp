@@ -0,0 +1,890 @@
+﻿//*********************************************************************************************
+//* Programme : TransactionsVisca.cpp                                          Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Suivre chaque commande VISCA envoyée sur une chaîne de caméras (ACK, Completion,
+//*       erreurs) et occuper les deux sockets de chaque caméra sans jamais les dépasser.
+//* Programmes associés : ControleCamera.cpp
+//*********************************************************************************************
+
+#include "TransactionsVisca.h"
+#include "Metriques.h"
+#include <QDebug>
+#include <algorithm>
+
+// Identifiants uniques dans tout le programme : plusieurs chaînes peuvent en réserver en parallèle
+std::atomic<quint32> TransactionsVisca::nextId(1);
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe TransactionsVisca
+//* Paramètres :
+//*  - Writer writer : la fonction qui écrit un paquet sur le port série
+//*  - QObject* parent : l'objet parent
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+TransactionsVisca::TransactionsVisca(Writer writer, QObject* parent)
+    : QObject(parent), writer(std::move(writer)), timeoutTimer(this)
+{
+    clock.start();
+
+    // Les délais ne sont examinés que tant qu'une réponse est attendue ou qu'une caméra attend
+    timeoutTimer.setInterval(CHECK_INTERVAL_MS);
+    connect(&timeoutTimer, &QTimer::timeout, this, &TransactionsVisca::checkTimeouts);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction réservant un identifiant de transaction avant l'envoi effectif de la commande
+//* Elle peut être appelée depuis n'importe quel thread.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : quint32, un identifiant jamais nul
+//---------------------------------------------------------------------------------------------
+quint32 TransactionsVisca::allocateId()
+{
+    quint32 id = nextId.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0)
+    {
+        id = nextId.fetch_add(1, std::memory_order_relaxed);  // 0 est réservé pour « aucune transaction »
+    }
+    return id;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de soumettre une commande ; elle est envoyée dès qu'un socket est libre
+//* Paramètres :
+//*  - const Visca::Command& command : la commande ou l'interrogation à envoyer
+//*  - quint32 id : l'identifiant réservé par allocateId(), ou 0 pour en attribuer un
+//*  - bool preemptible : vrai si un arrêt d'urgence peut l'annuler en cours d'exécution
+//*
+//* Valeur de retour : quint32, l'identifiant de la transaction repris par les signaux
+//---------------------------------------------------------------------------------------------
+quint32 TransactionsVisca::submit(const Visca::Command& command, quint32 id, bool preemptible)
+{
+    Transaction transaction;
+    transaction.id = id != 0 ? id : allocateId();
+    transaction.command = command;
+    transaction.preemptible = preemptible;
+
+    pending.append(transaction);
+    pump();
+    return transaction.id;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de traiter une réponse de la caméra et de résoudre la transaction associée
+//* Paramètres :
+//*  - const Visca::Reply& reply : la réponse décodée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::handleReply(const Visca::Reply& reply)
+{
+    Camera& camera = cameras[reply.address % ADDRESS_SLOTS];
+
+    switch (reply.type)
+    {
+    case Visca::ReplyType::Ack:
+        // Chaque caméra traite ses commandes dans l'ordre : l'ACK concerne la plus ancienne
+        if (!camera.awaitingAck.isEmpty() && reply.socket >= 1 && reply.socket <= SOCKET_COUNT)
+        {
+            camera.sockets[reply.socket] = camera.awaitingAck.takeFirst();
+            Metriques::observe(Metrique::Histogram::AckLatency, elapsedUs(camera.sockets[reply.socket]));
+            camera.sockets[reply.socket].deadline =
+                deadlineAfter(PolitiqueReprise::completionTimeoutMs(camera.sockets[reply.socket].command));
+            emit commandAcknowledged(camera.sockets[reply.socket].id, reply.socket);
+
+            // Un arrêt est arrivé pendant que la commande attendait son ACK
+            if (camera.sockets[reply.socket].cancelOnAck)
+            {
+                sendCancel(reply.address, reply.socket);
+            }
+        }
+        break;
+
+    case Visca::ReplyType::Completion:
+        if (reply.socket >= 1 && reply.socket <= SOCKET_COUNT && camera.sockets[reply.socket].id != 0)
+        {
+            quint32 id = camera.sockets[reply.socket].id;
+            Metriques::observe(Metrique::Histogram::CompletionLatency, elapsedUs(camera.sockets[reply.socket]));
+            camera.sockets[reply.socket] = Transaction();
+            emit commandCompleted(id);
+        }
+        else if (reply.socket == 0 && camera.recovering)
+        {
+            // Réponse à l'IF_Clear de la caméra : ses tampons sont vides, les renvois peuvent partir
+            camera.recovering = false;
+            emit cameraReady(reply.address);
+        }
+        else if (reply.socket == 0)
+        {
+            // Réponse à un IF_Clear adressé soumis par l'application : seule cette caméra a vidé
+            // ses tampons
+            for (int index = 0; index < camera.awaitingAck.size(); ++index)
+            {
+                if (camera.awaitingAck.at(index).command.isIfClear())
+                {
+                    quint32 id = camera.awaitingAck.takeAt(index).id;
+                    clear(reply.address);
+                    emit commandCompleted(id);
+                    break;
+                }
+            }
+        }
+        break;
+
+    case Visca::ReplyType::InquiryReply:
+        if (camera.inquiry.id != 0)
+        {
+            quint32 id = camera.inquiry.id;
+            Metriques::observe(Metrique::Histogram::AckLatency, elapsedUs(camera.inquiry));
+            camera.inquiry = Transaction();
+            emit inquiryCompleted(id, reply);
+        }
+        break;
+
+    case Visca::ReplyType::Error:
+        if (reply.error == Visca::NoSocket || camera.recovering)
+        {
+            // Réponse à un Cancel arrivé après la fin de la commande, ou annulation par l'IF_Clear
+            // de commandes déjà abandonnées : rien n'est à résoudre
+            break;
+        }
+        if (reply.socket >= 1 && reply.socket <= SOCKET_COUNT && camera.sockets[reply.socket].id != 0)
+        {
+            // Erreur sur une commande en cours d'exécution (annulée, non exécutable...)
+            quint32 id = camera.sockets[reply.socket].id;
+            camera.sockets[reply.socket] = Transaction();
+            fail(id, reply.error);
+        }
+        else if (!camera.awaitingAck.isEmpty())
+        {
+            // Erreur renvoyée à la place de l'ACK (syntaxe, tampon plein...). Une commande refusée
+            // faute de place n'a pas été exécutée : elle repart après une attente croissante
+            Transaction transaction = camera.awaitingAck.takeFirst();
+            if (reply.error == Visca::CommandBufferFull && !transaction.cancelOnAck
+                && transaction.attempts < PolitiqueReprise::MAX_RETRIES)
+            {
+                ++counters.bufferFull;
+                retry(transaction, Visca::CommandBufferFull);
+            }
+            else
+            {
+                fail(transaction.id, reply.error);
+            }
+        }
+        else if (camera.inquiry.id != 0)
+        {
+            quint32 id = camera.inquiry.id;
+            camera.inquiry = Transaction();
+            fail(id, reply.error);
+        }
+        break;
+
+    case Visca::ReplyType::AddressSet:
+        // Le dernier octet donne la première adresse libre : les caméras sont numérotées de 1 à w-1
+        if (broadcast.id != 0)
+        {
+            quint32 id = broadcast.id;
+            broadcast = Transaction();
+            emit inquiryCompleted(id, reply);
+        }
+        break;
+
+    case Visca::ReplyType::Broadcast:
+        // La commande a traversé toute la chaîne : chaque caméra l'a reçue et l'exécute, sans
+        // ACK ni Completion de leur part
+        if (broadcast.id != 0 && broadcast.command.size == reply.size
+            && std::equal(reply.bytes, reply.bytes + reply.size, broadcast.command.bytes))
+        {
+            quint32 id = broadcast.id;
+            Metriques::observe(Metrique::Histogram::AckLatency, elapsedUs(broadcast));
+            broadcast = Transaction();
+            emit commandCompleted(id);
+        }
+        break;
+
+    case Visca::ReplyType::IfClear:
+    {
+        // Les caméras de la chaîne ont vidé leurs tampons : ce qu'elles exécutaient est perdu,
+        // les commandes pas encore écrites partent ensuite normalement
+        quint32 id = broadcast.command.isIfClear() ? broadcast.id : 0;
+        if (id != 0)
+        {
+            broadcast = Transaction();
+        }
+        clear(Visca::BROADCAST_ADDRESS);
+        if (id != 0)
+        {
+            emit commandCompleted(id);
+        }
+        break;
+    }
+
+    default:
+        qDebug() << "Réponse VISCA non reconnue";
+        break;
+    }
+
+    pump();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction abandonnant les commandes qu'un IF_Clear a effacées des tampons : celles d'une
+//* caméra, ou de toute la chaîne pour un IF_Clear diffusé. Elles échouent (CommandCancelled) ;
+//* les commandes en attente d'un socket et celles retenues par holdWrites() n'ont pas encore
+//* été écrites et restent en file.
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7), ou 8 pour toute la chaîne
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::clear(std::uint8_t address)
+{
+    QList<Transaction> dropped;
+    const std::uint8_t first = address == Visca::BROADCAST_ADDRESS ? 1 : address;
+    const std::uint8_t last = address == Visca::BROADCAST_ADDRESS ? Visca::BROADCAST_ADDRESS - 1 : address;
+
+    for (std::uint8_t slot = first; slot <= last; ++slot)
+    {
+        Camera& camera = cameras[slot % ADDRESS_SLOTS];
+        QList<Transaction> unwritten;
+        for (const Transaction& transaction : camera.awaitingAck)
+        {
+            (burstIds.contains(transaction.id) ? unwritten : dropped).append(transaction);
+        }
+        camera.awaitingAck.swap(unwritten);
+
+        for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+        {
+            if (camera.sockets[socket].id != 0)
+            {
+                dropped.append(camera.sockets[socket]);
+                camera.sockets[socket] = Transaction();
+            }
+        }
+        if (camera.inquiry.id != 0 && !burstIds.contains(camera.inquiry.id))
+        {
+            dropped.append(camera.inquiry);
+            camera.inquiry = Transaction();
+        }
+        camera.resumeAt = 0;
+        if (camera.recovering)
+        {
+            camera.recovering = false;
+            emit cameraReady(slot);
+        }
+    }
+
+    for (const Transaction& transaction : dropped)
+    {
+        fail(transaction.id, Visca::CommandCancelled);
+    }
+    updateTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'abandonner toutes les transactions (port fermé)
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::reset()
+{
+    QList<Transaction> dropped;
+    dropped.swap(pending);
+
+    for (Camera& camera : cameras)
+    {
+        dropped.append(camera.awaitingAck);
+        camera.awaitingAck.clear();
+
+        for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+        {
+            if (camera.sockets[socket].id != 0)
+            {
+                dropped.append(camera.sockets[socket]);
+                camera.sockets[socket] = Transaction();
+            }
+        }
+        if (camera.inquiry.id != 0)
+        {
+            dropped.append(camera.inquiry);
+            camera.inquiry = Transaction();
+        }
+        camera.resumeAt = 0;
+        camera.recovering = false;
+    }
+    if (broadcast.id != 0)
+    {
+        dropped.append(broadcast);
+        broadcast = Transaction();
+    }
+    burst.clear();
+    burstIds.clear();
+
+    Metriques::add(Metrique::Counter::Errors, static_cast<quint64>(dropped.size()));
+    for (const Transaction& transaction : dropped)
+    {
+        emit commandFailed(transaction.id, Visca::CommandCancelled);
+    }
+    updateTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant de libérer les sockets d'une caméra au profit d'un arrêt : chaque
+//* commande annulable en cours reçoit un Cancel (8x 2y FF), sa réponse y0 6y 04 FF libère le
+//* socket et la fait échouer (CommandCancelled) ; une commande qui attend encore son ACK est
+//* annulée dès qu'il arrive
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7)
+//*
+//* Valeur de retour : int, le nombre de commandes annulées ou marquées pour l'être
+//---------------------------------------------------------------------------------------------
+int TransactionsVisca::cancel(std::uint8_t address)
+{
+    if (address == 0 || address >= Visca::BROADCAST_ADDRESS)
+    {
+        return 0;
+    }
+
+    Camera& camera = cameras[address % ADDRESS_SLOTS];
+    int cancelled = 0;
+
+    for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+    {
+        Transaction& transaction = camera.sockets[socket];
+        if (transaction.id != 0 && transaction.preemptible && !transaction.cancelOnAck)
+        {
+            transaction.cancelOnAck = true;     // Un seul Cancel par commande
+            if (sendCancel(address, socket))
+            {
+                ++cancelled;
+            }
+        }
+    }
+    for (Transaction& transaction : camera.awaitingAck)
+    {
+        if (transaction.preemptible && !transaction.cancelOnAck)
+        {
+            transaction.cancelOnAck = true;
+            ++cancelled;
+        }
+    }
+    return cancelled;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions groupant les écritures : une commande de groupe ou une Completion qui libère
+//* plusieurs caméras fait partir toutes ses commandes en une écriture sur le port, au lieu
+//* d'une par caméra. Les commandes retenues sont suivies comme envoyées ; si l'écriture
+//* échoue, elles échouent toutes (WRITE_ERROR).
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::holdWrites()
+{
+    ++holdDepth;
+}
+
+void TransactionsVisca::releaseWrites()
+{
+    if (holdDepth == 0 || --holdDepth > 0 || burstIds.isEmpty())
+    {
+        return;
+    }
+
+    QByteArray data;
+    QList<quint32> ids;
+    data.swap(burst);
+    ids.swap(burstIds);
+
+    if (writer && writer(data.constData(), data.size()))
+    {
+        if (ids.size() > 1)
+        {
+            ++counters.bursts;
+        }
+        Metriques::add(Metrique::Counter::CommandsSent, static_cast<quint64>(ids.size()));
+        for (quint32 id : ids)
+        {
+            emit commandSent(id);
+        }
+        return;
+    }
+
+    for (quint32 id : ids)
+    {
+        untrack(id);
+        fail(id, WRITE_ERROR);
+    }
+    updateTimer();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions d'état de la file de transactions
+//---------------------------------------------------------------------------------------------
+int TransactionsVisca::pendingCount() const
+{
+    return pending.size();
+}
+
+int TransactionsVisca::inFlightCount() const
+{
+    int count = broadcast.id != 0 ? 1 : 0;
+    for (const Camera& camera : cameras)
+    {
+        count += camera.awaitingAck.size() + busySockets(camera) + (camera.inquiry.id != 0 ? 1 : 0);
+    }
+    return count;
+}
+
+bool TransactionsVisca::isIdle() const
+{
+    return pending.isEmpty() && inFlightCount() == 0;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction indiquant si une nouvelle commande pour cette adresse partirait immédiatement
+//* Les interrogations ont leur propre place (une à la fois, sans socket) : une interrogation en
+//* attente ne retient pas les commandes de la caméra, et inversement.
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7) ou 8 pour la diffusion
+//*  - bool inquiry : vrai pour une interrogation, faux pour une commande
+//*
+//* Valeur de retour : bool, vrai si rien de même nature n'attend pour cette adresse et que la
+//*                    place (socket ou interrogation) est libre
+//---------------------------------------------------------------------------------------------
+bool TransactionsVisca::canAccept(std::uint8_t address, bool inquiry) const
+{
+    for (const Transaction& transaction : pending)
+    {
+        if (transaction.command.address() == address && transaction.command.isInquiry() == inquiry)
+        {
+            return false;
+        }
+    }
+
+    if (address == Visca::BROADCAST_ADDRESS)
+    {
+        return broadcast.id == 0;
+    }
+    const Camera& camera = cameras[address % ADDRESS_SLOTS];
+    if (isPaused(camera))
+    {
+        return false;
+    }
+    if (inquiry)
+    {
+        return camera.inquiry.id == 0;
+    }
+    return camera.awaitingAck.size() + busySockets(camera) < SOCKET_COUNT;
+}
+
+int TransactionsVisca::busySockets(const Camera& camera)
+{
+    int busy = 0;
+    for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+    {
+        if (camera.sockets[socket].id != 0)
+        {
+            ++busy;
+        }
+    }
+    return busy;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'envoyer les commandes en attente tant que les caméras peuvent les
+//* accepter ; une caméra occupée ne bloque pas les autres caméras de la chaîne. Les commandes
+//* parties ensemble sont écrites en une fois.
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::pump()
+{
+    bool blocked[ADDRESS_SLOTS][2] = {};
+    holdWrites();
+
+    int index = 0;
+    while (index < pending.size())
+    {
+        const Visca::Command& command = pending.at(index).command;
+        bool& addressBlocked = blocked[command.address() % ADDRESS_SLOTS][command.isInquiry() ? 1 : 0];
+
+        // L'ordre est conservé pour une même adresse, séparément pour les commandes et pour les
+        // interrogations : une interrogation qui attend sa place ne retient pas un arrêt
+        if (addressBlocked || !canSend(command))
+        {
+            addressBlocked = true;
+            ++index;
+            continue;
+        }
+
+        Transaction transaction = pending.takeAt(index);
+        transaction.sentAt = clock.nsecsElapsed();
+        transaction.deadline = deadlineAfter(PolitiqueReprise::ackTimeoutMs(transaction.command));
+        if (send(transaction))
+        {
+            track(transaction);
+        }
+    }
+    updateTimer();
+    releaseWrites();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction indiquant si la caméra destinataire peut recevoir la commande maintenant
+//* Paramètres :
+//*  - const Visca::Command& command : la commande à envoyer
+//*
+//* Valeur de retour : bool, vrai si la commande peut être écrite sur le port
+//---------------------------------------------------------------------------------------------
+bool TransactionsVisca::canSend(const Visca::Command& command) const
+{
+    if (command.address() == Visca::BROADCAST_ADDRESS)
+    {
+        return broadcast.id == 0;
+    }
+
+    const Camera& camera = cameras[command.address() % ADDRESS_SLOTS];
+    if (isPaused(camera))
+    {
+        return false;
+    }
+    if (command.isInquiry())
+    {
+        // Une seule interrogation à la fois : sa réponse ne porte pas de numéro de socket
+        return camera.inquiry.id == 0;
+    }
+    return camera.awaitingAck.size() + busySockets(camera) < SOCKET_COUNT;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction enregistrant une transaction envoyée dans l'état de sa caméra
+//* Paramètres :
+//*  - const Transaction& transaction : la transaction envoyée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::track(const Transaction& transaction)
+{
+    if (transaction.command.address() == Visca::BROADCAST_ADDRESS)
+    {
+        broadcast = transaction;
+        return;
+    }
+
+    Camera& camera = cameras[transaction.command.address() % ADDRESS_SLOTS];
+    if (transaction.command.isInquiry())
+    {
+        camera.inquiry = transaction;
+    }
+    else
+    {
+        camera.awaitingAck.append(transaction);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction retirant une transaction envoyée de l'état de sa caméra (écriture groupée échouée)
+//* Paramètres :
+//*  - quint32 id : l'identifiant de la transaction
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::untrack(quint32 id)
+{
+    if (broadcast.id == id)
+    {
+        broadcast = Transaction();
+        return;
+    }
+    for (Camera& camera : cameras)
+    {
+        if (camera.inquiry.id == id)
+        {
+            camera.inquiry = Transaction();
+            return;
+        }
+        for (int index = 0; index < camera.awaitingAck.size(); ++index)
+        {
+            if (camera.awaitingAck.at(index).id == id)
+            {
+                camera.awaitingAck.removeAt(index);
+                return;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction permettant d'écrire une transaction sur le port, ou de la retenir pendant
+//* holdWrites()
+//* Paramètres :
+//*  - const Transaction& transaction : la transaction à envoyer
+//*
+//* Valeur de retour : bool, vrai si le paquet a été écrit ou retenu, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool TransactionsVisca::send(const Transaction& transaction)
+{
+    if (holdDepth > 0)
+    {
+        burst.append(transaction.command.data(), transaction.command.size);
+        burstIds.append(transaction.id);
+        return true;
+    }
+
+    if (writer && writer(transaction.command.data(), transaction.command.size))
+    {
+        Metriques::add(Metrique::Counter::CommandsSent);
+        emit commandSent(transaction.id);
+        return true;
+    }
+
+    fail(transaction.id, WRITE_ERROR);
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction écrivant un Cancel ; il n'occupe pas de socket et part sans attendre de place
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra
+//*  - int socket : le socket de la commande à annuler
+//*
+//* Valeur de retour : bool, vrai si le paquet a été écrit, sinon faux.
+//---------------------------------------------------------------------------------------------
+bool TransactionsVisca::sendCancel(std::uint8_t address, int socket)
+{
+    Visca::Command command = Visca::cancel(address, static_cast<std::uint8_t>(socket));
+    return writer && writer(command.data(), command.size);
+}
+
+void TransactionsVisca::fail(quint32 id, int errorCode)
+{
+    qDebug() << "Commande VISCA" << id << "en échec, code" << errorCode;
+    Metriques::add(Metrique::Counter::Errors);
+    emit commandFailed(id, errorCode);
+}
+
+qint64 TransactionsVisca::elapsedUs(const Transaction& transaction) const
+{
+    return (clock.nsecsElapsed() - transaction.sentAt) / 1000;
+}
+
+qint64 TransactionsVisca::deadlineAfter(qint64 timeoutMs) const
+{
+    return clock.nsecsElapsed() + timeoutMs * 1000000;
+}
+
+bool TransactionsVisca::isPaused(const Camera& camera) const
+{
+    return camera.recovering || (camera.resumeAt != 0 && clock.nsecsElapsed() < camera.resumeAt);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction appelée toutes les CHECK_INTERVAL_MS tant que des réponses sont attendues : une
+//* interrogation ou une diffusion sans réponse est renvoyée ; une caméra dont un ACK ou une
+//* Completion manque a des sockets dans un état inconnu et reçoit un IF_Clear
+//* Paramètres :
+//*  Aucun paramètre
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::checkTimeouts()
+{
+    qint64 now = clock.nsecsElapsed();
+
+    for (std::uint8_t address = 1; address < Visca::BROADCAST_ADDRESS; ++address)
+    {
+        Camera& camera = cameras[address];
+
+        if (camera.recovering)
+        {
+            // IF_Clear resté sans réponse : la caméra est reprise telle quelle
+            if (now >= camera.recoveryDeadline)
+            {
+                camera.recovering = false;
+                emit cameraReady(address);
+            }
+            continue;
+        }
+        if (camera.resumeAt != 0 && now >= camera.resumeAt)
+        {
+            camera.resumeAt = 0;
+            emit cameraReady(address);
+        }
+
+        int expired = 0;
+        for (const Transaction& transaction : camera.awaitingAck)
+        {
+            if (now >= transaction.deadline)
+            {
+                ++expired;
+                emit commandTimedOut(transaction.id);
+            }
+        }
+        for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+        {
+            if (camera.sockets[socket].id != 0 && now >= camera.sockets[socket].deadline)
+            {
+                ++expired;
+                emit commandTimedOut(camera.sockets[socket].id);
+            }
+        }
+        if (expired > 0)
+        {
+            counters.timeouts += static_cast<quint64>(expired);
+            Metriques::add(Metrique::Counter::Timeouts, static_cast<quint64>(expired));
+            recover(address);
+        }
+
+        // Une interrogation n'occupe pas de socket : elle est simplement renvoyée
+        if (camera.inquiry.id != 0 && now >= camera.inquiry.deadline)
+        {
+            Transaction transaction = camera.inquiry;
+            camera.inquiry = Transaction();
+            ++counters.timeouts;
+            Metriques::add(Metrique::Counter::Timeouts);
+            emit commandTimedOut(transaction.id);
+            abandon(transaction);
+        }
+    }
+
+    if (broadcast.id != 0 && now >= broadcast.deadline)
+    {
+        Transaction transaction = broadcast;
+        broadcast = Transaction();
+        ++counters.timeouts;
+        Metriques::add(Metrique::Counter::Timeouts);
+        emit commandTimedOut(transaction.id);
+        abandon(transaction);
+    }
+
+    pump();
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction libérant les sockets d'une caméra dont une réponse s'est perdue : ses commandes en
+//* cours sont abandonnées (renvoyées si possible) et un IF_Clear (8x 01 00 01 FF) vide ses
+//* tampons ; rien ne lui est envoyé avant sa réponse y0 50 FF ou RECOVERY_TIMEOUT_MS
+//* Paramètres :
+//*  - std::uint8_t address : l'adresse de la caméra (1 à 7)
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::recover(std::uint8_t address)
+{
+    Camera& camera = cameras[address % ADDRESS_SLOTS];
+
+    QList<Transaction> lost;
+    lost.swap(camera.awaitingAck);
+    for (int socket = 1; socket <= SOCKET_COUNT; ++socket)
+    {
+        if (camera.sockets[socket].id != 0)
+        {
+            lost.append(camera.sockets[socket]);
+            camera.sockets[socket] = Transaction();
+        }
+    }
+
+    camera.recovering = true;
+    camera.recoveryDeadline = deadlineAfter(PolitiqueReprise::RECOVERY_TIMEOUT_MS);
+    ++counters.recoveries;
+    Metriques::add(Metrique::Counter::Recoveries);
+    emit recoveryStarted(address);
+
+    Visca::Command command = Visca::ifClear(address);
+    if (!writer || !writer(command.data(), command.size))
+    {
+        camera.recovering = false;
+    }
+
+    // Les renvois reprennent la tête de la file dans leur ordre d'envoi
+    for (int index = lost.size() - 1; index >= 0; --index)
+    {
+        abandon(lost.at(index));
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction décidant du sort d'une commande restée sans réponse : renvoyée si elle peut l'être
+//* sans effet de bord et qu'il lui reste des essais, sinon en échec (TIMEOUT, ou
+//* CommandCancelled si un arrêt l'avait annulée)
+//* Paramètres :
+//*  - Transaction transaction : la commande abandonnée
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::abandon(Transaction transaction)
+{
+    // Un mouvement qu'un arrêt a demandé d'annuler n'est jamais renvoyé
+    if (transaction.cancelOnAck)
+    {
+        fail(transaction.id, Visca::CommandCancelled);
+    }
+    else if (transaction.attempts < PolitiqueReprise::MAX_RETRIES && PolitiqueReprise::isIdempotent(transaction.command))
+    {
+        retry(transaction, TIMEOUT);
+    }
+    else
+    {
+        fail(transaction.id, TIMEOUT);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction remettant une commande en tête de la file d'attente pour un nouvel essai ; sa
+//* caméra ne reçoit plus rien pendant une attente qui double à chaque essai (backoffMs)
+//* Paramètres :
+//*  - Transaction transaction : la commande à renvoyer
+//*  - int reason : TIMEOUT ou Visca::CommandBufferFull
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::retry(Transaction transaction, int reason)
+{
+    ++transaction.attempts;
+    ++counters.retries;
+    Metriques::add(Metrique::Counter::Retries);
+    emit commandRetried(transaction.id, reason);
+
+    if (transaction.command.address() != Visca::BROADCAST_ADDRESS)
+    {
+        Camera& camera = cameras[transaction.command.address() % ADDRESS_SLOTS];
+        camera.resumeAt = std::max(camera.resumeAt, deadlineAfter(PolitiqueReprise::backoffMs(transaction.attempts)));
+    }
+    pending.prepend(transaction);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction démarrant l'examen des délais tant qu'une réponse est attendue ou qu'une caméra
+//* attend la fin d'une pause, et l'arrêtant sinon
+//---------------------------------------------------------------------------------------------
+void TransactionsVisca::updateTimer()
+{
+    bool waiting = !isIdle();
+    for (const Camera& camera : cameras)
+    {
+        waiting = waiting || camera.recovering || camera.resumeAt != 0;
+    }
+
+    if (waiting && !timeoutTimer.isActive())
+    {
+        timeoutTimer.start();
+    }
+    else if (!waiting && timeoutTimer.isActive())
+    {
+        timeoutTimer.stop();
+    }
+}
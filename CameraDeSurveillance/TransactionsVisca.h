@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+#include <atomic>
+#include <functional>
+#include "Visca.h"
+#include "PolitiqueReprise.h"
+
+class TransactionsVisca : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Nombre de sockets de commande d'une caméra VISCA
+    static constexpr int SOCKET_COUNT = 2;
+    // Code d'erreur local : la commande n'a pas pu être écrite sur le port
+    static constexpr int WRITE_ERROR = -1;
+    // Code d'erreur local : aucune réponse dans le délai, renvois épuisés ou interdits
+    static constexpr int TIMEOUT = -2;
+    static constexpr int CHECK_INTERVAL_MS = 20;    // Examen des délais tant qu'une réponse est attendue
+
+    // Compteurs de la politique de reprise, pour comparer les liaisons
+    struct Stats
+    {
+        quint64 retries = 0;        // Commandes renvoyées (délai dépassé ou tampon plein)
+        quint64 timeouts = 0;       // Réponses attendues en vain
+        quint64 bufferFull = 0;     // Refus « tampon plein » (60 03) suivis d'une attente
+        quint64 recoveries = 0;     // IF_Clear envoyés pour libérer les sockets d'une caméra
+        quint64 bursts = 0;         // Écritures groupant plusieurs commandes
+    };
+
+    using Writer = std::function<bool(const char*, qint64)>;
+
+    explicit TransactionsVisca(Writer writer, QObject* parent = nullptr);
+
+    static quint32 allocateId();
+    quint32 submit(const Visca::Command& command, quint32 id = 0, bool preemptible = false);
+    void handleReply(const Visca::Reply& reply);
+    void reset();
+    int cancel(std::uint8_t address);
+
+    // Entre holdWrites() et releaseWrites(), les commandes qui partent sont mises bout à bout
+    // et écrites sur le port en un seul appel
+    void holdWrites();
+    void releaseWrites();
+
+    int pendingCount() const;
+    int inFlightCount() const;
+    bool isIdle() const;
+    bool canAccept(std::uint8_t address, bool inquiry = false) const;
+    Stats stats() const { return counters; }
+
+signals:
+    void commandSent(quint32 id);
+    void commandAcknowledged(quint32 id, int socket);
+    void commandCompleted(quint32 id);
+    void commandFailed(quint32 id, int errorCode);
+    void inquiryCompleted(quint32 id, const Visca::Reply& reply);
+    void commandRetried(quint32 id, int reason);     // reason : TIMEOUT ou Visca::CommandBufferFull
+    void commandTimedOut(quint32 id);
+    void recoveryStarted(quint8 address);            // IF_Clear envoyé pour libérer ses sockets
+    void cameraReady(quint8 address);                // Fin d'une pause ou d'un IF_Clear : elle reçoit de nouveau
+
+private:
+    struct Transaction
+    {
+        quint32 id = 0;
+        Visca::Command command;
+        bool preemptible = false;       // Peut être annulée (Cancel) au profit d'un arrêt
+        bool cancelOnAck = false;       // Annulation demandée avant que son socket soit connu
+        qint64 sentAt = 0;              // Instant de l'écriture (ns, clock), pour les latences
+        qint64 deadline = 0;            // Réponse attendue avant cet instant (ns, clock)
+        int attempts = 0;               // Renvois déjà faits
+    };
+
+    // État d'une caméra de la chaîne : chaque adresse a ses propres sockets
+    struct Camera
+    {
+        QList<Transaction> awaitingAck;             // Commandes envoyées, ACK pas encore reçu
+        Transaction sockets[SOCKET_COUNT + 1];      // Commandes en cours d'exécution (index = socket)
+        Transaction inquiry;                        // Interrogation en attente de réponse
+        qint64 resumeAt = 0;                        // Renvoi différé : rien n'est envoyé avant (ns)
+        bool recovering = false;                    // IF_Clear envoyé, y0 50 FF attendu
+        qint64 recoveryDeadline = 0;
+    };
+
+    static constexpr int ADDRESS_SLOTS = 16;       // Adresses 1 à 7, 8 = diffusion
+
+    void pump();
+    bool canSend(const Visca::Command& command) const;
+    bool send(const Transaction& transaction);
+    bool sendCancel(std::uint8_t address, int socket);
+    void track(const Transaction& transaction);
+    void clear(std::uint8_t address);
+    void untrack(quint32 id);
+    void fail(quint32 id, int errorCode);
+    void checkTimeouts();
+    void recover(std::uint8_t address);
+    void abandon(Transaction transaction);
+    void retry(Transaction transaction, int reason);
+    void updateTimer();
+    bool isPaused(const Camera& camera) const;
+    qint64 deadlineAfter(qint64 timeoutMs) const;
+    static int busySockets(const Camera& camera);
+    qint64 elapsedUs(const Transaction& transaction) const;
+
+    static std::atomic<quint32> nextId;
+
+    Writer writer;
+    QElapsedTimer clock;
+    QTimer timeoutTimer;
+    Stats counters;
+    QList<Transaction> pending;                 // Commandes en attente d'un socket libre
+    Camera cameras[ADDRESS_SLOTS];
+    Transaction broadcast;                      // Diffusion en attente de son retour
+    int holdDepth = 0;
+    QByteArray burst;                           // Commandes retenues par holdWrites()
+    QList<quint32> burstIds;
+};
+
+Q_DECLARE_METATYPE(Visca::Reply)
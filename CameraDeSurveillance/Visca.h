@@ -0,0 +1,346 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//---------------------------------------------------------------------------------------------
+//* Encodage binaire des commandes VISCA : chaque paquet est un tableau d'octets de taille fixe
+//* construit à la compilation (commandes statiques) ou par un petit encodeur (commandes à
+//* paramètres), puis écrit directement sur le port série sans allocation ni conversion texte.
+//---------------------------------------------------------------------------------------------
+namespace Visca
+{
+    constexpr std::uint8_t BROADCAST_ADDRESS = 8;   // Adresse de diffusion (en-tête 0x88)
+    constexpr std::uint8_t TERMINATOR = 0xFF;       // Fin de paquet
+    constexpr std::size_t MAX_PACKET_SIZE = 16;     // Taille maximale d'un paquet VISCA
+
+    constexpr std::uint8_t PAN_SPEED_MAX = 0x18;
+    constexpr std::uint8_t TILT_SPEED_MAX = 0x14;
+
+    enum class PanDirection : std::uint8_t
+    {
+        Left = 0x01,
+        Right = 0x02,
+        Stop = 0x03
+    };
+
+    enum class TiltDirection : std::uint8_t
+    {
+        Up = 0x01,
+        Down = 0x02,
+        Stop = 0x03
+    };
+
+    // Paquet VISCA de N octets, terminateur compris
+    template <std::size_t N>
+    struct Packet
+    {
+        static_assert(N >= 3 && N <= MAX_PACKET_SIZE, "Taille de paquet VISCA invalide");
+
+        std::uint8_t bytes[N];
+
+        static constexpr std::size_t size() { return N; }
+        const char* data() const { return reinterpret_cast<const char*>(bytes); }
+    };
+
+    // Octet d'en-tête d'une commande envoyée par le contrôleur (adresse 0) à la caméra
+    constexpr std::uint8_t header(std::uint8_t address)
+    {
+        return static_cast<std::uint8_t>(0x80 | (address & 0x0F));
+    }
+
+    // Quartet de rang 'index' (0 = poids fort) d'une valeur 16 bits, format 0p 0q 0r 0s
+    constexpr std::uint8_t nibble(std::uint16_t value, int index)
+    {
+        return static_cast<std::uint8_t>((value >> (12 - 4 * index)) & 0x0F);
+    }
+
+    constexpr std::uint8_t clampSpeed(std::uint8_t speed, std::uint8_t max)
+    {
+        return speed < 0x01 ? 0x01 : (speed > max ? max : speed);
+    }
+
+    // Paquet de taille variable (jusqu'à 16 octets), utilisé pour mettre les commandes en file
+    struct Command
+    {
+        std::uint8_t bytes[MAX_PACKET_SIZE] = {};
+        std::uint8_t size = 0;
+
+        Command() = default;
+
+        template <std::size_t N>
+        Command(const Packet<N>& packet) : size(static_cast<std::uint8_t>(N))
+        {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                bytes[i] = packet.bytes[i];
+            }
+        }
+
+        const char* data() const { return reinterpret_cast<const char*>(bytes); }
+        std::uint8_t address() const { return bytes[0] & 0x0F; }
+        void setAddress(std::uint8_t address) { bytes[0] = header(address); }
+        bool isInquiry() const { return size > 1 && bytes[1] == 0x09; }
+        bool isIfClear() const { return size == 5 && bytes[1] == 0x01 && bytes[2] == 0x00 && bytes[3] == 0x01; }
+
+        // Arrêt d'un mouvement : Pan-tiltDrive 03 03, CAM_Zoom Stop ou CAM_Focus Stop
+        bool isStop() const
+        {
+            if (size == 9 && bytes[1] == 0x01 && bytes[2] == 0x06 && bytes[3] == 0x01)
+            {
+                return bytes[6] == static_cast<std::uint8_t>(PanDirection::Stop)
+                    && bytes[7] == static_cast<std::uint8_t>(TiltDirection::Stop);
+            }
+            return size == 6 && bytes[1] == 0x01 && bytes[2] == 0x04
+                && (bytes[3] == 0x07 || bytes[3] == 0x08) && bytes[4] == 0x00;
+        }
+    };
+
+    //-----------------------------------------------------------------------------------------
+    //* Commandes statiques
+    //-----------------------------------------------------------------------------------------
+
+    // IF_Clear : 88 01 00 01 FF en diffusion (renvoyé tel quel par la chaîne), ou 8x 01 00 01 FF
+    // pour vider les tampons de commande d'une seule caméra (réponse y0 50 FF)
+    constexpr Packet<5> ifClear(std::uint8_t address = BROADCAST_ADDRESS)
+    {
+        return { { header(address), 0x01, 0x00, 0x01, TERMINATOR } };
+    }
+
+    // AddressSet (diffusion) : 88 30 01 FF
+    constexpr Packet<4> addressSet()
+    {
+        return { { header(BROADCAST_ADDRESS), 0x30, 0x01, TERMINATOR } };
+    }
+
+    // CAM_Power On : 8x 01 04 00 02 FF
+    constexpr Packet<6> powerOn(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x01, 0x04, 0x00, 0x02, TERMINATOR } };
+    }
+
+    // CAM_Power Off : 8x 01 04 00 03 FF
+    constexpr Packet<6> powerOff(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x01, 0x04, 0x00, 0x03, TERMINATOR } };
+    }
+
+    // Pan-tiltDrive Home : 8x 01 06 04 FF
+    constexpr Packet<5> home(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x01, 0x06, 0x04, TERMINATOR } };
+    }
+
+    // CAM_Zoom Stop : 8x 01 04 07 00 FF
+    constexpr Packet<6> zoomStop(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x01, 0x04, 0x07, 0x00, TERMINATOR } };
+    }
+
+    // Cancel : 8x 2y FF, annule la commande en cours dans le socket y (réponse y0 6y 04 FF)
+    constexpr Packet<3> cancel(std::uint8_t address, std::uint8_t socket)
+    {
+        return { { header(address), static_cast<std::uint8_t>(0x20 | (socket & 0x0F)), TERMINATOR } };
+    }
+
+    //-----------------------------------------------------------------------------------------
+    //* Commandes à paramètres
+    //-----------------------------------------------------------------------------------------
+
+    // Pan-tiltDrive : 8x 01 06 01 VV WW 0p 0t FF
+    constexpr Packet<9> panTiltDrive(std::uint8_t address, std::uint8_t panSpeed, std::uint8_t tiltSpeed,
+        PanDirection pan, TiltDirection tilt)
+    {
+        return { { header(address), 0x01, 0x06, 0x01,
+            clampSpeed(panSpeed, PAN_SPEED_MAX), clampSpeed(tiltSpeed, TILT_SPEED_MAX),
+            static_cast<std::uint8_t>(pan), static_cast<std::uint8_t>(tilt), TERMINATOR } };
+    }
+
+    // Pan-tiltDrive Stop : 8x 01 06 01 VV WW 03 03 FF
+    constexpr Packet<9> panTiltStop(std::uint8_t address = 1)
+    {
+        return panTiltDrive(address, PAN_SPEED_MAX, TILT_SPEED_MAX, PanDirection::Stop, TiltDirection::Stop);
+    }
+
+    // Pan-tiltDrive RelativePosition : 8x 01 06 03 VV WW 0Y 0Y 0Y 0Y 0Z 0Z 0Z 0Z FF
+    constexpr Packet<15> relativePosition(std::uint8_t address, std::uint8_t panSpeed, std::uint8_t tiltSpeed,
+        std::uint16_t pan, std::uint16_t tilt)
+    {
+        return { { header(address), 0x01, 0x06, 0x03,
+            clampSpeed(panSpeed, PAN_SPEED_MAX), clampSpeed(tiltSpeed, TILT_SPEED_MAX),
+            nibble(pan, 0), nibble(pan, 1), nibble(pan, 2), nibble(pan, 3),
+            nibble(tilt, 0), nibble(tilt, 1), nibble(tilt, 2), nibble(tilt, 3), TERMINATOR } };
+    }
+
+    // Pan-tiltDrive AbsolutePosition : 8x 01 06 02 VV WW 0Y 0Y 0Y 0Y 0Z 0Z 0Z 0Z FF
+    constexpr Packet<15> absolutePosition(std::uint8_t address, std::uint8_t panSpeed, std::uint8_t tiltSpeed,
+        std::uint16_t pan, std::uint16_t tilt)
+    {
+        return { { header(address), 0x01, 0x06, 0x02,
+            clampSpeed(panSpeed, PAN_SPEED_MAX), clampSpeed(tiltSpeed, TILT_SPEED_MAX),
+            nibble(pan, 0), nibble(pan, 1), nibble(pan, 2), nibble(pan, 3),
+            nibble(tilt, 0), nibble(tilt, 1), nibble(tilt, 2), nibble(tilt, 3), TERMINATOR } };
+    }
+
+    // CAM_Zoom Direct : 8x 01 04 47 0p 0q 0r 0s FF
+    constexpr Packet<9> zoomDirect(std::uint8_t address, std::uint16_t position)
+    {
+        return { { header(address), 0x01, 0x04, 0x47,
+            nibble(position, 0), nibble(position, 1), nibble(position, 2), nibble(position, 3), TERMINATOR } };
+    }
+
+    // CAM_Focus Direct : 8x 01 04 48 0p 0q 0r 0s FF
+    constexpr Packet<9> focusDirect(std::uint8_t address, std::uint16_t position)
+    {
+        return { { header(address), 0x01, 0x04, 0x48,
+            nibble(position, 0), nibble(position, 1), nibble(position, 2), nibble(position, 3), TERMINATOR } };
+    }
+
+    // CAM_Memory Reset / Set / Recall : 8x 01 04 3F 00/01/02 pp FF (pp = 0 à 15)
+    constexpr std::uint8_t MEMORY_COUNT = 16;
+
+    constexpr Packet<7> memoryReset(std::uint8_t address, std::uint8_t preset)
+    {
+        return { { header(address), 0x01, 0x04, 0x3F, 0x00, static_cast<std::uint8_t>(preset & 0x0F), TERMINATOR } };
+    }
+
+    constexpr Packet<7> memorySet(std::uint8_t address, std::uint8_t preset)
+    {
+        return { { header(address), 0x01, 0x04, 0x3F, 0x01, static_cast<std::uint8_t>(preset & 0x0F), TERMINATOR } };
+    }
+
+    constexpr Packet<7> memoryRecall(std::uint8_t address, std::uint8_t preset)
+    {
+        return { { header(address), 0x01, 0x04, 0x3F, 0x02, static_cast<std::uint8_t>(preset & 0x0F), TERMINATOR } };
+    }
+
+    //-----------------------------------------------------------------------------------------
+    //* Interrogations (réponse y0 50 ... FF sans numéro de socket)
+    //-----------------------------------------------------------------------------------------
+
+    // CAM_PowerInq : 8x 09 04 00 FF -> y0 50 02 FF (allumée) ou y0 50 03 FF (veille)
+    constexpr Packet<5> powerInquiry(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x09, 0x04, 0x00, TERMINATOR } };
+    }
+
+    // Pan-tiltPosInq : 8x 09 06 12 FF -> y0 50 0w 0w 0w 0w 0z 0z 0z 0z FF
+    constexpr Packet<5> panTiltPosInquiry(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x09, 0x06, 0x12, TERMINATOR } };
+    }
+
+    // CAM_ZoomPosInq : 8x 09 04 47 FF -> y0 50 0p 0q 0r 0s FF
+    constexpr Packet<5> zoomPosInquiry(std::uint8_t address = 1)
+    {
+        return { { header(address), 0x09, 0x04, 0x47, TERMINATOR } };
+    }
+
+    //-----------------------------------------------------------------------------------------
+    //* Réponses de la caméra
+    //-----------------------------------------------------------------------------------------
+
+    enum class ReplyType : std::uint8_t
+    {
+        Unknown,
+        Ack,            // y0 4z FF : commande acceptée dans le socket z
+        Completion,     // y0 5z FF : commande du socket z terminée
+        InquiryReply,   // y0 50 ... FF : réponse à une interrogation
+        Error,          // y0 6z ee FF : erreur ee sur le socket z (0 si aucun)
+        AddressSet,     // 88 30 0w FF : w = prochaine adresse libre sur la chaîne
+        IfClear,        // 88 01 00 01 FF : tampons des caméras vidés
+        Broadcast       // 88 01 ... FF : commande de diffusion revenue, reçue par toute la chaîne
+    };
+
+    enum ErrorCode : std::uint8_t
+    {
+        MessageLengthError = 0x01,
+        SyntaxError = 0x02,
+        CommandBufferFull = 0x03,
+        CommandCancelled = 0x04,
+        NoSocket = 0x05,
+        CommandNotExecutable = 0x41
+    };
+
+    struct Reply
+    {
+        ReplyType type = ReplyType::Unknown;
+        std::uint8_t address = 0;   // Adresse de la caméra émettrice (1 à 7)
+        std::uint8_t socket = 0;
+        std::uint8_t error = 0;
+        std::uint8_t size = 0;
+        std::uint8_t bytes[MAX_PACKET_SIZE] = {};
+    };
+
+    // Décode un paquet complet (terminateur FF compris) reçu de la caméra
+    inline Reply parseReply(const std::uint8_t* data, std::size_t size)
+    {
+        Reply reply;
+        if (size < 3 || size > MAX_PACKET_SIZE || data[size - 1] != TERMINATOR || (data[0] & 0x80) == 0)
+        {
+            return reply;
+        }
+
+        reply.size = static_cast<std::uint8_t>(size);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            reply.bytes[i] = data[i];
+        }
+
+        // Messages de diffusion qui ont fait le tour de la chaîne
+        if (data[0] == header(BROADCAST_ADDRESS))
+        {
+            if (data[1] == 0x30 && size == 4)
+            {
+                reply.type = ReplyType::AddressSet;
+            }
+            else if (data[1] == 0x01 && size == 5 && data[2] == 0x00 && data[3] == 0x01)
+            {
+                reply.type = ReplyType::IfClear;
+            }
+            else if (data[1] == 0x01)
+            {
+                reply.type = ReplyType::Broadcast;
+            }
+            return reply;
+        }
+
+        // Les réponses sont adressées au contrôleur (adresse 0)
+        if ((data[0] & 0x0F) != 0)
+        {
+            return reply;
+        }
+
+        reply.address = (data[0] >> 4) & 0x07;
+        reply.socket = data[1] & 0x0F;
+
+        switch (data[1] & 0xF0)
+        {
+        case 0x40:
+            reply.type = size == 3 ? ReplyType::Ack : ReplyType::Unknown;
+            break;
+        case 0x50:
+            reply.type = size == 3 ? ReplyType::Completion : ReplyType::InquiryReply;
+            break;
+        case 0x60:
+            if (size == 4)
+            {
+                reply.type = ReplyType::Error;
+                reply.error = data[2];
+            }
+            break;
+        }
+        return reply;
+    }
+
+    // Valeur 16 bits au format 0p 0q 0r 0s à partir de l'octet 'offset' d'une réponse
+    inline std::uint16_t replyValue(const Reply& reply, std::size_t offset)
+    {
+        if (offset + 4 >= reply.size)
+        {
+            return 0;
+        }
+        return static_cast<std::uint16_t>(((reply.bytes[offset] & 0x0F) << 12) | ((reply.bytes[offset + 1] & 0x0F) << 8)
+            | ((reply.bytes[offset + 2] & 0x0F) << 4) | (reply.bytes[offset + 3] & 0x0F));
+    }
+}
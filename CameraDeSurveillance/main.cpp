@@ -1,9 +1,25 @@
 #include "CameraDeSurveillance.h"
+#include "ModeServeur.h"
+#include "ServeurMetriques.h"
 #include <QtWidgets/QApplication>
+#include <cstring>
 
 int main(int argc, char *argv[])
 {
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--serveur") == 0)
+        {
+            return runServer(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
+
+    // Les metriques restent consultables en mode fenetre ; un port deja pris n'empeche pas de demarrer
+    ServeurMetriques metriques;
+    metriques.listen();
+
     CameraDeSurveillance w;
     w.show();
     return a.exec();
@@ -0,0 +1,320 @@
+﻿//*********************************************************************************************
+//* Programme : main.cpp (RejeuTrafic)                                         Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Relire une trace .trc enregistrée par l'application (EnregistreurTrafic) :
+//*        - sans option, chaque échange est affiché et les octets reçus sont redécoupés par
+//*          l'analyseur de réponses de l'application (AnalyseurVisca) ;
+//*        - avec --to, les commandes enregistrées sont renvoyées sur un port série ou sur le
+//*          pseudo-terminal de SimulateurVisca, au rythme d'origine ou accéléré (--speed).
+//*
+//*       RejeuTrafic capture.trc [--last] [--to /tmp/visca0] [--speed X]
+//* Programmes associés : ../CameraDeSurveillance/FormatTrace.h, AnalyseurVisca.cpp
+//*********************************************************************************************
+
+#include "../CameraDeSurveillance/FormatTrace.h"
+#include "../CameraDeSurveillance/AnalyseurVisca.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    const char* replyName(Visca::ReplyType type)
+    {
+        switch (type)
+        {
+        case Visca::ReplyType::Ack: return "ACK";
+        case Visca::ReplyType::Completion: return "Completion";
+        case Visca::ReplyType::InquiryReply: return "Interrogation";
+        case Visca::ReplyType::Error: return "Erreur";
+        case Visca::ReplyType::AddressSet: return "AddressSet";
+        case Visca::ReplyType::IfClear: return "IF_Clear";
+        case Visca::ReplyType::Broadcast: return "Diffusion";
+        default: return "Inconnue";
+        }
+    }
+
+    void printBytes(const std::uint8_t* data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            std::printf(" %02X", data[i]);
+        }
+    }
+
+    void printReply(const Visca::Reply& reply, const char* origin)
+    {
+        std::printf("      %s %s camera %d", origin, replyName(reply.type), reply.address);
+        if (reply.type == Visca::ReplyType::Ack || reply.type == Visca::ReplyType::Completion)
+        {
+            std::printf(" socket %d", reply.socket);
+        }
+        if (reply.type == Visca::ReplyType::Error)
+        {
+            std::printf(" socket %d code %02X", reply.socket, reply.error);
+        }
+        std::printf("\n");
+    }
+
+    // Lit l'anneau du fichier et renvoie les enregistrements du plus ancien au plus récent
+    bool readTrace(const char* path, std::vector<Trace::Record>& records)
+    {
+        std::ifstream file(path, std::ios::binary);
+        Trace::FileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::memcmp(header.magic, Trace::MAGIC, sizeof(Trace::MAGIC)) != 0
+            || header.version != Trace::VERSION || header.recordSize != sizeof(Trace::Record)
+            || header.capacity == 0)
+        {
+            std::fprintf(stderr, "%s : fichier de trace invalide\n", path);
+            return false;
+        }
+
+        std::vector<Trace::Record> ring(header.capacity);
+        if (!file.read(reinterpret_cast<char*>(ring.data()), static_cast<std::streamsize>(ring.size() * sizeof(Trace::Record))))
+        {
+            std::fprintf(stderr, "%s : fichier de trace tronqué\n", path);
+            return false;
+        }
+
+        std::uint64_t count = header.written < header.capacity ? header.written : header.capacity;
+        std::uint64_t first = header.written - count;
+        records.reserve(count);
+        for (std::uint64_t i = first; i < header.written; ++i)
+        {
+            records.push_back(ring[i % header.capacity]);
+        }
+        return true;
+    }
+
+    bool openDevice(const char* path, int& device)
+    {
+        device = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (device < 0)
+        {
+            std::perror(path);
+            return false;
+        }
+
+        termios settings;
+        tcgetattr(device, &settings);
+        cfmakeraw(&settings);
+        cfsetispeed(&settings, B9600);
+        cfsetospeed(&settings, B9600);
+        tcsetattr(device, TCSANOW, &settings);
+        return true;
+    }
+
+    // Lit et décode les réponses qui arrivent pendant 'timeout' ms
+    std::size_t drainReplies(int device, AnalyseurVisca& analyseur, int timeout)
+    {
+        std::size_t count = 0;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        pollfd descriptor = { device, POLLIN, 0 };
+
+        for (;;)
+        {
+            int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count());
+            if (poll(&descriptor, 1, remaining > 0 ? remaining : 0) <= 0)
+            {
+                break;
+            }
+
+            std::uint8_t* destination = nullptr;
+            std::size_t span = analyseur.writableSpan(&destination);
+            ssize_t bytesRead = read(device, destination, span);
+            if (bytesRead < 0 && errno == EAGAIN)
+            {
+                continue;
+            }
+            if (bytesRead <= 0)
+            {
+                break;
+            }
+            analyseur.commit(static_cast<std::size_t>(bytesRead));
+
+            Visca::Reply reply;
+            while (analyseur.next(reply))
+            {
+                printReply(reply, "rejeu =");
+                ++count;
+            }
+        }
+        return count;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* tracePath = nullptr;
+    const char* devicePath = nullptr;
+    double speed = 1.0;
+    bool lastSession = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--to" && i + 1 < argc)
+        {
+            devicePath = argv[++i];
+        }
+        else if (argument == "--speed" && i + 1 < argc)
+        {
+            speed = std::atof(argv[++i]);
+        }
+        else if (argument == "--last")
+        {
+            lastSession = true;
+        }
+        else if (!tracePath && argument[0] != '-')
+        {
+            tracePath = argv[i];
+        }
+        else
+        {
+            tracePath = nullptr;
+            break;
+        }
+    }
+
+    if (!tracePath || speed < 0.0)
+    {
+        std::fprintf(stderr,
+            "Utilisation : %s capture.trc [--last] [--to PORT] [--speed X]\n"
+            "  --last      ne rejoue que la dernière session\n"
+            "  --to PORT   renvoie les commandes sur ce port (ex. lien de SimulateurVisca)\n"
+            "  --speed X   accélération du rejeu (1 = rythme d'origine, 0 = sans attente)\n",
+            argv[0]);
+        return 2;
+    }
+
+    std::vector<Trace::Record> records;
+    if (!readTrace(tracePath, records))
+    {
+        return 1;
+    }
+
+    std::size_t begin = 0;
+    if (lastSession)
+    {
+        for (std::size_t i = 0; i < records.size(); ++i)
+        {
+            if (records[i].direction == Trace::Direction::Session)
+            {
+                begin = i;
+            }
+        }
+    }
+
+    int device = -1;
+    if (devicePath && !openDevice(devicePath, device))
+    {
+        return 1;
+    }
+
+    // Les réponses enregistrées et celles renvoyées par le port passent par le même analyseur
+    // que l'application : un défaut de découpage se reproduit à l'identique
+    AnalyseurVisca recorded;
+    AnalyseurVisca live;
+    std::size_t commands = 0, replies = 0, liveReplies = 0;
+    std::uint64_t previousTime = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t sessionStart = 0;
+
+    for (std::size_t i = begin; i < records.size(); ++i)
+    {
+        const Trace::Record& record = records[i];
+        std::size_t size = record.size <= Trace::RECORD_DATA ? record.size : Trace::RECORD_DATA;
+
+        if (record.direction == Trace::Direction::Session)
+        {
+            std::int64_t epoch = 0;
+            std::memcpy(&epoch, record.data, sizeof(epoch));
+            std::time_t seconds = static_cast<std::time_t>(epoch / 1000);
+            char text[32];
+            std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", std::localtime(&seconds));
+            std::printf("--- Session du %s\n", text);
+
+            recorded.reset();
+            previousTime = 0;
+            start = std::chrono::steady_clock::now();
+            sessionStart = record.time;
+            continue;
+        }
+
+        double milliseconds = static_cast<double>(record.time) / 1e6;
+        std::printf("%12.3f %s", milliseconds, record.direction == Trace::Direction::Transmit ? "->" : "<-");
+        printBytes(record.data, size);
+        std::printf("\n");
+
+        if (record.direction == Trace::Direction::Receive)
+        {
+            recorded.feed(record.data, size);
+            Visca::Reply reply;
+            while (recorded.next(reply))
+            {
+                printReply(reply, "=");
+                ++replies;
+            }
+            continue;
+        }
+
+        ++commands;
+        if (device < 0)
+        {
+            continue;
+        }
+
+        // Rejeu au rythme d'origine divisé par l'accélération ; les réponses sont lues en attendant
+        if (speed > 0.0 && record.time > previousTime)
+        {
+            auto due = start + std::chrono::nanoseconds(static_cast<std::int64_t>((record.time - sessionStart) / speed));
+            auto now = std::chrono::steady_clock::now();
+            if (due > now)
+            {
+                int wait = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count());
+                liveReplies += drainReplies(device, live, wait);
+                std::this_thread::sleep_until(due);
+            }
+        }
+        previousTime = record.time;
+
+        if (write(device, record.data, size) < 0)
+        {
+            std::perror("write");
+            break;
+        }
+        liveReplies += drainReplies(device, live, 0);
+    }
+
+    if (device >= 0)
+    {
+        liveReplies += drainReplies(device, live, 500);
+        close(device);
+    }
+
+    std::printf("Enregistrements : %zu, blocs émis : %zu, réponses enregistrées : %zu", records.size() - begin, commands, replies);
+    if (devicePath)
+    {
+        std::printf(", réponses au rejeu : %zu", liveReplies);
+    }
+    std::printf(", erreurs de découpage : %llu\n", static_cast<unsigned long long>(recorded.framingErrors()));
+    return 0;
+}
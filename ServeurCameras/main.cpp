@@ -0,0 +1,22 @@
+﻿//*********************************************************************************************
+//* Programme : main.cpp (ServeurCameras)                                      Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Démon de commande des caméras pour les serveurs de la salle de contrôle : le mode
+//*       serveur de l'application, sans Qt Widgets ni affichage.
+//*
+//*       ServeurCameras --port /dev/ttyUSB0 [--port /dev/ttyUSB1] [--tcp 5600] [--ws 5601]
+//*                      [--metriques 9464] [--presets positions.json]
+//* Programmes associés : ../CameraDeSurveillance/ModeServeur.cpp
+//*********************************************************************************************
+
+#include "../CameraDeSurveillance/ModeServeur.h"
+
+int main(int argc, char *argv[])
+{
+    return runServer(argc, argv);
+}
@@ -0,0 +1,758 @@
+﻿//*********************************************************************************************
+//* Programme : SimulateurVisca.cpp                                            Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Simuler une chaîne de caméras VISCA (EVI-D70/D100) : numérotation, sockets, ACK et
+//*       Completion différée, erreurs, interrogations de position et débit de la liaison.
+//* Programmes associés : main.cpp
+//*********************************************************************************************
+
+#include "SimulateurVisca.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+    // Vitesses mécaniques (unités VISCA par seconde)
+    constexpr double PAN_UNITS_PER_SPEED = 100.0;     // Vitesse 0x18 : environ 2400 unités/s
+    constexpr double TILT_UNITS_PER_SPEED = 60.0;     // Vitesse 0x14 : environ 1200 unités/s
+    constexpr double ZOOM_FULL_TRAVEL = 2.0;          // Course complète du zoom en secondes
+    constexpr double FOCUS_FULL_TRAVEL = 1.5;
+    constexpr double ZOOM_VARIABLE_STEPS = 8.0;       // Vitesses variables 0 à 7
+
+    // Durée de traitement d'une commande sans déplacement
+    constexpr std::chrono::milliseconds COMMAND_LATENCY(10);
+    constexpr std::chrono::milliseconds POWER_ON_LATENCY(1000);
+    constexpr std::chrono::milliseconds POWER_OFF_LATENCY(500);
+
+    // Pas de la simulation pendant un déplacement
+    constexpr std::chrono::milliseconds MOTION_STEP(10);
+
+    double zoomSpeed(std::uint8_t variable)
+    {
+        return SimulateurVisca::ZOOM_MAX / ZOOM_FULL_TRAVEL * ((variable & 0x07) + 1) / ZOOM_VARIABLE_STEPS;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de l'axe motorisé
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::Axis::moveTo(double destination, double speed)
+{
+    continuous = false;
+    target = std::clamp(destination, min, max);
+    velocity = position < target ? speed : (position > target ? -speed : 0.0);
+}
+
+void SimulateurVisca::Axis::drive(double speed)
+{
+    continuous = speed != 0.0;
+    target = position;
+    velocity = speed;
+}
+
+void SimulateurVisca::Axis::stop()
+{
+    continuous = false;
+    target = position;
+    velocity = 0.0;
+}
+
+void SimulateurVisca::Axis::update(double seconds)
+{
+    if (velocity == 0.0)
+    {
+        return;
+    }
+
+    position += velocity * seconds;
+    if (continuous)
+    {
+        // Un déplacement continu s'arrête en butée
+        if (position <= min || position >= max)
+        {
+            position = std::clamp(position, min, max);
+            stop();
+        }
+    }
+    else if ((velocity > 0.0 && position >= target) || (velocity < 0.0 && position <= target))
+    {
+        position = target;
+        velocity = 0.0;
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Constructeur de la classe SimulateurVisca
+//* Paramètres :
+//*  - const Options& options : le nombre de caméras, le débit et les défauts simulés
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+SimulateurVisca::SimulateurVisca(const Options& options)
+    : options(options), random(std::random_device{}())
+{
+    // Les caméras n'ont pas d'adresse tant que le contrôleur n'a pas envoyé AddressSet
+    cameras.resize(std::clamp(options.cameras, 1, 7));
+    for (Camera& camera : cameras)
+    {
+        camera.power = !options.standby;
+        camera.pan.min = PAN_MIN;
+        camera.pan.max = PAN_MAX;
+        camera.tilt.min = TILT_MIN;
+        camera.tilt.max = TILT_MAX;
+        camera.zoom.min = 0;
+        camera.zoom.max = ZOOM_MAX;
+        camera.focus.min = FOCUS_MIN;
+        camera.focus.max = FOCUS_MAX;
+        camera.focus.position = camera.focus.target = FOCUS_MIN;
+    }
+
+    Clock::time_point now = Clock::now();
+    rxFree = txTime = lastUpdate = now;
+}
+
+void SimulateurVisca::setBaudRate(int baudRate)
+{
+    if (baudRate > 0)
+    {
+        options.baudRate = baudRate;
+    }
+}
+
+SimulateurVisca::Position SimulateurVisca::position(std::size_t index) const
+{
+    Position result;
+    if (index < cameras.size())
+    {
+        const Camera& camera = cameras[index];
+        result.pan = camera.pan.position;
+        result.tilt = camera.tilt.position;
+        result.zoom = camera.zoom.position;
+        result.moving = camera.pan.moving() || camera.tilt.moving() || camera.zoom.moving();
+    }
+    return result;
+}
+
+// Un octet sur la ligne : 1 bit de start, 8 bits de données, 1 bit de stop
+std::chrono::nanoseconds SimulateurVisca::byteDuration() const
+{
+    return std::chrono::nanoseconds(10LL * 1000000000LL / options.baudRate);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction recevant les octets écrits par le contrôleur ; chaque paquet complet est daté de
+//* l'instant où son dernier octet aurait fini d'arriver au débit simulé
+//* Paramètres :
+//*  - const std::uint8_t* data : les octets lus sur le pseudo-terminal
+//*  - std::size_t size : leur nombre
+//*  - Clock::time_point now : l'heure de lecture
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::receive(const std::uint8_t* data, std::size_t size, Clock::time_point now)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        std::uint8_t byte = data[i];
+        ++counters.bytesReceived;
+        rxFree = std::max(rxFree, now) + byteDuration();
+
+        if (byte == Visca::TERMINATOR)
+        {
+            if (!rxPacket.empty())
+            {
+                rxPacket.push_back(byte);
+                incoming.push_back({ rxFree, rxPacket });
+                rxPacket.clear();
+            }
+            continue;
+        }
+
+        // Un octet d'en-tête démarre un nouveau paquet et abandonne le précédent incomplet
+        if (byte & 0x80)
+        {
+            rxPacket.assign(1, byte);
+        }
+        else if (!rxPacket.empty())
+        {
+            rxPacket.push_back(byte);
+            if (rxPacket.size() >= Visca::MAX_PACKET_SIZE)
+            {
+                rxPacket.clear();
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction faisant avancer la simulation jusqu'à l'heure donnée : déplacements, exécution des
+//* paquets reçus et envoi des Completion
+//* Paramètres :
+//*  - Clock::time_point now : l'heure courante
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::advance(Clock::time_point now)
+{
+    double seconds = std::chrono::duration<double>(now - lastUpdate).count();
+    lastUpdate = now;
+    if (seconds > 0.0)
+    {
+        for (Camera& camera : cameras)
+        {
+            camera.pan.update(seconds);
+            camera.tilt.update(seconds);
+            camera.zoom.update(seconds);
+            camera.focus.update(seconds);
+        }
+    }
+
+    while (!incoming.empty() && incoming.front().time <= now)
+    {
+        Incoming packet = std::move(incoming.front());
+        incoming.pop_front();
+        execute(packet.packet, packet.time);
+    }
+
+    for (Camera& camera : cameras)
+    {
+        // Un déplacement à cible se termine quand tous les axes positionnés sont arrivés
+        bool moving = (camera.pan.moving() && !camera.pan.continuous)
+            || (camera.tilt.moving() && !camera.tilt.continuous)
+            || (camera.zoom.moving() && !camera.zoom.continuous)
+            || (camera.focus.moving() && !camera.focus.continuous);
+
+        for (int socket = 1; socket <= 2; ++socket)
+        {
+            Socket& state = camera.sockets[socket];
+            if (!state.busy || state.done > now || (state.waitMotion && moving))
+            {
+                continue;
+            }
+            state.busy = false;
+            replyShort(camera, static_cast<std::uint8_t>(0x50 | socket));
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction fournissant les octets de réponse dont l'émission est due, au débit de la liaison
+//* Paramètres :
+//*  - std::uint8_t* buffer : la mémoire où copier les octets
+//*  - std::size_t capacity : sa taille
+//*  - Clock::time_point now : l'heure courante
+//*
+//* Valeur de retour : std::size_t, le nombre d'octets à écrire sur le pseudo-terminal
+//---------------------------------------------------------------------------------------------
+std::size_t SimulateurVisca::transmit(std::uint8_t* buffer, std::size_t capacity, Clock::time_point now)
+{
+    if (output.empty())
+    {
+        return 0;
+    }
+
+    // Ligne inactive : le prochain octet part maintenant
+    if (txTime + byteDuration() < now)
+    {
+        txTime = now;
+    }
+
+    std::bernoulli_distribution loss(options.lossRate);
+    std::size_t count = 0;
+    while (!output.empty() && count < capacity && txTime <= now)
+    {
+        std::uint8_t byte = output.front();
+        output.pop_front();
+        txTime += byteDuration();
+
+        if (options.lossRate > 0.0 && loss(random))
+        {
+            ++counters.bytesLost;
+            continue;
+        }
+        buffer[count++] = byte;
+        ++counters.bytesSent;
+    }
+    return count;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction donnant l'instant du prochain évènement, pour l'attente de la boucle principale
+//* Paramètres :
+//*  - Clock::time_point now : l'heure courante
+//*
+//* Valeur de retour : Clock::time_point, l'heure à laquelle rappeler advance() / transmit()
+//---------------------------------------------------------------------------------------------
+SimulateurVisca::Clock::time_point SimulateurVisca::nextDeadline(Clock::time_point now) const
+{
+    Clock::time_point deadline = now + std::chrono::seconds(1);
+
+    if (!output.empty())
+    {
+        deadline = std::min(deadline, std::max(txTime, now));
+    }
+    if (!incoming.empty())
+    {
+        deadline = std::min(deadline, incoming.front().time);
+    }
+
+    for (const Camera& camera : cameras)
+    {
+        if (camera.pan.moving() || camera.tilt.moving() || camera.zoom.moving() || camera.focus.moving())
+        {
+            deadline = std::min(deadline, now + MOTION_STEP);
+        }
+        for (int socket = 1; socket <= 2; ++socket)
+        {
+            const Socket& state = camera.sockets[socket];
+            if (state.busy)
+            {
+                deadline = std::min(deadline, std::max(state.done, now));
+            }
+        }
+    }
+    return deadline;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction aiguillant un paquet reçu vers la diffusion, une commande, une interrogation ou
+//* une annulation
+//* Paramètres :
+//*  - const std::vector<std::uint8_t>& packet : le paquet, terminateur compris
+//*  - Clock::time_point now : l'heure de fin de réception du paquet
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::execute(const std::vector<std::uint8_t>& packet, Clock::time_point now)
+{
+    if (options.verbose)
+    {
+        std::fprintf(stderr, "<-");
+        for (std::uint8_t byte : packet)
+        {
+            std::fprintf(stderr, " %02X", byte);
+        }
+        std::fprintf(stderr, "\n");
+    }
+
+    if (packet.size() < 3)
+    {
+        return;
+    }
+
+    if (packet[0] == Visca::header(Visca::BROADCAST_ADDRESS))
+    {
+        executeBroadcast(packet);
+        return;
+    }
+
+    std::uint8_t address = packet[0] & 0x0F;
+    auto found = std::find_if(cameras.begin(), cameras.end(), [address](const Camera& camera) {
+        return camera.address != 0 && camera.address == address;
+    });
+
+    // Aucune caméra à cette adresse : le paquet traverse la chaîne sans réponse
+    if (found == cameras.end())
+    {
+        return;
+    }
+
+    Camera& camera = *found;
+    if (packet[1] == 0x01)
+    {
+        executeCommand(camera, packet, now);
+    }
+    else if (packet[1] == 0x09)
+    {
+        executeInquiry(camera, packet);
+    }
+    else if ((packet[1] & 0xF0) == 0x20 && packet.size() == 3)
+    {
+        cancel(camera, packet[1] & 0x0F);
+    }
+    else
+    {
+        ++counters.errors;
+        replyShort(camera, 0x60, Visca::SyntaxError, true);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction exécutant les paquets de diffusion : AddressSet, IF_Clear et commandes de groupe
+//* Paramètres :
+//*  - const std::vector<std::uint8_t>& packet : le paquet reçu
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::executeBroadcast(const std::vector<std::uint8_t>& packet)
+{
+    // AddressSet (88 30 01 FF) : chaque caméra prend l'adresse reçue et transmet la suivante
+    if (packet.size() == 4 && packet[1] == 0x30)
+    {
+        std::uint8_t address = packet[2];
+        for (Camera& camera : cameras)
+        {
+            camera.address = address++;
+        }
+        reply({ Visca::header(Visca::BROADCAST_ADDRESS), 0x30, address, Visca::TERMINATOR });
+        return;
+    }
+
+    // IF_Clear (88 01 00 01 FF) : les sockets sont vidés et le paquet revient au contrôleur
+    if (packet.size() == 5 && packet[1] == 0x01 && packet[2] == 0x00 && packet[3] == 0x01)
+    {
+        for (Camera& camera : cameras)
+        {
+            for (Socket& socket : camera.sockets)
+            {
+                socket.busy = false;
+            }
+        }
+        reply(packet);
+        return;
+    }
+
+    // Autre commande (88 01 ... FF) : chaque caméra l'exécute sans ACK ni Completion et sans
+    // occuper de socket, puis le paquet revient au contrôleur par la dernière caméra
+    if (packet[1] == 0x01)
+    {
+        bool isPower = packet.size() == 6 && packet[2] == 0x04 && packet[3] == 0x00;
+        for (Camera& camera : cameras)
+        {
+            ++counters.commands;
+            bool waitMotion = false;
+            if (camera.power || isPower)
+            {
+                startMotion(camera, packet, waitMotion);
+            }
+        }
+        reply(packet);
+    }
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction exécutant une commande adressée : ACK sur un socket libre puis Completion quand
+//* l'exécution est terminée, ou message d'erreur
+//* Paramètres :
+//*  - Camera& camera : la caméra destinataire
+//*  - const std::vector<std::uint8_t>& packet : la commande
+//*  - Clock::time_point now : l'heure de fin de réception
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::executeCommand(Camera& camera, const std::vector<std::uint8_t>& packet, Clock::time_point now)
+{
+    ++counters.commands;
+
+    // IF_Clear adressé (8x 01 00 01 FF) : réponse immédiate sans socket
+    if (packet.size() == 5 && packet[2] == 0x00 && packet[3] == 0x01)
+    {
+        for (Socket& socket : camera.sockets)
+        {
+            socket.busy = false;
+        }
+        replyShort(camera, 0x50);
+        return;
+    }
+
+    int socket = !camera.sockets[1].busy ? 1 : (!camera.sockets[2].busy ? 2 : 0);
+    if (socket == 0)
+    {
+        ++counters.errors;
+        replyShort(camera, 0x60, Visca::CommandBufferFull, true);
+        return;
+    }
+
+    bool isPower = packet.size() == 6 && packet[2] == 0x04 && packet[3] == 0x00;
+    if (!camera.power && !isPower)
+    {
+        ++counters.errors;
+        replyShort(camera, static_cast<std::uint8_t>(0x40 | socket));
+        replyShort(camera, static_cast<std::uint8_t>(0x60 | socket), Visca::CommandNotExecutable, true);
+        return;
+    }
+
+    bool waitMotion = false;
+    int latency = startMotion(camera, packet, waitMotion);
+    if (latency < 0)
+    {
+        ++counters.errors;
+        replyShort(camera, 0x60, Visca::SyntaxError, true);
+        return;
+    }
+
+    replyShort(camera, static_cast<std::uint8_t>(0x40 | socket));
+    Socket& state = camera.sockets[socket];
+    state.busy = true;
+    state.waitMotion = waitMotion;
+    state.done = now + std::chrono::milliseconds(latency);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction décodant une commande et démarrant son exécution
+//* Paramètres :
+//*  - Camera& camera : la caméra destinataire
+//*  - const std::vector<std::uint8_t>& packet : la commande
+//*  - bool& waitMotion : mis à vrai si la Completion attend la fin du déplacement
+//*
+//* Valeur de retour : int, la durée de traitement en millisecondes, -1 si la commande est inconnue
+//---------------------------------------------------------------------------------------------
+int SimulateurVisca::startMotion(Camera& camera, const std::vector<std::uint8_t>& packet, bool& waitMotion)
+{
+    const int latency = static_cast<int>(COMMAND_LATENCY.count());
+    std::size_t size = packet.size();
+    std::uint8_t category = packet[2];
+    std::uint8_t code = size > 3 ? packet[3] : 0;
+
+    if (category == 0x04)
+    {
+        // CAM_Power : 8x 01 04 00 02/03 FF
+        if (code == 0x00 && size == 6 && (packet[4] == 0x02 || packet[4] == 0x03))
+        {
+            camera.power = packet[4] == 0x02;
+            if (!camera.power)
+            {
+                camera.pan.stop();
+                camera.tilt.stop();
+                camera.zoom.stop();
+                camera.focus.stop();
+            }
+            return static_cast<int>((camera.power ? POWER_ON_LATENCY : POWER_OFF_LATENCY).count());
+        }
+
+        // CAM_Zoom : Stop / Tele / Wide / Tele(p) / Wide(p)
+        if (code == 0x07 && size == 6)
+        {
+            std::uint8_t mode = packet[4];
+            if (mode == 0x00)
+            {
+                camera.zoom.stop();
+            }
+            else if (mode == 0x02 || (mode & 0xF0) == 0x20)
+            {
+                camera.zoom.moveTo(ZOOM_MAX, zoomSpeed(mode == 0x02 ? 3 : mode));
+            }
+            else if (mode == 0x03 || (mode & 0xF0) == 0x30)
+            {
+                camera.zoom.moveTo(0, zoomSpeed(mode == 0x03 ? 3 : mode));
+            }
+            else
+            {
+                return -1;
+            }
+            return latency;
+        }
+
+        // CAM_Zoom Direct : 8x 01 04 47 0p 0q 0r 0s FF
+        if (code == 0x47 && size == 9)
+        {
+            camera.zoom.moveTo(decode16(packet, 4), ZOOM_MAX / ZOOM_FULL_TRAVEL);
+            waitMotion = true;
+            return latency;
+        }
+
+        // CAM_Focus Direct : 8x 01 04 48 0p 0q 0r 0s FF
+        if (code == 0x48 && size == 9)
+        {
+            camera.focus.moveTo(decode16(packet, 4), (FOCUS_MAX - FOCUS_MIN) / FOCUS_FULL_TRAVEL);
+            waitMotion = true;
+            return latency;
+        }
+
+        // CAM_Memory : 8x 01 04 3F 0[0-2] pp FF
+        if (code == 0x3F && size == 7 && packet[4] <= 0x02 && packet[5] < 16)
+        {
+            Camera::Preset& preset = camera.presets[packet[5]];
+            switch (packet[4])
+            {
+            case 0x00:
+                preset = Camera::Preset();
+                break;
+            case 0x01:
+                preset.set = true;
+                preset.pan = camera.pan.position;
+                preset.tilt = camera.tilt.position;
+                preset.zoom = camera.zoom.position;
+                break;
+            default:
+                if (preset.set)
+                {
+                    camera.pan.moveTo(preset.pan, Visca::PAN_SPEED_MAX * PAN_UNITS_PER_SPEED);
+                    camera.tilt.moveTo(preset.tilt, Visca::TILT_SPEED_MAX * TILT_UNITS_PER_SPEED);
+                    camera.zoom.moveTo(preset.zoom, ZOOM_MAX / ZOOM_FULL_TRAVEL);
+                    waitMotion = true;
+                }
+                break;
+            }
+            return latency;
+        }
+        return -1;
+    }
+
+    if (category == 0x06)
+    {
+        // Pan-tiltDrive : 8x 01 06 01 VV WW 0p 0t FF
+        if (code == 0x01 && size == 9)
+        {
+            double panSpeed = Visca::clampSpeed(packet[4], Visca::PAN_SPEED_MAX) * PAN_UNITS_PER_SPEED;
+            double tiltSpeed = Visca::clampSpeed(packet[5], Visca::TILT_SPEED_MAX) * TILT_UNITS_PER_SPEED;
+            std::uint8_t pan = packet[6];
+            std::uint8_t tilt = packet[7];
+            if (pan < 0x01 || pan > 0x03 || tilt < 0x01 || tilt > 0x03)
+            {
+                return -1;
+            }
+            camera.pan.drive(pan == 0x01 ? -panSpeed : (pan == 0x02 ? panSpeed : 0.0));
+            camera.tilt.drive(tilt == 0x01 ? tiltSpeed : (tilt == 0x02 ? -tiltSpeed : 0.0));
+            return latency;
+        }
+
+        // AbsolutePosition / RelativePosition : 8x 01 06 02/03 VV WW 0Y 0Y 0Y 0Y 0Z 0Z 0Z 0Z FF
+        if ((code == 0x02 || code == 0x03) && size == 15)
+        {
+            double panSpeed = Visca::clampSpeed(packet[4], Visca::PAN_SPEED_MAX) * PAN_UNITS_PER_SPEED;
+            double tiltSpeed = Visca::clampSpeed(packet[5], Visca::TILT_SPEED_MAX) * TILT_UNITS_PER_SPEED;
+            double pan = static_cast<std::int16_t>(decode16(packet, 6));
+            double tilt = static_cast<std::int16_t>(decode16(packet, 10));
+            if (code == 0x03)
+            {
+                pan += camera.pan.position;
+                tilt += camera.tilt.position;
+            }
+            camera.pan.moveTo(pan, panSpeed);
+            camera.tilt.moveTo(tilt, tiltSpeed);
+            waitMotion = true;
+            return latency;
+        }
+
+        // Home (8x 01 06 04 FF) et Reset (8x 01 06 05 FF) : retour au centre à vitesse maximale
+        if ((code == 0x04 || code == 0x05) && size == 5)
+        {
+            camera.pan.moveTo(0, Visca::PAN_SPEED_MAX * PAN_UNITS_PER_SPEED);
+            camera.tilt.moveTo(0, Visca::TILT_SPEED_MAX * TILT_UNITS_PER_SPEED);
+            waitMotion = true;
+            return latency;
+        }
+    }
+    return -1;
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction répondant à une interrogation : position pan/tilt, zoom, mise au point, alimentation
+//* Paramètres :
+//*  - Camera& camera : la caméra interrogée
+//*  - const std::vector<std::uint8_t>& packet : l'interrogation
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::executeInquiry(Camera& camera, const std::vector<std::uint8_t>& packet)
+{
+    ++counters.inquiries;
+
+    std::vector<std::uint8_t> answer = { static_cast<std::uint8_t>(0x80 | (camera.address << 4)), 0x50 };
+    if (packet.size() == 5 && packet[2] == 0x06 && packet[3] == 0x12)
+    {
+        encode16(answer, static_cast<std::uint16_t>(static_cast<std::int16_t>(camera.pan.position)));
+        encode16(answer, static_cast<std::uint16_t>(static_cast<std::int16_t>(camera.tilt.position)));
+    }
+    else if (packet.size() == 5 && packet[2] == 0x04 && packet[3] == 0x47)
+    {
+        encode16(answer, static_cast<std::uint16_t>(camera.zoom.position));
+    }
+    else if (packet.size() == 5 && packet[2] == 0x04 && packet[3] == 0x48)
+    {
+        encode16(answer, static_cast<std::uint16_t>(camera.focus.position));
+    }
+    else if (packet.size() == 5 && packet[2] == 0x04 && packet[3] == 0x00)
+    {
+        answer.push_back(camera.power ? 0x02 : 0x03);
+    }
+    else
+    {
+        ++counters.errors;
+        replyShort(camera, 0x60, Visca::SyntaxError, true);
+        return;
+    }
+
+    answer.push_back(Visca::TERMINATOR);
+    reply(std::move(answer));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonction annulant la commande en cours sur un socket (8x 2y FF)
+//* Paramètres :
+//*  - Camera& camera : la caméra concernée
+//*  - int socket : le numéro du socket
+//*
+//* Valeur de retour : aucun
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::cancel(Camera& camera, int socket)
+{
+    if (socket < 1 || socket > 2 || !camera.sockets[socket].busy)
+    {
+        ++counters.errors;
+        replyShort(camera, static_cast<std::uint8_t>(0x60 | (socket & 0x0F)), Visca::NoSocket, true);
+        return;
+    }
+
+    // La commande annulée arrête les axes qu'elle déplaçait
+    if (camera.sockets[socket].waitMotion)
+    {
+        camera.pan.stop();
+        camera.tilt.stop();
+        camera.zoom.stop();
+        camera.focus.stop();
+    }
+    camera.sockets[socket].busy = false;
+    replyShort(camera, static_cast<std::uint8_t>(0x60 | socket), Visca::CommandCancelled, true);
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions plaçant une réponse dans la file d'émission
+//---------------------------------------------------------------------------------------------
+void SimulateurVisca::reply(std::vector<std::uint8_t> packet)
+{
+    if (options.verbose)
+    {
+        std::fprintf(stderr, "->");
+        for (std::uint8_t byte : packet)
+        {
+            std::fprintf(stderr, " %02X", byte);
+        }
+        std::fprintf(stderr, "\n");
+    }
+    output.insert(output.end(), packet.begin(), packet.end());
+}
+
+void SimulateurVisca::replyShort(const Camera& camera, std::uint8_t message, std::uint8_t value, bool withValue)
+{
+    std::vector<std::uint8_t> packet = { static_cast<std::uint8_t>(0x80 | (camera.address << 4)), message };
+    if (withValue)
+    {
+        packet.push_back(value);
+    }
+    packet.push_back(Visca::TERMINATOR);
+    reply(std::move(packet));
+}
+
+//---------------------------------------------------------------------------------------------
+//* Fonctions de codage des valeurs 16 bits au format VISCA 0p 0q 0r 0s
+//---------------------------------------------------------------------------------------------
+std::uint16_t SimulateurVisca::decode16(const std::vector<std::uint8_t>& packet, std::size_t offset)
+{
+    return static_cast<std::uint16_t>(((packet[offset] & 0x0F) << 12) | ((packet[offset + 1] & 0x0F) << 8)
+        | ((packet[offset + 2] & 0x0F) << 4) | (packet[offset + 3] & 0x0F));
+}
+
+void SimulateurVisca::encode16(std::vector<std::uint8_t>& packet, std::uint16_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        packet.push_back(Visca::nibble(value, i));
+    }
+}
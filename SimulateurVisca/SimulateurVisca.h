@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+#include "../CameraDeSurveillance/Visca.h"
+
+//---------------------------------------------------------------------------------------------
+//* Modèle d'une chaîne de caméras VISCA : décodage des commandes reçues, exécution avec des
+//* durées réalistes (déplacements à vitesse finie, deux sockets par caméra), réponses ACK /
+//* Completion / erreurs / interrogations, et cadencement des octets au débit de la liaison.
+//* Le modèle ne connaît pas le pseudo-terminal : main.cpp lui fournit les octets et l'heure.
+//---------------------------------------------------------------------------------------------
+class SimulateurVisca
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options
+    {
+        int cameras = 1;            // Nombre de caméras sur la chaîne (1 à 7)
+        int baudRate = 9600;        // Débit simulé de la liaison
+        double lossRate = 0.0;      // Probabilité de perdre un octet émis
+        bool standby = false;       // Caméras éteintes au démarrage
+        bool verbose = false;
+    };
+
+    // Limites mécaniques (unités VISCA)
+    static constexpr int PAN_MIN = -2448;
+    static constexpr int PAN_MAX = 2448;
+    static constexpr int TILT_MIN = -432;
+    static constexpr int TILT_MAX = 1296;
+    static constexpr int ZOOM_MAX = 0x4000;
+    static constexpr int FOCUS_MIN = 0x1000;
+    static constexpr int FOCUS_MAX = 0xC000;
+
+    explicit SimulateurVisca(const Options& options);
+
+    void receive(const std::uint8_t* data, std::size_t size, Clock::time_point now);
+    void advance(Clock::time_point now);
+    std::size_t transmit(std::uint8_t* buffer, std::size_t capacity, Clock::time_point now);
+    Clock::time_point nextDeadline(Clock::time_point now) const;
+
+    void setBaudRate(int baudRate);
+    int baudRate() const { return options.baudRate; }
+
+    struct Stats
+    {
+        std::uint64_t commands = 0;
+        std::uint64_t inquiries = 0;
+        std::uint64_t errors = 0;
+        std::uint64_t bytesReceived = 0;
+        std::uint64_t bytesSent = 0;
+        std::uint64_t bytesLost = 0;
+    };
+    const Stats& stats() const { return counters; }
+
+    // Position d'une caméra de la chaîne (0 : la plus proche du contrôleur), pour les bancs de mesure
+    struct Position
+    {
+        double pan = 0.0;
+        double tilt = 0.0;
+        double zoom = 0.0;
+        bool moving = false;
+    };
+    Position position(std::size_t index) const;
+
+private:
+    // Axe motorisé : position courante, cible et vitesse en unités par seconde
+    struct Axis
+    {
+        double position = 0.0;
+        double target = 0.0;
+        double velocity = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+        bool continuous = false;    // Déplacement continu (Drive) : pas de cible
+
+        bool moving() const { return velocity != 0.0; }
+        void moveTo(double destination, double speed);
+        void drive(double speed);
+        void stop();
+        void update(double seconds);
+    };
+
+    struct Socket
+    {
+        bool busy = false;
+        bool waitMotion = false;            // La Completion attend la fin du déplacement
+        Clock::time_point done;
+    };
+
+    struct Camera
+    {
+        std::uint8_t address = 0;
+        bool power = true;
+        Axis pan, tilt, zoom, focus;
+        Socket sockets[3];
+        struct Preset
+        {
+            bool set = false;
+            double pan = 0.0, tilt = 0.0, zoom = 0.0;
+        } presets[16];
+    };
+
+    struct Incoming
+    {
+        Clock::time_point time;             // Instant où le dernier octet est arrivé sur la ligne
+        std::vector<std::uint8_t> packet;
+    };
+
+    void execute(const std::vector<std::uint8_t>& packet, Clock::time_point now);
+    void executeBroadcast(const std::vector<std::uint8_t>& packet);
+    void executeCommand(Camera& camera, const std::vector<std::uint8_t>& packet, Clock::time_point now);
+    void executeInquiry(Camera& camera, const std::vector<std::uint8_t>& packet);
+    int startMotion(Camera& camera, const std::vector<std::uint8_t>& packet, bool& waitMotion);
+    void cancel(Camera& camera, int socket);
+    void reply(std::vector<std::uint8_t> packet);
+    void replyShort(const Camera& camera, std::uint8_t message, std::uint8_t value = 0, bool withValue = false);
+    std::chrono::nanoseconds byteDuration() const;
+
+    static std::uint16_t decode16(const std::vector<std::uint8_t>& packet, std::size_t offset);
+    static void encode16(std::vector<std::uint8_t>& packet, std::uint16_t value);
+
+    Options options;
+    std::vector<Camera> cameras;
+    std::vector<std::uint8_t> rxPacket;
+    std::deque<Incoming> incoming;
+    std::deque<std::uint8_t> output;
+    Clock::time_point rxFree;               // Fin de réception du dernier octet sur la ligne
+    Clock::time_point txTime;               // Instant d'émission du prochain octet
+    Clock::time_point lastUpdate;
+    std::mt19937 random;
+    Stats counters;
+};
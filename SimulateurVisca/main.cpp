@@ -0,0 +1,187 @@
+﻿//*********************************************************************************************
+//* Programme : main.cpp (SimulateurVisca)                                     Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Exposer le simulateur de caméras VISCA sur un pseudo-terminal (Linux). L'application
+//*       ouvre le chemin donné par --link comme un port série ordinaire (QSerialPort accepte un
+//*       chemin complet), ce qui permet de la tester sans caméra ni adaptateur RS-232.
+//*
+//*       SimulateurVisca [--cameras N] [--baud B] [--link /tmp/visca0] [--loss P]
+//*                       [--standby] [--verbose]
+//* Programmes associés : SimulateurVisca.cpp
+//*********************************************************************************************
+
+#include "SimulateurVisca.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace
+{
+    volatile std::sig_atomic_t running = 1;
+
+    void onSignal(int)
+    {
+        running = 0;
+    }
+
+    void usage(const char* program)
+    {
+        std::fprintf(stderr,
+            "Utilisation : %s [--cameras N] [--baud B] [--link CHEMIN] [--loss P] [--standby] [--verbose]\n"
+            "  --cameras N   nombre de caméras sur la chaîne (1 à 7, défaut 1)\n"
+            "  --baud B      débit simulé de la liaison (défaut 9600)\n"
+            "  --link CHEMIN lien symbolique vers le pseudo-terminal esclave\n"
+            "  --loss P      probabilité de perdre chaque octet émis (0 à 1)\n"
+            "  --standby     caméras éteintes au démarrage\n"
+            "  --verbose     affiche les paquets échangés\n",
+            program);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SimulateurVisca::Options options;
+    std::string link;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--cameras" && hasValue)
+        {
+            options.cameras = std::atoi(argv[++i]);
+        }
+        else if (argument == "--baud" && hasValue)
+        {
+            options.baudRate = std::atoi(argv[++i]);
+        }
+        else if (argument == "--link" && hasValue)
+        {
+            link = argv[++i];
+        }
+        else if (argument == "--loss" && hasValue)
+        {
+            options.lossRate = std::atof(argv[++i]);
+        }
+        else if (argument == "--standby")
+        {
+            options.standby = true;
+        }
+        else if (argument == "--verbose")
+        {
+            options.verbose = true;
+        }
+        else
+        {
+            usage(argv[0]);
+            return argument == "--help" ? 0 : 2;
+        }
+    }
+
+    if (options.cameras < 1 || options.cameras > 7 || options.baudRate <= 0
+        || options.lossRate < 0.0 || options.lossRate > 1.0)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Création du pseudo-terminal : le maître est la caméra, l'esclave le port de l'application
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        std::perror("posix_openpt");
+        return 1;
+    }
+    const char* slave = ptsname(master);
+
+    // Une extrémité esclave reste ouverte : sans elle, le maître signale POLLHUP en boucle tant
+    // que l'application n'a pas ouvert le port
+    int keepAlive = open(slave, O_RDWR | O_NOCTTY);
+
+    // Mode brut : aucun traitement des octets 0x11/0x13, des fins de ligne ni de l'écho
+    termios settings;
+    tcgetattr(master, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(master, TCSANOW, &settings);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if (!link.empty())
+    {
+        unlink(link.c_str());
+        if (symlink(slave, link.c_str()) != 0)
+        {
+            std::perror("symlink");
+            return 1;
+        }
+    }
+
+    std::printf("SimulateurVisca : %d caméra(s) à %d bauds sur %s%s%s\n", options.cameras, options.baudRate,
+        slave, link.empty() ? "" : " -> ", link.c_str());
+    std::fflush(stdout);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    SimulateurVisca simulateur(options);
+    std::uint8_t buffer[256];
+
+    while (running)
+    {
+        SimulateurVisca::Clock::time_point now = SimulateurVisca::Clock::now();
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(simulateur.nextDeadline(now) - now);
+
+        pollfd descriptor = { master, POLLIN, 0 };
+        int ready = poll(&descriptor, 1, static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0)));
+        if (ready < 0 && errno != EINTR)
+        {
+            std::perror("poll");
+            break;
+        }
+
+        now = SimulateurVisca::Clock::now();
+        if (ready > 0 && (descriptor.revents & POLLIN))
+        {
+            ssize_t count = read(master, buffer, sizeof(buffer));
+            if (count > 0)
+            {
+                simulateur.receive(buffer, static_cast<std::size_t>(count), now);
+            }
+        }
+
+        simulateur.advance(now);
+
+        std::size_t count = simulateur.transmit(buffer, sizeof(buffer), now);
+        if (count > 0 && write(master, buffer, count) < 0 && errno != EAGAIN)
+        {
+            std::perror("write");
+            break;
+        }
+    }
+
+    const SimulateurVisca::Stats& stats = simulateur.stats();
+    std::printf("Commandes : %llu, interrogations : %llu, erreurs : %llu, octets reçus : %llu, émis : %llu, perdus : %llu\n",
+        static_cast<unsigned long long>(stats.commands), static_cast<unsigned long long>(stats.inquiries),
+        static_cast<unsigned long long>(stats.errors), static_cast<unsigned long long>(stats.bytesReceived),
+        static_cast<unsigned long long>(stats.bytesSent), static_cast<unsigned long long>(stats.bytesLost));
+
+    if (!link.empty())
+    {
+        unlink(link.c_str());
+    }
+    close(keepAlive);
+    close(master);
+    return 0;
+}
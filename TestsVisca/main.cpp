@@ -0,0 +1,1176 @@
+﻿//*********************************************************************************************
+//* Programme : main.cpp (TestsVisca)                                          Date : 17/10/2026
+//*--------------------------------------------------------------------------------------------
+//* Dernière mise à jour : 17/10/2026
+//*
+//* Programmeurs : Lemaire Kévin                                              Classe : BTSCIEL2
+//*                Tellier Néo
+//*--------------------------------------------------------------------------------------------
+//* But : Tests unitaires du protocole et de la file de commandes, sans port série : encodage
+//*       des paquets, décodage des réponses, découpage du flux reçu (lectures de tailles
+//*       aléatoires comprises), sockets des caméras, IF_Clear d'une caméra ou de la chaîne,
+//*       reprise des réponses perdues, priorités de l'ordonnanceur (dont l'arrêt sous charge,
+//*       sur SimulateurVisca en temps virtuel), conduite en vitesse (débit, zone morte, arrêt
+//*       sans consigne), suivi de position pendant un déplacement, enchaînement des étapes
+//*       d'une tournée, canal de télémétrie et pool d'images de l'aperçu vidéo, détection de
+//*       mouvement, anneau et segments de l'enregistrement, visée d'un point de l'aperçu,
+//*       commandes de groupe. Lancés par ctest.
+//* Programmes associés : ../CameraDeSurveillance/Visca.h, AnalyseurVisca.cpp,
+//*                       TransactionsVisca.cpp, OrdonnanceurCommandes.cpp, EtatCameras.cpp,
+//*                       MoteurTournees.cpp, BibliothequePresets.cpp, PiloteVitesse.cpp,
+//*                       CanalTelemetrie.h, PoolImages.h, CaptureVideo.cpp,
+//*                       DetectionMouvement.cpp, AnneauImages.cpp, EnregistreurVideo.cpp,
+//*                       ChampVision.cpp, ../SimulateurVisca/SimulateurVisca.cpp
+//*********************************************************************************************
+
+#include <QtTest>
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QTemporaryDir>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include "AnalyseurVisca.h"
+#include "AnneauImages.h"
+#include "BibliothequePresets.h"
+#include "CanalTelemetrie.h"
+#include "CaptureVideo.h"
+#include "ChampVision.h"
+#include "DetectionMouvement.h"
+#include "EnregistreurVideo.h"
+#include "EtatCameras.h"
+#include "FormatSegment.h"
+#include "MoteurTournees.h"
+#include "OrdonnanceurCommandes.h"
+#include "PiloteVitesse.h"
+#include "PolitiqueReprise.h"
+#include "PoolImages.h"
+#include "TransactionsVisca.h"
+#include "Visca.h"
+#include "../SimulateurVisca/SimulateurVisca.h"
+
+namespace
+{
+    QByteArray bytes(const Visca::Command& command)
+    {
+        return QByteArray(command.data(), command.size);
+    }
+
+    Visca::Reply reply(std::initializer_list<std::uint8_t> data)
+    {
+        std::vector<std::uint8_t> packet(data);
+        return Visca::parseReply(packet.data(), packet.size());
+    }
+
+    // Port simulé : garde les paquets écrits par le moteur de transactions
+    struct PortEcrit
+    {
+        QList<QByteArray> packets;
+
+        TransactionsVisca::Writer writer()
+        {
+            return [this](const char* data, qint64 size) {
+                packets.append(QByteArray(data, static_cast<int>(size)));
+                return true;
+            };
+        }
+    };
+}
+
+class TestsVisca : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void encodesCommands();
+    void detectsStops();
+    void parsesReplies();
+    void framesSplitAndJoinedReplies();
+    void resynchronisesOnGarbage();
+    void framesRandomChunks();
+    void limitsCommandsToTwoSockets();
+    void failsCommandOnErrorReply();
+    void retriesAfterBufferFull();
+    void spacesRetriesAfterTimeouts();
+    void recoversSocketsAfterLostAck();
+    void ifClearKeepsUnsentCommands();
+    void neverRetriesRelativeMoves();
+    void coalescesQueuedCommands();
+    void stopPreemptsQueuedMotion();
+    void keepsQueuedStopBeforeDrive();
+    void stopsDriveWithoutInput();
+    void stopsPromptlyUnderMotionLoad();
+    void inquiriesDoNotHoldCommands();
+    void pollsPositionDuringMove();
+    void tourWaitsForCompletion();
+    void keepsLatestTelemetryPerCamera();
+    void poolDropsStaleFrames();
+    void captureSharesItsBuffers();
+    void motionKernelsAgree();
+    void raisesMotionInItsZone();
+    void ringKeepsUnwrittenFrames();
+    void recorderWritesIndexedSegments();
+    void aimsAtPreviewPoints();
+    void sendsGroupCommandsInOneWrite();
+};
+
+void TestsVisca::encodesCommands()
+{
+    QCOMPARE(bytes(Visca::panTiltDrive(1, 0x30, 0x00, Visca::PanDirection::Left, Visca::TiltDirection::Stop)),
+        QByteArray::fromHex("8101060118010103ff"));
+    QCOMPARE(bytes(Visca::absolutePosition(2, 0x10, 0x10, 0x1234, 0xFEDC)),
+        QByteArray::fromHex("820106021010010203040f0e0d0cff"));
+    QCOMPARE(bytes(Visca::zoomDirect(1, 0x4000)), QByteArray::fromHex("8101044704000000ff"));
+    QCOMPARE(bytes(Visca::cancel(3, 2)), QByteArray::fromHex("8322ff"));
+    QCOMPARE(bytes(Visca::ifClear()), QByteArray::fromHex("88010001ff"));
+    QVERIFY(Visca::Command(Visca::panTiltPosInquiry(1)).isInquiry());
+}
+
+void TestsVisca::detectsStops()
+{
+    QVERIFY(Visca::Command(Visca::panTiltStop(1)).isStop());
+    QVERIFY(Visca::Command(Visca::zoomStop(1)).isStop());
+    QVERIFY(!Visca::Command(Visca::panTiltDrive(1, 1, 1, Visca::PanDirection::Right, Visca::TiltDirection::Stop)).isStop());
+    QVERIFY(!Visca::Command(Visca::powerOn(1)).isStop());
+}
+
+void TestsVisca::parsesReplies()
+{
+    Visca::Reply ack = reply({ 0x90, 0x41, 0xFF });
+    QCOMPARE(ack.type, Visca::ReplyType::Ack);
+    QCOMPARE(ack.address, std::uint8_t(1));
+    QCOMPARE(ack.socket, std::uint8_t(1));
+
+    QCOMPARE(reply({ 0xA0, 0x52, 0xFF }).type, Visca::ReplyType::Completion);
+    QCOMPARE(reply({ 0xA0, 0x52, 0xFF }).address, std::uint8_t(2));
+
+    Visca::Reply zoom = reply({ 0x90, 0x50, 0x01, 0x02, 0x03, 0x04, 0xFF });
+    QCOMPARE(zoom.type, Visca::ReplyType::InquiryReply);
+    QCOMPARE(Visca::replyValue(zoom, 2), std::uint16_t(0x1234));
+
+    Visca::Reply error = reply({ 0x90, 0x60, 0x03, 0xFF });
+    QCOMPARE(error.type, Visca::ReplyType::Error);
+    QCOMPARE(error.error, std::uint8_t(Visca::CommandBufferFull));
+
+    QCOMPARE(reply({ 0x88, 0x30, 0x03, 0xFF }).type, Visca::ReplyType::AddressSet);
+    QCOMPARE(reply({ 0x88, 0x01, 0x00, 0x01, 0xFF }).type, Visca::ReplyType::IfClear);
+    QCOMPARE(reply({ 0x90, 0x41 }).type, Visca::ReplyType::Unknown);
+}
+
+void TestsVisca::framesSplitAndJoinedReplies()
+{
+    AnalyseurVisca analyseur;
+    Visca::Reply decoded;
+
+    const std::uint8_t first[] = { 0x90, 0x41 };
+    analyseur.feed(first, sizeof(first));
+    QVERIFY(!analyseur.next(decoded));
+
+    // Fin de l'ACK et Completion complète dans la même lecture
+    const std::uint8_t second[] = { 0xFF, 0x90, 0x51, 0xFF };
+    analyseur.feed(second, sizeof(second));
+    QVERIFY(analyseur.next(decoded));
+    QCOMPARE(decoded.type, Visca::ReplyType::Ack);
+    QVERIFY(analyseur.next(decoded));
+    QCOMPARE(decoded.type, Visca::ReplyType::Completion);
+    QVERIFY(!analyseur.next(decoded));
+    QCOMPARE(analyseur.framingErrors(), std::uint64_t(0));
+}
+
+void TestsVisca::resynchronisesOnGarbage()
+{
+    AnalyseurVisca analyseur;
+    Visca::Reply decoded;
+
+    const std::uint8_t data[] = { 0x12, 0x34, 0x90, 0x41, 0xFF };
+    analyseur.feed(data, sizeof(data));
+    QVERIFY(analyseur.next(decoded));
+    QCOMPARE(decoded.type, Visca::ReplyType::Ack);
+    QCOMPARE(analyseur.framingErrors(), std::uint64_t(2));
+}
+
+void TestsVisca::framesRandomChunks()
+{
+    // Flux de 5000 réponses de toutes les formes, découpé en lectures de 1 à 40 octets
+    std::mt19937 random(2026);
+    std::uniform_int_distribution<int> kind(0, 4);
+    std::uniform_int_distribution<int> address(1, 7);
+    std::uniform_int_distribution<int> payload(0, 0x7F);
+    std::uniform_int_distribution<int> chunk(1, 40);
+
+    QList<QByteArray> expected;
+    QByteArray stream;
+    for (int index = 0; index < 5000; ++index)
+    {
+        QByteArray packet(1, static_cast<char>(0x80 | (address(random) << 4)));
+        switch (kind(random))
+        {
+        case 0: packet += static_cast<char>(0x41 + index % 2); break;   // ACK
+        case 1: packet += static_cast<char>(0x51 + index % 2); break;   // Completion
+        case 2: packet += static_cast<char>(0x60 + index % 3); packet += static_cast<char>(0x02 + index % 3); break;
+        case 3: packet = QByteArray::fromHex("8830"); packet += static_cast<char>(address(random) + 1); break;
+        default:
+            packet += static_cast<char>(0x50);
+            for (int length = 1 + index % 11; length > 0; --length)
+            {
+                packet += static_cast<char>(payload(random));
+            }
+            break;
+        }
+        packet += static_cast<char>(Visca::TERMINATOR);
+        expected.append(packet);
+        stream += packet;
+    }
+
+    // Une lecture sur deux passe par writableSpan()/commit(), comme le port série
+    AnalyseurVisca analyseur;
+    Visca::Reply decoded;
+    int received = 0;
+    int offset = 0;
+    bool direct = false;
+    while (offset < stream.size())
+    {
+        int size = std::min(chunk(random), static_cast<int>(stream.size()) - offset);
+        const std::uint8_t* data = reinterpret_cast<const std::uint8_t*>(stream.constData()) + offset;
+        if (direct)
+        {
+            std::uint8_t* destination = nullptr;
+            size = static_cast<int>(std::min<std::size_t>(analyseur.writableSpan(&destination), size));
+            std::memcpy(destination, data, size);
+            analyseur.commit(size);
+        }
+        else
+        {
+            QCOMPARE(analyseur.feed(data, size), std::size_t(size));
+        }
+        offset += size;
+        direct = !direct;
+
+        while (analyseur.next(decoded))
+        {
+            QVERIFY(received < expected.size());
+            QCOMPARE(QByteArray(reinterpret_cast<const char*>(decoded.bytes), decoded.size), expected.at(received));
+            QVERIFY(decoded.type != Visca::ReplyType::Unknown);
+            ++received;
+        }
+    }
+    QCOMPARE(received, static_cast<int>(expected.size()));
+    QCOMPARE(analyseur.framingErrors(), std::uint64_t(0));
+    QCOMPARE(analyseur.droppedBytes(), std::uint64_t(0));
+}
+
+void TestsVisca::limitsCommandsToTwoSockets()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    QSignalSpy completed(&transactions, &TransactionsVisca::commandCompleted);
+
+    quint32 first = transactions.submit(Visca::home(1));
+    transactions.submit(Visca::home(1));
+    transactions.submit(Visca::home(1));
+    QCOMPARE(port.packets.size(), 2);
+    QCOMPARE(transactions.pendingCount(), 1);
+    QVERIFY(!transactions.canAccept(1));
+    QVERIFY(transactions.canAccept(2));    // Une caméra occupée ne bloque pas les autres
+
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x42, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x51, 0xFF }));
+    QCOMPARE(completed.size(), 1);
+    QCOMPARE(completed.at(0).at(0).value<quint32>(), first);
+    QCOMPARE(port.packets.size(), 3);   // Le socket libéré reçoit la commande en attente
+}
+
+void TestsVisca::failsCommandOnErrorReply()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    QSignalSpy failed(&transactions, &TransactionsVisca::commandFailed);
+
+    quint32 id = transactions.submit(Visca::home(1));
+    transactions.handleReply(reply({ 0x90, 0x60, 0x02, 0xFF }));
+    QCOMPARE(failed.size(), 1);
+    QCOMPARE(failed.at(0).at(0).value<quint32>(), id);
+    QCOMPARE(failed.at(0).at(1).toInt(), int(Visca::SyntaxError));
+    QVERIFY(transactions.isIdle());
+}
+
+void TestsVisca::retriesAfterBufferFull()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    QSignalSpy retried(&transactions, &TransactionsVisca::commandRetried);
+
+    transactions.submit(Visca::zoomDirect(1, 0x1000));
+    transactions.handleReply(reply({ 0x90, 0x60, 0x03, 0xFF }));
+    QCOMPARE(retried.size(), 1);
+    QCOMPARE(port.packets.size(), 1);       // Attente avant le renvoi
+
+    QTRY_COMPARE(port.packets.size(), 2);
+    QCOMPARE(port.packets.at(1), port.packets.at(0));
+    QCOMPARE(transactions.stats().bufferFull, quint64(1));
+}
+
+void TestsVisca::spacesRetriesAfterTimeouts()
+{
+    // Interrogation sans réponse : chaque renvoi attend plus longtemps que le précédent après
+    // le constat du délai dépassé
+    QElapsedTimer clock;
+    clock.start();
+    QList<qint64> written;
+    QList<qint64> timedOut;
+    TransactionsVisca transactions([&](const char*, qint64) {
+        written.append(clock.elapsed());
+        return true;
+    });
+    QObject::connect(&transactions, &TransactionsVisca::commandTimedOut, [&] { timedOut.append(clock.elapsed()); });
+    QSignalSpy failed(&transactions, &TransactionsVisca::commandFailed);
+
+    transactions.submit(Visca::panTiltPosInquiry(1));
+    QTRY_COMPARE_WITH_TIMEOUT(failed.size(), 1, 5000);
+    QCOMPARE(written.size(), 1 + PolitiqueReprise::MAX_RETRIES);
+    for (int attempt = 1; attempt <= PolitiqueReprise::MAX_RETRIES; ++attempt)
+    {
+        QVERIFY(written.at(attempt) - timedOut.at(attempt - 1) >= PolitiqueReprise::backoffMs(attempt));
+    }
+    QVERIFY(written.at(3) - written.at(2) > written.at(1) - written.at(0));
+}
+
+void TestsVisca::recoversSocketsAfterLostAck()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    QSignalSpy completed(&transactions, &TransactionsVisca::commandCompleted);
+
+    // L'ACK ne vient pas : IF_Clear de la caméra, puis renvoi une fois ses tampons vidés
+    quint32 id = transactions.submit(Visca::zoomDirect(1, 0x1000));
+    QTRY_VERIFY_WITH_TIMEOUT(port.packets.contains(bytes(Visca::ifClear(1))), 2000);
+    QCOMPARE(transactions.stats().timeouts, quint64(1));
+    QCOMPARE(transactions.stats().recoveries, quint64(1));
+
+    transactions.handleReply(reply({ 0x90, 0x50, 0xFF }));
+    QTRY_COMPARE(port.packets.last(), bytes(Visca::zoomDirect(1, 0x1000)));     // Après backoffMs(1)
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x51, 0xFF }));
+    QCOMPARE(completed.size(), 1);
+    QCOMPARE(completed.at(0).at(0).value<quint32>(), id);
+    QCOMPARE(transactions.stats().retries, quint64(1));
+}
+
+void TestsVisca::ifClearKeepsUnsentCommands()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    QSignalSpy completed(&transactions, &TransactionsVisca::commandCompleted);
+    QSignalSpy failed(&transactions, &TransactionsVisca::commandFailed);
+
+    // Caméra 1 : deux commandes en cours et une en attente ; caméra 2 : une commande en cours
+    quint32 first = transactions.submit(Visca::home(1));
+    quint32 second = transactions.submit(Visca::home(1));
+    transactions.submit(Visca::zoomDirect(1, 0x1000));
+    quint32 other = transactions.submit(Visca::home(2));
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x42, 0xFF }));
+    transactions.handleReply(reply({ 0xA0, 0x41, 0xFF }));
+
+    // IF_Clear de la caméra 2 : seule sa commande est perdue
+    quint32 clearOne = transactions.submit(Visca::ifClear(2));
+    transactions.handleReply(reply({ 0xA0, 0x50, 0xFF }));
+    QCOMPARE(failed.size(), 1);
+    QCOMPARE(failed.at(0).at(0).value<quint32>(), other);
+    QCOMPARE(failed.at(0).at(1).toInt(), int(Visca::CommandCancelled));
+    QCOMPARE(completed.size(), 1);
+    QCOMPARE(completed.at(0).at(0).value<quint32>(), clearOne);
+    QCOMPARE(transactions.inFlightCount(), 2);
+    QCOMPARE(transactions.pendingCount(), 1);
+
+    // IF_Clear diffusé : les commandes en cours de la chaîne sont perdues, celle en attente part
+    quint32 clearAll = transactions.submit(Visca::ifClear());
+    transactions.handleReply(reply({ 0x88, 0x01, 0x00, 0x01, 0xFF }));
+    QCOMPARE(failed.size(), 3);
+    QCOMPARE(failed.at(1).at(0).value<quint32>() + failed.at(2).at(0).value<quint32>(), first + second);
+    QCOMPARE(completed.size(), 2);
+    QCOMPARE(completed.at(1).at(0).value<quint32>(), clearAll);
+    QCOMPARE(transactions.pendingCount(), 0);
+    QCOMPARE(port.packets.last(), bytes(Visca::zoomDirect(1, 0x1000)));
+    QCOMPARE(transactions.inFlightCount(), 1);
+}
+
+void TestsVisca::neverRetriesRelativeMoves()
+{
+    QVERIFY(!PolitiqueReprise::isIdempotent(Visca::relativePosition(1, 1, 1, 0x0100, 0x0000)));
+    QVERIFY(PolitiqueReprise::isIdempotent(Visca::absolutePosition(1, 1, 1, 0x0100, 0x0000)));
+    QVERIFY(PolitiqueReprise::isIdempotent(Visca::zoomPosInquiry(1)));
+    QVERIFY(PolitiqueReprise::completionTimeoutMs(Visca::absolutePosition(1, 1, 1, 0, 0))
+        > PolitiqueReprise::completionTimeoutMs(Visca::panTiltStop(1)));
+    QCOMPARE(PolitiqueReprise::backoffMs(1), qint64(PolitiqueReprise::BACKOFF_BASE_MS));
+    QCOMPARE(PolitiqueReprise::backoffMs(10), qint64(PolitiqueReprise::BACKOFF_MAX_MS));
+}
+
+void TestsVisca::coalescesQueuedCommands()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    OrdonnanceurCommandes ordonnanceur(transactions);
+
+    // Deux commandes occupent les sockets : les zooms suivants restent en file et se remplacent
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::zoomDirect(1, 0x1000), CommandClass::ZoomAbsolute);
+    ordonnanceur.schedule(Visca::zoomDirect(1, 0x2000), CommandClass::ZoomAbsolute);
+    QCOMPARE(ordonnanceur.pendingCount(), 1);
+    QCOMPARE(ordonnanceur.counters().coalesced, quint64(1));
+
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x51, 0xFF }));
+    QCOMPARE(port.packets.last(), bytes(Visca::zoomDirect(1, 0x2000)));
+}
+
+void TestsVisca::stopPreemptsQueuedMotion()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    QSignalSpy dropped(&ordonnanceur, &OrdonnanceurCommandes::commandDropped);
+
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::absolutePosition(1, 0x10, 0x10, 0x0100, 0x0100));
+    ordonnanceur.schedule(Visca::panTiltStop(1));
+
+    // Le déplacement en file est abandonné, les commandes en cours reçoivent un Cancel
+    QCOMPARE(dropped.size(), 1);
+    QCOMPARE(ordonnanceur.pendingCount(CommandPriority::Motion), 0);
+    QCOMPARE(ordonnanceur.pendingCount(CommandPriority::Emergency), 1);
+
+    // L'arrêt part au premier socket libéré, avant toute autre commande
+    ordonnanceur.schedule(Visca::zoomDirect(1, 0x1000));
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x61, 0x04, 0xFF }));
+    QVERIFY(port.packets.contains(bytes(Visca::panTiltStop(1))));
+    QVERIFY(!port.packets.contains(bytes(Visca::zoomDirect(1, 0x1000))));
+    QCOMPARE(ordonnanceur.counters().stops, quint64(1));
+}
+
+void TestsVisca::keepsQueuedStopBeforeDrive()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    QSignalSpy coalesced(&ordonnanceur, &OrdonnanceurCommandes::commandCoalesced);
+    const QByteArray stop = bytes(Visca::panTiltStop(1));
+    const QByteArray drive = bytes(Visca::panTiltDrive(1, 0x10, 0x10, Visca::PanDirection::Left, Visca::TiltDirection::Up));
+
+    // Sockets pris : un déplacement de même classe ne remplace pas l'arrêt en attente
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::home(1));
+    ordonnanceur.schedule(Visca::panTiltStop(1), CommandClass::PanTiltDrive);
+    ordonnanceur.schedule(Visca::panTiltDrive(1, 0x10, 0x10, Visca::PanDirection::Left, Visca::TiltDirection::Up),
+        CommandClass::PanTiltDrive);
+    QCOMPARE(coalesced.size(), 0);
+    QCOMPARE(ordonnanceur.pendingCount(CommandPriority::Emergency), 1);
+    QCOMPARE(ordonnanceur.pendingCount(CommandPriority::Motion), 1);
+
+    // L'arrêt part au premier socket libéré, le déplacement au suivant
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x61, 0x04, 0xFF }));
+    QCOMPARE(port.packets.last(), stop);
+    QVERIFY(!port.packets.contains(drive));
+    transactions.handleReply(reply({ 0x90, 0x42, 0xFF }));
+    transactions.handleReply(reply({ 0x90, 0x62, 0x04, 0xFF }));
+    QCOMPARE(port.packets.last(), drive);
+}
+
+void TestsVisca::stopsDriveWithoutInput()
+{
+    // Temps virtuel : l'horloge du pilote est avancée à la main et l'échéance appelée aussitôt
+    qint64 time = 1000000000;
+    QList<QByteArray> sent;
+    PiloteVitesse pilote([&](const Visca::Command& command) {
+        sent.append(bytes(command));
+        return quint32(1);
+    });
+    pilote.setClock([&] { return time; });
+    QSignalSpy timedOut(&pilote, &PiloteVitesse::inputTimedOut);
+    auto expire = [&](qint64 ms) {
+        time += ms * 1000000;
+        QMetaObject::invokeMethod(&pilote, "onTimeout");
+    };
+
+    // Une commande par durée de trame (9,375 ms à 9600 bauds) : seule la dernière consigne part
+    pilote.setVelocity(1, 0.5, 0);
+    QCOMPARE(sent.size(), 1);
+    QCOMPARE(sent.last(), bytes(Visca::panTiltDrive(1, 12, 1, Visca::PanDirection::Right, Visca::TiltDirection::Stop)));
+    time += 2000000;
+    pilote.setVelocity(1, 0.7, 0);
+    time += 2000000;
+    pilote.setVelocity(1, 0.9, 0);
+    QCOMPARE(sent.size(), 1);
+    expire(4);
+    QCOMPARE(sent.size(), 1);
+    expire(2);
+    QCOMPARE(sent.size(), 2);
+    QCOMPARE(sent.last(), bytes(Visca::panTiltDrive(1, 22, 1, Visca::PanDirection::Right, Visca::TiltDirection::Stop)));
+
+    // La même consigne rafraîchit l'entrée sans rien envoyer ; l'arrêt part 300 ms après elle
+    pilote.setVelocity(1, 0.9, 0);
+    QCOMPARE(sent.size(), 2);
+    expire(PiloteVitesse::INPUT_TIMEOUT_MS - 1);
+    QCOMPARE(sent.size(), 2);
+    QCOMPARE(timedOut.size(), 0);
+    expire(1);
+    QCOMPARE(sent.size(), 3);
+    QCOMPARE(sent.last(), bytes(Visca::panTiltStop(1)));
+    QCOMPARE(timedOut.size(), 1);
+    QCOMPARE(timedOut.first().first().value<quint8>(), quint8(1));
+    expire(PiloteVitesse::INPUT_TIMEOUT_MS);
+    QCOMPARE(sent.size(), 3);
+    QCOMPARE(timedOut.size(), 1);
+
+    // Zone morte : l'axe sous DEAD_ZONE est à l'arrêt, les deux dessous arrêtent la caméra
+    pilote.setVelocity(2, 0.04, -0.5);
+    QCOMPARE(sent.last(), bytes(Visca::panTiltDrive(2, 1, 10, Visca::PanDirection::Stop, Visca::TiltDirection::Down)));
+    time += 1000000;
+    pilote.setVelocity(2, 0.04, 0.03);
+    QCOMPARE(sent.size(), 5);
+    QCOMPARE(sent.last(), bytes(Visca::panTiltStop(2)));
+}
+
+void TestsVisca::stopsPromptlyUnderMotionLoad()
+{
+    // Chaîne de 7 caméras à 9600 bauds simulée en temps virtuel derrière le vrai chemin
+    // d'envoi. 200 déplacements lents saturent la file Motion et les positions sont
+    // interrogées au rythme rapide ; l'arrêt de la caméra 1 doit partir sur la ligne en moins
+    // de 100 ms (Cancel des sockets, puis l'arrêt lui-même).
+    using namespace std::chrono_literals;
+    SimulateurVisca::Options options;
+    options.cameras = 7;
+    SimulateurVisca simulateur(options);
+    SimulateurVisca::Clock::time_point now = SimulateurVisca::Clock::now();
+    SimulateurVisca::Clock::time_point stopWritten;
+    const QByteArray stop = bytes(Visca::panTiltStop(1));
+
+    TransactionsVisca transactions([&](const char* data, qint64 size) {
+        if (QByteArray(data, static_cast<int>(size)).contains(stop))
+        {
+            stopWritten = now;
+        }
+        simulateur.receive(reinterpret_cast<const std::uint8_t*>(data), static_cast<std::size_t>(size), now);
+        return true;
+    });
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    AnalyseurVisca analyseur;
+
+    // Interrogations comme celles d'EtatCameras pendant un déplacement : pan/tilt toutes les
+    // FAST_INTERVAL ms, zoom à sa réponse, une caméra à la fois réinterrogée
+    quint32 polling[8] = {};
+    int answered = 0;
+    QObject::connect(&transactions, &TransactionsVisca::inquiryCompleted, [&](quint32 id, const Visca::Reply& received) {
+        std::uint8_t address = received.address;
+        if (address < 8 && id == polling[address])
+        {
+            ++answered;
+            polling[address] = received.size == 11 ? ordonnanceur.schedule(Visca::zoomPosInquiry(address)) : 0;
+        }
+    });
+    int tick = 0;
+    auto run = [&](std::chrono::milliseconds duration) {
+        for (SimulateurVisca::Clock::time_point end = now + duration; now < end; )
+        {
+            now += 1ms;
+            if (++tick % EtatCameras::FAST_INTERVAL == 0)
+            {
+                for (std::uint8_t address = 1; address < 8; ++address)
+                {
+                    if (polling[address] == 0)
+                    {
+                        polling[address] = ordonnanceur.schedule(Visca::panTiltPosInquiry(address));
+                    }
+                }
+            }
+            simulateur.advance(now);
+            std::uint8_t buffer[AnalyseurVisca::RING_SIZE];
+            std::size_t size;
+            while ((size = simulateur.transmit(buffer, sizeof(buffer), now)) > 0)
+            {
+                analyseur.feed(buffer, size);
+                Visca::Reply received;
+                while (analyseur.next(received))
+                {
+                    transactions.handleReply(received);
+                }
+            }
+        }
+    };
+
+    Visca::Command addressSet = Visca::addressSet();
+    simulateur.receive(addressSet.bytes, addressSet.size, now);
+    run(100ms);
+    for (int index = 0; index < 200; ++index)
+    {
+        std::uint8_t address = static_cast<std::uint8_t>(1 + index % 7);
+        std::uint16_t pan = index % 2 ? 0x0700 : 0xF900;
+        ordonnanceur.schedule(Visca::absolutePosition(address, 0x01, 0x01, pan, 0x0000));
+    }
+    answered = 0;
+    run(500ms);
+    QVERIFY(simulateur.position(0).moving);
+    QVERIFY(ordonnanceur.pendingCount(CommandPriority::Motion) > 150);
+    QVERIFY(answered >= 7 * 2 * 2);     // Au moins deux tours de suivi malgré les déplacements
+
+    SimulateurVisca::Clock::time_point requested = now;
+    ordonnanceur.schedule(Visca::panTiltStop(1));
+    run(1s);
+    QVERIFY(stopWritten != SimulateurVisca::Clock::time_point());
+    QVERIFY(stopWritten - requested < 100ms);
+    QVERIFY(!simulateur.position(0).moving);
+}
+
+void TestsVisca::inquiriesDoNotHoldCommands()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+
+    // La seconde interrogation attend la réponse de la première sans retenir l'arrêt
+    transactions.submit(Visca::panTiltPosInquiry(1));
+    transactions.submit(Visca::zoomPosInquiry(1));
+    QCOMPARE(port.packets.size(), 1);
+    QVERIFY(!transactions.canAccept(1, true));
+    QVERIFY(transactions.canAccept(1));
+    transactions.submit(Visca::panTiltStop(1));
+    QCOMPARE(port.packets.size(), 2);
+    QCOMPARE(port.packets.last(), bytes(Visca::panTiltStop(1)));
+
+    // Deux sockets pris : les commandes attendent, les interrogations continuent
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.submit(Visca::zoomDirect(1, 0x4000));
+    transactions.handleReply(reply({ 0x90, 0x42, 0xFF }));
+    QVERIFY(!transactions.canAccept(1));
+    transactions.handleReply(reply({ 0x90, 0x50, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0xFF }));
+    QCOMPARE(port.packets.last(), bytes(Visca::zoomPosInquiry(1)));
+    transactions.handleReply(reply({ 0x90, 0x50, 0x00, 0x00, 0x00, 0x03, 0xFF }));
+    QVERIFY(transactions.canAccept(1, true));
+    QVERIFY(!transactions.canAccept(1));
+}
+
+void TestsVisca::pollsPositionDuringMove()
+{
+    // Un déplacement et un zoom lents prennent les deux sockets de la caméra : le suivi de
+    // position l'interroge quand même, une interrogation à la fois, et un arrêt demandé pendant
+    // une interrogation part sans l'attendre
+    using namespace std::chrono_literals;
+    SimulateurVisca simulateur{ SimulateurVisca::Options() };
+    SimulateurVisca::Clock::time_point now = SimulateurVisca::Clock::now();
+    SimulateurVisca::Clock::time_point stopWritten;
+    const QByteArray stop = bytes(Visca::panTiltStop(1));
+
+    TransactionsVisca transactions([&](const char* data, qint64 size) {
+        if (QByteArray(data, static_cast<int>(size)).contains(stop))
+        {
+            stopWritten = now;
+        }
+        simulateur.receive(reinterpret_cast<const std::uint8_t*>(data), static_cast<std::size_t>(size), now);
+        return true;
+    });
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    EtatCameras etat(ordonnanceur);
+    QObject::connect(&transactions, &TransactionsVisca::inquiryCompleted, &etat, &EtatCameras::onInquiryCompleted);
+    QObject::connect(&transactions, &TransactionsVisca::commandFailed, &etat, &EtatCameras::onCommandFailed);
+    AnalyseurVisca analyseur;
+    auto run = [&](std::chrono::milliseconds duration) {
+        for (SimulateurVisca::Clock::time_point end = now + duration; now < end; )
+        {
+            now += 1ms;
+            simulateur.advance(now);
+            std::uint8_t buffer[AnalyseurVisca::RING_SIZE];
+            std::size_t size;
+            while ((size = simulateur.transmit(buffer, sizeof(buffer), now)) > 0)
+            {
+                analyseur.feed(buffer, size);
+                Visca::Reply received;
+                while (analyseur.next(received))
+                {
+                    transactions.handleReply(received);
+                }
+            }
+        }
+    };
+
+    Visca::Command addressSet = Visca::addressSet();
+    simulateur.receive(addressSet.bytes, addressSet.size, now);
+    run(100ms);
+    ordonnanceur.schedule(Visca::absolutePosition(1, 0x01, 0x01, 0x0700, 0x0000));
+    ordonnanceur.schedule(Visca::zoomDirect(1, 0x4000));
+    run(200ms);
+    QCOMPARE(transactions.inFlightCount(), 2);
+
+    etat.track(1);
+    QMetaObject::invokeMethod(&etat, "poll");
+    QCOMPARE(transactions.inFlightCount(), 3);      // Pan/tilt seulement, le zoom suit sa réponse
+    QCOMPARE(transactions.pendingCount(), 0);
+    run(100ms);
+    CameraState state = etat.state(1);
+    QVERIFY(state.valid);
+    QVERIFY(state.pan > 0);
+    QVERIFY(state.zoom > 0);
+    QVERIFY(simulateur.position(0).moving);
+
+    etat.track(1);
+    QMetaObject::invokeMethod(&etat, "poll");
+    SimulateurVisca::Clock::time_point requested = now;
+    ordonnanceur.schedule(Visca::panTiltStop(1));
+    run(200ms);
+    QVERIFY(stopWritten != SimulateurVisca::Clock::time_point());
+    QVERIFY(stopWritten - requested < 30ms);
+    QVERIFY(etat.state(1).valid);
+}
+
+void TestsVisca::tourWaitsForCompletion()
+{
+    // Tournée « balayage » sans temps d'arrêt, sur SimulateurVisca en temps virtuel : chaque
+    // position absolue ne part qu'une fois la caméra arrêtée sur la position de l'étape
+    // précédente (Completion reçue), jamais à l'ACK
+    using namespace std::chrono_literals;
+    SimulateurVisca simulateur{ SimulateurVisca::Options() };
+    SimulateurVisca::Clock::time_point now = SimulateurVisca::Clock::now();
+    QList<SimulateurVisca::Position> atSend;
+
+    TransactionsVisca transactions([&](const char* data, qint64 size) {
+        for (qint64 index = 0; index + 3 < size; ++index)
+        {
+            // 8x 01 06 02 : position absolue (les paramètres n'ont jamais le bit 7)
+            if ((data[index] & 0xF0) == 0x80 && data[index + 1] == 0x01 && data[index + 2] == 0x06 && data[index + 3] == 0x02)
+            {
+                atSend.append(simulateur.position(0));
+            }
+        }
+        simulateur.receive(reinterpret_cast<const std::uint8_t*>(data), static_cast<std::size_t>(size), now);
+        return true;
+    });
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    MoteurTournees tournees([&](const Visca::Command& command, quint32 id) {
+        return ordonnanceur.schedule(command, CommandClass::None, id, CommandPriority::Background);
+    });
+    QObject::connect(&transactions, &TransactionsVisca::commandCompleted, &tournees, &MoteurTournees::onCommandCompleted);
+    QObject::connect(&transactions, &TransactionsVisca::commandFailed, &tournees, &MoteurTournees::onCommandFailed);
+    QSignalSpy reached(&tournees, &MoteurTournees::stepReached);
+    QSignalSpy finished(&tournees, &MoteurTournees::tourFinished);
+    AnalyseurVisca analyseur;
+    auto run = [&](std::chrono::milliseconds duration) {
+        for (SimulateurVisca::Clock::time_point end = now + duration; now < end; )
+        {
+            now += 1ms;
+            simulateur.advance(now);
+            std::uint8_t buffer[AnalyseurVisca::RING_SIZE];
+            std::size_t size;
+            while ((size = simulateur.transmit(buffer, sizeof(buffer), now)) > 0)
+            {
+                analyseur.feed(buffer, size);
+                Visca::Reply received;
+                while (analyseur.next(received))
+                {
+                    transactions.handleReply(received);
+                }
+            }
+        }
+    };
+
+    Visca::Command addressSet = Visca::addressSet();
+    simulateur.receive(addressSet.bytes, addressSet.size, now);
+    run(100ms);
+
+    BibliothequePresets presets;
+    const Tour* tour = presets.tour("balayage");
+    QVERIFY(tour);
+    QVERIFY(tournees.start(1, *tour, presets));
+    run(100ms);
+    QCOMPARE(atSend.size(), 1);             // Première étape en route, la suivante attend
+    QVERIFY(simulateur.position(0).moving);
+
+    run(10s);
+    QCOMPARE(finished.size(), 1);
+    QCOMPARE(reached.size(), tour->steps.size());
+    QCOMPARE(atSend.size(), tour->steps.size());
+    for (int step = 1; step < tour->steps.size(); ++step)
+    {
+        const Preset* previous = presets.preset(tour->steps.at(step - 1).preset);
+        QVERIFY(!atSend.at(step).moving);
+        QVERIFY(std::abs(atSend.at(step).pan - previous->pan) < 1.0);
+    }
+}
+
+void TestsVisca::keepsLatestTelemetryPerCamera()
+{
+    CanalTelemetrie canal;
+    Telemetrie::Snapshot snapshot = {};
+
+    for (int index = 0; index < 10; ++index)
+    {
+        snapshot.address = static_cast<std::uint8_t>(1 + index % 2);
+        snapshot.pan = static_cast<std::int16_t>(index);
+        QVERIFY(canal.push(snapshot));
+    }
+    QCOMPARE(canal.drain(), std::size_t(10));
+    QCOMPARE(canal.latest(1).pan, std::int16_t(8));
+    QCOMPARE(canal.latest(2).pan, std::int16_t(9));
+    QCOMPARE(canal.latest(2).sequence, std::uint64_t(10));
+
+    for (std::size_t index = 0; index < CanalTelemetrie::CAPACITY; ++index)
+    {
+        canal.push(snapshot);
+    }
+    QVERIFY(!canal.push(snapshot));
+    QCOMPARE(canal.droppedCount(), std::uint64_t(1));
+}
+
+void TestsVisca::poolDropsStaleFrames()
+{
+    PoolImages pool(3);
+
+    int first = pool.acquire();
+    int second = pool.acquire();
+    int third = pool.acquire();
+    QVERIFY(first >= 0 && second >= 0 && third >= 0);
+    QCOMPARE(pool.acquire(), -1);
+
+    // Une image non prise est rendue au producteur dès qu'une plus récente est publiée
+    pool.publish(first);
+    pool.publish(second);
+    QCOMPARE(pool.droppedCount(), std::uint64_t(1));
+    QCOMPARE(pool.acquire(), first);
+    QCOMPARE(pool.take(), second);
+    QCOMPARE(pool.take(), -1);
+
+    // L'image affichée reste au consommateur jusqu'à ce qu'il la rende
+    pool.publish(third);
+    QCOMPARE(pool.acquire(), -1);
+    pool.release(second);
+    QCOMPARE(pool.acquire(), second);
+    QCOMPARE(pool.publishedCount(), std::uint64_t(3));
+}
+
+void TestsVisca::captureSharesItsBuffers()
+{
+    CaptureVideo capture;
+    QSignalSpy ready(&capture, &CaptureVideo::frameReady);
+    capture.open("synthetique:64x36:200");
+
+    QTRY_VERIFY(ready.count() >= 1);
+    capture.acknowledge();
+    int slot = capture.pool().take();
+    QVERIFY(slot >= 0);
+    const Video::Image& image = capture.pool().imageAt(slot);
+    const std::uint8_t* pixels = image.data;
+    QCOMPARE(image.width, 64);
+    QVERIFY(image.format == Video::PixelFormat::Gray8);
+    QVERIFY(image.captureTime > 0);
+
+    // Tant que l'image est tenue, la capture écrit dans les autres emplacements seulement
+    QTRY_VERIFY(ready.count() >= 2);
+    capture.acknowledge();
+    int next = capture.pool().take();
+    QVERIFY(next >= 0 && next != slot);
+    QCOMPARE(capture.pool().imageAt(slot).data, pixels);
+    QVERIFY(capture.pool().imageAt(next).data != pixels);
+    QVERIFY(capture.pool().imageAt(next).sequence > capture.pool().imageAt(slot).sequence);
+    capture.pool().release(slot);
+    capture.pool().release(next);
+}
+
+void TestsVisca::motionKernelsAgree()
+{
+    // Largeurs et nombres de pixels non multiples des registres : les fins de ligne passent
+    // par la version scalaire
+    const int width = 1922;
+    const int height = 18;
+    const int stride = width * 2 + 6;
+    QByteArray source(stride * height, Qt::Uninitialized);
+    quint32 noise = 7;
+    for (char& byte : source)
+    {
+        noise = noise * 1664525u + 1013904223u;
+        byte = static_cast<char>(noise >> 24);
+    }
+    const std::uint8_t* pixels = reinterpret_cast<const std::uint8_t*>(source.constData());
+    const int count = (width / 4) * (height / 4);
+
+    const NoyauxMouvement::Isa best = NoyauxMouvement::best();
+    std::vector<std::uint8_t> scalar(count);
+    std::vector<std::uint8_t> vector(count);
+    NoyauxMouvement::downscaleGray(pixels, stride, width, height, scalar.data(), NoyauxMouvement::Isa::Scalar);
+    NoyauxMouvement::downscaleGray(pixels, stride, width, height, vector.data(), best);
+    QVERIFY(scalar == vector);
+    NoyauxMouvement::downscaleYuyv(pixels, stride, width, height, scalar.data(), NoyauxMouvement::Isa::Scalar);
+    NoyauxMouvement::downscaleYuyv(pixels, stride, width, height, vector.data(), best);
+    QVERIFY(scalar == vector);
+
+    std::vector<std::uint8_t> previous(pixels + count, pixels + 2 * count);
+    std::vector<std::uint8_t> mask(pixels + 2 * count, pixels + 3 * count);
+    std::vector<std::uint8_t> scalarBackground(pixels + 3 * count, pixels + 4 * count);
+    std::vector<std::uint8_t> vectorBackground = scalarBackground;
+    std::uint32_t scalarCounts[NoyauxMouvement::MAX_ZONES];
+    std::uint32_t vectorCounts[NoyauxMouvement::MAX_ZONES];
+    NoyauxMouvement::detect(scalar.data(), previous.data(), scalarBackground.data(), mask.data(), count, 24, 3,
+        NoyauxMouvement::MAX_ZONES, scalarCounts, NoyauxMouvement::Isa::Scalar);
+    NoyauxMouvement::detect(scalar.data(), previous.data(), vectorBackground.data(), mask.data(), count, 24, 3,
+        NoyauxMouvement::MAX_ZONES, vectorCounts, best);
+    QVERIFY(scalarBackground == vectorBackground);
+    for (int zone = 0; zone < NoyauxMouvement::MAX_ZONES; ++zone)
+    {
+        QCOMPARE(vectorCounts[zone], scalarCounts[zone]);
+        QVERIFY(scalarCounts[zone] > 0);
+    }
+}
+
+void TestsVisca::raisesMotionInItsZone()
+{
+    const int width = 320;
+    const int height = 240;
+    DetectionMouvement detection(3);
+    DetectionMouvement::Zone left;
+    left.name = "gauche";
+    left.area = QRectF(0.0, 0.0, 0.5, 1.0);
+    DetectionMouvement::Zone right = left;
+    right.name = "droite";
+    right.area = QRectF(0.5, 0.0, 0.5, 1.0);
+    detection.setZones({ left, right });
+    QSignalSpy started(&detection, &DetectionMouvement::motionStarted);
+    QSignalSpy stopped(&detection, &DetectionMouvement::motionStopped);
+
+    std::vector<std::uint8_t> pixels(width * height, 80);
+    Video::Image image;
+    image.data = pixels.data();
+    image.width = width;
+    image.height = height;
+    image.stride = width;
+    auto feed = [&](int frames) {
+        for (int i = 0; i < frames; ++i)
+        {
+            image.captureTime += 33000000;
+            detection.process(image);
+        }
+    };
+
+    feed(3);
+    QCOMPARE(started.count(), 0);
+
+    // Un carré clair apparaît à gauche puis se déplace : l'alarme part à la deuxième image
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        std::fill(pixels.begin(), pixels.end(), 80);
+        for (int y = 80; y < 160; ++y)
+        {
+            std::fill_n(pixels.begin() + y * width + 20 + frame * 40, 60, 220);
+        }
+        feed(1);
+        QCOMPARE(started.count(), frame >= 1 ? 1 : 0);
+    }
+    QCOMPARE(started.first().at(0).value<quint8>(), quint8(3));
+    QCOMPARE(started.first().at(1).toInt(), 0);
+    QCOMPARE(started.first().at(2).toString(), QString("gauche"));
+
+    // Retour au calme : l'alarme tombe après HOLD_MS
+    std::fill(pixels.begin(), pixels.end(), 80);
+    feed(static_cast<int>(DetectionMouvement::HOLD_MS / 33) + 2);
+    QCOMPARE(stopped.count(), 1);
+    QCOMPARE(started.count(), 1);
+    QCOMPARE(detection.stats().events, quint64(1));
+}
+
+void TestsVisca::ringKeepsUnwrittenFrames()
+{
+    // Place pour quatre images de 512 octets : la cinquième repart au début de l'anneau
+    AnneauImages ring(4 * 512 + 100, 16);
+    std::vector<std::uint8_t> pixels(32 * 16);
+    Video::Image image;
+    image.data = pixels.data();
+    image.width = 32;
+    image.height = 16;
+    image.stride = 32;
+    auto push = [&](int value) {
+        std::fill(pixels.begin(), pixels.end(), static_cast<std::uint8_t>(value));
+        image.captureTime = value;
+        image.sequence = static_cast<quint64>(value);
+        return ring.push(image);
+    };
+
+    for (int value = 1; value <= 6; ++value)
+    {
+        QVERIFY(push(value));
+    }
+    QCOMPARE(ring.stats().frames, std::size_t(4));
+    QCOMPARE(ring.stats().evicted, std::uint64_t(2));
+
+    AnneauImages::Frame frames[8];
+    ring.startReading(0);
+    QCOMPARE(ring.peek(frames, 8), std::size_t(4));
+    for (int index = 0; index < 4; ++index)
+    {
+        QCOMPARE(frames[index].captureTime, std::int64_t(index + 3));
+        const std::uint8_t* data = ring.data(frames[index]);
+        QCOMPARE(data[0], std::uint8_t(index + 3));
+        QCOMPARE(data[frames[index].size - 1], std::uint8_t(index + 3));
+    }
+
+    // Les images pas encore écrites ne sont jamais écrasées : la nouvelle est refusée
+    QVERIFY(!push(7));
+    QCOMPARE(ring.stats().overruns, std::uint64_t(1));
+    ring.consume(2);
+    QVERIFY(push(7));
+    QCOMPARE(ring.peek(frames, 8), std::size_t(3));
+    QCOMPARE(frames[0].captureTime, std::int64_t(5));
+    QCOMPARE(ring.data(frames[2])[0], std::uint8_t(7));
+}
+
+void TestsVisca::recorderWritesIndexedSegments()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    EnregistreurVideo recorder(2, directory.path(), 64 * 1024);
+    QSignalSpy started(&recorder, &EnregistreurVideo::recordingStarted);
+    QSignalSpy stopped(&recorder, &EnregistreurVideo::recordingStopped);
+
+    std::vector<std::uint8_t> pixels(32 * 16);
+    Video::Image image;
+    image.data = pixels.data();
+    image.width = 32;
+    image.height = 16;
+    image.stride = 32;
+    auto push = [&](int value, qint64 captureTime) {
+        std::fill(pixels.begin(), pixels.end(), static_cast<std::uint8_t>(value));
+        image.captureTime = captureTime;
+        image.sequence = static_cast<quint64>(value);
+        QVERIFY(recorder.ring().push(image));
+    };
+
+    // Vingt images avant le déclenchement, cinq après
+    qint64 now = PiloteVitesse::now();
+    for (int value = 0; value < 20; ++value)
+    {
+        push(value, now - (20 - value) * 1000000);
+    }
+    recorder.trigger("test");
+    QCOMPARE(started.count(), 1);
+    for (int value = 20; value < 25; ++value)
+    {
+        push(value, PiloteVitesse::now());
+    }
+    recorder.flush();
+    recorder.stop();
+    QCOMPARE(stopped.count(), 1);
+    QCOMPARE(stopped.first().at(0).value<quint64>(), quint64(25));
+    QVERIFY(!recorder.isRecording());
+    QCOMPARE(recorder.stats().writes, quint64(2));     // Un bloc par lot
+
+    QStringList segments = QDir(directory.path()).entryList({ "*.vseg" });
+    QCOMPARE(segments.size(), 1);
+    QFile segment(QDir(directory.path()).filePath(segments.first()));
+    QFile index(QDir(directory.path()).filePath(segments.first().replace(".vseg", ".vidx")));
+    QVERIFY(segment.open(QIODevice::ReadOnly));
+    QVERIFY(index.open(QIODevice::ReadOnly));
+    QByteArray data = segment.readAll();
+    QByteArray entries = index.readAll();
+
+    Segment::FileHeader header;
+    QCOMPARE(data.size(), qsizetype(sizeof(header) + 25 * 512));
+    std::memcpy(&header, data.constData(), sizeof(header));
+    QVERIFY(std::memcmp(header.magic, Segment::MAGIC, sizeof(Segment::MAGIC)) == 0);
+    QCOMPARE(header.address, std::uint8_t(2));
+    QCOMPARE(header.width, std::uint32_t(32));
+    QCOMPARE(entries.size(), qsizetype(25 * sizeof(Segment::IndexEntry)));
+    for (int value = 0; value < 25; ++value)
+    {
+        Segment::IndexEntry entry;
+        std::memcpy(&entry, entries.constData() + value * sizeof(entry), sizeof(entry));
+        QCOMPARE(entry.sequence, std::uint64_t(value));
+        QCOMPARE(entry.size, std::uint32_t(512));
+        QCOMPARE(static_cast<std::uint8_t>(data.at(static_cast<qsizetype>(entry.offset))), std::uint8_t(value));
+    }
+}
+
+void TestsVisca::aimsAtPreviewPoints()
+{
+    // Le zoom et le grossissement se correspondent dans les deux sens
+    QCOMPARE(ChampVision::magnification(0), 1.0);
+    QVERIFY(std::abs(ChampVision::magnification(ChampVision::ZOOM_MAX) - ChampVision::MAX_MAGNIFICATION) < 1e-9);
+    for (std::uint16_t zoom : { std::uint16_t(0x1000), std::uint16_t(0x2A1D), std::uint16_t(0x3C00) })
+    {
+        QVERIFY(std::abs(ChampVision::zoomFor(ChampVision::magnification(zoom)) - zoom) <= 1);
+    }
+
+    // En grand angle, le bord droit est à un demi-champ (24°) et le centre ne bouge pas
+    const double aspect = 16.0 / 9.0;
+    ChampVision::Pose home;
+    ChampVision::Pose right = ChampVision::centerOn(home, 1.0, 0.5, aspect);
+    QCOMPARE(right.pan, std::int16_t(346));
+    QCOMPARE(right.tilt, std::int16_t(0));
+    ChampVision::Pose center = ChampVision::centerOn(right, 0.5, 0.5, aspect);
+    QCOMPARE(center.pan, right.pan);
+    QCOMPARE(center.tilt, right.tilt);
+
+    // Un point vers le haut reste au centre de l'image une fois visé, même caméra inclinée
+    ChampVision::Pose tilted;
+    tilted.pan = -600;
+    tilted.tilt = 500;
+    tilted.zoom = ChampVision::zoomFor(3.0);
+    double pan;
+    double tilt;
+    ChampVision::direction(tilted, 0.8, 0.2, aspect, pan, tilt);
+    ChampVision::Pose aimed = ChampVision::centerOn(tilted, 0.8, 0.2, aspect);
+    double centerPan;
+    double centerTilt;
+    ChampVision::direction(aimed, 0.5, 0.5, aspect, centerPan, centerTilt);
+    QVERIFY(std::abs(centerPan - pan) < 1.0);
+    QVERIFY(std::abs(centerTilt - tilt) < 1.0);
+
+    // Un rectangle du quart de l'image est cadré à quatre fois le grossissement, borné à 18x
+    ChampVision::Pose framed = ChampVision::frame(home, 0.375, 0.375, 0.25, 0.25, aspect);
+    QCOMPARE(framed.pan, std::int16_t(0));
+    QVERIFY(std::abs(ChampVision::magnification(framed.zoom) - 4.0) < 0.01);
+    QCOMPARE(ChampVision::frame(framed, 0.49, 0.49, 0.02, 0.02, aspect).zoom, ChampVision::ZOOM_MAX);
+}
+
+void TestsVisca::sendsGroupCommandsInOneWrite()
+{
+    PortEcrit port;
+    TransactionsVisca transactions(port.writer());
+    OrdonnanceurCommandes ordonnanceur(transactions);
+    QSignalSpy completed(&transactions, &TransactionsVisca::commandCompleted);
+
+    // Trois caméras adressées : une seule écriture, les paquets bout à bout
+    transactions.holdWrites();
+    for (std::uint8_t address = 1; address <= 3; ++address)
+    {
+        ordonnanceur.schedule(Visca::memoryRecall(address, 5));
+    }
+    QVERIFY(port.packets.isEmpty());
+    transactions.releaseWrites();
+    QCOMPARE(port.packets.size(), 1);
+    QCOMPARE(port.packets.first(), bytes(Visca::memoryRecall(1, 5)) + bytes(Visca::memoryRecall(2, 5))
+        + bytes(Visca::memoryRecall(3, 5)));
+    QCOMPARE(transactions.stats().bursts, quint64(1));
+    transactions.handleReply(reply({ 0x90, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0xA0, 0x41, 0xFF }));
+    transactions.handleReply(reply({ 0xB0, 0x41, 0xFF }));
+    QCOMPARE(transactions.inFlightCount(), 3);
+
+    // Diffusion : pas d'ACK, la commande revenue au contrôleur termine la transaction
+    quint32 id = ordonnanceur.schedule(Visca::memoryRecall(Visca::BROADCAST_ADDRESS, 5));
+    QCOMPARE(OrdonnanceurCommandes::priorityOf(Visca::memoryRecall(Visca::BROADCAST_ADDRESS, 5)), CommandPriority::Motion);
+    QCOMPARE(port.packets.last(), bytes(Visca::memoryRecall(Visca::BROADCAST_ADDRESS, 5)));
+    Visca::Reply returned = reply({ 0x88, 0x01, 0x04, 0x3F, 0x02, 0x05, 0xFF });
+    QCOMPARE(returned.type, Visca::ReplyType::Broadcast);
+    transactions.handleReply(returned);
+    QCOMPARE(completed.size(), 1);
+    QCOMPARE(completed.at(0).at(0).value<quint32>(), id);
+
+    // Une diffusion n'est renvoyée que si la commande diffusée peut l'être
+    QVERIFY(!PolitiqueReprise::isIdempotent(Visca::relativePosition(Visca::BROADCAST_ADDRESS, 1, 1, 0x0100, 0)));
+    QVERIFY(PolitiqueReprise::isIdempotent(Visca::ifClear()));
+}
+
+QTEST_GUILESS_MAIN(TestsVisca)
+#include "main.moc"